@@ -72,6 +72,9 @@ namespace gbe
     // void dumpFreeList();
     /*! the maximum offset */
     int32_t maxOffset;
+    /*! Bytes currently allocated and their peak */
+    int32_t usedSize;
+    int32_t maxUsedSize;
     /*! Head and tail of the free list */
     Block *head;
     Block *tail;
@@ -94,6 +97,7 @@ namespace gbe
   class RegisterAllocator: public SimpleAllocator {
   public:
     RegisterAllocator(int32_t offset, int32_t size): SimpleAllocator(offset, size) {}
+    int32_t getMaxRegUsed() { return maxUsedSize; }
 
     GBE_CLASS(RegisterAllocator);
   };
@@ -113,7 +117,7 @@ namespace gbe
 
   SimpleAllocator::SimpleAllocator(int32_t startOffset,
                                    int32_t size)
-                                  : maxOffset(0) {
+                                  : maxOffset(0), usedSize(0), maxUsedSize(0) {
     tail = head = this->newBlock(startOffset, size);
   }
 
@@ -251,6 +255,8 @@ namespace gbe
       allocatedBlocks.insert(std::make_pair(aligned, size));
       // update max offset
       if(aligned + size > maxOffset) maxOffset = aligned + size;
+      usedSize += size;
+      if(usedSize > maxUsedSize) maxUsedSize = usedSize;
       // We have a valid offset now
       return aligned;
     }
@@ -263,6 +269,7 @@ namespace gbe
     auto it = allocatedBlocks.find(offset);
     GBE_ASSERT(it != allocatedBlocks.end());
     const int32_t size = it->second;
+    usedSize -= size;
 
     // Find the two blocks where to insert the new block
     Block *list = tail, *next = nullptr;
@@ -388,6 +395,7 @@ namespace gbe
     }
     if(this->kernel != nullptr) {
       this->kernel->scratchSize = this->alignScratchSize(scratchAllocator->getMaxScratchMemUsed());
+      this->kernel->grfSize = registerAllocator->getMaxRegUsed();
       this->kernel->ctx = this;
       this->kernel->setUseDeviceEnqueue(fn.getUseDeviceEnqueue());
     }
@@ -72,6 +72,9 @@ static const struct {
   [GEN_OPCODE_F16TO32] = { .name = "f16to32", .nsrc = 1, .ndst = 1 },
   [GEN_OPCODE_F32TO16] = { .name = "f32to16", .nsrc = 1, .ndst = 1 },
   [GEN_OPCODE_BFREV] = { .name = "bfrev", .nsrc = 1, .ndst = 1 },
+  [GEN_OPCODE_BFE] = { .name = "bfe", .nsrc = 3, .ndst = 1 },
+  [GEN_OPCODE_BFI1] = { .name = "bfi1", .nsrc = 2, .ndst = 1 },
+  [GEN_OPCODE_BFI2] = { .name = "bfi2", .nsrc = 3, .ndst = 1 },
 
   [GEN_OPCODE_MUL] = { .name = "mul", .nsrc = 2, .ndst = 1 },
   [GEN_OPCODE_MAC] = { .name = "mac", .nsrc = 2, .ndst = 1 },
@@ -330,9 +330,20 @@ namespace gbe
 
     uint32_t base = src0.nr * 32 + src0.subnr;
     GenRegister baseReg = GenRegister::immuw(base);
-    const GenRegister a0 = GenRegister::addr8(0);
-    p->ADD(a0, GenRegister::unpacked_uw(src1.nr, src1.subnr / typeSize(GEN_TYPE_UW)), baseReg);
     GenRegister indirect = GenRegister::to_indirect1xN(src0, 0, 0);
+    if (src1.hstride == GEN_HORIZONTAL_STRIDE_0) {
+      // Uniform index, one address and a scalar region
+      p->push();
+        p->curr.execWidth = 1;
+        p->curr.predicate = GEN_PREDICATE_NONE;
+        p->curr.noMask = 1;
+        p->ADD(GenRegister::addr1(0), GenRegister::retype(src1, GEN_TYPE_UW), baseReg);
+      p->pop();
+      indirect.vstride = GEN_VERTICAL_STRIDE_0;
+    } else {
+      const GenRegister a0 = GenRegister::addr8(0);
+      p->ADD(a0, GenRegister::unpacked_uw(src1.nr, src1.subnr / typeSize(GEN_TYPE_UW)), baseReg);
+    }
     p->MOV(dst, indirect);
   }
 
@@ -463,15 +474,10 @@ namespace gbe
     GenRegister s0l_s1h_h = unpacked_ud(s0l_s1h, 1);
     p->ADD(dst_h, dst_h, s0l_s1h_h);
 
-    // No longer need s0l_s1h
-    GenRegister tmp = s0l_s1h;
-
-    p->SHL(tmp, s0h_s1l, GenRegister::immud(32));
-    GenRegister tmp_unpacked = unpacked_ud(tmp, 1);
-    p->MOV(dst_l_h, tmp_unpacked);
-
-    p->SHR(tmp, s0h_s1l, GenRegister::immud(32));
-    p->ADD(dst_h, dst_h, tmp);
+    /* The low dword of the middle sum is the high dword of dst_l and its
+       high dword is the carry into dst_h, both read as unpacked dwords. */
+    p->MOV(dst_l_h, unpacked_ud(s0h_s1l));
+    p->ADD(dst_h, dst_h, unpacked_ud(s0h_s1l, 1));
   }
 
   void Gen8Context::calculateFullS64MUL(GenRegister src0, GenRegister src1, GenRegister dst_h,
@@ -725,22 +731,25 @@ namespace gbe
     dst.type = GEN_TYPE_UL;
     res.type = GEN_TYPE_UL;
 
-    /* Low 32 bits X low 32 bits. */
     GenRegister s0l = unpacked_ud(src0);
     GenRegister s1l = unpacked_ud(src1);
-    p->MUL(dst, s0l, s1l);
-
-    /* Low 32 bits X high 32 bits. */
+    GenRegister s0h = GenRegister::offset(s0l, 0, 4);
     GenRegister s1h = GenRegister::offset(s1l, 0, 4);
-    p->MUL(res, s0l, s1h);
-    p->SHL(res, res, GenRegister::immud(32));
-    p->ADD(dst, dst, res);
 
-    /* High 32 bits X low 32 bits. */
-    GenRegister s0h = GenRegister::offset(s0l, 0, 4);
-    p->MUL(res, s0h, s1l);
-    p->SHL(res, res, GenRegister::immud(32));
-    p->ADD(dst, dst, res);
+    /* The cross products only reach the high dword of the result, so their
+       low 32 bits are enough: use the native 32x32 dword MUL for them and
+       add them to the high dword, instead of 64 bits MUL, SHL and ADD. The
+       cross products are computed first as dst may be one of the sources. */
+    GenRegister cross0 = unpacked_ud(res);
+    GenRegister cross1 = unpacked_ud(res, 1);
+    p->MUL(cross0, s0l, s1h);
+    p->MUL(cross1, s0h, s1l);
+    p->ADD(cross0, cross0, cross1);
+
+    /* Low 32 bits X low 32 bits, the full 64 bits product. */
+    p->MUL(dst, s0l, s1l);
+    GenRegister dst_h = unpacked_ud(dst, 1);
+    p->ADD(dst_h, dst_h, cross0);
   }
 
   void Gen8Context::emitI64HADDInstruction(const SelectionInstruction &insn)
@@ -749,20 +758,17 @@ namespace gbe
     GenRegister src1 = ra->genReg(insn.src(1));
     GenRegister dst = ra->genReg(insn.dst(0));
     GenRegister tmp0 = ra->genReg(insn.dst(1));
-    GenRegister tmp1 = ra->genReg(insn.dst(2));
 
     /* Src0 and Src1 are always unsigned long type.*/
     GBE_ASSERT(src0.type == GEN_TYPE_UL && src1.type == GEN_TYPE_UL);
     dst.type = src0.type;
-    tmp0.type = tmp1.type = GEN_TYPE_UL;
+    tmp0.type = GEN_TYPE_UL;
 
-    //hadd = (src0>>1) + (src1>>1) + ((src0&0x1) & (src1&0x1))
-    p->AND(tmp0, src0, GenRegister::immud(1));
-    p->AND(dst, src1, tmp0);
-    p->SHR(tmp0, src0, GenRegister::immud(1));
-    p->SHR(tmp1, src1, GenRegister::immud(1));
+    //hadd = (src0&src1) + ((src0^src1)>>1), which never overflows
+    p->XOR(tmp0, src0, src1);
+    p->SHR(tmp0, tmp0, GenRegister::immud(1));
+    p->AND(dst, src0, src1);
     p->ADD(dst, dst, tmp0);
-    p->ADD(dst, dst, tmp1);
   }
 
   void Gen8Context::emitI64RHADDInstruction(const SelectionInstruction &insn)
@@ -771,21 +777,17 @@ namespace gbe
     GenRegister src1 = ra->genReg(insn.src(1));
     GenRegister dst = ra->genReg(insn.dst(0));
     GenRegister tmp0 = ra->genReg(insn.dst(1));
-    GenRegister tmp1 = ra->genReg(insn.dst(2));
 
     /* Src0 and Src1 are always unsigned long type.*/
     GBE_ASSERT(src0.type == GEN_TYPE_UL && src1.type == GEN_TYPE_UL);
     dst.type = src0.type;
-    tmp0.type = tmp1.type = GEN_TYPE_UL;
+    tmp0.type = GEN_TYPE_UL;
 
-    //rhadd = (src0>>1) + (src1>>1) + ((src0&0x1) | (src1&0x1))
-    p->AND(tmp0, src0, GenRegister::immud(1));
-    p->AND(tmp1, src1, GenRegister::immud(1));
-    p->OR(dst, tmp0, tmp1);
-    p->SHR(tmp0, src0, GenRegister::immud(1));
-    p->SHR(tmp1, src1, GenRegister::immud(1));
-    p->ADD(dst, dst, tmp0);
-    p->ADD(dst, dst, tmp1);
+    //rhadd = (src0|src1) - ((src0^src1)>>1), which never overflows
+    p->XOR(tmp0, src0, src1);
+    p->SHR(tmp0, tmp0, GenRegister::immud(1));
+    p->OR(dst, src0, src1);
+    p->ADD(dst, dst, GenRegister::negate(tmp0));
   }
 
   void Gen8Context::emitI64DIVREMInstruction(const SelectionInstruction &cnst_insn)
@@ -1588,6 +1590,56 @@ namespace gbe
       GBE_ASSERT(0);
   }
 
+  /* Region of the n lanes of reg starting at lane first, n being 1 or a power
+   * of two */
+  static GenRegister wgOpLanes(GenRegister reg, uint32_t first, uint32_t n)
+  {
+    const uint32_t typeSz = typeSize(reg.type);
+    const uint32_t offset = reg.nr * GEN_REG_SIZE + reg.subnr + first * typeSz;
+    reg.nr = offset / GEN_REG_SIZE;
+    reg.subnr = offset % GEN_REG_SIZE;
+    if (n == 1)
+      return GenRegister::toUniform(reg, reg.type);
+    const uint32_t width = std::min(n, GEN_REG_SIZE / typeSz);
+    reg.hstride = GEN_HORIZONTAL_STRIDE_1;
+    reg.width = logi2(width);
+    reg.vstride = logi2(width) + 1;
+    return reg;
+  }
+
+  /* Lanes from first issued by one instruction: a power of two aligned on
+   * itself, with a destination in one GRF so that a source shifted by some
+   * lanes spans two GRFs at most */
+  static uint32_t wgOpChunk(uint32_t first, uint32_t end, uint32_t type)
+  {
+    uint32_t n = GEN_REG_SIZE / typeSize(type);
+    while (first % n || first + n > end)
+      n /= 2;
+    return n;
+  }
+
+  /* One Kogge-Stone step of an inclusive scan over the simd lanes:
+   * dst[i] = src[i - d] op src[i], dst[i] = src[i] for the first d lanes */
+  static void wgOpScanStep(GenRegister dst,
+                           GenRegister src,
+                           uint32_t d,
+                           uint32_t simd,
+                           uint32_t wg_op,
+                           GenEncoder *p)
+  {
+    p->push();
+    for (uint32_t first = 0, n; first < simd; first += n) {
+      n = wgOpChunk(first, first < d ? d : simd, dst.type);
+      p->curr.execWidth = n;
+      if (first < d)
+        p->MOV(wgOpLanes(dst, first, n), wgOpLanes(src, first, n));
+      else
+        wgOpPerform(wgOpLanes(dst, first, n), wgOpLanes(src, first - d, n),
+                    wgOpLanes(src, first, n), wg_op, p);
+    }
+    p->pop();
+  }
+
   static void wgOpPerformThread(GenRegister threadDst,
                                   GenRegister inputVal,
                                   GenRegister threadExchangeData,
@@ -1606,9 +1658,6 @@ namespace gbe
    threadDst = GenRegister::retype(threadDst, inputVal.type);
    threadExchangeData = GenRegister::retype(threadExchangeData, inputVal.type);
 
-   vector<GenRegister> input;
-   vector<GenRegister> result;
-
    /* for workgroup all and any we can use simd_all/any for each thread */
    if (wg_op == ir::WORKGROUP_OP_ALL || wg_op == ir::WORKGROUP_OP_ANY) {
      GenRegister constZero = GenRegister::immuw(0);
@@ -1656,83 +1705,32 @@ namespace gbe
        return;
      }
 
-     /* init thread data to min/max/null values */
-     p->push(); {
+     if (wg_op == ir::WORKGROUP_OP_REDUCE_ADD ||
+         wg_op == ir::WORKGROUP_OP_REDUCE_MIN ||
+         wg_op == ir::WORKGROUP_OP_REDUCE_MAX) {
+       /* reduction tree, each step folds the upper half of the lanes left
+        * onto the lower half */
        p->curr.execWidth = simd;
-       wgOpInitValue(p, threadExchangeData, wg_op);
        p->MOV(resultVal, inputVal);
-     } p->pop();
-
-     GenRegister resultValSingle = resultVal;
-     resultValSingle.hstride = GEN_HORIZONTAL_STRIDE_0;
-     resultValSingle.vstride = GEN_VERTICAL_STRIDE_0;
-     resultValSingle.width = GEN_WIDTH_1;
-
-     GenRegister inputValSingle = inputVal;
-     inputValSingle.hstride = GEN_HORIZONTAL_STRIDE_0;
-     inputValSingle.vstride = GEN_VERTICAL_STRIDE_0;
-     inputValSingle.width = GEN_WIDTH_1;
-
-
-     /* make an array of registers for easy accesing */
-     for(uint32_t i = 0; i < simd; i++){
-       /* add all resultVal offset reg positions from list */
-       result.push_back(resultValSingle);
-       input.push_back(inputValSingle);
-
-       /* move to next position */
-       resultValSingle.subnr += typeSize(resultValSingle.type);
-       if (resultValSingle.subnr == 32) {
-           resultValSingle.subnr = 0;
-           resultValSingle.nr++;
+       for (uint32_t n = simd / 2; n > 0; n /= 2) {
+         p->curr.execWidth = n;
+         wgOpPerform(wgOpLanes(resultVal, 0, n), wgOpLanes(resultVal, 0, n),
+                     wgOpLanes(resultVal, n, n), wg_op, p);
        }
-       /* move to next position */
-       inputValSingle.subnr += typeSize(inputValSingle.type);
-       if (inputValSingle.subnr == 32) {
-           inputValSingle.subnr = 0;
-           inputValSingle.nr++;
+     } else {
+       /* inclusive scan in log2(simd) steps, ping-ponging between
+        * threadExchangeData and resultVal so that the last step writes
+        * resultVal, the exclusive scan is then shifted by one lane */
+       uint32_t stepNum = 0;
+       for (uint32_t d = 1; d < simd; d *= 2)
+         stepNum++;
+       GenRegister scanSrc = inputVal;
+       for (uint32_t d = 1; d < simd; d *= 2) {
+         GenRegister scanDst = stepNum-- % 2 ? resultVal : threadExchangeData;
+         wgOpScanStep(scanDst, scanSrc, d, simd, wg_op, p);
+         scanSrc = scanDst;
        }
      }
-
-     uint32_t start_i = 0;
-     if( wg_op == ir::WORKGROUP_OP_REDUCE_ADD ||
-         wg_op == ir::WORKGROUP_OP_REDUCE_MIN ||
-         wg_op == ir::WORKGROUP_OP_REDUCE_MAX ||
-         wg_op == ir::WORKGROUP_OP_INCLUSIVE_ADD ||
-         wg_op == ir::WORKGROUP_OP_INCLUSIVE_MIN ||
-         wg_op == ir::WORKGROUP_OP_INCLUSIVE_MAX) {
-       p->MOV(result[0], input[0]);
-       start_i = 1;
-     }
-
-     else if(wg_op == ir::WORKGROUP_OP_EXCLUSIVE_ADD ||
-         wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MIN ||
-         wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MAX) {
-       p->MOV(result[1], input[0]);
-       start_i = 2;
-     }
-
-     /* algorithm workgroup */
-     for (uint32_t i = start_i; i < simd; i++)
-     {
-       if( wg_op == ir::WORKGROUP_OP_REDUCE_ADD ||
-           wg_op == ir::WORKGROUP_OP_REDUCE_MIN ||
-           wg_op == ir::WORKGROUP_OP_REDUCE_MAX)
-         wgOpPerform(result[0], result[0], input[i], wg_op, p);
-
-       else if(wg_op == ir::WORKGROUP_OP_INCLUSIVE_ADD ||
-           wg_op == ir::WORKGROUP_OP_INCLUSIVE_MIN ||
-           wg_op == ir::WORKGROUP_OP_INCLUSIVE_MAX)
-         wgOpPerform(result[i], result[i - 1], input[i], wg_op, p);
-
-       else if(wg_op == ir::WORKGROUP_OP_EXCLUSIVE_ADD ||
-           wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MIN ||
-           wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MAX)
-         wgOpPerform(result[i], result[i - 1], input[i - 1], wg_op, p);
-
-       else
-         GBE_ASSERT(0);
-     }
    }
 
    if( wg_op == ir::WORKGROUP_OP_REDUCE_ADD ||
@@ -1741,9 +1739,9 @@ namespace gbe
    {
      p->curr.execWidth = simd;
      /* value exchanged with other threads */
-     p->MOV(threadExchangeData, result[0]);
+     p->MOV(threadExchangeData, wgOpLanes(resultVal, 0, 1));
      /* partial result thread */
-     p->MOV(threadDst, result[0]);
+     p->MOV(threadDst, wgOpLanes(resultVal, 0, 1));
    }
    else if(wg_op == ir::WORKGROUP_OP_INCLUSIVE_ADD ||
        wg_op == ir::WORKGROUP_OP_INCLUSIVE_MIN ||
@@ -1751,7 +1749,7 @@ namespace gbe
    {
      p->curr.execWidth = simd;
      /* value exchanged with other threads */
-     p->MOV(threadExchangeData, result[simd - 1]);
+     p->MOV(threadExchangeData, wgOpLanes(resultVal, simd - 1, 1));
      /* partial result thread */
      p->MOV(threadDst, resultVal);
    }
@@ -1759,15 +1757,18 @@ namespace gbe
        wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MIN ||
        wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MAX)
    {
-     p->curr.execWidth = 1;
-     /* set result[0] to min/max/null */
-     wgOpInitValue(p, result[0], wg_op);
-
      p->curr.execWidth = simd;
      /* value exchanged with other threads */
-     wgOpPerform(threadExchangeData, result[simd - 1], input[simd - 1], wg_op, p);
-     /* partial result thread */
-     p->MOV(threadDst, resultVal);
+     p->MOV(threadExchangeData, wgOpLanes(resultVal, simd - 1, 1));
+
+     /* partial result thread, set lane 0 to min/max/null */
+     p->curr.execWidth = 1;
+     wgOpInitValue(p, wgOpLanes(threadDst, 0, 1), wg_op);
+     for (uint32_t first = 1, n; first < simd; first += n) {
+       n = wgOpChunk(first, simd, threadDst.type);
+       p->curr.execWidth = n;
+       p->MOV(wgOpLanes(threadDst, first, n), wgOpLanes(resultVal, first - 1, n));
+     }
    }
 
    p->pop();
@@ -1778,15 +1779,14 @@ namespace gbe
  *
  * Implementation:
  * 1. All the threads first perform the workgroup op value for the
- * allocated work-items. SIMD16=> 16 work-items allocated for each thread
+ * allocated work-items. SIMD16=> 16 work-items allocated for each thread,
+ * with a log2(simd) steps reduction tree or Kogge-Stone scan over the lanes
  * 2. Each thread writes the partial result in shared local memory using threadId
- * 3. After a barrier, each thread will read in chunks of 1-4 elements,
- * the shared local memory region, using a loop based on the thread num value (threadN)
- * 4. Each thread computes the final value individually
- *
- * Optimizations:
- * Performance is given by chunk read. If threads read in chunks of 4 elements
- * the performance is increase 2-3x times compared to chunks of 1 element.
+ * 3. After a barrier, each thread gathers the partial results of 8 threads
+ * per SLM read, combining them lane-wise, up to the thread num value (threadN)
+ * for reduce or its threadId for scans
+ * 4. Each thread reduces the 8 lanes with a tree and computes the final value
+ * individually
  */
   void Gen8Context::emitWorkGroupOpInstruction(const SelectionInstruction &insn){
     const GenRegister dst = ra->genReg(insn.dst(0));
@@ -1794,8 +1794,9 @@ namespace gbe
     const GenRegister theVal = GenRegister::retype(ra->genReg(insn.src(2)), dst.type);
     GenRegister threadData = ra->genReg(insn.src(3));
     GenRegister partialData = GenRegister::toUniform(threadData, dst.type);
+    const GenRegister threadPartials = GenRegister::retype(threadData, dst.type);
     GenRegister threadId = ra->genReg(insn.src(0));
-    GenRegister threadLoop = ra->genReg(insn.src(1));
+    GenRegister threadNum = ra->genReg(insn.src(1));
     GenRegister barrierId = ra->genReg(GenRegister::ud1grf(ir::ocl::barrierid));
     GenRegister localBarrier = ra->genReg(insn.src(5));
 
@@ -1828,26 +1829,15 @@ namespace gbe
     p->MOV(theVal, dst);
     threadData = GenRegister::toUniform(threadData, dst.type);
 
-    /* store thread count for future use on read/write to SLM */
+    /* number of partial results to combine: all the threads for reduce,
+     * the previous threads for scans */
+    GenRegister threadLimit = threadId;
     if (wg_op == ir::WORKGROUP_OP_ANY ||
       wg_op == ir::WORKGROUP_OP_ALL ||
       wg_op == ir::WORKGROUP_OP_REDUCE_ADD ||
       wg_op == ir::WORKGROUP_OP_REDUCE_MIN ||
       wg_op == ir::WORKGROUP_OP_REDUCE_MAX)
-    {
-      threadLoop = GenRegister::retype(tmp, GEN_TYPE_D);
-      p->MOV(threadLoop, ra->genReg(GenRegister::ud1grf(ir::ocl::threadn)));
-    }
-    else if(wg_op == ir::WORKGROUP_OP_INCLUSIVE_ADD ||
-      wg_op == ir::WORKGROUP_OP_INCLUSIVE_MIN ||
-      wg_op == ir::WORKGROUP_OP_INCLUSIVE_MAX ||
-      wg_op == ir::WORKGROUP_OP_EXCLUSIVE_ADD ||
-      wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MIN ||
-      wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MAX)
-    {
-      threadLoop = GenRegister::retype(tmp, GEN_TYPE_D);
-      p->MOV(threadLoop, ra->genReg(GenRegister::ud1grf(ir::ocl::threadid)));
-    }
+      threadLimit = GenRegister::toUniform(threadNum, GEN_TYPE_UD);
 
     /* all threads write the partial results to SLM memory */
     if(dst.type == GEN_TYPE_UL || dst.type == GEN_TYPE_L)
@@ -1873,9 +1863,6 @@ namespace gbe
       p->UNTYPED_WRITE(msgAddr, msgData, GenRegister::immw(0xFE), 1, insn.extra.wgop.splitSend);
     }
 
-    /* init partialData register, it will hold the final result */
-    wgOpInitValue(p, partialData, wg_op);
-
     /* add call to barrier */
     p->push();
       p->curr.execWidth = 8;
@@ -1887,53 +1874,81 @@ namespace gbe
       p->WAIT();
     p->pop();
 
-    /* perform a loop, based on thread count (which is now multiple of 4) */
+    /* each SEND gathers the partial results of 8 threads, one per lane, and
+     * combines them lane-wise into threadPartials (8 lanes of init values
+     * first), the lanes past the last thread taking the init value */
+    const uint32_t slotSize = (dst.type == GEN_TYPE_UL || dst.type == GEN_TYPE_L) ? 8 : 4;
+    const GenRegister partials = wgOpLanes(threadPartials, 0, 8);
+    const GenRegister endAddr = GenRegister::toUniform(localBarrier, GEN_TYPE_UD);
+    GenRegister readData;
+    if (slotSize == 8) {
+      readData = wgOpLanes(tmp, 0, 8);
+    } else {
+      /* 16 bits values sit in the low word of their dword */
+      readData = wgOpLanes(GenRegister::retype(msgData, dst.type), 0, 8);
+      if (typeSize(dst.type) == 2) {
+        readData.hstride = GEN_HORIZONTAL_STRIDE_2;
+        readData.width = GEN_WIDTH_8;
+        readData.vstride = GEN_VERTICAL_STRIDE_16;
+      }
+    }
+
     p->push();{
+      p->curr.execWidth = 8;
+      p->curr.predicate = GEN_PREDICATE_NONE;
+      p->curr.noMask = 1;
+      wgOpInitValue(p, partials, wg_op);
+      p->MOV(msgAddr, GenRegister::immv(0x76543210));
+      p->MUL(msgAddr, msgAddr, GenRegister::immd(slotSize));
+      p->ADD(msgAddr, msgAddr, msgSlmOff);
+      p->curr.execWidth = 1;
+      p->MUL(endAddr, threadLimit, GenRegister::immd(slotSize));
+      p->ADD(endAddr, endAddr, GenRegister::toUniform(msgSlmOff, GEN_TYPE_UD));
+      p->curr.execWidth = 8;
+
       jip0 = p->n_instruction();
 
-      /* read in chunks of 4 to optimize SLM reads and reduce SEND messages */
-      if(dst.type == GEN_TYPE_UL || dst.type == GEN_TYPE_L)
+      if (slotSize == 8)
       {
-        p->curr.execWidth = 8;
-        p->curr.predicate = GEN_PREDICATE_NONE;
-        p->ADD(threadLoop, threadLoop, GenRegister::immd(-1));
-        p->MUL(msgAddr, threadLoop, GenRegister::immd(0x8));
-        p->ADD(msgAddr, msgAddr, msgSlmOff);
+        /* interleave the low and high dwords returned in 2 GRFs */
+        GenRegister readL = wgOpLanes(GenRegister::retype(tmp, GEN_TYPE_UD), 0, 8);
+        GenRegister readH = wgOpLanes(GenRegister::retype(tmp, GEN_TYPE_UD), 1, 8);
+        readL.hstride = readH.hstride = GEN_HORIZONTAL_STRIDE_2;
         p->UNTYPED_READ(msgData, msgAddr, GenRegister::immw(0xFE), 2);
-
-        GenRegister msgDataL = msgData.retype(msgData.offset(msgData, 0, 4), GEN_TYPE_D);
-        GenRegister msgDataH = msgData.retype(msgData.offset(msgData, 1, 4), GEN_TYPE_D);
-        msgDataL.hstride = 2;
-        msgDataH.hstride = 2;
-        p->MOV(msgDataL, msgDataH);
-
-        /* perform operation, partialData will hold result */
-        wgOpPerform(partialData, partialData, msgData.offset(msgData, 0), wg_op, p);
+        p->MOV(readL, wgOpLanes(GenRegister::retype(msgData, GEN_TYPE_UD), 0, 8));
+        p->MOV(readH, wgOpLanes(GenRegister::retype(msgData, GEN_TYPE_UD), 8, 8));
       }
       else
-      {
-        p->curr.execWidth = 8;
-        p->curr.predicate = GEN_PREDICATE_NONE;
-        p->ADD(threadLoop, threadLoop, GenRegister::immd(-1));
-        p->MUL(msgAddr, threadLoop, GenRegister::immd(0x4));
-        p->ADD(msgAddr, msgAddr, msgSlmOff);
         p->UNTYPED_READ(msgData, msgAddr, GenRegister::immw(0xFE), 1);
 
-        /* perform operation, partialData will hold result */
-        wgOpPerform(partialData, partialData, msgData.offset(msgData, 0), wg_op, p);
-      }
-
-      /* while threadN is not 0, cycle read SLM / update value */
-      p->curr.noMask = 1;
       p->curr.flag = 0;
       p->curr.subFlag = 1;
-      p->CMP(GEN_CONDITIONAL_G, threadLoop, GenRegister::immd(0x0));
+      p->CMP(GEN_CONDITIONAL_GE, msgAddr, endAddr);
+      p->curr.predicate = GEN_PREDICATE_NORMAL;
+      wgOpInitValue(p, readData, wg_op);
+      p->curr.predicate = GEN_PREDICATE_NONE;
+      wgOpPerform(partials, partials, readData, wg_op, p);
+
+      /* while some threads are left, cycle read SLM / update value */
+      p->ADD(msgAddr, msgAddr, GenRegister::immd(8 * slotSize));
+      p->CMP(GEN_CONDITIONAL_L, GenRegister::toUniform(msgAddr, GEN_TYPE_UD), endAddr);
       p->curr.predicate = GEN_PREDICATE_NORMAL;
       jip1 = p->n_instruction();
       p->JMPI(GenRegister::immud(0));
       p->patchJMPI(jip1, jip0 - jip1, 0);
     } p->pop();
 
+    /* reduction tree of the 8 lanes, partialData gets the final result */
+    p->push();{
+      p->curr.predicate = GEN_PREDICATE_NONE;
+      p->curr.noMask = 1;
+      for (uint32_t n = 4; n > 0; n /= 2) {
+        p->curr.execWidth = n;
+        wgOpPerform(wgOpLanes(threadPartials, 0, n), wgOpLanes(threadPartials, 0, n),
+                    wgOpLanes(threadPartials, n, n), wg_op, p);
+      }
+    } p->pop();
+
     if(wg_op == ir::WORKGROUP_OP_ANY ||
       wg_op == ir::WORKGROUP_OP_ALL ||
       wg_op == ir::WORKGROUP_OP_REDUCE_ADD ||
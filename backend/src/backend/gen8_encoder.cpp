@@ -360,6 +360,29 @@ namespace gbe
                            response_length);
   }
 
+  void Gen8Encoder::PREFETCHA64(GenRegister src) {
+    GenNativeInstruction *insn = this->next(GEN_OPCODE_SEND);
+    this->setHeader(insn);
+    insn->header.destreg_or_condmod = GEN_SFID_DATAPORT1_DATA;
+
+    this->setDst(insn, GenRegister::retype(GenRegister::null(), GEN_TYPE_UD));
+    this->setSrc0(insn, GenRegister::ud8grf(src.nr, 0));
+    this->setSrc1(insn, GenRegister::immud(0));
+
+    // only support simd8, no response
+    GBE_ASSERT(this->curr.execWidth == 8);
+    const uint32_t msg_length = 2;
+    const uint32_t response_length = 0;
+    setDPByteScatterGatherA64(this,
+                           insn,
+                           0xff,
+                           0x0,
+                           GEN_BYTE_SCATTER_BYTE,
+                           GEN8_P1_BYTE_GATHER_A64,
+                           msg_length,
+                           response_length);
+  }
+
   void Gen8Encoder::BYTE_SCATTERA64(GenRegister msg, uint32_t elemSize) {
     GenNativeInstruction *insn = this->next(GEN_OPCODE_SEND);
 
@@ -690,11 +713,19 @@ namespace gbe
      assert(dest.file == GEN_GENERAL_REGISTER_FILE);
      assert(dest.nr < 128);
      assert(dest.address_mode == GEN_ADDRESS_DIRECT);
-     assert(src0.type == GEN_TYPE_HF || src0.type == GEN_TYPE_F || src0.type == GEN_TYPE_DF);
      assert(src0.type == dest.type);
      assert(src0.type == src1.type);
      assert(src0.type == src2.type);
-     int32_t dataType = src0.type == GEN_TYPE_DF ? 3 : (src0.type == GEN_TYPE_HF ? 4 : 0);
+     // MAD and LRP are float only, BFE and BFI2 are D or UD only
+     int32_t dataType = 0;
+     switch (src0.type) {
+       case GEN_TYPE_F: dataType = 0; break;
+       case GEN_TYPE_D: dataType = 1; break;
+       case GEN_TYPE_UD: dataType = 2; break;
+       case GEN_TYPE_DF: dataType = 3; break;
+       case GEN_TYPE_HF: dataType = 4; break;
+       default: NOT_SUPPORTED;
+     }
      //gen8_insn->bits1.da3src.dest_reg_file = 0;
      gen8_insn->bits1.da3src.dest_reg_nr = dest.nr;
      gen8_insn->bits1.da3src.dest_subreg_nr = dest.subnr / 4;
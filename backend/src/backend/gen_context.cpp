@@ -718,7 +718,24 @@ namespace gbe
     const GenRegister a0 = GenRegister::addr8(0);
     uint32_t simd = p->curr.execWidth;
     p->push();
-      if (simd == 8) {
+      if (src1.hstride == GEN_HORIZONTAL_STRIDE_0) {
+        // Uniform index, one address and a scalar region
+        p->push();
+          p->curr.execWidth = 1;
+          p->curr.predicate = GEN_PREDICATE_NONE;
+          p->curr.noMask = 1;
+          p->ADD(GenRegister::addr1(0), GenRegister::retype(src1, GEN_TYPE_UW), baseReg);
+        p->pop();
+        GenRegister indirect = GenRegister::to_indirect1xN(src0, 0, 0);
+        indirect.vstride = GEN_VERTICAL_STRIDE_0;
+        if (simd == 16) {
+          p->curr.execWidth = 8;
+          p->MOV(dst, indirect);
+          p->curr.quarterControl = 1;
+          p->MOV(GenRegister::offset(dst, 0, 8 * typeSize(src0.type)), indirect);
+        } else
+          p->MOV(dst, indirect);
+      } else if (simd == 8) {
         p->ADD(a0, GenRegister::unpacked_uw(src1.nr, src1.subnr / typeSize(GEN_TYPE_UW)), baseReg);
         GenRegister indirect = GenRegister::to_indirect1xN(src0, 0, 0);
         p->MOV(dst, indirect);
@@ -1811,6 +1828,8 @@ namespace gbe
     switch (insn.opcode) {
       case SEL_OP_MAD:  p->MAD(dst, src0, src1, src2); break;
       case SEL_OP_LRP:  p->LRP(dst, src0, src1, src2); break;
+      case SEL_OP_BFE:  p->BFE(dst, src0, src1, src2); break;
+      case SEL_OP_BFI2: p->BFI2(dst, src0, src1, src2); break;
       default: NOT_IMPLEMENTED;
     }
   }
@@ -2228,6 +2247,15 @@ namespace gbe
     }
   }
 
+  void GenContext::emitPrefetchInstruction(const SelectionInstruction &insn) {
+    const GenRegister src = ra->genReg(insn.src(0));
+    const uint32_t bti = insn.extra.function;
+    if (bti == 0xff)
+      p->PREFETCHA64(src);
+    else
+      p->PREFETCH(src, bti);
+  }
+
   void GenContext::emitByteScatterInstruction(const SelectionInstruction &insn) {
     const GenRegister addr = ra->genReg(insn.src(0));
     GenRegister data = ra->genReg(insn.src(1));
@@ -3044,6 +3072,56 @@ namespace gbe
       GBE_ASSERT(0);
   }
 
+  /* Region of the n lanes of reg starting at lane first, n being 1 or a power
+   * of two */
+  static GenRegister wgOpLanes(GenRegister reg, uint32_t first, uint32_t n)
+  {
+    const uint32_t typeSz = typeSize(reg.type);
+    const uint32_t offset = reg.nr * GEN_REG_SIZE + reg.subnr + first * typeSz;
+    reg.nr = offset / GEN_REG_SIZE;
+    reg.subnr = offset % GEN_REG_SIZE;
+    if (n == 1)
+      return GenRegister::toUniform(reg, reg.type);
+    const uint32_t width = std::min(n, GEN_REG_SIZE / typeSz);
+    reg.hstride = GEN_HORIZONTAL_STRIDE_1;
+    reg.width = logi2(width);
+    reg.vstride = logi2(width) + 1;
+    return reg;
+  }
+
+  /* Lanes from first issued by one instruction: a power of two aligned on
+   * itself, with a destination in one GRF so that a source shifted by some
+   * lanes spans two GRFs at most */
+  static uint32_t wgOpChunk(uint32_t first, uint32_t end, uint32_t type)
+  {
+    uint32_t n = GEN_REG_SIZE / typeSize(type);
+    while (first % n || first + n > end)
+      n /= 2;
+    return n;
+  }
+
+  /* One Kogge-Stone step of an inclusive scan over the simd lanes:
+   * dst[i] = src[i - d] op src[i], dst[i] = src[i] for the first d lanes */
+  static void wgOpScanStep(GenRegister dst,
+                           GenRegister src,
+                           uint32_t d,
+                           uint32_t simd,
+                           uint32_t wg_op,
+                           GenEncoder *p)
+  {
+    p->push();
+    for (uint32_t first = 0, n; first < simd; first += n) {
+      n = wgOpChunk(first, first < d ? d : simd, dst.type);
+      p->curr.execWidth = n;
+      if (first < d)
+        p->MOV(wgOpLanes(dst, first, n), wgOpLanes(src, first, n));
+      else
+        wgOpPerform(wgOpLanes(dst, first, n), wgOpLanes(src, first - d, n),
+                    wgOpLanes(src, first, n), wg_op, p);
+    }
+    p->pop();
+  }
+
   static void wgOpPerformThread(GenRegister threadDst,
                                   GenRegister inputVal,
                                   GenRegister threadExchangeData,
@@ -3062,9 +3140,6 @@ namespace gbe
    threadDst = GenRegister::retype(threadDst, inputVal.type);
    threadExchangeData = GenRegister::retype(threadExchangeData, inputVal.type);
 
-   vector<GenRegister> input;
-   vector<GenRegister> result;
-
    /* for workgroup all and any we can use simd_all/any for each thread */
    if (wg_op == ir::WORKGROUP_OP_ALL || wg_op == ir::WORKGROUP_OP_ANY) {
      GenRegister constZero = GenRegister::immuw(0);
@@ -3112,83 +3187,32 @@ namespace gbe
        return;
      }
 
-     /* init thread data to min/max/null values */
-     p->push(); {
+     if (wg_op == ir::WORKGROUP_OP_REDUCE_ADD ||
+         wg_op == ir::WORKGROUP_OP_REDUCE_MIN ||
+         wg_op == ir::WORKGROUP_OP_REDUCE_MAX) {
+       /* reduction tree, each step folds the upper half of the lanes left
+        * onto the lower half */
        p->curr.execWidth = simd;
-       wgOpInitValue(p, threadExchangeData, wg_op);
        p->MOV(resultVal, inputVal);
-     } p->pop();
-
-     GenRegister resultValSingle = resultVal;
-     resultValSingle.hstride = GEN_HORIZONTAL_STRIDE_0;
-     resultValSingle.vstride = GEN_VERTICAL_STRIDE_0;
-     resultValSingle.width = GEN_WIDTH_1;
-
-     GenRegister inputValSingle = inputVal;
-     inputValSingle.hstride = GEN_HORIZONTAL_STRIDE_0;
-     inputValSingle.vstride = GEN_VERTICAL_STRIDE_0;
-     inputValSingle.width = GEN_WIDTH_1;
-
-
-     /* make an array of registers for easy accesing */
-     for(uint32_t i = 0; i < simd; i++){
-       /* add all resultVal offset reg positions from list */
-       result.push_back(resultValSingle);
-       input.push_back(inputValSingle);
-
-       /* move to next position */
-       resultValSingle.subnr += typeSize(resultValSingle.type);
-       if (resultValSingle.subnr == 32) {
-           resultValSingle.subnr = 0;
-           resultValSingle.nr++;
+       for (uint32_t n = simd / 2; n > 0; n /= 2) {
+         p->curr.execWidth = n;
+         wgOpPerform(wgOpLanes(resultVal, 0, n), wgOpLanes(resultVal, 0, n),
+                     wgOpLanes(resultVal, n, n), wg_op, p);
        }
-       /* move to next position */
-       inputValSingle.subnr += typeSize(inputValSingle.type);
-       if (inputValSingle.subnr == 32) {
-           inputValSingle.subnr = 0;
-           inputValSingle.nr++;
+     } else {
+       /* inclusive scan in log2(simd) steps, ping-ponging between
+        * threadExchangeData and resultVal so that the last step writes
+        * resultVal, the exclusive scan is then shifted by one lane */
+       uint32_t stepNum = 0;
+       for (uint32_t d = 1; d < simd; d *= 2)
+         stepNum++;
+       GenRegister scanSrc = inputVal;
+       for (uint32_t d = 1; d < simd; d *= 2) {
+         GenRegister scanDst = stepNum-- % 2 ? resultVal : threadExchangeData;
+         wgOpScanStep(scanDst, scanSrc, d, simd, wg_op, p);
+         scanSrc = scanDst;
        }
      }
-
-     uint32_t start_i = 0;
-     if( wg_op == ir::WORKGROUP_OP_REDUCE_ADD ||
-         wg_op == ir::WORKGROUP_OP_REDUCE_MIN ||
-         wg_op == ir::WORKGROUP_OP_REDUCE_MAX ||
-         wg_op == ir::WORKGROUP_OP_INCLUSIVE_ADD ||
-         wg_op == ir::WORKGROUP_OP_INCLUSIVE_MIN ||
-         wg_op == ir::WORKGROUP_OP_INCLUSIVE_MAX) {
-       p->MOV(result[0], input[0]);
-       start_i = 1;
-     }
-
-     else if(wg_op == ir::WORKGROUP_OP_EXCLUSIVE_ADD ||
-         wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MIN ||
-         wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MAX) {
-       p->MOV(result[1], input[0]);
-       start_i = 2;
-     }
-
-     /* algorithm workgroup */
-     for (uint32_t i = start_i; i < simd; i++)
-     {
-       if( wg_op == ir::WORKGROUP_OP_REDUCE_ADD ||
-           wg_op == ir::WORKGROUP_OP_REDUCE_MIN ||
-           wg_op == ir::WORKGROUP_OP_REDUCE_MAX)
-         wgOpPerform(result[0], result[0], input[i], wg_op, p);
-
-       else if(wg_op == ir::WORKGROUP_OP_INCLUSIVE_ADD ||
-           wg_op == ir::WORKGROUP_OP_INCLUSIVE_MIN ||
-           wg_op == ir::WORKGROUP_OP_INCLUSIVE_MAX)
-         wgOpPerform(result[i], result[i - 1], input[i], wg_op, p);
-
-       else if(wg_op == ir::WORKGROUP_OP_EXCLUSIVE_ADD ||
-           wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MIN ||
-           wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MAX)
-         wgOpPerform(result[i], result[i - 1], input[i - 1], wg_op, p);
-
-       else
-         GBE_ASSERT(0);
-     }
    }
 
    if( wg_op == ir::WORKGROUP_OP_REDUCE_ADD ||
@@ -3197,9 +3221,9 @@ namespace gbe
    {
      p->curr.execWidth = simd;
      /* value exchanged with other threads */
-     p->MOV(threadExchangeData, result[0]);
+     p->MOV(threadExchangeData, wgOpLanes(resultVal, 0, 1));
      /* partial result thread */
-     p->MOV(threadDst, result[0]);
+     p->MOV(threadDst, wgOpLanes(resultVal, 0, 1));
    }
    else if(wg_op == ir::WORKGROUP_OP_INCLUSIVE_ADD ||
        wg_op == ir::WORKGROUP_OP_INCLUSIVE_MIN ||
@@ -3207,7 +3231,7 @@ namespace gbe
    {
      p->curr.execWidth = simd;
      /* value exchanged with other threads */
-     p->MOV(threadExchangeData, result[simd - 1]);
+     p->MOV(threadExchangeData, wgOpLanes(resultVal, simd - 1, 1));
      /* partial result thread */
      p->MOV(threadDst, resultVal);
    }
@@ -3215,15 +3239,18 @@ namespace gbe
        wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MIN ||
        wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MAX)
    {
-     p->curr.execWidth = 1;
-     /* set result[0] to min/max/null */
-     wgOpInitValue(p, result[0], wg_op);
-
      p->curr.execWidth = simd;
      /* value exchanged with other threads */
-     wgOpPerform(threadExchangeData, result[simd - 1], input[simd - 1], wg_op, p);
-     /* partial result thread */
-     p->MOV(threadDst, resultVal);
+     p->MOV(threadExchangeData, wgOpLanes(resultVal, simd - 1, 1));
+
+     /* partial result thread, set lane 0 to min/max/null */
+     p->curr.execWidth = 1;
+     wgOpInitValue(p, wgOpLanes(threadDst, 0, 1), wg_op);
+     for (uint32_t first = 1, n; first < simd; first += n) {
+       n = wgOpChunk(first, simd, threadDst.type);
+       p->curr.execWidth = n;
+       p->MOV(wgOpLanes(threadDst, first, n), wgOpLanes(resultVal, first - 1, n));
+     }
    }
 
    p->pop();
@@ -3234,15 +3261,14 @@ namespace gbe
  *
  * Implementation:
  * 1. All the threads first perform the workgroup op value for the
- * allocated work-items. SIMD16=> 16 work-items allocated for each thread
+ * allocated work-items. SIMD16=> 16 work-items allocated for each thread,
+ * with a log2(simd) steps reduction tree or Kogge-Stone scan over the lanes
  * 2. Each thread writes the partial result in shared local memory using threadId
- * 3. After a barrier, each thread will read in chunks of 1-4 elements,
- * the shared local memory region, using a loop based on the thread num value (threadN)
- * 4. Each thread computes the final value individually
- *
- * Optimizations:
- * Performance is given by chunk read. If threads read in chunks of 4 elements
- * the performance is increase 2-3x times compared to chunks of 1 element.
+ * 3. After a barrier, each thread gathers the partial results of 8 threads
+ * per SLM read, combining them lane-wise, up to the thread num value (threadN)
+ * for reduce or its threadId for scans
+ * 4. Each thread reduces the 8 lanes with a tree and computes the final value
+ * individually
  */
   void GenContext::emitWorkGroupOpInstruction(const SelectionInstruction &insn){
     const GenRegister dst = ra->genReg(insn.dst(0));
@@ -3250,8 +3276,9 @@ namespace gbe
     const GenRegister theVal = GenRegister::retype(ra->genReg(insn.src(2)), dst.type);
     GenRegister threadData = ra->genReg(insn.src(3));
     GenRegister partialData = GenRegister::toUniform(threadData, dst.type);
+    const GenRegister threadPartials = GenRegister::retype(threadData, dst.type);
     GenRegister threadId = ra->genReg(insn.src(0));
-    GenRegister threadLoop = ra->genReg(insn.src(1));
+    GenRegister threadNum = ra->genReg(insn.src(1));
     GenRegister barrierId = ra->genReg(GenRegister::ud1grf(ir::ocl::barrierid));
     GenRegister localBarrier = ra->genReg(insn.src(5));
 
@@ -3284,26 +3311,15 @@ namespace gbe
     p->MOV(theVal, dst);
     threadData = GenRegister::toUniform(threadData, dst.type);
 
-    /* store thread count for future use on read/write to SLM */
+    /* number of partial results to combine: all the threads for reduce,
+     * the previous threads for scans */
+    GenRegister threadLimit = threadId;
     if (wg_op == ir::WORKGROUP_OP_ANY ||
       wg_op == ir::WORKGROUP_OP_ALL ||
       wg_op == ir::WORKGROUP_OP_REDUCE_ADD ||
       wg_op == ir::WORKGROUP_OP_REDUCE_MIN ||
       wg_op == ir::WORKGROUP_OP_REDUCE_MAX)
-    {
-      threadLoop = GenRegister::retype(tmp, GEN_TYPE_D);
-      p->MOV(threadLoop, ra->genReg(GenRegister::ud1grf(ir::ocl::threadn)));
-    }
-    else if(wg_op == ir::WORKGROUP_OP_INCLUSIVE_ADD ||
-      wg_op == ir::WORKGROUP_OP_INCLUSIVE_MIN ||
-      wg_op == ir::WORKGROUP_OP_INCLUSIVE_MAX ||
-      wg_op == ir::WORKGROUP_OP_EXCLUSIVE_ADD ||
-      wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MIN ||
-      wg_op == ir::WORKGROUP_OP_EXCLUSIVE_MAX)
-    {
-      threadLoop = GenRegister::retype(tmp, GEN_TYPE_D);
-      p->MOV(threadLoop, ra->genReg(GenRegister::ud1grf(ir::ocl::threadid)));
-    }
+      threadLimit = GenRegister::toUniform(threadNum, GEN_TYPE_UD);
 
     /* all threads write the partial results to SLM memory */
     if(dst.type == GEN_TYPE_UL || dst.type == GEN_TYPE_L)
@@ -3329,9 +3345,6 @@ namespace gbe
       p->UNTYPED_WRITE(msg, msg, GenRegister::immw(0xFE), 1, false);
     }
 
-    /* init partialData register, it will hold the final result */
-    wgOpInitValue(p, partialData, wg_op);
-
     /* add call to barrier */
     p->push();
       p->curr.execWidth = 8;
@@ -3343,53 +3356,81 @@ namespace gbe
       p->WAIT();
     p->pop();
 
-    /* perform a loop, based on thread count (which is now multiple of 4) */
+    /* each SEND gathers the partial results of 8 threads, one per lane, and
+     * combines them lane-wise into threadPartials (8 lanes of init values
+     * first), the lanes past the last thread taking the init value */
+    const uint32_t slotSize = (dst.type == GEN_TYPE_UL || dst.type == GEN_TYPE_L) ? 8 : 4;
+    const GenRegister partials = wgOpLanes(threadPartials, 0, 8);
+    const GenRegister endAddr = GenRegister::toUniform(localBarrier, GEN_TYPE_UD);
+    GenRegister readData;
+    if (slotSize == 8) {
+      readData = wgOpLanes(tmp, 0, 8);
+    } else {
+      /* 16 bits values sit in the low word of their dword */
+      readData = wgOpLanes(GenRegister::retype(msgData, dst.type), 0, 8);
+      if (typeSize(dst.type) == 2) {
+        readData.hstride = GEN_HORIZONTAL_STRIDE_2;
+        readData.width = GEN_WIDTH_8;
+        readData.vstride = GEN_VERTICAL_STRIDE_16;
+      }
+    }
+
     p->push();{
+      p->curr.execWidth = 8;
+      p->curr.predicate = GEN_PREDICATE_NONE;
+      p->curr.noMask = 1;
+      wgOpInitValue(p, partials, wg_op);
+      p->MOV(msgAddr, GenRegister::immv(0x76543210));
+      p->MUL(msgAddr, msgAddr, GenRegister::immd(slotSize));
+      p->ADD(msgAddr, msgAddr, msgSlmOff);
+      p->curr.execWidth = 1;
+      p->MUL(endAddr, threadLimit, GenRegister::immd(slotSize));
+      p->ADD(endAddr, endAddr, GenRegister::toUniform(msgSlmOff, GEN_TYPE_UD));
+      p->curr.execWidth = 8;
+
       jip0 = p->n_instruction();
 
-      /* read in chunks of 4 to optimize SLM reads and reduce SEND messages */
-      if(dst.type == GEN_TYPE_UL || dst.type == GEN_TYPE_L)
+      if (slotSize == 8)
       {
-        p->curr.execWidth = 8;
-        p->curr.predicate = GEN_PREDICATE_NONE;
-        p->ADD(threadLoop, threadLoop, GenRegister::immd(-1));
-        p->MUL(msgAddr, threadLoop, GenRegister::immd(0x8));
-        p->ADD(msgAddr, msgAddr, msgSlmOff);
+        /* interleave the low and high dwords returned in 2 GRFs */
+        GenRegister readL = wgOpLanes(GenRegister::retype(tmp, GEN_TYPE_UD), 0, 8);
+        GenRegister readH = wgOpLanes(GenRegister::retype(tmp, GEN_TYPE_UD), 1, 8);
+        readL.hstride = readH.hstride = GEN_HORIZONTAL_STRIDE_2;
         p->UNTYPED_READ(msgData, msgAddr, GenRegister::immw(0xFE), 2);
-
-        GenRegister msgDataL = msgData.retype(msgData.offset(msgData, 0, 4), GEN_TYPE_D);
-        GenRegister msgDataH = msgData.retype(msgData.offset(msgData, 1, 4), GEN_TYPE_D);
-        msgDataL.hstride = 2;
-        msgDataH.hstride = 2;
-        p->MOV(msgDataL, msgDataH);
-
-        /* perform operation, partialData will hold result */
-        wgOpPerform(partialData, partialData, msgData.offset(msgData, 0), wg_op, p);
+        p->MOV(readL, wgOpLanes(GenRegister::retype(msgData, GEN_TYPE_UD), 0, 8));
+        p->MOV(readH, wgOpLanes(GenRegister::retype(msgData, GEN_TYPE_UD), 8, 8));
       }
       else
-      {
-        p->curr.execWidth = 8;
-        p->curr.predicate = GEN_PREDICATE_NONE;
-        p->ADD(threadLoop, threadLoop, GenRegister::immd(-1));
-        p->MUL(msgAddr, threadLoop, GenRegister::immd(0x4));
-        p->ADD(msgAddr, msgAddr, msgSlmOff);
         p->UNTYPED_READ(msgData, msgAddr, GenRegister::immw(0xFE), 1);
 
-        /* perform operation, partialData will hold result */
-        wgOpPerform(partialData, partialData, msgData.offset(msgData, 0), wg_op, p);
-      }
-
-      /* while threadN is not 0, cycle read SLM / update value */
-      p->curr.noMask = 1;
       p->curr.flag = 0;
       p->curr.subFlag = 1;
-      p->CMP(GEN_CONDITIONAL_G, threadLoop, GenRegister::immd(0x0));
+      p->CMP(GEN_CONDITIONAL_GE, msgAddr, endAddr);
+      p->curr.predicate = GEN_PREDICATE_NORMAL;
+      wgOpInitValue(p, readData, wg_op);
+      p->curr.predicate = GEN_PREDICATE_NONE;
+      wgOpPerform(partials, partials, readData, wg_op, p);
+
+      /* while some threads are left, cycle read SLM / update value */
+      p->ADD(msgAddr, msgAddr, GenRegister::immd(8 * slotSize));
+      p->CMP(GEN_CONDITIONAL_L, GenRegister::toUniform(msgAddr, GEN_TYPE_UD), endAddr);
       p->curr.predicate = GEN_PREDICATE_NORMAL;
       jip1 = p->n_instruction();
       p->JMPI(GenRegister::immud(0));
       p->patchJMPI(jip1, jip0 - jip1, 0);
     } p->pop();
 
+    /* reduction tree of the 8 lanes, partialData gets the final result */
+    p->push();{
+      p->curr.predicate = GEN_PREDICATE_NONE;
+      p->curr.noMask = 1;
+      for (uint32_t n = 4; n > 0; n /= 2) {
+        p->curr.execWidth = n;
+        wgOpPerform(wgOpLanes(threadPartials, 0, n), wgOpLanes(threadPartials, 0, n),
+                    wgOpLanes(threadPartials, n, n), wg_op, p);
+      }
+    } p->pop();
+
     if(wg_op == ir::WORKGROUP_OP_ANY ||
       wg_op == ir::WORKGROUP_OP_ALL ||
       wg_op == ir::WORKGROUP_OP_REDUCE_ADD ||
@@ -3516,16 +3557,26 @@ namespace gbe
         p->curr.noMask = 1;
         //ptr[0] is the total count of the log size.
         p->MOV(addr, GenRegister::immud(0));
-        p->MOV(data, GenRegister::immud(insn.extra.printfSize + 12));
+        p->MOV(data, GenRegister::immud(insn.extra.printfSize + 16));
       } p->pop();
 
       p->ATOMIC(addr, GEN_ATOMIC_OP_ADD, addr, data, GenRegister::immud(insn.extra.printfBTI), 2, useSends);
+      /* ptr[1] wraps the reserved offset when the buffer is a ring. */
+      p->push(); {
+        p->curr.predicate = GEN_PREDICATE_NONE;
+        p->curr.noMask = 1;
+        p->MOV(data, GenRegister::immud(sizeof(uint32_t)));
+      } p->pop();
+      p->UNTYPED_READ(data, data, GenRegister::immud(insn.extra.printfBTI), 1);
+      p->AND(addr, addr, data);
+      p->ADD(addr, addr, GenRegister::immud(GBE_PRINTF_BUF_HEADER_SIZE));
+
       /* Write out the header. */
-      p->MOV(data, GenRegister::immud(0xAABBCCDD));
+      p->MOV(data, GenRegister::immud(GBE_PRINTF_LOG_MAGIC));
       p->UNTYPED_WRITE(addr, data, GenRegister::immud(insn.extra.printfBTI), 1, useSends);
 
       p->ADD(addr, addr, GenRegister::immud(sizeof(uint32_t)));
-      p->MOV(data, GenRegister::immud(insn.extra.printfSize + 12));
+      p->MOV(data, GenRegister::immud(insn.extra.printfSize + 16));
       p->UNTYPED_WRITE(addr, data, GenRegister::immud(insn.extra.printfBTI), 1, useSends);
 
       p->ADD(addr, addr, GenRegister::immud(sizeof(uint32_t)));
@@ -3550,6 +3601,20 @@ namespace gbe
         emitPrintfLongInstruction(addr, data, src, insn.extra.printfBTI, useSends);
       }
     }
+
+    /* The end marker tells the host the record is complete, so it must land
+       after the arguments. */
+    if (insn.extra.printfLast) {
+      p->push(); {
+        p->curr.predicate = GEN_PREDICATE_NONE;
+        p->curr.noMask = 1;
+        p->curr.execWidth = 8;
+        p->FENCE(data, false);
+        p->MOV(data, data);
+      } p->pop();
+      p->MOV(data, GenRegister::immud(GBE_PRINTF_LOG_END));
+      p->UNTYPED_WRITE(addr, data, GenRegister::immud(insn.extra.printfBTI), 1, useSends);
+    }
   }
 
   void GenContext::setA0Content(uint16_t new_a0[16], uint16_t max_offset, int sz) {
@@ -3647,6 +3712,7 @@ namespace gbe
       outputSelectionIR(*this, this->sel, genKernel->getName());
     if (UNLIKELY(!ra->allocate(*this->sel)))
       return false;
+    genKernel->spillNum = ra->getSpilledRegNum();
     schedulePostRegAllocation(*this, *this->sel);
     if (OCL_OUTPUT_REG_ALLOC)
       ra->outputAllocation();
@@ -129,6 +129,9 @@ enum GenOpCode
   GEN_OPCODE_F32TO16 = 19,
   GEN_OPCODE_F16TO32 = 20,
   GEN_OPCODE_BFREV = 23,
+  GEN_OPCODE_BFE = 24,
+  GEN_OPCODE_BFI1 = 25,
+  GEN_OPCODE_BFI2 = 26,
   GEN_OPCODE_JMPI = 32,
   GEN_OPCODE_BRD = 33,
   GEN_OPCODE_IF = 34,
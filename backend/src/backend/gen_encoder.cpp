@@ -579,6 +579,36 @@ namespace gbe
     assert(0);
   }
 
+  void GenEncoder::PREFETCH(GenRegister src, uint32_t bti) {
+    GenNativeInstruction *insn = this->next(GEN_OPCODE_SEND);
+    uint32_t msg_length = 0;
+
+    this->setHeader(insn);
+    insn->header.destreg_or_condmod = GEN_SFID_DATAPORT_DATA;
+
+    if (this->curr.execWidth == 8) {
+      msg_length = 1;
+      this->setDst(insn, GenRegister::retype(GenRegister::null(), GEN_TYPE_UD));
+    } else if (this->curr.execWidth == 16) {
+      msg_length = 2;
+      this->setDst(insn, GenRegister::retype(GenRegister::null(), GEN_TYPE_UW));
+    } else
+      NOT_IMPLEMENTED;
+
+    this->setSrc0(insn, GenRegister::ud8grf(src.nr, 0));
+    this->setSrc1(insn, GenRegister::immud(0));
+    setDPByteScatterGather(insn,
+                           bti,
+                           GEN_BYTE_SCATTER_BYTE,
+                           GEN7_BYTE_GATHER,
+                           msg_length,
+                           0);
+  }
+
+  void GenEncoder::PREFETCHA64(GenRegister src) {
+    assert(0);
+  }
+
   void GenEncoder::DWORD_GATHER(GenRegister dst, GenRegister src, uint32_t bti) {
     GenNativeInstruction *insn = this->next(GEN_OPCODE_SEND);
     uint32_t msg_length = 0;
@@ -851,6 +881,8 @@ namespace gbe
   ALU2(MACH)
   ALU3(MAD)
   ALU3(LRP)
+  ALU3(BFE)
+  ALU3(BFI2)
   ALU1(BFREV)
  // ALU2(BRC)
  // ALU1(ENDIF)
@@ -129,6 +129,8 @@ namespace gbe
     ALU2(PLN)
     ALU3(MAD)
     ALU3(LRP)
+    ALU3(BFE)
+    ALU3(BFI2)
     ALU2(BRC)
     ALU1(BRD)
     ALU1(BFREV)
@@ -190,6 +192,10 @@ namespace gbe
     virtual void BYTE_GATHERA64(GenRegister dst, GenRegister src, uint32_t elemSize);
     /*! Byte scatter a64 (for unaligned bytes, shorts and ints) */
     virtual void BYTE_SCATTERA64(GenRegister src, uint32_t elemSize);
+    /*! Prefetch, byte gather without response (data only goes to the caches) */
+    void PREFETCH(GenRegister src, uint32_t bti);
+    /*! Prefetch a64 */
+    virtual void PREFETCHA64(GenRegister src);
     /*! DWord gather (for constant cache read) */
     void DWORD_GATHER(GenRegister dst, GenRegister src, uint32_t bti);
     /*! for scratch memory read */
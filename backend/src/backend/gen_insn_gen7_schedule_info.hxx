@@ -37,6 +37,7 @@ DECL_GEN7_SCHEDULE(ByteScatterA64,  160,       1,        1)
 DECL_GEN7_SCHEDULE(ByteGather,      160,       1,        1)
 DECL_GEN7_SCHEDULE(ByteScatter,     160,       1,        1)
 DECL_GEN7_SCHEDULE(DWordGather,     160,       1,        1)
+DECL_GEN7_SCHEDULE(Prefetch,        20,        1,        1)
 DECL_GEN7_SCHEDULE(PackByte,        40,        1,        1)
 DECL_GEN7_SCHEDULE(UnpackByte,      40,        1,        1)
 DECL_GEN7_SCHEDULE(PackLong,        40,        1,        1)
@@ -399,8 +399,8 @@ namespace gbe
       this->nodes[index] = node;
     }
 
-    // Track writes in memory
-    if (insn.isWrite()) {
+    // Track writes in memory, the prefetches are pinned like the writes
+    if (insn.isWrite() || insn.opcode == SEL_OP_PREFETCH) {
       const uint32_t index = this->getMemoryIndex();
       this->nodes[index] = node;
     }
@@ -501,7 +501,9 @@ namespace gbe
       if (insn.state.predicate != GEN_PREDICATE_NONE)
         tracker.addDependency(node, getFlag(insn), READ_AFTER_WRITE);
 
-      // read-after-write in memory
+      // read-after-write in memory. A prefetch has no response, but it is
+      // ordered with the memory accesses like a write so that it stays ahead
+      // of the loads it targets
       if (insn.isRead()) {
         const uint32_t index = tracker.getMemoryIndex();
         tracker.addDependency(node, index, READ_AFTER_WRITE);
@@ -534,7 +536,7 @@ namespace gbe
         tracker.addDependency(node, GenRegister::acc(), WRITE_AFTER_WRITE);
 
       // write-after-write in memory
-      if (insn.isWrite()) {
+      if (insn.isWrite() || insn.opcode == SEL_OP_PREFETCH) {
         const uint32_t index = tracker.getMemoryIndex();
         tracker.addDependency(node, index, WRITE_AFTER_WRITE);
       }
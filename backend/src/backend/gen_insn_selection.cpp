@@ -275,7 +275,9 @@ namespace gbe
            this->opcode == SEL_OP_MACH        ||
            this->opcode == SEL_OP_MATH        ||
            this->opcode == SEL_OP_LRP         || /* ALU3 */
-           this->opcode == SEL_OP_MAD;
+           this->opcode == SEL_OP_MAD         ||
+           this->opcode == SEL_OP_BFE         ||
+           this->opcode == SEL_OP_BFI2;
   }
 
   ///////////////////////////////////////////////////////////////////////////
@@ -420,6 +422,8 @@ namespace gbe
     bool hasSends() const { return bHasSends; }
     void setHas32X32Mul(bool b) { bHas32X32Mul = b; }
     void setHasSends(bool b) { bHasSends = b; }
+    bool hasBitField() const { return bHasBitField; }
+    void setHasBitField(bool b) { bHasBitField = b; }
     bool hasLongType() const { return bHasLongType; }
     bool hasDoubleType() const { return bHasDoubleType; }
     bool hasHalfType() const { return bHasHalfType; }
@@ -612,6 +616,8 @@ namespace gbe
     ALU1(LZD)
     ALU3(MAD)
     ALU3(LRP)
+    ALU3(BFE)
+    ALU3(BFI2)
     ALU2WithTemp(MUL_HI)
     ALU1(FBH)
     ALU1(FBL)
@@ -714,6 +720,8 @@ namespace gbe
     void UNTYPED_READA64(Reg addr, const GenRegister *dst, uint32_t dstNum, uint32_t elemNum);
     /*! Untyped write (up to 4 elements) */
     void UNTYPED_WRITEA64(const GenRegister *msgs, uint32_t msgNum, uint32_t elemNum);
+    /*! Prefetch (byte gather without response) */
+    void PREFETCH(Reg addr, uint32_t bti);
     /*! DWord scatter (for constant cache read) */
     void DWORD_GATHER(Reg dst, Reg addr, uint32_t bti);
     /*! Unpack the uint to charN */
@@ -752,7 +760,7 @@ namespace gbe
     void STORE_PROFILING(uint32_t profilingType, uint32_t bti, GenRegister tmp0, GenRegister tmp1, GenRegister ts[5], int tsNum);
     /*! Printf */
     void PRINTF(uint8_t bti, GenRegister tmp0, GenRegister tmp1, GenRegister src[8],
-                int srcNum, uint16_t num, bool isContinue, uint32_t totalSize);
+                int srcNum, uint16_t num, bool isContinue, bool isLast, uint32_t totalSize);
     /*! Multiply 64-bit integers */
     void I64MUL(Reg dst, Reg src0, Reg src1, GenRegister *tmp, bool native_long);
     /*! 64-bit integer division */
@@ -869,6 +877,7 @@ namespace gbe
     bool bHasHalfType;
     bool bLongRegRestrict;
     bool bHasSends;
+    bool bHasBitField;
     uint32_t ldMsgOrder;
     bool slowByteGather;
     INLINE ir::LabelIndex newAuxLabel()
@@ -912,7 +921,7 @@ namespace gbe
     stateNum(0), vectorNum(0), bwdCodeGeneration(false), storeThreadMap(false),
     currAuxLabel(ctx.getFunction().labelNum()), bHas32X32Mul(false), bHasLongType(false),
     bHasDoubleType(false), bHasHalfType(false), bLongRegRestrict(false), bHasSends(false),
-    ldMsgOrder(LD_MSG_ORDER_IVB), slowByteGather(false)
+    bHasBitField(false), ldMsgOrder(LD_MSG_ORDER_IVB), slowByteGather(false)
   {
     const ir::Function &fn = ctx.getFunction();
     this->regNum = fn.regNum();
@@ -1922,6 +1931,19 @@ namespace gbe
     vector->reg = &insn->src(0);
   }
 
+  void Selection::Opaque::PREFETCH(Reg addr, uint32_t bti) {
+    SelectionInstruction *insn = this->appendInsn(SEL_OP_PREFETCH, 0, 1);
+    SelectionVector *vector = this->appendVector();
+
+    insn->src(0) = addr;
+    insn->extra.function = bti;
+
+    vector->regNum = 1;
+    vector->isSrc = 1;
+    vector->offsetID = 0;
+    vector->reg = &insn->src(0);
+  }
+
   void Selection::Opaque::DWORD_GATHER(Reg dst, Reg addr, uint32_t bti) {
     SelectionInstruction *insn = this->appendInsn(SEL_OP_DWORD_GATHER, 1, 1);
     SelectionVector *vector = this->appendVector();
@@ -2238,7 +2260,7 @@ namespace gbe
   }
 
   void Selection::Opaque::PRINTF(uint8_t bti, GenRegister tmp0, GenRegister tmp1,
-               GenRegister src[8], int srcNum, uint16_t num, bool isContinue, uint32_t totalSize) {
+               GenRegister src[8], int srcNum, uint16_t num, bool isContinue, bool isLast, uint32_t totalSize) {
     SelectionInstruction *insn = this->appendInsn(SEL_OP_PRINTF, 2, srcNum);
 
     for (int i = 0; i < srcNum; i++)
@@ -2270,6 +2292,7 @@ namespace gbe
 
     insn->extra.printfSize = static_cast<uint16_t>(totalSize);
     insn->extra.continueFlag = isContinue;
+    insn->extra.printfLast = isLast;
     insn->extra.printfBTI = bti;
     insn->extra.printfNum = num;
   }
@@ -2797,6 +2820,7 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
     this->opaque->setHasDoubleType(true);
     this->opaque->setSlowByteGather(false);
     this->opaque->setHasHalfType(true);
+    this->opaque->setHasBitField(true);
     opt_features = SIOF_LOGICAL_SRCMOD;
   }
 
@@ -2807,6 +2831,7 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
     this->opaque->setLongRegRestrict(true);
     this->opaque->setSlowByteGather(false);
     this->opaque->setHasHalfType(true);
+    this->opaque->setHasBitField(true);
     opt_features = (SEL_IR_OPT_FEATURE)(SIOF_LOGICAL_SRCMOD | SIOF_OP_MOV_LONG_REG_RESTRICT);
   }
 
@@ -2818,6 +2843,7 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
     this->opaque->setSlowByteGather(false);
     this->opaque->setHasHalfType(true);
     this->opaque->setHasSends(true);
+    this->opaque->setHasBitField(true);
     opt_features = SIOF_LOGICAL_SRCMOD;
   }
 
@@ -2829,6 +2855,7 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
     this->opaque->setLdMsgOrder(LD_MSG_ORDER_SKL);
     this->opaque->setSlowByteGather(false);
     this->opaque->setHasHalfType(true);
+    this->opaque->setHasBitField(true);
     opt_features = (SEL_IR_OPT_FEATURE)(SIOF_LOGICAL_SRCMOD | SIOF_OP_MOV_LONG_REG_RESTRICT);
   }
 
@@ -2840,6 +2867,7 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
     this->opaque->setSlowByteGather(false);
     this->opaque->setHasHalfType(true);
     this->opaque->setHasSends(true);
+    this->opaque->setHasBitField(true);
     opt_features = SIOF_LOGICAL_SRCMOD;
   }
 
@@ -2851,6 +2879,7 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
     this->opaque->setLdMsgOrder(LD_MSG_ORDER_SKL);
     this->opaque->setSlowByteGather(false);
     this->opaque->setHasHalfType(true);
+    this->opaque->setHasBitField(true);
     opt_features = (SEL_IR_OPT_FEATURE)(SIOF_LOGICAL_SRCMOD | SIOF_OP_MOV_LONG_REG_RESTRICT);
   }
 
@@ -3616,8 +3645,7 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
               sel.I64HADD(dst, src0, src1, tmp, 4);
             } else {
               tmp[0] = sel.selReg(sel.reg(FAMILY_QWORD), ir::TYPE_U64);
-              tmp[1] = sel.selReg(sel.reg(FAMILY_QWORD), ir::TYPE_U64);
-              sel.I64HADD(dst, src0, src1, tmp, 2);
+              sel.I64HADD(dst, src0, src1, tmp, 1);
             }
             break;
           }
@@ -3630,8 +3658,7 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
               sel.I64RHADD(dst, src0, src1, tmp, 4);
             } else {
               tmp[0] = sel.selReg(sel.reg(FAMILY_QWORD), ir::TYPE_U64);
-              tmp[1] = sel.selReg(sel.reg(FAMILY_QWORD), ir::TYPE_U64);
-              sel.I64RHADD(dst, src0, src1, tmp, 2);
+              sel.I64RHADD(dst, src0, src1, tmp, 1);
             }
             break;
           }
@@ -3734,6 +3761,297 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
     }
   };
 
+  /*! Whether a child of the DAG is computed by the given opcode and can be
+   *  merged in its parent (its result is only used there and its sources
+   *  are still valid) */
+  static bool isFoldableChild(const SelectionDAG &dag, uint32_t childID, ir::Opcode opcode) {
+    const SelectionDAG *child = dag.child[childID];
+    return child != NULL && child->insn.getOpcode() == opcode &&
+           !child->isRoot && dag.isMergeable(childID);
+  }
+
+  /*! Whether the DAG is a float LOADI of 1.0 */
+  static bool isFloatOne(const SelectionDAG *dag) {
+    if (dag == NULL || dag->insn.getOpcode() != ir::OP_LOADI)
+      return false;
+    const ir::Immediate &imm = ir::cast<ir::LoadImmInstruction>(dag->insn).getImmediate();
+    return imm.getType() == ir::TYPE_FLOAT && imm.getFloatValue() == 1.0f;
+  }
+
+  /*! Get the value of a 32 bits integer LOADI */
+  static bool getDWordImmediate(const SelectionDAG *dag, uint32_t &value) {
+    if (dag == NULL || dag->insn.getOpcode() != ir::OP_LOADI)
+      return false;
+    const ir::Immediate &imm = ir::cast<ir::LoadImmInstruction>(dag->insn).getImmediate();
+    if (imm.getType() != ir::TYPE_S32 && imm.getType() != ir::TYPE_U32)
+      return false;
+    value = (uint32_t) imm.getIntegerValue();
+    return true;
+  }
+
+  /*! Float binary instruction (LRP is float only) */
+  static bool isFloatBinary(const ir::Instruction &insn) {
+    return insn.isMemberOf<ir::BinaryInstruction>() &&
+           ir::cast<ir::BinaryInstruction>(insn).getType() == ir::TYPE_FLOAT;
+  }
+
+  /*! 32 bits integer binary instruction (the bit field instructions are D/UD only) */
+  static bool isDWordBinary(const ir::Instruction &insn) {
+    if (!insn.isMemberOf<ir::BinaryInstruction>())
+      return false;
+    const ir::Type type = ir::cast<ir::BinaryInstruction>(insn).getType();
+    return type == ir::TYPE_S32 || type == ir::TYPE_U32;
+  }
+
+  /*! The 3 sources instructions do not take immediates, load them in a
+   *  scalar register which is replicated to all the channels */
+  static GenRegister loadScalarImmediate(Selection::Opaque &sel, uint32_t value) {
+    const GenRegister reg = sel.selReg(sel.reg(ir::FAMILY_DWORD, true), ir::TYPE_U32);
+    sel.push();
+      sel.curr.predicate = GEN_PREDICATE_NONE;
+      sel.curr.execWidth = 1;
+      sel.curr.noMask = 1;
+      sel.MOV(reg, GenRegister::immud(value));
+    sel.pop();
+    return reg;
+  }
+
+  /*! LRP pattern, dst = src0 * src1 + (1 - src0) * src2 on HW:
+    mul r0, a, (sub 1.0, t)
+    mul r1, b, t            ===> lrp dst, t, b, a
+    add dst, r0, r1;
+    or:
+    sub r0, b, a
+    mul r1, t, r0           ===> lrp dst, t, b, a
+    add dst, a, r1; */
+  class LrpInstructionPattern : public SelectionPattern
+  {
+  public:
+    /*! Register the pattern for all opcodes of the family */
+    LrpInstructionPattern() : SelectionPattern(4, 1) {
+       this->opcodes.push_back(ir::OP_ADD);
+    }
+
+    /*! Implements base class */
+    virtual bool emit(Selection::Opaque  &sel, SelectionDAG &dag) const
+    {
+      using namespace ir;
+
+      // Same as MAD, the rounding is not the one of the separate operations
+      if (!sel.ctx.relaxMath || sel.ctx.limitRegisterPressure)
+        return false;
+      const ir::BinaryInstruction &insn = cast<ir::BinaryInstruction>(dag.insn);
+      if (insn.getType() != TYPE_FLOAT)
+        return false;
+
+      // a * (1 - t) + b * t
+      const bool twoMuls = isFoldableChild(dag, 0, OP_MUL) && isFoldableChild(dag, 1, OP_MUL) &&
+                           isFloatBinary(dag.child[0]->insn) && isFloatBinary(dag.child[1]->insn);
+      for (uint32_t mulID = 0; twoMuls && mulID < 2; ++mulID) {
+        SelectionDAG *mul0 = dag.child[mulID];
+        SelectionDAG *mul1 = dag.child[mulID ^ 1];
+        for (uint32_t subID = 0; subID < 2; ++subID) {
+          SelectionDAG *sub = mul0->child[subID];
+          if (!isFoldableChild(*mul0, subID, OP_SUB) || !isFloatBinary(sub->insn) ||
+              !isFloatOne(sub->child[0]))
+            continue;
+          for (uint32_t tID = 0; tID < 2; ++tID) {
+            if (!sourceMatch(sub, 1, mul1, tID))
+              continue;
+            const Register a = mul0->insn.getSrc(subID ^ 1);
+            const Register b = mul1->insn.getSrc(tID ^ 1);
+            this->emitLRP(sel, insn, sub->insn.getSrc(1), b, a);
+            if (mul0->child[subID ^ 1]) mul0->child[subID ^ 1]->isRoot = 1;
+            if (mul1->child[0]) mul1->child[0]->isRoot = 1;
+            if (mul1->child[1]) mul1->child[1]->isRoot = 1;
+            if (sub->child[1]) sub->child[1]->isRoot = 1;
+            return true;
+          }
+        }
+      }
+
+      // a + t * (b - a)
+      for (uint32_t mulID = 0; mulID < 2; ++mulID) {
+        if (!isFoldableChild(dag, mulID, OP_MUL) || !isFloatBinary(dag.child[mulID]->insn))
+          continue;
+        SelectionDAG *mul = dag.child[mulID];
+        for (uint32_t subID = 0; subID < 2; ++subID) {
+          SelectionDAG *sub = mul->child[subID];
+          if (!isFoldableChild(*mul, subID, OP_SUB) || !isFloatBinary(sub->insn) ||
+              !sourceMatch(sub, 1, &dag, mulID ^ 1))
+            continue;
+          this->emitLRP(sel, insn, mul->insn.getSrc(subID ^ 1), sub->insn.getSrc(0), insn.getSrc(mulID ^ 1));
+          if (dag.child[mulID ^ 1]) dag.child[mulID ^ 1]->isRoot = 1;
+          if (mul->child[subID ^ 1]) mul->child[subID ^ 1]->isRoot = 1;
+          if (sub->child[0]) sub->child[0]->isRoot = 1;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    INLINE void emitLRP(Selection::Opaque &sel, const ir::BinaryInstruction &insn,
+                        ir::Register t, ir::Register b, ir::Register a) const
+    {
+      using namespace ir;
+      sel.push();
+      if (sel.isScalarReg(insn.getDst(0)))
+        sel.curr.execWidth = 1;
+      sel.LRP(sel.selReg(insn.getDst(0), TYPE_FLOAT), sel.selReg(t, TYPE_FLOAT),
+              sel.selReg(b, TYPE_FLOAT), sel.selReg(a, TYPE_FLOAT));
+      sel.pop();
+    }
+  };
+
+  /*! Bit field extract pattern (Gen8+), BFE dst = (src2 >> src1) & ((1 << src0) - 1):
+    shr r0, x, off;
+    and dst, r0, (1 << w) - 1;  ===> bfe dst, w, off, x */
+  class BitFieldExtractInstructionPattern : public SelectionPattern
+  {
+  public:
+    /*! Register the pattern for all opcodes of the family */
+    BitFieldExtractInstructionPattern() : SelectionPattern(2, 1) {
+       this->opcodes.push_back(ir::OP_AND);
+    }
+
+    /*! Implements base class */
+    virtual bool emit(Selection::Opaque  &sel, SelectionDAG &dag) const
+    {
+      using namespace ir;
+      // A scalar extract stays two scalar instructions
+      if (!sel.hasBitField() || !isDWordBinary(dag.insn) || sel.isScalarReg(dag.insn.getDst(0)))
+        return false;
+
+      for (uint32_t maskID = 0; maskID < 2; ++maskID) {
+        uint32_t mask;
+        if (!getDWordImmediate(dag.child[maskID], mask) ||
+            !isFoldableChild(dag, maskID ^ 1, OP_SHR))
+          continue;
+        SelectionDAG *shr = dag.child[maskID ^ 1];
+        // The mask must be the (1 << w) - 1 of a partial field
+        if (mask == 0 || mask == 0xffffffff || (mask & (mask + 1)) != 0 || !isDWordBinary(shr->insn))
+          continue;
+        // With an immediate offset, the two scalar MOVs of the width and the
+        // offset only pay off in SIMD16
+        uint32_t offset;
+        const bool immOffset = getDWordImmediate(shr->child[1], offset);
+        if (immOffset && sel.ctx.getSimdWidth() != 16)
+          continue;
+
+        const GenRegister dst = sel.selReg(dag.insn.getDst(0), TYPE_U32);
+        const GenRegister src = sel.selReg(shr->insn.getSrc(0), TYPE_U32);
+        // BFE uses the 5 low bits of the offset like SHR, and when the field
+        // is out of the source it keeps src >> offset like the AND would
+        const GenRegister width = loadScalarImmediate(sel, __builtin_popcount(mask));
+        const GenRegister off = immOffset ? loadScalarImmediate(sel, offset & 0x1f) :
+                                            sel.selReg(shr->insn.getSrc(1), TYPE_U32);
+        sel.BFE(dst, width, off, src);
+        if (shr->child[0]) shr->child[0]->isRoot = 1;
+        if (!immOffset && shr->child[1]) shr->child[1]->isRoot = 1;
+        return true;
+      }
+      return false;
+    }
+  };
+
+  /*! Bit field insert pattern (Gen8+), BFI2 dst = ((src1 << ctz(src0)) & src0) | (src2 & ~src0):
+    shl r0, b, n;
+    and r1, r0, m;
+    and r2, a, ~m;     ===> bfi2 dst, m, b, a   (n = ctz(m))
+    or dst, r1, r2;
+    or with the field masked before the shift:
+    and r0, b, w;
+    shl r1, r0, n;
+    and r2, a, ~(w << n);   ===> bfi2 dst, w << n, b, a
+    or dst, r1, r2; */
+  class BitFieldInsertInstructionPattern : public SelectionPattern
+  {
+  public:
+    /*! Register the pattern for all opcodes of the family */
+    BitFieldInsertInstructionPattern() : SelectionPattern(4, 1) {
+       this->opcodes.push_back(ir::OP_OR);
+    }
+
+    /*! Implements base class */
+    virtual bool emit(Selection::Opaque  &sel, SelectionDAG &dag) const
+    {
+      using namespace ir;
+      if (!sel.hasBitField() || !isDWordBinary(dag.insn))
+        return false;
+
+      for (uint32_t baseID = 0; baseID < 2; ++baseID) {
+        if (!isFoldableChild(dag, baseID, OP_AND) || !isDWordBinary(dag.child[baseID]->insn))
+          continue;
+        SelectionDAG *base = dag.child[baseID];
+        for (uint32_t notMaskID = 0; notMaskID < 2; ++notMaskID) {
+          uint32_t notMask;
+          if (!getDWordImmediate(base->child[notMaskID], notMask))
+            continue;
+          const uint32_t mask = ~notMask;
+          if (mask == 0 || notMask == 0)
+            continue;
+          uint32_t insertID;
+          SelectionDAG *inner = this->matchField(dag, baseID ^ 1, mask, insertID);
+          if (inner == NULL)
+            continue;
+
+          const GenRegister dst = sel.selReg(dag.insn.getDst(0), TYPE_U32);
+          const GenRegister insert = sel.selReg(inner->insn.getSrc(insertID), TYPE_U32);
+          const GenRegister src = sel.selReg(base->insn.getSrc(notMaskID ^ 1), TYPE_U32);
+          sel.push();
+          if (sel.isScalarReg(dag.insn.getDst(0)))
+            sel.curr.execWidth = 1;
+          sel.BFI2(dst, loadScalarImmediate(sel, mask), insert, src);
+          sel.pop();
+          if (base->child[notMaskID ^ 1]) base->child[notMaskID ^ 1]->isRoot = 1;
+          if (inner->child[insertID]) inner->child[insertID]->isRoot = 1;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /*! Match (b << n) & mask or (b & (mask >> n)) << n with n = ctz(mask), and
+     *  return the instruction that reads b and its source index */
+    INLINE SelectionDAG *matchField(SelectionDAG &dag, uint32_t fieldID,
+                                    uint32_t mask, uint32_t &insertID) const
+    {
+      using namespace ir;
+      const uint32_t shift = __builtin_ctz(mask);
+      uint32_t imm;
+      if (isFoldableChild(dag, fieldID, OP_AND)) {
+        SelectionDAG *andDAG = dag.child[fieldID];
+        if (!isDWordBinary(andDAG->insn))
+          return NULL;
+        for (uint32_t maskID = 0; maskID < 2; ++maskID) {
+          SelectionDAG *shl = andDAG->child[maskID ^ 1];
+          if (!getDWordImmediate(andDAG->child[maskID], imm) || imm != mask ||
+              !isFoldableChild(*andDAG, maskID ^ 1, OP_SHL) || !isDWordBinary(shl->insn) ||
+              !getDWordImmediate(shl->child[1], imm) || imm != shift)
+            continue;
+          insertID = 0;
+          return shl;
+        }
+      } else if (isFoldableChild(dag, fieldID, OP_SHL)) {
+        SelectionDAG *shl = dag.child[fieldID];
+        if (!isDWordBinary(shl->insn) || !getDWordImmediate(shl->child[1], imm) ||
+            imm != shift || !isFoldableChild(*shl, 0, OP_AND))
+          return NULL;
+        SelectionDAG *andDAG = shl->child[0];
+        if (!isDWordBinary(andDAG->insn))
+          return NULL;
+        // The bits of the field mask shifted out do not matter
+        for (uint32_t maskID = 0; maskID < 2; ++maskID) {
+          if (!getDWordImmediate(andDAG->child[maskID], imm) || (imm << shift) != mask)
+            continue;
+          insertID = maskID ^ 1;
+          return andDAG;
+        }
+      }
+      return NULL;
+    }
+  };
+
   /*! there some patterns like:
     sqrt r1, r2;
     load r4, 1.0;       ===> rqrt r3, r2
@@ -4166,6 +4484,46 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
     DECL_CTOR(WaitInstruction, 1,1);
   };
 
+  /*! Prefetch instruction pattern */
+  DECL_PATTERN(PrefetchInstruction)
+  {
+    INLINE bool emitOne(Selection::Opaque &sel, const ir::PrefetchInstruction &insn, bool &markChildren) const
+    {
+      using namespace ir;
+      Register reg = insn.getAddressRegister();
+      GenRegister address = sel.selReg(reg, getType(sel.getRegisterFamily(reg)));
+      const uint32_t simdWidth = sel.ctx.getSimdWidth();
+      GBE_ASSERT(insn.getAddressMode() != AM_DynamicBti);
+
+      // The messages need a non uniform address register
+      if (insn.getAddressMode() == AM_StaticBti) {
+        GenRegister addrDW = sel.selReg(sel.reg(FAMILY_DWORD), TYPE_U32);
+        if (typeSize(address.type) == 8)
+          address = GenRegister::retype(sel.unpacked_ud(address.reg()), GEN_TYPE_UD);
+        sel.MOV(addrDW, address);
+        sel.PREFETCH(addrDW, insn.getSurfaceIndex());
+        return true;
+      }
+
+      GenRegister addrQ = sel.selReg(sel.reg(FAMILY_QWORD), TYPE_U64);
+      sel.MOV(addrQ, address);
+      sel.push();
+        if (simdWidth == 8) {
+          sel.PREFETCH(addrQ, 0xff);
+        } else if (simdWidth == 16) {
+          sel.curr.execWidth = 8;
+          sel.curr.quarterControl = GEN_COMPRESSION_Q1;
+          sel.PREFETCH(GenRegister::Qn(addrQ, 0), 0xff);
+          sel.curr.quarterControl = GEN_COMPRESSION_Q2;
+          sel.PREFETCH(GenRegister::Qn(addrQ, 1), 0xff);
+        }
+      sel.pop();
+      return true;
+    }
+
+    DECL_CTOR(PrefetchInstruction, 1, 1);
+  };
+
   INLINE uint32_t getByteScatterGatherSize(Selection::Opaque &sel, ir::Type type) {
     using namespace ir;
     switch (type) {
@@ -7201,12 +7559,143 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
     }
   };
 
+  /*! Shuffle with an index register through the address register. A uniform
+   *  index only needs one address and a scalar region */
+  static void emitIndirectShuffle(Selection::Opaque &sel, ir::Type type, GenRegister dst,
+                                  GenRegister src0, GenRegister src1, bool uniformIndex) {
+    using namespace ir;
+    const uint32_t size = typeSize(getGenType(type));
+    const uint32_t SHLimm = size == 2 ? 1 : (size == 4 ? 2 : 3);
+    GenRegister shiftL;
+    sel.push();
+      if (uniformIndex) {
+        shiftL = sel.selReg(sel.reg(FAMILY_DWORD, true), TYPE_U32);
+        sel.curr.execWidth = 1;
+        sel.curr.predicate = GEN_PREDICATE_NONE;
+        sel.curr.noMask = 1;
+      } else
+        shiftL = sel.selReg(sel.reg(FAMILY_DWORD), TYPE_U32);
+      sel.SHL(shiftL, src1, GenRegister::immud(SHLimm));
+    sel.pop();
+    sel.SIMD_SHUFFLE(dst, src0, shiftL);
+  }
+
   class SimdShuffleInstructionPattern : public SelectionPattern
   {
   public:
     SimdShuffleInstructionPattern() : SelectionPattern(1,1) {
       this->opcodes.push_back(ir::OP_SIMD_SHUFFLE);
     }
+
+    /*! Index (laneid OP c) or (laneid OP c) % simdsize with OP in ADD, SUB or
+     *  XOR and c an immediate, as built by intel_sub_group_shuffle_down, up and
+     *  xor. Return the lanes rotation (ADD) or the xor mask (XOR) */
+    static bool getLanePermutation(const SelectionDAG *dag, uint32_t simdWidth,
+                                   ir::Opcode &op, uint32_t &c) {
+      using namespace ir;
+      if (dag == NULL)
+        return false;
+      if (dag->insn.getOpcode() == OP_REM) {
+        const SelectionDAG *size = dag->child[1];
+        if (cast<BinaryInstruction>(dag->insn).getType() != TYPE_U32 ||
+            size == NULL || size->insn.getOpcode() != OP_SIMD_SIZE)
+          return false;
+        dag = dag->child[0];
+        if (dag == NULL)
+          return false;
+      }
+      op = dag->insn.getOpcode();
+      if ((op != OP_ADD && op != OP_SUB && op != OP_XOR) || !isDWordBinary(dag->insn))
+        return false;
+      const SelectionDAG *laneID = dag->child[0];
+      const SelectionDAG *imm = dag->child[1];
+      if (op != OP_SUB && imm != NULL && imm->insn.getOpcode() == OP_SIMD_ID)
+        std::swap(laneID, imm);
+      if (laneID == NULL || laneID->insn.getOpcode() != OP_SIMD_ID ||
+          !getDWordImmediate(imm, c))
+        return false;
+      // The simd width divides 2^32, laneid - c wraps like laneid + (-c)
+      if (op == OP_SUB) {
+        op = OP_ADD;
+        c = -c;
+      }
+      c %= simdWidth;
+      return op == OP_ADD || (c & (c - 1)) == 0;
+    }
+
+    /*! Region of the lanes of a virtual register, 'stride' lanes apart */
+    static GenRegister laneRegion(GenRegister reg, uint32_t lane, uint32_t stride) {
+      reg = GenRegister::offset(reg, 0, lane * typeSize(reg.type));
+      reg.vstride = logi2(stride) + 1;
+      reg.width = GEN_WIDTH_1;
+      reg.hstride = GEN_HORIZONTAL_STRIDE_0;
+      return reg;
+    }
+
+    /*! dst[i] = src[(i + r) % simd]. src is copied twice in a row and each 8
+     *  lanes of dst read the copies from lane r. The region may cross a
+     *  register so it is made of one element rows */
+    static void emitRotate(Selection::Opaque &sel, ir::Type type,
+                           GenRegister dst, GenRegister src, uint32_t r) {
+      const uint32_t simdWidth = sel.curr.execWidth;
+      const GenRegister tmp = sel.selReg(sel.reg(ir::FAMILY_QWORD), type);
+      sel.push();
+        sel.curr.predicate = GEN_PREDICATE_NONE;
+        sel.curr.noMask = 1;
+        sel.MOV(tmp, src);
+        sel.MOV(GenRegister::offset(tmp, 0, simdWidth * typeSize(tmp.type)), src);
+      sel.pop();
+      sel.push();
+        sel.curr.execWidth = 8;
+        for (uint32_t quarter = 0; quarter < simdWidth / 8; ++quarter) {
+          sel.curr.quarterControl = quarter == 0 ? GEN_COMPRESSION_Q1 : GEN_COMPRESSION_Q2;
+          sel.MOV(GenRegister::QnVirtual(dst, quarter), laneRegion(tmp, r + 8 * quarter, 1));
+        }
+      sel.pop();
+    }
+
+    /*! dst[i] = src[i ^ k], k being a power of 2. The 8 lanes blocks are
+     *  swapped in place, the smaller ones are gathered in a temporary: the 4
+     *  lanes blocks one by one, the 1 and 2 lanes blocks 2k lanes apart */
+    static void emitXor(Selection::Opaque &sel, ir::Type type,
+                        GenRegister dst, GenRegister src, uint32_t k) {
+      const uint32_t simdWidth = sel.curr.execWidth;
+      if (k == 8) {
+        sel.push();
+          sel.curr.execWidth = 8;
+          for (uint32_t quarter = 0; quarter < 2; ++quarter) {
+            sel.curr.quarterControl = quarter == 0 ? GEN_COMPRESSION_Q1 : GEN_COMPRESSION_Q2;
+            sel.MOV(GenRegister::QnVirtual(dst, quarter), GenRegister::QnVirtual(src, quarter ^ 1));
+          }
+        sel.pop();
+        return;
+      }
+      const GenRegister tmp = sel.selReg(sel.reg(ir::FAMILY_DWORD), type);
+      const uint32_t size = typeSize(tmp.type);
+      sel.push();
+        sel.curr.predicate = GEN_PREDICATE_NONE;
+        sel.curr.noMask = 1;
+        if (k == 4) {
+          sel.curr.execWidth = 4;
+          for (uint32_t lane = 0; lane < simdWidth; lane += 4) {
+            GenRegister block = GenRegister::offset(src, 0, (lane ^ k) * size);
+            block.vstride = GEN_VERTICAL_STRIDE_4;
+            block.width = GEN_WIDTH_4;
+            block.hstride = GEN_HORIZONTAL_STRIDE_1;
+            sel.MOV(GenRegister::offset(tmp, 0, lane * size), block);
+          }
+        } else {
+          sel.curr.execWidth = simdWidth / (2 * k);
+          for (uint32_t lane = 0; lane < 2 * k; ++lane) {
+            GenRegister strided = GenRegister::offset(tmp, 0, lane * size);
+            strided.hstride = k == 1 ? GEN_HORIZONTAL_STRIDE_2 : GEN_HORIZONTAL_STRIDE_4;
+            sel.MOV(strided, laneRegion(src, lane ^ k, 2 * k));
+          }
+        }
+      sel.pop();
+      sel.MOV(dst, tmp);
+    }
+
     bool emit(Selection::Opaque &sel, SelectionDAG &dag) const override {
       using namespace ir;
       const auto &insn = cast<SimdShuffleInstruction>(dag.insn);
@@ -7218,6 +7707,27 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
 
       SelectionDAG *dag0 = dag.child[0];
       SelectionDAG *dag1 = dag.child[1];
+      const uint32_t simdWidth = sel.curr.execWidth;
+      const uint32_t size = typeSize(getGenType(type));
+      Opcode op = OP_INVALID;
+      uint32_t c = 0;
+      if (!sel.isScalarReg(insn.getSrc(0)) && (size == 2 || size == 4) &&
+          (simdWidth == 8 || simdWidth == 16) &&
+          getLanePermutation(dag1, simdWidth, op, c)) {
+        // Only the lanes are moved, the index is not computed
+        if (dag0) dag0->isRoot = 1;
+        const Type movType = size == 2 ? TYPE_U16 : TYPE_U32;
+        dst = sel.selReg(insn.getDst(0), movType);
+        src0 = sel.selReg(insn.getSrc(0), movType);
+        if (c == 0)
+          sel.MOV(dst, src0);
+        else if (op == OP_XOR)
+          emitXor(sel, movType, dst, src0, c);
+        else
+          emitRotate(sel, movType, dst, src0, c);
+        return true;
+      }
+
       if (dag1 != nullptr && dag1->insn.getOpcode() == OP_LOADI && canGetRegisterFromImmediate(dag1->insn)) {
         const auto &childInsn = cast<LoadImmInstruction>(dag1->insn);
         src1 = getRegisterFromImmediate(childInsn.getImmediate(), TYPE_U32);
@@ -7244,12 +7754,8 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
           reg.width = GEN_WIDTH_1;
           sel.MOV(dst, reg);
         }
-        else {
-          GenRegister shiftL = sel.selReg(sel.reg(FAMILY_DWORD), TYPE_U32);
-          uint32_t SHLimm = typeSize(getGenType(type)) == 2 ? 1 : (typeSize(getGenType(type)) == 4 ? 2 : 3);
-          sel.SHL(shiftL, src1, GenRegister::immud(SHLimm));
-          sel.SIMD_SHUFFLE(dst, src0, shiftL);
-        }
+        else
+          emitIndirectShuffle(sel, type, dst, src0, src1, sel.isScalarReg(insn.getSrc(1)));
       }
       sel.pop();
       return true;
@@ -7424,14 +7930,14 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
       i = 0;
       GenRegister regs[8];
       if (srcNum == 0) {
-          sel.PRINTF(BTI, tmp0, tmp1, regs, srcNum, num, isContinue, totalSize);
+          sel.PRINTF(BTI, tmp0, tmp1, regs, srcNum, num, isContinue, true, totalSize);
       } else {
         do {
           uint32_t s = srcNum < 8 ? srcNum : 8;
           for (uint32_t j = 0; j < s; j++) {
             regs[j] = sel.selReg(insn.getSrc(i + j), insn.getType(i + j));
           }
-          sel.PRINTF(BTI, tmp0, tmp1, regs, s, num, isContinue, totalSize);
+          sel.PRINTF(BTI, tmp0, tmp1, regs, s, num, isContinue, srcNum <= 8, totalSize);
 
           if (srcNum > 8) {
             srcNum -= 8;
@@ -7912,12 +8418,8 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
           reg.hstride = GEN_HORIZONTAL_STRIDE_0;
           reg.width = GEN_WIDTH_1;
           sel.MOV(dst, reg);
-      } else {
-        GenRegister shiftL = sel.selReg(sel.reg(FAMILY_DWORD), TYPE_U32);
-        uint32_t SHLimm = typeSize(getGenType(type)) == 2 ? 1 : (typeSize(getGenType(type)) == 4 ? 2 : 3);
-        sel.SHL(shiftL, src1, GenRegister::immud(SHLimm));
-        sel.SIMD_SHUFFLE(dst, src0, shiftL);
-      }
+      } else
+        emitIndirectShuffle(sel, type, dst, src0, src1, sel.isScalarReg(insn.getSrc(1)));
       } sel.pop();
 
       return true;
@@ -8149,6 +8651,9 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
     this->insert<Int32x32MulInstructionPattern>();
     this->insert<Int32x16MulInstructionPattern>();
     this->insert<MulAddInstructionPattern>();
+    this->insert<LrpInstructionPattern>();
+    this->insert<BitFieldExtractInstructionPattern>();
+    this->insert<BitFieldInsertInstructionPattern>();
     this->insert<SelectModifierInstructionPattern>();
     this->insert<SampleInstructionPattern>();
     this->insert<VmeInstructionPattern>();
@@ -8163,6 +8668,7 @@ extern int32_t OCL_DEBUGINFO; // first defined by calling BVAR in program.cpp
     this->insert<SubGroupInstructionPattern>();
     this->insert<NullaryInstructionPattern>();
     this->insert<WaitInstructionPattern>();
+    this->insert<PrefetchInstructionPattern>();
     this->insert<PrintfInstructionPattern>();
     this->insert<MediaBlockReadInstructionPattern>();
     this->insert<MediaBlockWriteInstructionPattern>();
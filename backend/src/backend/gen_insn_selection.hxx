@@ -45,6 +45,8 @@ DECL_SELECTION_IR(I64CMP, I64CompareInstruction)
 DECL_SELECTION_IR(SEL_CMP, CompareInstruction)
 DECL_SELECTION_IR(MAD, TernaryInstruction)
 DECL_SELECTION_IR(LRP, TernaryInstruction)
+DECL_SELECTION_IR(BFE, TernaryInstruction)
+DECL_SELECTION_IR(BFI2, TernaryInstruction)
 DECL_SELECTION_IR(JMPI, JumpInstruction)
 DECL_SELECTION_IR(EOT, EotInstruction)
 DECL_SELECTION_IR(INDIRECT_MOVE, IndirectMoveInstruction)
@@ -108,3 +110,4 @@ DECL_SELECTION_IR(OBWRITE, OBWriteInstruction)
 DECL_SELECTION_IR(MBREAD, MBReadInstruction)
 DECL_SELECTION_IR(MBWRITE, MBWriteInstruction)
 DECL_SELECTION_IR(BFREV, UnaryInstruction)
+DECL_SELECTION_IR(PREFETCH, PrefetchInstruction)
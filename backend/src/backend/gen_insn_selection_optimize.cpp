@@ -209,6 +209,8 @@ namespace gbe
         case SEL_OP_BRC:
         case SEL_OP_BRD:
         case SEL_OP_BFREV:
+        case SEL_OP_BFE:
+        case SEL_OP_BFI2:
         case SEL_OP_LZD:
         case SEL_OP_HADD:
         case SEL_OP_RHADD:
@@ -73,14 +73,18 @@
 namespace gbe {
 
   GenKernel::GenKernel(const std::string &name, uint32_t deviceID) :
-    Kernel(name), deviceID(deviceID), insns(nullptr), insnNum(0)
+    Kernel(name), deviceID(deviceID), insns(nullptr), insnNum(0), spillNum(0), ownInsns(true)
   {}
-  GenKernel::~GenKernel() { GBE_SAFE_DELETE_ARRAY(insns); }
+  GenKernel::~GenKernel() { if (ownInsns) GBE_SAFE_DELETE_ARRAY(insns); }
   const char *GenKernel::getCode() const { return (const char*) insns; }
   void GenKernel::setCode(const char * ins, size_t size) {
     insns = (GenInstruction *)ins;
     insnNum = size / sizeof(GenInstruction);
   }
+  void GenKernel::referCode(const char * ins, size_t size) {
+    this->setCode(ins, size);
+    ownInsns = false;
+  }
   uint32_t GenKernel::getCodeSize() const { return insnNum * sizeof(GenInstruction); }
 
   void GenKernel::printStatus(int indent, std::ostream& outs) {
@@ -276,7 +280,10 @@ namespace gbe {
     GBHI_GLK = 8,
     GBHI_MAX,
   };
-#define GEN_BINARY_VERSION  1
+  /* Version 2 is the flat format (see program.hpp), version 1 the
+   * serialized stream, still readable */
+#define GEN_BINARY_VERSION  2
+#define GEN_BINARY_STREAM_VERSION  1
   static const unsigned char gen_binary_header[GBHI_MAX][GEN_BINARY_HEADER_LENGTH]= \
                                              {{GEN_BINARY_VERSION, 'G','E', 'N', 'C', 'B', 'Y', 'T'},
                                               {GEN_BINARY_VERSION, 'G','E', 'N', 'C', 'I', 'V', 'B'},
@@ -308,7 +315,7 @@ namespace gbe {
       matched = matched && (BufPtr[i] == gen_binary_header[index][i]);
     }
     if(matched) {
-      if(BufPtr[0] != gen_binary_header[index][0]) {
+      if(BufPtr[0] != gen_binary_header[index][0] && BufPtr[0] != GEN_BINARY_STREAM_VERSION) {
         std::cout << "Beignet binary format have been changed, please generate binary again.\n";
         matched = false;
       }
@@ -351,6 +358,19 @@ namespace gbe {
       return nullptr;
     }
 
+    if (binary[0] == GEN_BINARY_VERSION) {
+      // One copy to own the flat binary, the kernels refer to it
+      const size_t flat_size = size - GEN_BINARY_HEADER_LENGTH;
+      char *flat = (char *)GBE_ALIGNED_MALLOC(flat_size, FLAT_CODE_ALIGN);
+      memcpy(flat, binary + GEN_BINARY_HEADER_LENGTH, flat_size);
+      GenProgram *program = GBE_NEW(GenProgram, deviceID);
+      if (!program->deserializeFromFlatBin(flat, flat_size, true)) {
+        GBE_DELETE(program);
+        return nullptr;
+      }
+      return reinterpret_cast<gbe_program>(program);
+    }
+
     binary_content.assign(binary+GEN_BINARY_HEADER_LENGTH, size-GEN_BINARY_HEADER_LENGTH);
     GenProgram *program = GBE_NEW(GenProgram, deviceID);
     std::istringstream ifs(binary_content, std::ostringstream::binary);
@@ -364,6 +384,30 @@ namespace gbe {
     return reinterpret_cast<gbe_program>(program);
   }
 
+  static gbe_program genProgramNewFromMappedBinary(uint32_t deviceID, const char *binary, size_t size) {
+    using namespace gbe;
+
+    if(size < GEN_BINARY_HEADER_LENGTH || !MATCH_DEVICE(deviceID, (unsigned char*)binary))
+      return nullptr;
+
+    // The stream format is copied
+    const char *flat = binary + GEN_BINARY_HEADER_LENGTH;
+    if (binary[0] != GEN_BINARY_VERSION)
+      return genProgramNewFromBinary(deviceID, binary, size);
+
+    // The runtime allocates the binaries so that the flat one is read in place
+    GBE_ASSERTM((uintptr_t)flat % sizeof(uint64_t) == 0, "the mapped gen binary is not 8 bytes aligned");
+    if ((uintptr_t)flat % sizeof(uint64_t) != 0)
+      return genProgramNewFromBinary(deviceID, binary, size);
+
+    GenProgram *program = GBE_NEW(GenProgram, deviceID);
+    if (!program->deserializeFromFlatBin(flat, size - GEN_BINARY_HEADER_LENGTH, false)) {
+      GBE_DELETE(program);
+      return nullptr;
+    }
+    return reinterpret_cast<gbe_program>(program);
+  }
+
   static gbe_program genProgramNewFromLLVMBinary(uint32_t deviceID, const char *binary, size_t size) {
 #ifdef GBE_COMPILER_AVAILABLE
     using namespace gbe;
@@ -410,12 +454,12 @@ namespace gbe {
   static size_t genProgramSerializeToBinary(gbe_program program, char **binary, int binary_type) {
     using namespace gbe;
     size_t sz;
-    std::ostringstream oss;
+    std::string flat;
     auto *prog = (GenProgram*)program;
 
     //0 means GEN binary, 1 means LLVM bitcode compiled object, 2 means LLVM bitcode library
     if(binary_type == 0){
-      if ((sz = prog->serializeToBin(oss)) == 0) {
+      if ((sz = prog->serializeToFlatBin(flat)) == 0) {
         *binary = nullptr;
         return 0;
       }
@@ -453,7 +497,7 @@ namespace gbe {
         *binary = nullptr;
         return 0;
       }
-      memcpy(*binary+GEN_BINARY_HEADER_LENGTH, oss.str().c_str(), sz*sizeof(char));
+      memcpy(*binary+GEN_BINARY_HEADER_LENGTH, flat.data(), sz*sizeof(char));
       return sz+GEN_BINARY_HEADER_LENGTH;
     }else{
 #ifdef GBE_COMPILER_AVAILABLE
@@ -496,15 +540,19 @@ namespace gbe {
         fast_relaxed_math = 1;
 
     GenProgram *program = GBE_NEW(GenProgram, deviceID, module, llvm_ctx, asm_file_name, fast_relaxed_math);
+    if (options != nullptr && strstr(options, "-cl-medium-precision-math") != nullptr)
+      program->medium_precision_math = 1;
 #ifdef GBE_COMPILER_AVAILABLE
     std::string error;
-    // Try to compile the program
-    if (!program->buildFromLLVMModule(module, error, optLevel)) {
-      if (err != nullptr && errSize != nullptr && stringSize > 0u) {
-        const size_t msgSize = std::min(error.size(), stringSize-1u);
-        std::memcpy(err, error.c_str(), msgSize);
-        *errSize = error.size();
-      }
+    // Try to compile the program. The notes and warnings of a successful
+    // build (like the SLM padding report) go to the build log too
+    const bool built = program->buildFromLLVMModule(module, error, optLevel);
+    if (err != nullptr && errSize != nullptr && stringSize > 0u) {
+      const size_t msgSize = std::min(error.size(), stringSize-1u);
+      std::memcpy(err, error.c_str(), msgSize);
+      *errSize = error.size();
+    }
+    if (!built) {
       GBE_DELETE(program);
       return nullptr;
     }
@@ -590,6 +638,7 @@ namespace gbe {
     std::string dumpASMFileName;
     size_t start = 0, end = 0;
     uint32_t fast_relaxed_math = 0;
+    uint32_t medium_precision_math = 0;
 
     if(options) {
       char *p;
@@ -600,6 +649,8 @@ namespace gbe {
       if (options != nullptr)
         if (strstr(options, "-cl-fast-relaxed-math") != nullptr)
           fast_relaxed_math = 1;
+      if (strstr(options, "-cl-medium-precision-math") != nullptr)
+        medium_precision_math = 1;
 
       char *options_str = (char *)malloc(sizeof(char) * (strlen(options) + 1));
       if (options_str == nullptr)
@@ -623,6 +674,7 @@ namespace gbe {
 
     auto* p = (GenProgram*) program;
     p->fast_relaxed_math = fast_relaxed_math;
+    p->medium_precision_math = medium_precision_math;
     if (!dumpASMFileName.empty()) {
       p->asm_file_name = dumpASMFileName.c_str();
       FILE *asmDumpStream = fopen(dumpASMFileName.c_str(), "w");
@@ -633,12 +685,11 @@ namespace gbe {
     acquireLLVMContextLock();
     auto* module = (llvm::Module*)p->module;
 
-    if (!p->buildFromLLVMModule(module, error, optLevel)) {
-      if (err != nullptr && errSize != nullptr && stringSize > 0u) {
-        const size_t msgSize = std::min(error.size(), stringSize-1u);
-        std::memcpy(err, error.c_str(), msgSize);
-        *errSize = error.size();
-      }
+    p->buildFromLLVMModule(module, error, optLevel);
+    if (err != nullptr && errSize != nullptr && stringSize > 0u) {
+      const size_t msgSize = std::min(error.size(), stringSize-1u);
+      std::memcpy(err, error.c_str(), msgSize);
+      *errSize = error.size();
     }
     releaseLLVMContextLock();
 #endif
@@ -649,6 +700,7 @@ namespace gbe {
 void genSetupCallBacks()
 {
   gbe_program_new_from_binary = gbe::genProgramNewFromBinary;
+  gbe_program_new_from_mapped_binary = gbe::genProgramNewFromMappedBinary;
   gbe_program_new_from_llvm_binary = gbe::genProgramNewFromLLVMBinary;
   gbe_program_serialize_to_binary = gbe::genProgramSerializeToBinary;
   gbe_program_new_from_llvm = gbe::genProgramNewFromLLVM;
@@ -45,6 +45,8 @@ namespace gbe
     virtual const char *getCode(void) const;
     /*! Set the instruction stream (to be implemented) */
     virtual void setCode(const char *, size_t size);
+    /*! Implements base class */
+    virtual void referCode(const char *, size_t size);
     /*! Implements get the code size */
     virtual uint32_t getCodeSize(void) const;
     /*! Implements printStatus*/
@@ -52,6 +54,8 @@ namespace gbe
     uint32_t deviceID;      //!< Current device ID
     GenInstruction *insns; //!< Instruction stream
     uint32_t insnNum;      //!< Number of instructions
+    uint32_t spillNum;     //!< Number of spilled registers (not serialized)
+    bool ownInsns;         //!< False when insns is in a flat binary
     GBE_CLASS(GenKernel);  //!< Use custom allocators
   };
 
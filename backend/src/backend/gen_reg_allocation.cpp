@@ -83,6 +83,9 @@ namespace gbe
     }
     /*! Output the register allocation */
     void outputAllocation();
+    INLINE uint32_t getSpilledRegNum(void) const {
+      return spilledRegs.size();
+    }
     INLINE void getRegAttrib(ir::Register reg, uint32_t &regSize, ir::RegisterFamily *regFamily = nullptr) const {
       // Note that byte vector registers use two bytes per byte (and can be
       // interleaved)
@@ -1244,7 +1247,8 @@ namespace gbe
       for (auto &insn : block.insnList) {
         const uint32_t srcNum = insn.srcNum, dstNum = insn.dstNum;
         assert(insnID == (int32_t)insn.ID);
-        bool is3SrcOp = insn.opcode == SEL_OP_MAD;
+        bool is3SrcOp = insn.opcode == SEL_OP_MAD || insn.opcode == SEL_OP_LRP ||
+                        insn.opcode == SEL_OP_BFE || insn.opcode == SEL_OP_BFI2;
         for (uint32_t srcID = 0; srcID < srcNum; ++srcID) {
           const GenRegister &selReg = insn.src(srcID);
           const ir::Register reg = selReg.reg();
@@ -1537,6 +1541,10 @@ do { \
     this->opaque->outputAllocation();
   }
 
+  uint32_t GenRegAllocator::getSpilledRegNum(void) const {
+    return this->opaque->getSpilledRegNum();
+  }
+
   uint32_t GenRegAllocator::getRegSize(ir::Register reg) {
     uint32_t regSize;
     gbe_curbe_type curbeType = GBE_GEN_REG;
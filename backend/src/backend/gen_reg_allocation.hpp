@@ -60,6 +60,8 @@ namespace gbe
     void outputAllocation(void);
     /*! Get register actual size in byte. */
     uint32_t getRegSize(ir::Register reg);
+    /*! Number of virtual registers spilled to scratch */
+    uint32_t getSpilledRegNum(void) const;
   private:
     /*! Actual implementation of the register allocator (use Pimpl) */
     class Opaque;
@@ -43,6 +43,7 @@
 #include "llvm/IRReader/IRReader.h"
 #endif
 
+#include <cerrno>
 #include <cstring>
 #include <algorithm>
 #include <fstream>
@@ -51,10 +52,13 @@
 #include <iostream>
 #include <unistd.h>
 #include <mutex>
+#include <sys/stat.h>
+#include <sys/types.h>
 
 #ifdef GBE_COMPILER_AVAILABLE
 
 #include <clang/CodeGen/CodeGenAction.h>
+#include <clang/Frontend/FrontendActions.h>
 #include <clang/Frontend/CompilerInstance.h>
 #include <clang/Frontend/CompilerInvocation.h>
 #include <clang/Basic/DiagnosticOptions.h>
@@ -78,9 +82,9 @@
 namespace gbe {
 
   Kernel::Kernel(const std::string &name) :
-    name(name), args(nullptr), argNum(0), curbeSize(0), stackSize(0), useSLM(false),
+    name(name), args(nullptr), argNum(0), curbeSize(0), stackSize(0), scratchSize(0), grfSize(0), useSLM(false),
         slmSize(0), ctx(nullptr), samplerSet(nullptr), imageSet(nullptr), printfSet(nullptr),
-        profilingInfo(nullptr), useDeviceEnqueue(false) {}
+        profilingInfo(nullptr), useDeviceEnqueue(false), flat(nullptr), flatBase(nullptr) {}
 
   Kernel::~Kernel(void) {
     if(ctx) GBE_DELETE(ctx);
@@ -92,20 +96,62 @@ namespace gbe {
   }
   int32_t Kernel::getCurbeOffset(gbe_curbe_type type, uint32_t subType) const {
     const PatchInfo patch(type, subType);
+    if (flat) {
+      const PatchInfo *begin = (const PatchInfo *)(flatBase + flat->patchOffset);
+      const PatchInfo *end = begin + flat->patchNum;
+      const PatchInfo *it = std::lower_bound(begin, end, patch);
+      if (it == end || patch < *it) return -1;
+      return it->offset;
+    }
     const auto it = std::lower_bound(patches.begin(), patches.end(), patch);
     if (it == patches.end()) return -1; // nothing found
     if (patch < *it) return -1; // they are not equal
     return it->offset; // we found it!
   }
 
-  Program::Program(uint32_t fast_relaxed_math) : fast_relaxed_math(fast_relaxed_math), 
+  Program::Program(uint32_t fast_relaxed_math) : fast_relaxed_math(fast_relaxed_math),
+                               medium_precision_math(0),
                                constantSet(nullptr),
-                               relocTable(nullptr) {}
+                               relocTable(nullptr),
+                               oclVersion(120),
+                               lazyUnit(nullptr),
+                               lazyKernelNum(0),
+                               lazyBuild(false),
+                               flat(nullptr),
+                               flatStorage(nullptr) {}
   Program::~Program(void) {
     for (map<std::string, Kernel*>::iterator it = kernels.begin(); it != kernels.end(); ++it)
-      GBE_DELETE(it->second);
+      if (it->second) GBE_DELETE(it->second);
     if (constantSet) delete constantSet;
     if (relocTable) delete relocTable;
+#ifdef GBE_COMPILER_AVAILABLE
+    if (lazyUnit) delete lazyUnit;
+#endif
+    if (flatStorage) GBE_ALIGNED_FREE(flatStorage);
+  }
+
+  Kernel *Program::getCompiledKernel(map<std::string, Kernel*>::iterator it) {
+    if (!lazyBuild)
+      return it->second;
+    std::lock_guard<std::mutex> lock(lazyMutex);
+#ifdef GBE_COMPILER_AVAILABLE
+    if (it->second == NULL && lazyUnit != NULL) {
+      std::string error;
+      it->second = this->buildKernel(*lazyUnit, it->first, error);
+      if (it->second && --lazyKernelNum == 0) {
+        delete lazyUnit;
+        lazyUnit = NULL;
+      }
+    }
+#endif
+    return it->second;
+  }
+
+  bool Program::compileAllKernels(void) {
+    for (map<std::string, Kernel*>::iterator it = kernels.begin(); it != kernels.end(); ++it)
+      if (this->getCompiledKernel(it) == NULL)
+        return false;
+    return true;
   }
 
 #ifdef GBE_COMPILER_AVAILABLE
@@ -113,6 +159,7 @@ namespace gbe {
   BVAR(OCL_STRICT_CONFORMANCE, true);
   IVAR(OCL_PROFILING_LOG, 0, 0, 1); // Int for different profiling types.
   BVAR(OCL_OUTPUT_BUILD_LOG, false);
+  BVAR(OCL_LAZY_KERNEL_COMPILE, false);
 
   bool Program::buildFromLLVMModule(const void* module,
                                               std::string &error,
@@ -124,7 +171,10 @@ namespace gbe {
     if (fast_relaxed_math || !OCL_STRICT_CONFORMANCE)
       strictMath = false;
 
-    if (!llvmToGen(*unit, module, optLevel, strictMath, OCL_PROFILING_LOG, error)) {
+    // The medium precision math only replaces the strict path
+    const bool mediumMath = medium_precision_math && strictMath;
+
+    if (!llvmToGen(*unit, module, optLevel, strictMath, mediumMath, OCL_PROFILING_LOG, error)) {
       delete unit;
       return false;
     }
@@ -143,43 +193,71 @@ namespace gbe {
       }
       error = error + error2;
     }
+    // The pending kernels are compiled from it on demand
+    if (ret && lazyBuild) {
+      lazyUnit = unit;
+      return ret;
+    }
     delete unit;
     return ret;
   }
 
+  void (*Program::unitHook)(const ir::Unit &unit) = nullptr;
+
   bool Program::buildFromUnit(const ir::Unit &unit, std::string &error) {
     constantSet = new ir::ConstantSet(unit.getConstantSet());
     relocTable = new ir::RelocTable(unit.getRelocTable());
     blockFuncs = unit.blockFuncs;
+    oclVersion = unit.getOclVersion();
     const auto &set = unit.getFunctionSet();
     const uint32_t kernelNum = set.size();
     if (OCL_OUTPUT_GEN_IR) std::cout << unit;
+    if (unitHook) unitHook(unit);
     if (kernelNum == 0) return true;
 
-    bool strictMath = true;
-    if (fast_relaxed_math || !OCL_STRICT_CONFORMANCE)
-      strictMath = false;
+    // Only the kernels actually created get compiled, see getCompiledKernel
+    if (OCL_LAZY_KERNEL_COMPILE) {
+      for (const auto &pair : set)
+        kernels.insert(std::make_pair(pair.first, (Kernel *) NULL));
+      lazyKernelNum = kernelNum;
+      lazyBuild = true;
+      return true;
+    }
 
     for (const auto &pair : set) {
       const std::string &name = pair.first;
-      Kernel *kernel = this->compileKernel(unit, name, !strictMath, OCL_PROFILING_LOG);
-      if (!kernel) {
-        error +=  name;
-        error += ":(GBE): error: failed in Gen backend.\n";
-        if (OCL_OUTPUT_BUILD_LOG)
-          llvm::errs() << error;
+      Kernel *kernel = this->buildKernel(unit, name, error);
+      if (!kernel)
         return false;
-      }
-      kernel->setSamplerSet(pair.second->getSamplerSet());
-      kernel->setProfilingInfo(new ir::ProfilingInfo(*unit.getProfilingInfo()));
-      kernel->setImageSet(pair.second->getImageSet());
-      kernel->setPrintfSet(pair.second->getPrintfSet());
-      kernel->setCompileWorkGroupSize(pair.second->getCompileWorkGroupSize());
-      kernel->setFunctionAttributes(pair.second->getFunctionAttributes());
       kernels.insert(std::make_pair(name, kernel));
     }
     return true;
   }
+
+  Kernel *Program::buildKernel(const ir::Unit &unit, const std::string &name, std::string &error) {
+    bool strictMath = true;
+    if (fast_relaxed_math || !OCL_STRICT_CONFORMANCE)
+      strictMath = false;
+
+    const ir::Function *fn = unit.getFunction(name);
+    Kernel *kernel = this->compileKernel(unit, name, !strictMath, OCL_PROFILING_LOG);
+    if (!kernel) {
+      error +=  name;
+      error += ":(GBE): error: failed in Gen backend.\n";
+      if (OCL_OUTPUT_BUILD_LOG)
+        llvm::errs() << error;
+      return NULL;
+    }
+    kernel->setSamplerSet(fn->getSamplerSet());
+    ir::ProfilingInfo *profilingInfo = new ir::ProfilingInfo(*unit.getProfilingInfo());
+    profilingInfo->setKernelName(name);
+    kernel->setProfilingInfo(profilingInfo);
+    kernel->setImageSet(fn->getImageSet());
+    kernel->setPrintfSet(fn->getPrintfSet());
+    kernel->setCompileWorkGroupSize(fn->getCompileWorkGroupSize());
+    kernel->setFunctionAttributes(fn->getFunctionAttributes());
+    return kernel;
+  }
 #endif
 
 #define OUT_UPDATE_SZ(elt) SERIALIZE_OUT(elt, outs, ret_size)
@@ -191,6 +269,11 @@ namespace gbe {
     uint32_t has_constset = 0;
     uint32_t has_relocTable = 0;
 
+
+    // The binary holds all the kernels
+    if (!this->compileAllKernels())
+      return 0;
+
     OUT_UPDATE_SZ(magic_begin);
 
     if (constantSet) {
@@ -278,6 +361,8 @@ namespace gbe {
       kernels.insert(std::make_pair(ker->getName(), ker));
       total_size += ker_serial_sz;
     }
+    if (!kernels.empty())
+      oclVersion = kernels.begin()->second->getOclVersion();
 
     IN_UPDATE_SZ(magic);
     if (magic != magic_end)
@@ -541,6 +626,272 @@ namespace gbe {
 #undef OUT_UPDATE_SZ
 #undef IN_UPDATE_SZ
 
+  /*! Sections of a flat binary. The offsets of the records are relative to
+   *  their section until Program::serializeToFlatBin lays them out */
+  class FlatWriter
+  {
+  public:
+    vector<FlatKernel> kernels;
+    vector<FlatArgument> args;
+    vector<PatchInfo> patches;
+    vector<uint32_t> samplers;
+    vector<ImageInfo> images;
+    std::string strings;
+    std::string code;
+    /*! Append a zero terminated string, returns its offset */
+    uint32_t addString(const char *str) {
+      const uint32_t offset = strings.size();
+      strings.append(str);
+      strings.push_back('\0');
+      return offset;
+    }
+  };
+
+  /*! Says if count elements of elemSize bytes, at an offset aligned on
+   *  align, fit in a flat binary of size bytes */
+  static bool flatFits(uint32_t size, uint32_t offset, uint32_t count, uint32_t elemSize, uint32_t align) {
+    return offset % align == 0 && offset <= size && uint64_t(count) * elemSize <= size - offset;
+  }
+
+  static bool flatIsString(const FlatProgram &program, uint32_t offset) {
+    return offset >= program.stringOffset && offset - program.stringOffset < program.stringSize;
+  }
+
+  bool Kernel::serializeToFlat(FlatWriter &writer) {
+    FlatKernel record;
+    memset(&record, 0, sizeof(record));
+    record.name = writer.addString(name.c_str());
+    record.functionAttributes = writer.addString(getFunctionAttributes());
+    record.oclVersion = oclVersion;
+
+    record.argNum = argNum;
+    record.argOffset = writer.args.size() * sizeof(FlatArgument);
+    for (uint32_t i = 0; i < argNum; i++) {
+      FlatArgument arg;
+      arg.type = getArgType(i);
+      arg.size = getArgSize(i);
+      arg.align = getArgAlign(i);
+      arg.bti = getArgBTI(i);
+      if (flat) {
+        const FlatArgument *from = getFlatArg(i);
+        arg.addrSpace = from->addrSpace;
+        arg.typeSize = from->typeSize;
+        arg.typeName = writer.addString(getFlatString(from->typeName));
+        arg.accessQual = writer.addString(getFlatString(from->accessQual));
+        arg.typeQual = writer.addString(getFlatString(from->typeQual));
+        arg.argName = writer.addString(getFlatString(from->argName));
+      } else {
+        const KernelArgument::ArgInfo &info = args[i].info;
+        arg.addrSpace = info.addrSpace;
+        arg.typeSize = info.typeSize;
+        arg.typeName = writer.addString(info.typeName.c_str());
+        arg.accessQual = writer.addString(info.accessQual.c_str());
+        arg.typeQual = writer.addString(info.typeQual.c_str());
+        arg.argName = writer.addString(info.argName.c_str());
+      }
+      writer.args.push_back(arg);
+    }
+
+    if (flat) {
+      const PatchInfo *from = (const PatchInfo *)(flatBase + flat->patchOffset);
+      record.patchNum = flat->patchNum;
+      record.patchOffset = writer.patches.size() * sizeof(PatchInfo);
+      writer.patches.insert(writer.patches.end(), from, from + flat->patchNum);
+    } else {
+      record.patchNum = patches.size();
+      record.patchOffset = writer.patches.size() * sizeof(PatchInfo);
+      writer.patches.insert(writer.patches.end(), patches.begin(), patches.end());
+    }
+
+    record.samplerNum = getSamplerSize();
+    record.samplerOffset = writer.samplers.size() * sizeof(uint32_t);
+    if (record.samplerNum) {
+      writer.samplers.resize(writer.samplers.size() + record.samplerNum);
+      getSamplerData(&writer.samplers[record.samplerOffset / sizeof(uint32_t)]);
+    }
+
+    record.imageNum = getImageSize();
+    record.imageOffset = writer.images.size() * sizeof(ImageInfo);
+    if (record.imageNum) {
+      writer.images.resize(writer.images.size() + record.imageNum);
+      getImageData(&writer.images[record.imageOffset / sizeof(ImageInfo)]);
+    }
+
+    record.codeSize = getCodeSize();
+    writer.code.resize(ALIGN(writer.code.size(), FLAT_CODE_ALIGN), '\0');
+    record.codeOffset = writer.code.size();
+    if (record.codeSize)
+      writer.code.append(getCode(), record.codeSize);
+
+    record.curbeSize = curbeSize;
+    record.simdWidth = simdWidth;
+    record.stackSize = stackSize;
+    record.scratchSize = scratchSize;
+    record.grfSize = grfSize;
+    record.slmSize = slmSize;
+    record.useSLM = useSLM;
+    record.useDeviceEnqueue = useDeviceEnqueue;
+    for (uint32_t dim = 0; dim < 3; dim++)
+      record.compileWgSize[dim] = compileWgSize[dim];
+
+    writer.kernels.push_back(record);
+    return true;
+  }
+
+  bool Kernel::deserializeFromFlat(const FlatProgram &program, const FlatKernel &record) {
+    const char *base = (const char *)&program;
+    const uint32_t size = program.size;
+
+    if (!flatFits(size, record.argOffset, record.argNum, sizeof(FlatArgument), sizeof(uint32_t)) ||
+        !flatFits(size, record.patchOffset, record.patchNum, sizeof(PatchInfo), sizeof(PatchInfo)) ||
+        !flatFits(size, record.samplerOffset, record.samplerNum, sizeof(uint32_t), sizeof(uint32_t)) ||
+        !flatFits(size, record.imageOffset, record.imageNum, sizeof(ImageInfo), sizeof(uint32_t)) ||
+        !flatFits(size, record.codeOffset, record.codeSize, 1, 1) ||
+        !flatIsString(program, record.functionAttributes))
+      return false;
+    const FlatArgument *flatArgs = (const FlatArgument *)(base + record.argOffset);
+    for (uint32_t i = 0; i < record.argNum; i++) {
+      const FlatArgument &arg = flatArgs[i];
+      if (!flatIsString(program, arg.typeName) || !flatIsString(program, arg.accessQual) ||
+          !flatIsString(program, arg.typeQual) || !flatIsString(program, arg.argName))
+        return false;
+    }
+
+    flat = &record;
+    flatBase = base;
+    oclVersion = record.oclVersion;
+    argNum = record.argNum;
+    curbeSize = record.curbeSize;
+    simdWidth = record.simdWidth;
+    stackSize = record.stackSize;
+    scratchSize = record.scratchSize;
+    grfSize = record.grfSize;
+    slmSize = record.slmSize;
+    useSLM = record.useSLM != 0;
+    useDeviceEnqueue = record.useDeviceEnqueue != 0;
+    for (uint32_t dim = 0; dim < 3; dim++)
+      compileWgSize[dim] = record.compileWgSize[dim];
+    if (record.codeSize)
+      referCode(base + record.codeOffset, record.codeSize);
+    return true;
+  }
+
+  uint32_t Program::serializeToFlatBin(std::string &bin) {
+    FlatWriter writer;
+
+    // The binary holds all the kernels
+    if (!this->compileAllKernels())
+      return 0;
+    for (auto &kernel : kernels)
+      if (!kernel.second->serializeToFlat(writer))
+        return 0;
+
+    FlatProgram header;
+    memset(&header, 0, sizeof(header));
+    header.magic = FLAT_MAGIC;
+    header.version = FLAT_VERSION;
+    header.oclVersion = oclVersion;
+    header.kernelNum = writer.kernels.size();
+    header.relocNum = (flat || relocTable) ? getGlobalRelocCount() : 0;
+    header.constantSize = (flat || constantSet) ? getGlobalConstantSize() : 0;
+    header.stringSize = writer.strings.size();
+
+    uint32_t offset = sizeof(FlatProgram);
+    header.kernelOffset = offset;
+    offset += writer.kernels.size() * sizeof(FlatKernel);
+    const uint32_t argBase = offset;
+    offset += writer.args.size() * sizeof(FlatArgument);
+    const uint32_t patchBase = offset = ALIGN(offset, sizeof(PatchInfo));
+    offset += writer.patches.size() * sizeof(PatchInfo);
+    const uint32_t samplerBase = offset;
+    offset += writer.samplers.size() * sizeof(uint32_t);
+    const uint32_t imageBase = offset;
+    offset += writer.images.size() * sizeof(ImageInfo);
+    header.relocOffset = offset;
+    offset += header.relocNum * sizeof(ir::RelocEntry);
+    header.stringOffset = offset;
+    offset += header.stringSize;
+    header.constantOffset = offset = ALIGN(offset, sizeof(uint64_t));
+    offset += header.constantSize;
+    const uint32_t codeBase = ALIGN(offset, FLAT_CODE_ALIGN);
+    header.size = codeBase + writer.code.size();
+
+    for (auto &record : writer.kernels) {
+      record.name += header.stringOffset;
+      record.functionAttributes += header.stringOffset;
+      record.argOffset += argBase;
+      record.patchOffset += patchBase;
+      record.samplerOffset += samplerBase;
+      record.imageOffset += imageBase;
+      record.codeOffset += codeBase;
+    }
+    for (auto &arg : writer.args) {
+      arg.typeName += header.stringOffset;
+      arg.accessQual += header.stringOffset;
+      arg.typeQual += header.stringOffset;
+      arg.argName += header.stringOffset;
+    }
+
+    bin.assign(header.size, '\0');
+    char *data = &bin[0];
+    memcpy(data, &header, sizeof(header));
+    if (!writer.kernels.empty())
+      memcpy(data + header.kernelOffset, writer.kernels.data(), writer.kernels.size() * sizeof(FlatKernel));
+    if (!writer.args.empty())
+      memcpy(data + argBase, writer.args.data(), writer.args.size() * sizeof(FlatArgument));
+    if (!writer.patches.empty())
+      memcpy(data + patchBase, writer.patches.data(), writer.patches.size() * sizeof(PatchInfo));
+    if (!writer.samplers.empty())
+      memcpy(data + samplerBase, writer.samplers.data(), writer.samplers.size() * sizeof(uint32_t));
+    if (!writer.images.empty())
+      memcpy(data + imageBase, writer.images.data(), writer.images.size() * sizeof(ImageInfo));
+    if (header.relocNum)
+      getGlobalRelocTable(data + header.relocOffset);
+    memcpy(data + header.stringOffset, writer.strings.data(), header.stringSize);
+    if (header.constantSize)
+      getGlobalConstantData(data + header.constantOffset);
+    memcpy(data + codeBase, writer.code.data(), writer.code.size());
+    return header.size;
+  }
+
+  bool Program::isFlatBin(const char *bin, size_t size) {
+    if (size < sizeof(FlatProgram))
+      return false;
+    const FlatProgram *header = (const FlatProgram *)bin;
+    return header->magic == FLAT_MAGIC && header->version == FLAT_VERSION && header->size <= size;
+  }
+
+  bool Program::deserializeFromFlatBin(const char *bin, size_t size, bool owned) {
+    if (owned)
+      flatStorage = (char *)bin;
+    if (((uintptr_t)bin % sizeof(uint64_t)) != 0 || !isFlatBin(bin, size))
+      return false;
+
+    const FlatProgram *header = (const FlatProgram *)bin;
+    if (!flatFits(header->size, header->kernelOffset, header->kernelNum, sizeof(FlatKernel), sizeof(uint32_t)) ||
+        !flatFits(header->size, header->relocOffset, header->relocNum, sizeof(ir::RelocEntry), sizeof(uint32_t)) ||
+        !flatFits(header->size, header->constantOffset, header->constantSize, 1, 1) ||
+        !flatFits(header->size, header->stringOffset, header->stringSize, 1, 1) ||
+        (header->stringSize != 0 && bin[header->stringOffset + header->stringSize - 1] != '\0'))
+      return false;
+
+    flat = header;
+    oclVersion = header->oclVersion;
+    const FlatKernel *records = (const FlatKernel *)(bin + header->kernelOffset);
+    for (uint32_t i = 0; i < header->kernelNum; i++) {
+      if (!flatIsString(*header, records[i].name))
+        return false;
+      Kernel *ker = allocateKernel(bin + records[i].name);
+      if (!ker->deserializeFromFlat(*header, records[i])) {
+        GBE_DELETE(ker);
+        return false;
+      }
+      // The records are sorted by name
+      kernels.insert(kernels.end(), std::make_pair(ker->getName(), ker));
+    }
+    return true;
+  }
+
   void Program::printStatus(int indent, std::ostream& outs) {
     using namespace std;
     string spaces = indent_to_str(indent);
@@ -552,7 +903,10 @@ namespace gbe {
     }
 
     for (map<std::string, Kernel*>::iterator it = kernels.begin(); it != kernels.end(); ++it) {
-      it->second->printStatus(indent + 4, outs);
+      if (it->second)
+        it->second->printStatus(indent + 4, outs);
+      else
+        outs << indent_to_str(indent + 4) << "Kernel Name: " << it->first << " (not compiled)\n";
     }
 
     outs << spaces << "================ End Program ================" << "\n";
@@ -570,24 +924,26 @@ namespace gbe {
     outs << spaces_nl << "  simdWidth: " << simdWidth << "\n";
     outs << spaces_nl << "  stackSize: " << stackSize << "\n";
     outs << spaces_nl << "  scratchSize: " << scratchSize << "\n";
+    outs << spaces_nl << "  grfSize: " << grfSize << "\n";
     outs << spaces_nl << "  useSLM: " << useSLM << "\n";
     outs << spaces_nl << "  slmSize: " << slmSize << "\n";
     outs << spaces_nl << "  compileWgSize: " << compileWgSize[0] << compileWgSize[1] << compileWgSize[2] << "\n";
 
     outs << spaces_nl << "  Argument Number is " << argNum << "\n";
     for (uint32_t i = 0; i < argNum; i++) {
-      KernelArgument& arg = args[i];
       outs << spaces_nl << "  Arg " << i << ":\n";
-      outs << spaces_nl << "      type value: "<< arg.type << "\n";
-      outs << spaces_nl << "      size: "<< arg.size << "\n";
-      outs << spaces_nl << "      align: "<< arg.align << "\n";
-      outs << spaces_nl << "      bti: "<< arg.bti << "\n";
+      outs << spaces_nl << "      type value: "<< getArgType(i) << "\n";
+      outs << spaces_nl << "      size: "<< getArgSize(i) << "\n";
+      outs << spaces_nl << "      align: "<< getArgAlign(i) << "\n";
+      outs << spaces_nl << "      bti: "<< getArgBTI(i) << "\n";
     }
 
-    outs << spaces_nl << "  Patches Number is " << patches.size() << "\n";
+    const PatchInfo *patchData = flat ? (const PatchInfo *)(flatBase + flat->patchOffset) : patches.data();
+    const size_t patchNum = flat ? flat->patchNum : patches.size();
+    outs << spaces_nl << "  Patches Number is " << patchNum << "\n";
     num = 0;
-    for (size_t i = 0; i < patches.size(); ++i) {
-      PatchInfo& patch = patches[i];
+    for (size_t i = 0; i < patchNum; ++i) {
+      const PatchInfo& patch = patchData[i];
       num++;
       outs << spaces_nl << "  patch " << num << ":\n";
       outs << spaces_nl << "      type value: "<< patch.type << "\n";
@@ -816,6 +1172,151 @@ namespace gbe {
   SVAR(OCL_PCH_20_PATH, OCL_PCH_OBJECT_20);
   SVAR(OCL_HEADER_FILE_DIR, OCL_HEADER_DIR);
   BVAR(OCL_OUTPUT_KERNEL_SOURCE, false);
+  BVAR(OCL_PCH_CACHE, true);
+  SVAR(OCL_PCH_CACHE_DIR, "");
+
+  /*! Directory of the PCH built for the options the installed one does not
+   *  fit. Empty if there is none */
+  static std::string getPCHCacheDir(void) {
+    if (OCL_PCH_CACHE_DIR != "")
+      return OCL_PCH_CACHE_DIR;
+    const char *xdgCache = getenv("XDG_CACHE_HOME");
+    if (xdgCache && xdgCache[0] == '/')
+      return std::string(xdgCache) + "/beignet";
+    const char *home = getenv("HOME");
+    if (home && home[0] == '/')
+      return std::string(home) + "/.cache/beignet";
+    return "";
+  }
+
+  /*! mkdir -p */
+  static bool makeDirectories(const std::string &dir) {
+    for (size_t pos = 1; pos != std::string::npos; pos++) {
+      pos = dir.find('/', pos);
+      const std::string parent = dir.substr(0, pos);
+      if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST)
+        return false;
+      if (pos == std::string::npos)
+        break;
+    }
+    return true;
+  }
+
+  /*! Build the PCH of ocl.h for the given options, like libocl does for
+   *  the installed one */
+  static bool generatePCH(const std::string &headerDir, const std::vector<std::string> &options,
+                          uint32_t oclVersion, const std::string &pchFile) {
+    const std::string oclDotH = headerDir + "/ocl.h";
+    vector<const char *> args;
+    for (auto &option : options)
+      args.push_back(option.c_str());
+    args.push_back("-fno-builtin");
+    args.push_back("-ffp-contract=off");
+    args.push_back("-cl-kernel-arg-info");
+#ifdef GEN7_SAMPLER_CLAMP_BORDER_WORKAROUND
+    args.push_back("-DGEN7_SAMPLER_CLAMP_BORDER_WORKAROUND");
+#endif
+    args.push_back("-triple");
+    if (oclVersion >= 200) {
+      args.push_back("spir64");
+      args.push_back("-fblocks");
+    } else
+      args.push_back("spir");
+    args.push_back("-I");
+    args.push_back(headerDir.c_str());
+    args.push_back("-emit-pch");
+    args.push_back("-x");
+    args.push_back("cl");
+    args.push_back(oclDotH.c_str());
+    args.push_back("-o");
+    args.push_back(pchFile.c_str());
+
+    std::string ErrorString;
+    llvm::raw_string_ostream ErrorInfo(ErrorString);
+    llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> DiagOpts = new clang::DiagnosticOptions();
+    clang::TextDiagnosticPrinter *DiagClient = new clang::TextDiagnosticPrinter(ErrorInfo, &*DiagOpts);
+    llvm::IntrusiveRefCntPtr<clang::DiagnosticIDs> DiagID(new clang::DiagnosticIDs());
+    clang::DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagClient);
+
+#if LLVM_VERSION_MAJOR * 10 + LLVM_VERSION_MINOR >= 40
+    auto CI = std::make_shared<clang::CompilerInvocation>();
+#else
+    std::unique_ptr<clang::CompilerInvocation> CI(new clang::CompilerInvocation);
+#endif
+#if LLVM_VERSION_MAJOR >= 10
+    clang::CompilerInvocation::CreateFromArgs(*CI, clang::ArrayRef<const char*>(args), Diags);
+#else
+    clang::CompilerInvocation::CreateFromArgs(*CI, &args[0], &args[0] + args.size(), Diags);
+#endif
+    clang::CompilerInstance Clang;
+#if LLVM_VERSION_MAJOR * 10 + LLVM_VERSION_MINOR >= 40
+    Clang.setInvocation(std::move(CI));
+#else
+    Clang.setInvocation(CI.release());
+#endif
+    Clang.createDiagnostics(DiagClient, false);
+    if (!Clang.hasDiagnostics())
+      return false;
+    Clang.getLangOpts().OpenCL = 1;
+
+    clang::GeneratePCHAction Act;
+    const bool ok = Clang.ExecuteAction(Act) && !Clang.getDiagnostics().hasErrorOccurred();
+    if (!ok && OCL_OUTPUT_BUILD_LOG)
+      llvm::errs() << "Failed to build the PCH " << pchFile << ":\n" << ErrorInfo.str();
+    return ok;
+  }
+
+  /*! Find, or build on first use, the PCH for a set of options the
+   *  installed PCH does not fit. The PCH are kept in the cache directory,
+   *  named after a hash of the options and of the headers */
+  static bool getCachedPCH(const std::string &headerDir, std::vector<std::string> options,
+                           uint32_t oclVersion, std::string &pchFile) {
+    static std::mutex pchCacheMutex;
+    const std::string cacheDir = getPCHCacheDir();
+    if (!OCL_PCH_CACHE || cacheDir == "")
+      return false;
+
+    std::sort(options.begin(), options.end());
+    options.erase(std::unique(options.begin(), options.end()), options.end());
+
+    // A new beignet comes with new headers, so they are part of the key
+    struct stat headerStat;
+    const std::string oclDotH = headerDir + "/ocl.h";
+    if (stat(oclDotH.c_str(), &headerStat) != 0)
+      return false;
+    std::ostringstream key;
+    key << LLVM_VERSION_MAJOR << "." << LLVM_VERSION_MINOR << ";" << oclVersion << ";" << oclDotH
+        << ";" << (uint64_t)headerStat.st_mtime << ";" << (uint64_t)headerStat.st_size;
+    for (auto &option : options)
+      key << ";" << option;
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : key.str()) {
+      hash ^= (uint8_t)c;
+      hash *= 1099511628211ull;
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "/ocl-%u-%016llx.pch", oclVersion, (unsigned long long)hash);
+    pchFile = cacheDir + name;
+
+    std::lock_guard<std::mutex> lock(pchCacheMutex);
+    if (access(pchFile.c_str(), R_OK) == 0)
+      return true;
+    if (!makeDirectories(cacheDir))
+      return false;
+
+    // Built aside and renamed, other processes only see complete files
+    std::string tmpFile = pchFile + ".XXXXXX";
+    const int fd = mkstemp(&tmpFile[0]);
+    if (fd < 0)
+      return false;
+    close(fd);
+    if (!generatePCH(headerDir, options, oclVersion, tmpFile) ||
+        rename(tmpFile.c_str(), pchFile.c_str()) != 0) {
+      unlink(tmpFile.c_str());
+      return false;
+    }
+    return true;
+  }
 
   static bool processSourceAndOption(const char *source,
                                      const char *options,
@@ -840,6 +1341,7 @@ namespace gbe {
     bool invalidPCH = false;
 #endif
     size_t start = 0, end = 0;
+    std::vector<std::string> pchOptions; // The options the installed PCH does not fit
 
     std::string hdirs = OCL_HEADER_FILE_DIR;
     if(hdirs == "")
@@ -970,12 +1472,15 @@ EXTEND_QUOTE:
           }
         }
 
-        if (uncompatiblePCHOptions.find(str) != std::string::npos)
+        if (uncompatiblePCHOptions.find(str) != std::string::npos) {
           invalidPCH = true;
+          pchOptions.push_back(str);
+        }
 
         if (fastMathOption.find(str) != std::string::npos) {
           clOpt.push_back("-D");
           clOpt.push_back("__FAST_RELAXED_MATH__=1");
+          pchOptions.push_back("-D__FAST_RELAXED_MATH__=1");
         }
 
         if(str.find("-dump-opt-llvm=") != std::string::npos) {
@@ -988,6 +1493,9 @@ EXTEND_QUOTE:
           continue; // Don't push this str back; ignore it.
         }
 
+        if(str == "-cl-medium-precision-math")
+          continue; // Handled by the backend; clang does not know it.
+
         if(str.find("-dump-spir-binary=") != std::string::npos) {
           dumpSPIRBinaryName = str.substr(str.find("=") + 1);
           continue; // Don't push this str back; ignore it.
@@ -1046,6 +1554,18 @@ EXTEND_QUOTE:
       }
     }
 
+#if !defined(__ANDROID__)
+    if (invalidPCH && !pchOptions.empty()) {
+      std::vector<std::string> options(pchOptions);
+      options.push_back("-cl-std=" + std::string(oclVersion >= 200 ? "CL2.0" : oclVersion >= 120 ? "CL1.2" : "CL1.1"));
+      options.push_back("-D__OPENCL_C_VERSION__=" + std::to_string(oclVersion));
+      if (getCachedPCH(headerFilePath, options, oclVersion, pchFileName)) {
+        findPCH = true;
+        invalidPCH = false;
+      }
+    }
+#endif
+
     if (!findPCH || invalidPCH) {
       clOpt.push_back("-include");
       clOpt.push_back("ocl.h");
@@ -1255,6 +1775,10 @@ EXTEND_QUOTE:
       if(pos != std::string::npos) {
         s.erase(pos, strlen("-dump-opt-asm"));
       }
+      pos = s.find("-cl-medium-precision-math");
+      if(pos != std::string::npos) {
+        s.erase(pos, strlen("-cl-medium-precision-math"));
+      }
       args.push_back(s.c_str());
 
       // The compiler invocation needs a DiagnosticsEngine so it can report problems
@@ -1324,16 +1848,28 @@ EXTEND_QUOTE:
 
   static gbe_kernel programGetKernelByName(gbe_program gbeProgram, const char *name) {
     if (gbeProgram == nullptr) return nullptr;
-    const gbe::Program *program = (gbe::Program*) gbeProgram;
+    gbe::Program *program = (gbe::Program*) gbeProgram;
     return (gbe_kernel) program->getKernel(std::string(name));
   }
 
   static gbe_kernel programGetKernel(const gbe_program gbeProgram, uint32_t ID) {
     if (gbeProgram == nullptr) return nullptr;
-    const gbe::Program *program = (gbe::Program*) gbeProgram;
+    gbe::Program *program = (gbe::Program*) gbeProgram;
     return (gbe_kernel) program->getKernel(ID);
   }
 
+  static const char *programGetKernelName(gbe_program gbeProgram, uint32_t ID) {
+    if (gbeProgram == nullptr) return nullptr;
+    const gbe::Program *program = (const gbe::Program*) gbeProgram;
+    return program->getKernelName(ID);
+  }
+
+  static uint32_t programGetOclVersion(gbe_program gbeProgram) {
+    if (gbeProgram == nullptr) return 0;
+    const gbe::Program *program = (const gbe::Program*) gbeProgram;
+    return program->getOclVersion();
+  }
+
   static const char *kernelGetName(gbe_kernel genKernel) {
     if (genKernel == nullptr) return nullptr;
     const gbe::Kernel *kernel = (const gbe::Kernel*) genKernel;
@@ -1367,21 +1903,40 @@ EXTEND_QUOTE:
   static void *kernelGetArgInfo(gbe_kernel genKernel, uint32_t argID, uint32_t value) {
     if (genKernel == nullptr) return nullptr;
     const gbe::Kernel *kernel = (const gbe::Kernel*) genKernel;
-    KernelArgument::ArgInfo* info = kernel->getArgInfo(argID);
+    uint32_t addrSpace, typeSize;
+    const char *typeName, *accessQual, *typeQual, *argName;
+
+    if (kernel->isFlat()) {
+      const FlatArgument *arg = kernel->getFlatArg(argID);
+      addrSpace = arg->addrSpace;
+      typeSize = arg->typeSize;
+      typeName = kernel->getFlatString(arg->typeName);
+      accessQual = kernel->getFlatString(arg->accessQual);
+      typeQual = kernel->getFlatString(arg->typeQual);
+      argName = kernel->getFlatString(arg->argName);
+    } else {
+      KernelArgument::ArgInfo* info = kernel->getArgInfo(argID);
+      addrSpace = info->addrSpace;
+      typeSize = info->typeSize;
+      typeName = info->typeName.c_str();
+      accessQual = info->accessQual.c_str();
+      typeQual = info->typeQual.c_str();
+      argName = info->argName.c_str();
+    }
 
     switch (value) {
       case GBE_GET_ARG_INFO_ADDRSPACE:
-        return (void*)((unsigned long)info->addrSpace);
+        return (void*)((unsigned long)addrSpace);
       case GBE_GET_ARG_INFO_TYPE:
-        return (void *)(info->typeName.c_str());
+        return (void *)typeName;
       case GBE_GET_ARG_INFO_ACCESS:
-        return (void *)(info->accessQual.c_str());
+        return (void *)accessQual;
       case GBE_GET_ARG_INFO_TYPEQUAL:
-        return (void *)(info->typeQual.c_str());
+        return (void *)typeQual;
       case GBE_GET_ARG_INFO_NAME:
-        return (void *)(info->argName.c_str());
+        return (void *)argName;
       case GBE_GET_ARG_INFO_TYPESIZE:
-        return (void *)((size_t)info->typeSize);
+        return (void *)((size_t)typeSize);
       default:
         assert(0);
     }
@@ -1442,6 +1997,12 @@ EXTEND_QUOTE:
     return kernel->getScratchSize();
   }
 
+  static uint32_t kernelGetGRFSize(gbe_kernel genKernel) {
+    if (genKernel == nullptr) return 0;
+    const gbe::Kernel *kernel = (const gbe::Kernel*) genKernel;
+    return kernel->getGRFSize();
+  }
+
   static int32_t kernelUseSLM(gbe_kernel genKernel) {
     if (genKernel == nullptr) return 0;
     const gbe::Kernel *kernel = (const gbe::Kernel*) genKernel;
@@ -1511,11 +2072,11 @@ EXTEND_QUOTE:
     delete ps;
   }
 
-  static void kernelOutputPrintf(void * printf_info, void* buf_addr)
+  static void kernelOutputPrintf(void * printf_info, const void* log, FILE* out)
   {
     if (printf_info == nullptr) return;
     ir::PrintfSet *ps = (ir::PrintfSet *)printf_info;
-    ps->outputPrintf(buf_addr);
+    ps->outputPrintf(log, out);
   }
 
   static void kernelGetCompileWorkGroupSize(gbe_kernel gbeKernel, size_t wg_size[3]) {
@@ -1564,6 +2125,7 @@ GBE_EXPORT_SYMBOL gbe_program_compile_from_source_cb *gbe_program_compile_from_s
 GBE_EXPORT_SYMBOL gbe_program_link_program_cb *gbe_program_link_program = nullptr;
 GBE_EXPORT_SYMBOL gbe_program_check_opt_cb *gbe_program_check_opt = nullptr;
 GBE_EXPORT_SYMBOL gbe_program_new_from_binary_cb *gbe_program_new_from_binary = nullptr;
+GBE_EXPORT_SYMBOL gbe_program_new_from_mapped_binary_cb *gbe_program_new_from_mapped_binary = nullptr;
 GBE_EXPORT_SYMBOL gbe_program_new_from_llvm_binary_cb *gbe_program_new_from_llvm_binary = nullptr;
 GBE_EXPORT_SYMBOL gbe_program_serialize_to_binary_cb *gbe_program_serialize_to_binary = nullptr;
 GBE_EXPORT_SYMBOL gbe_program_new_from_llvm_cb *gbe_program_new_from_llvm = nullptr;
@@ -1579,6 +2141,8 @@ GBE_EXPORT_SYMBOL gbe_program_delete_cb *gbe_program_delete = nullptr;
 GBE_EXPORT_SYMBOL gbe_program_get_kernel_num_cb *gbe_program_get_kernel_num = nullptr;
 GBE_EXPORT_SYMBOL gbe_program_get_kernel_by_name_cb *gbe_program_get_kernel_by_name = nullptr;
 GBE_EXPORT_SYMBOL gbe_program_get_kernel_cb *gbe_program_get_kernel = nullptr;
+GBE_EXPORT_SYMBOL gbe_program_get_kernel_name_cb *gbe_program_get_kernel_name = nullptr;
+GBE_EXPORT_SYMBOL gbe_program_get_ocl_version_cb *gbe_program_get_ocl_version = nullptr;
 GBE_EXPORT_SYMBOL gbe_program_get_device_enqueue_kernel_name_cb *gbe_program_get_device_enqueue_kernel_name = nullptr;
 GBE_EXPORT_SYMBOL gbe_kernel_get_name_cb *gbe_kernel_get_name = nullptr;
 GBE_EXPORT_SYMBOL gbe_kernel_get_attributes_cb *gbe_kernel_get_attributes = nullptr;
@@ -1595,6 +2159,7 @@ GBE_EXPORT_SYMBOL gbe_kernel_get_curbe_offset_cb *gbe_kernel_get_curbe_offset =
 GBE_EXPORT_SYMBOL gbe_kernel_get_curbe_size_cb *gbe_kernel_get_curbe_size = nullptr;
 GBE_EXPORT_SYMBOL gbe_kernel_get_stack_size_cb *gbe_kernel_get_stack_size = nullptr;
 GBE_EXPORT_SYMBOL gbe_kernel_get_scratch_size_cb *gbe_kernel_get_scratch_size = nullptr;
+GBE_EXPORT_SYMBOL gbe_kernel_get_grf_size_cb *gbe_kernel_get_grf_size = nullptr;
 GBE_EXPORT_SYMBOL gbe_kernel_get_required_work_group_size_cb *gbe_kernel_get_required_work_group_size = nullptr;
 GBE_EXPORT_SYMBOL gbe_kernel_use_slm_cb *gbe_kernel_use_slm = nullptr;
 GBE_EXPORT_SYMBOL gbe_kernel_get_slm_size_cb *gbe_kernel_get_slm_size = nullptr;
@@ -1636,6 +2201,8 @@ namespace gbe
       gbe_program_get_device_enqueue_kernel_name = gbe::programGetDeviceEnqueueKernelName;
       gbe_program_get_kernel_by_name = gbe::programGetKernelByName;
       gbe_program_get_kernel = gbe::programGetKernel;
+      gbe_program_get_kernel_name = gbe::programGetKernelName;
+      gbe_program_get_ocl_version = gbe::programGetOclVersion;
       gbe_kernel_get_name = gbe::kernelGetName;
       gbe_kernel_get_attributes = gbe::kernelGetAttributes;
       gbe_kernel_get_code = gbe::kernelGetCode;
@@ -1651,6 +2218,7 @@ namespace gbe
       gbe_kernel_get_curbe_size = gbe::kernelGetCurbeSize;
       gbe_kernel_get_stack_size = gbe::kernelGetStackSize;
       gbe_kernel_get_scratch_size = gbe::kernelGetScratchSize;
+      gbe_kernel_get_grf_size = gbe::kernelGetGRFSize;
       gbe_kernel_get_required_work_group_size = gbe::kernelGetRequiredWorkGroupSize;
       gbe_kernel_use_slm = gbe::kernelUseSLM;
       gbe_kernel_get_slm_size = gbe::kernelGetSLMSize;
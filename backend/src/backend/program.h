@@ -31,6 +31,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -177,7 +178,19 @@ extern gbe_release_printf_info_cb *gbe_release_printf_info;
 typedef void* (gbe_dup_printfset_cb)(gbe_kernel gbeKernel);
 extern gbe_dup_printfset_cb *gbe_dup_printfset;
 
-typedef void (gbe_output_printf_cb) (void* printf_info, void* buf_addr);
+/*! Layout of the printf buffer: a header of GBE_PRINTF_BUF_HEADER_SIZE
+ *  bytes, dword 0 counts the bytes the kernel reserved so far and dword 1
+ *  is the mask applied to that count to get the offset of a record in the
+ *  data area following the header (all ones unless the buffer is a ring).
+ *  A record is {GBE_PRINTF_LOG_MAGIC, size, statement}, the arguments and
+ *  GBE_PRINTF_LOG_END, which is written last. */
+#define GBE_PRINTF_BUF_HEADER_SIZE 16
+#define GBE_PRINTF_LOG_MAGIC 0xAABBCCDD
+#define GBE_PRINTF_LOG_END 0xDDCCBBAA
+#define GBE_PRINTF_LOG_MAX_SIZE (0xffff + 16)
+
+/*! Format one printf record (starting with its magic) to out */
+typedef void (gbe_output_printf_cb) (void* printf_info, const void* log, FILE* out);
 extern gbe_output_printf_cb* gbe_output_printf;
 
 
@@ -230,6 +243,11 @@ extern gbe_program_new_gen_program_cb *gbe_program_new_gen_program;
 typedef gbe_program (gbe_program_new_from_binary_cb)(uint32_t deviceID, const char *binary, size_t size);
 extern gbe_program_new_from_binary_cb *gbe_program_new_from_binary;
 
+/*! Like gbe_program_new_from_binary, but a flat binary is used in place: it
+ *  must stay valid until the program is deleted */
+typedef gbe_program (gbe_program_new_from_mapped_binary_cb)(uint32_t deviceID, const char *binary, size_t size);
+extern gbe_program_new_from_mapped_binary_cb *gbe_program_new_from_mapped_binary;
+
 /*! Create a new program from the llvm bitcode*/
 typedef gbe_program (gbe_program_new_from_llvm_binary_cb)(uint32_t deviceID, const char *binary, size_t size);
 extern gbe_program_new_from_llvm_binary_cb *gbe_program_new_from_llvm_binary;
@@ -306,10 +324,19 @@ extern gbe_program_get_kernel_num_cb *gbe_program_get_kernel_num;
 typedef gbe_kernel (gbe_program_get_kernel_by_name_cb)(gbe_program, const char *name);
 extern gbe_program_get_kernel_by_name_cb *gbe_program_get_kernel_by_name;
 
-/*! Get the kernel from its ID */
+/*! Get the kernel from its ID. With OCL_LAZY_KERNEL_COMPILE, this is where
+ *  the kernel gets compiled. Returns NULL if the compilation fails */
 typedef gbe_kernel (gbe_program_get_kernel_cb)(gbe_program, uint32_t ID);
 extern gbe_program_get_kernel_cb *gbe_program_get_kernel;
 
+/*! Get the name of a kernel from its ID, without compiling it */
+typedef const char* (gbe_program_get_kernel_name_cb)(gbe_program, uint32_t ID);
+extern gbe_program_get_kernel_name_cb *gbe_program_get_kernel_name;
+
+/*! Get the OpenCL version the program was built for (120, 200) */
+typedef uint32_t (gbe_program_get_ocl_version_cb)(gbe_program);
+extern gbe_program_get_ocl_version_cb *gbe_program_get_ocl_version;
+
 typedef const char* (gbe_program_get_device_enqueue_kernel_name_cb)(gbe_program, uint32_t ID);
 extern gbe_program_get_device_enqueue_kernel_name_cb *gbe_program_get_device_enqueue_kernel_name;
 
@@ -369,6 +396,10 @@ extern gbe_kernel_get_stack_size_cb *gbe_kernel_get_stack_size;
 typedef int32_t (gbe_kernel_get_scratch_size_cb)(gbe_kernel);
 extern gbe_kernel_get_scratch_size_cb *gbe_kernel_get_scratch_size;
 
+/*! Get the peak register file size allocated by the kernel, in bytes */
+typedef uint32_t (gbe_kernel_get_grf_size_cb)(gbe_kernel);
+extern gbe_kernel_get_grf_size_cb *gbe_kernel_get_grf_size;
+
 /*! Get the curbe offset where to put the data. Returns -1 if not required */
 typedef int32_t (gbe_kernel_get_curbe_offset_cb)(gbe_kernel, enum gbe_curbe_type type, uint32_t sub_type);
 extern gbe_kernel_get_curbe_offset_cb *gbe_kernel_get_curbe_offset;
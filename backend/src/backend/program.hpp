@@ -34,6 +34,8 @@
 #include "ir/sampler.hpp"
 #include "sys/vector.hpp"
 #include <string>
+#include <mutex>
+#include <iterator>
 
 namespace gbe {
 namespace ir {
@@ -78,6 +80,82 @@ namespace gbe {
     return i0.subType < i1.subType;
   }
 
+  /* Flat binary format. Unlike the serialized stream, every record has a
+   * fixed size and a natural alignment, and refers to the other ones by an
+   * offset from the start of the FlatProgram. A loaded (or mmap'd) flat
+   * binary is then used in place: the kernels point to their records, and
+   * the instruction streams are never copied.
+   *
+   *   FlatProgram         |
+   *   FlatKernel[n]       | sorted by name
+   *   FlatArgument[]      |
+   *   PatchInfo[]         | sorted, searched in place
+   *   sampler values      |
+   *   ImageInfo[]         |
+   *   RelocEntry[]        |
+   *   strings             | zero terminated
+   *   constant data       |
+   *   code                | FLAT_CODE_ALIGN aligned
+   */
+  static const uint32_t FLAT_MAGIC = TO_MAGIC('F', 'P', 'R', 'G');
+  static const uint32_t FLAT_VERSION = 1;
+  static const uint32_t FLAT_CODE_ALIGN = 64;
+
+  struct FlatProgram {
+    uint32_t magic;          //!< FLAT_MAGIC
+    uint32_t version;        //!< FLAT_VERSION
+    uint32_t size;           //!< Bytes of the whole flat binary
+    uint32_t oclVersion;
+    uint32_t kernelNum;
+    uint32_t kernelOffset;   //!< FlatKernel array
+    uint32_t relocNum;
+    uint32_t relocOffset;
+    uint32_t constantSize;
+    uint32_t constantOffset;
+    uint32_t stringSize;     //!< The strings end with the section
+    uint32_t stringOffset;
+  };
+
+  struct FlatKernel {
+    uint32_t name;           //!< String offset
+    uint32_t functionAttributes;
+    uint32_t oclVersion;
+    uint32_t argNum;
+    uint32_t argOffset;      //!< FlatArgument array
+    uint32_t patchNum;
+    uint32_t patchOffset;    //!< PatchInfo array
+    uint32_t samplerNum;
+    uint32_t samplerOffset;  //!< Sampler values, by slot
+    uint32_t imageNum;
+    uint32_t imageOffset;    //!< ImageInfo array
+    uint32_t codeSize;
+    uint32_t codeOffset;
+    uint32_t curbeSize;
+    uint32_t simdWidth;
+    uint32_t stackSize;
+    uint32_t scratchSize;
+    uint32_t grfSize;
+    uint32_t slmSize;
+    uint32_t useSLM;
+    uint32_t useDeviceEnqueue;
+    uint32_t compileWgSize[3];
+  };
+
+  struct FlatArgument {
+    uint32_t type;
+    uint32_t size;
+    uint32_t align;
+    uint32_t bti;
+    uint32_t addrSpace;
+    uint32_t typeSize;
+    uint32_t typeName;       //!< String offsets
+    uint32_t accessQual;
+    uint32_t typeQual;
+    uint32_t argName;
+  };
+
+  class FlatWriter; // Gathers the sections of a flat binary
+
   /*! Describe a compiled kernel */
   class Kernel : public NonCopyable, public Serializable
   {
@@ -90,6 +168,8 @@ namespace gbe {
     virtual const char *getCode(void) const = 0;
     /*! Set the instruction stream.*/
     virtual void setCode(const char *, size_t size) = 0;
+    /*! Use an instruction stream the kernel does not own (flat binaries) */
+    virtual void referCode(const char *, size_t size) = 0;
     /*! Return the instruction stream size (to be implemented) */
     virtual uint32_t getCodeSize(void) const = 0;
     /*! Get the kernel name */
@@ -98,20 +178,32 @@ namespace gbe {
     INLINE uint32_t getArgNum(void) const { return argNum; }
     /*! Return the size of the given argument */
     INLINE uint32_t getArgSize(uint32_t argID) const {
-      return argID >= argNum ? 0u : args[argID].size;
+      if (argID >= argNum) return 0u;
+      return flat ? getFlatArg(argID)->size : args[argID].size;
     }
     /*! Return the bti for __global buffer */
     INLINE uint8_t getArgBTI(uint32_t argID) const {
-      return argID >= argNum ? 0u : args[argID].bti;
+      if (argID >= argNum) return 0u;
+      return flat ? getFlatArg(argID)->bti : args[argID].bti;
     }
     /*! Return the alignment of buffer argument */
     INLINE uint32_t getArgAlign(uint32_t argID) const {
-      return argID >= argNum ? 0u : args[argID].align;
+      if (argID >= argNum) return 0u;
+      return flat ? getFlatArg(argID)->align : args[argID].align;
     }
     /*! Return the type of the given argument */
     INLINE gbe_arg_type getArgType(uint32_t argID) const {
-      return argID >= argNum ? GBE_ARG_INVALID : args[argID].type;
+      if (argID >= argNum) return GBE_ARG_INVALID;
+      return flat ? gbe_arg_type(getFlatArg(argID)->type) : args[argID].type;
+    }
+    /*! Record of the given argument when loaded from a flat binary */
+    INLINE const FlatArgument *getFlatArg(uint32_t argID) const {
+      return (const FlatArgument *)(flatBase + flat->argOffset) + argID;
     }
+    /*! String of a flat binary */
+    INLINE const char *getFlatString(uint32_t offset) const { return flatBase + offset; }
+    /*! Says if the kernel refers to a flat binary */
+    INLINE bool isFlat(void) const { return flat != NULL; }
     /*! Get the offset where to patch. Returns -1 if no patch needed */
     int32_t getCurbeOffset(gbe_curbe_type type, uint32_t subType) const;
     /*! Get the curbe size required by the kernel */
@@ -120,6 +212,8 @@ namespace gbe {
     INLINE uint32_t getStackSize(void) const { return this->stackSize; }
     /*! Return the size of the scratch memory needed (zero if none) */
     INLINE uint32_t getScratchSize(void) const { return this->scratchSize; }
+    /*! Return the peak size of the register file allocated by the kernel */
+    INLINE uint32_t getGRFSize(void) const { return this->grfSize; }
     /*! Get the SIMD width for the kernel */
     INLINE uint32_t getSIMDWidth(void) const { return this->simdWidth; }
     /*! Says if SLM is needed for it */
@@ -134,9 +228,17 @@ namespace gbe {
       samplerSet = from;
     }
     /*! Get defined sampler size */
-    size_t getSamplerSize(void) const { return (samplerSet == NULL ? 0 : samplerSet->getDataSize()); }
+    size_t getSamplerSize(void) const {
+      if (flat) return flat->samplerNum;
+      return (samplerSet == NULL ? 0 : samplerSet->getDataSize());
+    }
     /*! Get defined sampler value array */
-    void getSamplerData(uint32_t *samplers) const { samplerSet->getData(samplers); }
+    void getSamplerData(uint32_t *samplers) const {
+      if (flat)
+        memcpy(samplers, flatBase + flat->samplerOffset, flat->samplerNum * sizeof(uint32_t));
+      else
+        samplerSet->getData(samplers);
+    }
     /*! Set image set. */
     void setImageSet(ir::ImageSet * from) {
       imageSet = from;
@@ -162,7 +264,10 @@ namespace gbe {
     }
 
     void * dupPrintfSet() const {
-      void* ptr = printfSet ? (void *)(new ir::PrintfSet(*printfSet)) : NULL;
+      /* Nothing to keep around for the launch if the kernel has no printf */
+      if (printfSet == NULL || printfSet->getPrintfNum() == 0)
+        return NULL;
+      void* ptr = (void *)(new ir::PrintfSet(*printfSet));
       return ptr;
     }
     uint8_t getPrintfBufBTI() const {
@@ -197,12 +302,22 @@ namespace gbe {
     /*! Set function attributes string. */
     void setFunctionAttributes(const std::string& functionAttributes) {  this->functionAttributes= functionAttributes; }
     /*! Get function attributes string. */
-    const char* getFunctionAttributes(void) const {return this->functionAttributes.c_str();}
+    const char* getFunctionAttributes(void) const {
+      return flat ? flatBase + flat->functionAttributes : this->functionAttributes.c_str();
+    }
 
     /*! Get defined image size */
-    size_t getImageSize(void) const { return (imageSet == NULL ? 0 : imageSet->getDataSize()); }
+    size_t getImageSize(void) const {
+      if (flat) return flat->imageNum;
+      return (imageSet == NULL ? 0 : imageSet->getDataSize());
+    }
     /*! Get defined image value array */
-    void getImageData(ImageInfo *images) const { imageSet->getData(images); }
+    void getImageData(ImageInfo *images) const {
+      if (flat)
+        memcpy(images, flatBase + flat->imageOffset, flat->imageNum * sizeof(ImageInfo));
+      else
+        imageSet->getData(images);
+    }
 
     static const uint32_t magic_begin = TO_MAGIC('K', 'E', 'R', 'N');
     static const uint32_t magic_end = TO_MAGIC('N', 'R', 'E', 'K');
@@ -226,12 +341,18 @@ namespace gbe {
        code_size         |
        code              |
        magic_end
+       This layout is shared with older libraries, grfSize is only kept by
+       the flat format and is 0 for kernels read from this one.
     */
 
     /*! Implements the serialization. */
     virtual uint32_t serializeToBin(std::ostream& outs);
     virtual uint32_t deserializeFromBin(std::istream& ins);
     virtual void printStatus(int indent, std::ostream& outs);
+    /*! Append the records of the kernel to a flat binary */
+    bool serializeToFlat(FlatWriter &writer);
+    /*! Refer to a kernel record of a flat binary */
+    bool deserializeFromFlat(const FlatProgram &program, const FlatKernel &record);
     /*! Does kernel use device enqueue */
     INLINE bool getUseDeviceEnqueue(void) const { return this->useDeviceEnqueue; }
     /*! Change the device enqueue info of the function */
@@ -250,6 +371,7 @@ namespace gbe {
     uint32_t simdWidth;        //!< SIMD size for the kernel (lane number)
     uint32_t stackSize;        //!< Stack size (0 if unused)
     uint32_t scratchSize;      //!< Scratch memory size (may be 0 if unused)
+    uint32_t grfSize;          //!< Peak register file bytes allocated
     uint32_t oclVersion;       //!< Opencl Version (120 for 1.2, 200 for 2.0)
     bool useSLM;               //!< SLM requires a special HW config
     uint32_t slmSize;          //!< slm size for kernel variable
@@ -261,6 +383,8 @@ namespace gbe {
     uint32_t compileWgSize[3]; //!< required work group size by kernel attribute.
     std::string functionAttributes; //!< function attribute qualifiers combined.
     bool useDeviceEnqueue;          //!< Has device enqueue?
+    const FlatKernel *flat;    //!< Record when loaded from a flat binary
+    const char *flatBase;      //!< Start of that flat binary
     GBE_CLASS(Kernel);         //!< Use custom allocators
   };
 
@@ -276,27 +400,35 @@ namespace gbe {
     virtual void CleanLlvmResource() = 0;
     /*! Get the number of kernels in the program */
     uint32_t getKernelNum(void) const { return kernels.size(); }
-    /*! Get the kernel from its name */
-    Kernel *getKernel(const std::string &name) const {
-      map<std::string, Kernel*>::const_iterator it = kernels.find(name);
+    /*! Get the kernel from its name. In the lazy mode, the kernel is
+     *  compiled by the first call. Returns NULL if it fails */
+    Kernel *getKernel(const std::string &name) {
+      map<std::string, Kernel*>::iterator it = kernels.find(name);
       if (it == kernels.end())
         return NULL;
       else
-        return it->second;
+        return this->getCompiledKernel(it);
     }
     /*! Get the kernel from its ID */
-    Kernel *getKernel(uint32_t ID) const {
-      uint32_t currID = 0;
-      Kernel *kernel = NULL;
-      for (map<std::string, Kernel*>::const_iterator it = kernels.begin(); it != kernels.end(); ++it) {
-        if (currID == ID) {
-          kernel = it->second;
-          break;
-        }
-        currID++;
-      }
-      return kernel;
+    Kernel *getKernel(uint32_t ID) {
+      if (ID >= kernels.size())
+        return NULL;
+      map<std::string, Kernel*>::iterator it = kernels.begin();
+      std::advance(it, ID);
+      return this->getCompiledKernel(it);
+    }
+    /*! Get the name of a kernel from its ID without compiling it */
+    const char *getKernelName(uint32_t ID) const {
+      if (ID >= kernels.size())
+        return NULL;
+      map<std::string, Kernel*>::const_iterator it = kernels.begin();
+      std::advance(it, ID);
+      return it->first.c_str();
     }
+    /*! Compile the kernels not compiled yet by the lazy mode */
+    bool compileAllKernels(void);
+    /*! Return the OpenCL version of the kernels */
+    uint32_t getOclVersion(void) const { return oclVersion; }
 
     const char *getDeviceEnqueueKernelName(uint32_t index) const {
       if(index >= blockFuncs.size())
@@ -305,17 +437,32 @@ namespace gbe {
     }
     /*! Build a program from a ir::Unit */
     bool buildFromUnit(const ir::Unit &unit, std::string &error);
+    /*! When set, called with every unit before its kernels are compiled.
+     *  Lets offline tools (gbe_ir_interp) look at the Gen IR */
+    static void (*unitHook)(const ir::Unit &unit);
     /*! Buils a program from a LLVM Module */
     bool buildFromLLVMModule(const void* module, std::string &error, int optLevel);
     /*! Buils a program from a OCL string */
     bool buildFromSource(const char *source, std::string &error);
     /*! Get size of the global constant arrays */
-    size_t getGlobalConstantSize(void) const { return constantSet->getDataSize(); }
+    size_t getGlobalConstantSize(void) const {
+      return flat ? flat->constantSize : constantSet->getDataSize();
+    }
     /*! Get the content of global constant arrays */
-    void getGlobalConstantData(char *mem) const { constantSet->getData(mem); }
+    void getGlobalConstantData(char *mem) const {
+      if (flat)
+        memcpy(mem, (const char *)flat + flat->constantOffset, flat->constantSize);
+      else
+        constantSet->getData(mem);
+    }
 
-    uint32_t getGlobalRelocCount(void) const { return relocTable->getCount(); }
-    void getGlobalRelocTable(char *p) const { relocTable->getData(p); }
+    uint32_t getGlobalRelocCount(void) const { return flat ? flat->relocNum : relocTable->getCount(); }
+    void getGlobalRelocTable(char *p) const {
+      if (flat)
+        memcpy(p, (const char *)flat + flat->relocOffset, flat->relocNum * sizeof(ir::RelocEntry));
+      else
+        relocTable->getData(p);
+    }
     static const uint32_t magic_begin = TO_MAGIC('P', 'R', 'O', 'G');
     static const uint32_t magic_end = TO_MAGIC('G', 'O', 'R', 'P');
 
@@ -335,7 +482,17 @@ namespace gbe {
     virtual uint32_t serializeToBin(std::ostream& outs);
     virtual uint32_t deserializeFromBin(std::istream& ins);
     virtual void printStatus(int indent, std::ostream& outs);
+    /*! Write the flat binary of the program. Returns its size, 0 on failure */
+    virtual uint32_t serializeToFlatBin(std::string &bin);
+    /*! Use the flat binary in place. It must be 8 bytes aligned and stay
+     *  valid as long as the program. When owned, it is freed with the
+     *  program (GBE_ALIGNED_FREE). O(number of kernels) */
+    bool deserializeFromFlatBin(const char *bin, size_t size, bool owned);
+    /*! Says if the data is a flat binary */
+    static bool isFlatBin(const char *bin, size_t size);
     uint32_t fast_relaxed_math : 1;
+    /*! -cl-medium-precision-math: ULP bounded libocl exp, log, pow, sin, cos */
+    uint32_t medium_precision_math : 1;
 
   protected:
     /*! Compile a kernel */
@@ -343,7 +500,11 @@ namespace gbe {
                                   bool relaxMath, int profiling) = 0;
     /*! Allocate an empty kernel. */
     virtual Kernel *allocateKernel(const std::string &name) = 0;
-    /*! Kernels sorted by their name */
+    /*! Compile a kernel of the unit and attach the function data to it */
+    Kernel *buildKernel(const ir::Unit &unit, const std::string &name, std::string &error);
+    /*! Return the kernel, compiling it first if it is still pending */
+    Kernel *getCompiledKernel(map<std::string, Kernel*>::iterator it);
+    /*! Kernels sorted by their name. NULL while pending in the lazy mode */
     map<std::string, Kernel*> kernels;
     /*! Global (constants) outside any kernel */
     ir::ConstantSet *constantSet;
@@ -351,6 +512,17 @@ namespace gbe {
     ir::RelocTable *relocTable;
     /*! device enqueue functions */
     vector<std::string> blockFuncs;
+    /*! Opencl Version (120 for 1.2, 200 for 2.0) */
+    uint32_t oclVersion;
+    /*! With OCL_LAZY_KERNEL_COMPILE, the unit the pending kernels are
+     *  compiled from. Freed once they are all compiled */
+    ir::Unit *lazyUnit;
+    uint32_t lazyKernelNum;    //!< Kernels still pending
+    bool lazyBuild;            //!< Set by the build, before any lookup
+    std::mutex lazyMutex;      //!< Serializes the on demand compilations
+    /*! Flat binary the kernels refer to, if loaded from one */
+    const FlatProgram *flat;
+    char *flatStorage;         //!< Owned flat binary, if any
     /*! Use custom allocators */
     GBE_CLASS(Program);
   };
@@ -195,8 +195,8 @@ void program_build_instance::serialize_program()
 
       if(gen_pci_id){
         //add header to differeciate from llvm bitcode binary.
-        // (5 bytes: 1 byte for binary version, 4 byte for bc code, 'GENC' is for gen binary.)
-        char gen_header[6] = "\1GENC";
+        // (5 bytes: 1 byte for binary version (2 is the flat format), 4 byte for bc code, 'GENC' is for gen binary.)
+        char gen_header[6] = "\2GENC";
         OUTS_UPDATE_SZ(gen_header[0]);
         OUTS_UPDATE_SZ(gen_header[1]);
         OUTS_UPDATE_SZ(gen_header[2]);
@@ -218,7 +218,9 @@ void program_build_instance::serialize_program()
       ofs << "char " << array_name << "[] = {" << "\n";
 
       if(gen_pci_id){
-        sz = gbe_prog->serializeToBin(oss);
+        std::string flat;
+        sz = gbe_prog->serializeToFlatBin(flat);
+        oss.write(flat.data(), sz);
         sz += header_sz;
       }else{
         char *llvm_binary;
@@ -242,8 +244,8 @@ void program_build_instance::serialize_program()
     } else {
       if(gen_pci_id){
         //add header to differeciate from llvm bitcode binary.
-        // (5 bytes: 1 byte for binary version, 4 byte for bc code, 'GENC' is for gen binary.)
-        char gen_header[6] = "\1GENC";
+        // (5 bytes: 1 byte for binary version (2 is the flat format), 4 byte for bc code, 'GENC' is for gen binary.)
+        char gen_header[6] = "\2GENC";
         OUTF_UPDATE_SZ(gen_header[0]);
         OUTF_UPDATE_SZ(gen_header[1]);
         OUTF_UPDATE_SZ(gen_header[2]);
@@ -252,7 +254,9 @@ void program_build_instance::serialize_program()
         OUTF_UPDATE_SZ(src_hw_info[0]);
         OUTF_UPDATE_SZ(src_hw_info[1]);
         OUTF_UPDATE_SZ(src_hw_info[2]);
-        sz = gbe_prog->serializeToBin(ofs);
+        std::string flat;
+        sz = gbe_prog->serializeToFlatBin(flat);
+        ofs.write(flat.data(), sz);
       }else{
         char *llvm_binary;
         size_t bin_length = gbe_program_serialize_to_binary((gbe_program)gbe_prog, &llvm_binary, 1);
@@ -37,9 +37,12 @@ struct BinInterpCallBackInitializer
 {
   BinInterpCallBackInitializer() {
     gbe_program_new_from_binary = gbe::genProgramNewFromBinary;
+    gbe_program_new_from_mapped_binary = gbe::genProgramNewFromMappedBinary;
     gbe_program_get_kernel_num = gbe::programGetKernelNum;
     gbe_program_get_kernel_by_name = gbe::programGetKernelByName;
     gbe_program_get_kernel = gbe::programGetKernel;
+    gbe_program_get_kernel_name = gbe::programGetKernelName;
+    gbe_program_get_ocl_version = gbe::programGetOclVersion;
     gbe_program_get_device_enqueue_kernel_name = gbe::programGetDeviceEnqueueKernelName;
     gbe_kernel_get_code_size = gbe::kernelGetCodeSize;
     gbe_kernel_get_code = gbe::kernelGetCode;
@@ -56,6 +59,7 @@ struct BinInterpCallBackInitializer
     gbe_kernel_get_arg_bti = gbe::kernelGetArgBTI;
     gbe_kernel_get_simd_width = gbe::kernelGetSIMDWidth;
     gbe_kernel_get_scratch_size = gbe::kernelGetScratchSize;
+    gbe_kernel_get_grf_size = gbe::kernelGetGRFSize;
     gbe_kernel_use_slm = gbe::kernelUseSLM;
     gbe_kernel_get_required_work_group_size = gbe::kernelGetRequiredWorkGroupSize;
     gbe_kernel_get_curbe_offset = gbe::kernelGetCurbeOffset;
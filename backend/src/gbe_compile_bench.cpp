@@ -0,0 +1,443 @@
+/*
+ * Copyright © 2013 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*******************************************************************************
+   Compiler throughput benchmark. Every OpenCL source given on the command line
+   (or found in the given directories) is compiled offline, the same way
+   gbe_bin_generater does, for each target device and SIMD mode. No GPU is
+   needed.
+
+   Each compilation runs in its own process so that the peak RSS is per
+   program and OCL_SIMD_WIDTH can be changed between runs. The results are
+   written as CSV or JSON and may be compared against a previous CSV run.
+ *******************************************************************************/
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "backend/program.h"
+#include "backend/program.hpp"
+#include "backend/gen_program.hpp"
+#include "src/cl_device_data.h"
+
+using namespace std;
+
+struct bench_result {
+    string file;
+    string device;
+    string simd;
+    string status;
+    uint32_t kernels;
+    double compile_ms;
+    long peak_rss_kb;
+    uint64_t insns;
+    uint64_t spills;
+    uint64_t binary_bytes;
+    uint64_t scratch_bytes;
+    bench_result() : kernels(0), compile_ms(0), peak_rss_kb(0), insns(0),
+                     spills(0), binary_bytes(0), scratch_bytes(0) { }
+};
+
+static const char* device_name(uint32_t pci_id)
+{
+    if (IS_BAYTRAIL_T(pci_id)) return "BYT";
+    if (IS_IVYBRIDGE(pci_id)) return "IVB";
+    if (IS_HASWELL(pci_id)) return "HSW";
+    if (IS_BROADWELL(pci_id)) return "BDW";
+    if (IS_CHERRYVIEW(pci_id)) return "CHV";
+    if (IS_SKYLAKE(pci_id)) return "SKL";
+    if (IS_BROXTON(pci_id)) return "BXT";
+    if (IS_KABYLAKE(pci_id)) return "KBL";
+    return "UNKNOWN";
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* Child side: build one program and report the statistics on fd */
+static int run_worker(uint32_t pci_id, int fd, const char* file_path, const char* options)
+{
+    ifstream ifs(file_path);
+    if (!ifs) {
+        dprintf(fd, "nofile\n");
+        return 1;
+    }
+    stringstream source;
+    source << ifs.rdbuf();
+
+    /* Kernels may include headers living next to them */
+    string opts = options;
+    string path = file_path;
+    size_t slash = path.rfind('/');
+    opts += " -I" + (slash == string::npos ? string(".") : path.substr(0, slash));
+
+    const string code = source.str();
+    const double start = now_ms();
+    gbe_program opaque = gbe_program_new_from_source(pci_id, code.c_str(), 0, opts.c_str(), nullptr, nullptr);
+    const double compile_ms = now_ms() - start;
+    if (opaque == nullptr) {
+        dprintf(fd, "fail %f\n", compile_ms);
+        return 1;
+    }
+
+    gbe::Program* prog = reinterpret_cast<gbe::Program*>(opaque);
+    uint64_t insns = 0, spills = 0, scratch = 0;
+    const uint32_t kernel_num = gbe_program_get_kernel_num(opaque);
+    for (uint32_t i = 0; i < kernel_num; i++) {
+        const gbe::GenKernel* kernel =
+            static_cast<const gbe::GenKernel*>(reinterpret_cast<gbe::Kernel*>(gbe_program_get_kernel(opaque, i)));
+        insns += kernel->insnNum;
+        spills += kernel->spillNum;
+        scratch += kernel->getScratchSize();
+    }
+    string flat;
+    const uint64_t binary_bytes = prog->serializeToFlatBin(flat);
+
+    dprintf(fd, "ok %f %u %llu %llu %llu %llu\n", compile_ms, kernel_num,
+            (unsigned long long)insns, (unsigned long long)spills,
+            (unsigned long long)binary_bytes, (unsigned long long)scratch);
+    gbe_program_delete(opaque);
+    return 0;
+}
+
+/* Parent side: spawn a worker for one (file, device, simd) */
+static bench_result run_one(const char* self, const string& file, uint32_t pci_id,
+                            const string& simd, const string& options, bool verbose)
+{
+    bench_result res;
+    res.file = file;
+    res.device = device_name(pci_id);
+    res.simd = simd;
+    res.status = "error";
+
+    int fds[2];
+    if (pipe(fds) != 0)
+        return res;
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return res;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        /* OCL_SIMD_WIDTH is read when libgbe is loaded, so re-exec */
+        setenv("OCL_SIMD_WIDTH", simd == "auto" ? "15" : simd.c_str(), 1);
+        if (!verbose) {
+            int null_fd = open("/dev/null", O_WRONLY);
+            if (null_fd >= 0) {
+                dup2(null_fd, STDOUT_FILENO);
+                dup2(null_fd, STDERR_FILENO);
+            }
+        }
+        char pci_str[16], fd_str[16];
+        snprintf(pci_str, sizeof(pci_str), "0x%x", pci_id);
+        snprintf(fd_str, sizeof(fd_str), "%d", fds[1]);
+        execl(self, self, "-w", pci_str, fd_str, file.c_str(), options.c_str(), (char *)nullptr);
+        _exit(127);
+    }
+
+    close(fds[1]);
+    string line;
+    char buf[256];
+    ssize_t n;
+    while ((n = read(fds[0], buf, sizeof(buf))) > 0)
+        line.append(buf, n);
+    close(fds[0]);
+
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) == pid)
+        res.peak_rss_kb = usage.ru_maxrss;
+
+    istringstream iss(line);
+    iss >> res.status;
+    if (res.status == "ok")
+        iss >> res.compile_ms >> res.kernels >> res.insns >> res.spills
+            >> res.binary_bytes >> res.scratch_bytes;
+    else if (res.status == "fail")
+        iss >> res.compile_ms;
+    else if (WIFSIGNALED(status))
+        res.status = "crash";
+    else
+        res.status = "error";
+    return res;
+}
+
+static const char* csv_header =
+    "file,device,simd,status,kernels,compile_ms,peak_rss_kb,insns,spills,binary_bytes,scratch_bytes";
+
+static void output_csv(ostream& os, const vector<bench_result>& results)
+{
+    os << csv_header << "\n";
+    for (auto& r : results) {
+        os << r.file << "," << r.device << "," << r.simd << "," << r.status << ","
+           << r.kernels << "," << r.compile_ms << "," << r.peak_rss_kb << ","
+           << r.insns << "," << r.spills << "," << r.binary_bytes << ","
+           << r.scratch_bytes << "\n";
+    }
+}
+
+static void output_json(ostream& os, const vector<bench_result>& results)
+{
+    os << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const bench_result& r = results[i];
+        os << "  {\"file\": \"" << r.file << "\", \"device\": \"" << r.device
+           << "\", \"simd\": \"" << r.simd << "\", \"status\": \"" << r.status
+           << "\", \"kernels\": " << r.kernels << ", \"compile_ms\": " << r.compile_ms
+           << ", \"peak_rss_kb\": " << r.peak_rss_kb << ", \"insns\": " << r.insns
+           << ", \"spills\": " << r.spills << ", \"binary_bytes\": " << r.binary_bytes
+           << ", \"scratch_bytes\": " << r.scratch_bytes << "}"
+           << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    os << "]\n";
+}
+
+static string result_key(const bench_result& r)
+{
+    return r.file + "," + r.device + "," + r.simd;
+}
+
+static bool load_csv(const char* path, map<string, bench_result>& results)
+{
+    ifstream ifs(path);
+    if (!ifs)
+        return false;
+
+    string line;
+    getline(ifs, line); // header
+    while (getline(ifs, line)) {
+        vector<string> fields;
+        istringstream iss(line);
+        string field;
+        while (getline(iss, field, ','))
+            fields.push_back(field);
+        if (fields.size() != 11)
+            continue;
+        bench_result r;
+        r.file = fields[0];
+        r.device = fields[1];
+        r.simd = fields[2];
+        r.status = fields[3];
+        r.kernels = strtoul(fields[4].c_str(), nullptr, 10);
+        r.compile_ms = atof(fields[5].c_str());
+        r.peak_rss_kb = atol(fields[6].c_str());
+        r.insns = strtoull(fields[7].c_str(), nullptr, 10);
+        r.spills = strtoull(fields[8].c_str(), nullptr, 10);
+        r.binary_bytes = strtoull(fields[9].c_str(), nullptr, 10);
+        r.scratch_bytes = strtoull(fields[10].c_str(), nullptr, 10);
+        results[result_key(r)] = r;
+    }
+    return true;
+}
+
+/* Report what got worse than the baseline. Compile time and RSS are noisy,
+   so they only count past the given threshold (in percent); the generated
+   code is deterministic and any growth is reported. */
+static int compare(const vector<bench_result>& results, const map<string, bench_result>& baseline,
+                   double threshold)
+{
+    int regressions = 0;
+    double total = 0, base_total = 0;
+
+    for (auto& r : results) {
+        auto it = baseline.find(result_key(r));
+        if (it == baseline.end())
+            continue;
+        const bench_result& b = it->second;
+        ostringstream why;
+
+        if (b.status == "ok" && r.status != "ok")
+            why << " status " << b.status << "->" << r.status;
+        if (b.status == "ok" && r.status == "ok") {
+            total += r.compile_ms;
+            base_total += b.compile_ms;
+            if (r.compile_ms > b.compile_ms * (1 + threshold / 100) && r.compile_ms - b.compile_ms > 1)
+                why << " compile_ms " << b.compile_ms << "->" << r.compile_ms;
+            if (r.peak_rss_kb > b.peak_rss_kb * (1 + threshold / 100))
+                why << " peak_rss_kb " << b.peak_rss_kb << "->" << r.peak_rss_kb;
+            if (r.insns > b.insns)
+                why << " insns " << b.insns << "->" << r.insns;
+            if (r.spills > b.spills)
+                why << " spills " << b.spills << "->" << r.spills;
+            if (r.binary_bytes > b.binary_bytes)
+                why << " binary_bytes " << b.binary_bytes << "->" << r.binary_bytes;
+        }
+        if (!why.str().empty()) {
+            cerr << "REGRESSION " << result_key(r) << ":" << why.str() << endl;
+            regressions++;
+        }
+    }
+    if (base_total > 0)
+        cerr << "total compile time " << base_total << "ms -> " << total << "ms ("
+             << (total - base_total) * 100 / base_total << "%)" << endl;
+    cerr << regressions << " regression(s)" << endl;
+    return regressions;
+}
+
+static void collect_sources(const string& path, vector<string>& files)
+{
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        files.push_back(path);
+        return;
+    }
+
+    vector<string> found;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        string name = entry->d_name;
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, ".cl") == 0)
+            found.push_back(path + "/" + name);
+    }
+    closedir(dir);
+    sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+}
+
+static void usage(void)
+{
+    cout << "Usage: gbe_compile_bench [-t gen_pci_id]... [-s 8|16|auto]... [-p build_options]" << endl
+         << "         [-f csv|json] [-o output] [-c baseline.csv] [-r threshold_percent] [-v]" << endl
+         << "         file.cl|directory..." << endl
+         << "Defaults to IVB, HSW, BDW and SKL in SIMD8 and SIMD16." << endl;
+}
+
+int main (int argc, const char **argv)
+{
+    vector<uint32_t> pci_ids;
+    vector<string> simds;
+    vector<string> files;
+    string options, format = "csv";
+    const char* output = nullptr;
+    const char* baseline_path = nullptr;
+    double threshold = 10;
+    bool verbose = false;
+
+    if (argc > 1 && strcmp(argv[1], "-w") == 0) {
+        if (argc != 6)
+            return 1;
+        return run_worker(strtoul(argv[2], nullptr, 0), atoi(argv[3]), argv[4], argv[5]);
+    }
+
+    for (int i = 1; i < argc; i++) {
+        const string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "-t" && has_value)
+            pci_ids.push_back(strtoul(argv[++i], nullptr, 16));
+        else if (arg == "-s" && has_value)
+            simds.push_back(argv[++i]);
+        else if (arg == "-p" && has_value)
+            options = argv[++i];
+        else if (arg == "-f" && has_value)
+            format = argv[++i];
+        else if (arg == "-o" && has_value)
+            output = argv[++i];
+        else if (arg == "-c" && has_value)
+            baseline_path = argv[++i];
+        else if (arg == "-r" && has_value)
+            threshold = atof(argv[++i]);
+        else if (arg == "-v")
+            verbose = true;
+        else if (arg[0] == '-') {
+            usage();
+            return 1;
+        } else
+            collect_sources(arg, files);
+    }
+
+    if (files.empty() || (format != "csv" && format != "json")) {
+        usage();
+        return 1;
+    }
+    for (auto& simd : simds) {
+        if (simd != "8" && simd != "16" && simd != "auto") {
+            usage();
+            return 1;
+        }
+    }
+    if (pci_ids.empty())
+        pci_ids = { PCI_CHIP_IVYBRIDGE_GT2, PCI_CHIP_HASWELL_D2,
+                    PCI_CHIP_BROADWLL_D_GT2, PCI_CHIP_SKYLAKE_DT_GT2 };
+    if (simds.empty())
+        simds = { "8", "16" };
+
+    map<string, bench_result> baseline;
+    if (baseline_path && !load_csv(baseline_path, baseline)) {
+        cerr << "can not open the baseline " << baseline_path << endl;
+        return 1;
+    }
+
+    char self[4096];
+    ssize_t len = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    if (len <= 0) {
+        cerr << "can not find the benchmark executable" << endl;
+        return 1;
+    }
+    self[len] = '\0';
+
+    vector<bench_result> results;
+    for (auto& file : files) {
+        for (auto pci_id : pci_ids) {
+            for (auto& simd : simds) {
+                results.push_back(run_one(self, file, pci_id, simd, options, verbose));
+                const bench_result& r = results.back();
+                cerr << r.file << " " << r.device << " SIMD" << r.simd << ": " << r.status
+                     << " " << r.compile_ms << "ms" << endl;
+            }
+        }
+    }
+
+    ofstream ofs;
+    if (output) {
+        ofs.open(output, ofstream::out | ofstream::trunc);
+        if (!ofs) {
+            cerr << "can not open " << output << endl;
+            return 1;
+        }
+    }
+    ostream& os = output ? ofs : cout;
+    if (format == "json")
+        output_json(os, results);
+    else
+        output_csv(os, results);
+
+    if (baseline_path)
+        return compare(results, baseline, threshold) ? 2 : 0;
+    return 0;
+}
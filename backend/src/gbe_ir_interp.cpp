@@ -0,0 +1,266 @@
+/*
+ * Copyright © 2013 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*******************************************************************************
+   Offline Gen IR interpreter. The OpenCL source is compiled like
+   gbe_bin_generater does, then the Gen IR of one kernel is run on the CPU for
+   the given NDRange and arguments, without any GPU. It reports the dynamic
+   instruction mix, the lane utilization and divergence, the cache lines
+   touched by each memory instruction, the SLM bank conflicts and the barrier
+   imbalance.
+
+   Arguments are given in the kernel order:
+     buf:SIZE[:FILL]  __global / __constant buffer of SIZE bytes, FILL is
+                      zero (default), iota (32 bits indices) or rand
+     local:SIZE       __local buffer
+     i:V u:V l:V      32 bits signed, unsigned and 64 bits integers
+     f:V d:V          float and double
+     x:HEX            raw bytes, for vectors and structures
+   A checksum of each buffer is output after the run, so the results of two
+   compilations of a kernel can be compared.
+ *******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "backend/program.h"
+#include "backend/program.hpp"
+#include "ir/interpreter.hpp"
+#include "src/cl_device_data.h"
+
+using namespace std;
+
+struct interp_options {
+    string kernel;
+    vector<string> args;
+    gbe::ir::InterpreterLaunch launch;
+    bool ran;
+    bool failed;
+    interp_options() : ran(false), failed(false) { }
+};
+
+static interp_options opts;
+
+static bool parse_sizes(const char* str, uint32_t* sizes, uint32_t* dim)
+{
+    uint32_t n = 0;
+    for (const char* p = str; n < 3; n++) {
+        char* end;
+        sizes[n] = strtoul(p, &end, 0);
+        if (end == p || sizes[n] == 0)
+            return false;
+        if (*end != ',') {
+            n++;
+            break;
+        }
+        p = end + 1;
+    }
+    if (dim)
+        *dim = n;
+    return true;
+}
+
+static bool parse_arg(const gbe::ir::FunctionArgument& fnArg, const string& spec,
+                      gbe::ir::InterpreterArg& arg)
+{
+    const size_t colon = spec.find(':');
+    if (colon == string::npos)
+        return false;
+    const string kind = spec.substr(0, colon), value = spec.substr(colon + 1);
+    const bool pointer = fnArg.type == gbe::ir::FunctionArgument::GLOBAL_POINTER ||
+                         fnArg.type == gbe::ir::FunctionArgument::CONSTANT_POINTER;
+
+    auto put = [&](const void* data, size_t size) {
+        arg.data.assign((const char*)data, (const char*)data + size);
+    };
+    if (kind == "buf") {
+        if (!pointer)
+            return false;
+        const size_t fill = value.find(':');
+        const uint64_t size = strtoull(value.c_str(), nullptr, 0);
+        const string pattern = fill == string::npos ? "zero" : value.substr(fill + 1);
+        arg.data.assign(size, 0);
+        if (pattern == "iota") {
+            for (uint64_t i = 0; i + 4 <= size; i += 4) {
+                const uint32_t index = i / 4;
+                memcpy(&arg.data[i], &index, 4);
+            }
+        } else if (pattern == "rand") {
+            srand(1);
+            for (auto& byte : arg.data)
+                byte = rand();
+        } else if (pattern != "zero")
+            return false;
+    } else if (kind == "local") {
+        if (fnArg.type != gbe::ir::FunctionArgument::LOCAL_POINTER)
+            return false;
+        arg.localSize = strtoul(value.c_str(), nullptr, 0);
+    } else if (pointer || fnArg.type == gbe::ir::FunctionArgument::LOCAL_POINTER) {
+        return false;
+    } else if (kind == "i" || kind == "u") {
+        const uint32_t v = kind == "i" ? (uint32_t)strtol(value.c_str(), nullptr, 0)
+                                       : (uint32_t)strtoul(value.c_str(), nullptr, 0);
+        put(&v, sizeof(v));
+    } else if (kind == "l") {
+        const int64_t v = strtoll(value.c_str(), nullptr, 0);
+        put(&v, sizeof(v));
+    } else if (kind == "f") {
+        const float v = strtof(value.c_str(), nullptr);
+        put(&v, sizeof(v));
+    } else if (kind == "d") {
+        const double v = strtod(value.c_str(), nullptr);
+        put(&v, sizeof(v));
+    } else if (kind == "x") {
+        if (value.size() % 2)
+            return false;
+        arg.data.clear();
+        for (size_t i = 0; i < value.size(); i += 2)
+            arg.data.push_back((char)strtoul(value.substr(i, 2).c_str(), nullptr, 16));
+    } else
+        return false;
+    return true;
+}
+
+static uint64_t checksum(const gbe::vector<char>& data)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : data) {
+        hash ^= (uint8_t)c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/* Called by the compiler with the Gen IR before the Gen code generation */
+static void run_unit(const gbe::ir::Unit& unit)
+{
+    if (opts.ran)
+        return;
+    opts.ran = true;
+    opts.failed = true;
+
+    const gbe::ir::Function* fn = unit.getFunction(opts.kernel);
+    if (fn == nullptr) {
+        cerr << "gbe_ir_interp: no kernel " << opts.kernel << endl;
+        return;
+    }
+    if (opts.args.size() != fn->argNum()) {
+        cerr << "gbe_ir_interp: kernel " << opts.kernel << " takes " << fn->argNum() << " arguments" << endl;
+        return;
+    }
+    gbe::vector<gbe::ir::InterpreterArg> args(fn->argNum());
+    for (uint32_t i = 0; i < fn->argNum(); i++) {
+        if (!parse_arg(fn->getArg(i), opts.args[i], args[i])) {
+            cerr << "gbe_ir_interp: bad value " << opts.args[i] << " for argument "
+                 << fn->getArg(i).name << endl;
+            return;
+        }
+    }
+
+    gbe::ir::Interpreter interp(unit, *fn);
+    string error;
+    if (!interp.run(opts.launch, args, error)) {
+        cerr << "gbe_ir_interp: " << error << endl;
+        return;
+    }
+    interp.outputStatistics(cout);
+    for (uint32_t i = 0; i < fn->argNum(); i++) {
+        if (fn->getArg(i).type == gbe::ir::FunctionArgument::GLOBAL_POINTER)
+            printf("  %s checksum %016llx\n", fn->getArg(i).name.c_str(),
+                   (unsigned long long)checksum(args[i].data));
+    }
+    opts.failed = false;
+}
+
+static void usage(void)
+{
+    cout << "Usage: gbe_ir_interp [-t gen_pci_id] [-p build_options] [-s 8|16] [-n max_insns]" << endl
+         << "                     -k kernel -g gx[,gy[,gz]] [-l lx[,ly[,lz]]] [-a arg]... file.cl" << endl
+         << "  -a buf:SIZE[:zero|iota|rand] | local:SIZE | i:V | u:V | l:V | f:V | d:V | x:HEX" << endl;
+}
+
+int main (int argc, const char **argv)
+{
+    uint32_t pci_id = PCI_CHIP_SKYLAKE_DT_GT2;
+    string options, file;
+    gbe::ir::InterpreterLaunch& launch = opts.launch;
+    bool has_local = false;
+
+    for (int i = 1; i < argc; i++) {
+        const string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "-t" && has_value)
+            pci_id = strtoul(argv[++i], nullptr, 16);
+        else if (arg == "-p" && has_value)
+            options = argv[++i];
+        else if (arg == "-k" && has_value)
+            opts.kernel = argv[++i];
+        else if (arg == "-a" && has_value)
+            opts.args.push_back(argv[++i]);
+        else if (arg == "-s" && has_value)
+            launch.simdWidth = strtoul(argv[++i], nullptr, 0);
+        else if (arg == "-n" && has_value)
+            launch.maxInsnNum = strtoull(argv[++i], nullptr, 0);
+        else if (arg == "-g" && has_value) {
+            if (!parse_sizes(argv[++i], launch.globalSize, &launch.workDim)) {
+                usage();
+                return 1;
+            }
+        } else if (arg == "-l" && has_value) {
+            if (!parse_sizes(argv[++i], launch.localSize, nullptr)) {
+                usage();
+                return 1;
+            }
+            has_local = true;
+        } else if (arg[0] == '-' || !file.empty()) {
+            usage();
+            return 1;
+        } else
+            file = arg;
+    }
+    if (file.empty() || opts.kernel.empty() || (launch.simdWidth != 8 && launch.simdWidth != 16)) {
+        usage();
+        return 1;
+    }
+    if (!has_local) {
+        launch.localSize[0] = launch.globalSize[0] < 64 ? launch.globalSize[0] : 64;
+        for (uint32_t dim = 1; dim < 3; dim++)
+            launch.localSize[dim] = 1;
+    }
+
+    ifstream ifs(file.c_str());
+    if (!ifs) {
+        cerr << "gbe_ir_interp: cannot read " << file << endl;
+        return 1;
+    }
+    stringstream source;
+    source << ifs.rdbuf();
+
+    gbe::Program::unitHook = run_unit;
+    const string code = source.str();
+    gbe_program program = gbe_program_new_from_source(pci_id, code.c_str(), 0, options.c_str(), nullptr, nullptr);
+    if (program)
+        gbe_program_delete(program);
+    if (!opts.ran)
+        cerr << "gbe_ir_interp: " << file << " failed to build" << endl;
+    return opts.ran && !opts.failed ? 0 : 1;
+}
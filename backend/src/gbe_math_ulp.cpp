@@ -0,0 +1,155 @@
+/*
+ * Copyright © 2013 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*******************************************************************************
+   Host ULP harness of the medium precision math of libocl. The OpenCL C
+   source of libocl/src/ocl_math_medium.cl is compiled for the CPU and
+   compared against the double precision libm, exhaustively on all the floats
+   for the one argument functions and on a pseudo random sweep for pow. Like
+   Gen, denormal inputs are flushed to zero and the denormal results are
+   accepted as zero. The maximum error of each function is printed in ulp of
+   the correctly rounded result, and the exit status is non zero when one of
+   them is above the bound given as argument (4 by default).
+
+   The build must not contract multiplications and additions into fma, as
+   Gen evaluates the source without contraction (-ffp-contract=off).
+ *******************************************************************************/
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/* Compile the OpenCL C library source as C++ */
+#define __OCL_TYPES_H__
+#define INLINE static inline
+#define OVERLOADABLE
+typedef unsigned int uint;
+#include "libocl/src/ocl_math_medium.cl"
+
+struct ulp_stat {
+  const char *name;
+  double max;
+  float worst[2];
+  uint64_t count;
+  ulp_stat(const char *name) : name(name), max(0.0), count(0) { worst[0] = worst[1] = 0.0f; }
+};
+
+static float flush(float x)
+{
+  return std::fabs(x) < FLT_MIN ? std::copysign(0.0f, x) : x;
+}
+
+/* Error of res in ulp of ref rounded to float */
+static double ulp_error(float res, double ref)
+{
+  if (std::isnan(ref))
+    return std::isnan(res) ? 0.0 : INFINITY;
+  if (std::fabs(ref) < FLT_MIN && std::fabs(res) <= FLT_MIN)
+    return 0.0;
+  const float rounded = (float) ref;
+  if (std::isinf(rounded) || std::isinf(res))
+    return res == rounded ? 0.0 : INFINITY;
+  int e;
+  std::frexp(rounded, &e);
+  const double ulp = std::ldexp(1.0, std::max(e, FLT_MIN_EXP) - FLT_MANT_DIG);
+  return std::fabs((double) res - ref) / ulp;
+}
+
+static void record(ulp_stat &stat, double err, float x, float y = 0.0f)
+{
+  stat.count++;
+  if (err > stat.max || std::isnan(err)) {
+    stat.max = std::isnan(err) ? INFINITY : err;
+    stat.worst[0] = x;
+    stat.worst[1] = y;
+  }
+}
+
+template <typename F, typename R>
+static void sweep(ulp_stat &stat, F f, R ref, float bound)
+{
+  for (uint64_t i = 0; i <= 0xffffffffull; i++) {
+    float x;
+    const uint32_t u = (uint32_t) i;
+    memcpy(&x, &u, sizeof(x));
+    if (!(std::fabs(x) < bound) && !std::isnan(x) && bound != INFINITY)
+      continue;
+    if (x != 0.0f && flush(x) == 0.0f)
+      continue;
+    record(stat, ulp_error(f(x), ref((double) x)), x);
+  }
+}
+
+static double ref_exp(double x) { return std::exp(x); }
+static double ref_log(double x) { return std::log(x); }
+static double ref_sin(double x) { return std::sin(x); }
+static double ref_cos(double x) { return std::cos(x); }
+static float medium_exp(float x) { return __gen_ocl_internal_medium_exp(x); }
+static float medium_log(float x) { return __gen_ocl_internal_medium_log(x); }
+static float medium_sin(float x) { return __gen_ocl_internal_medium_sin(x); }
+static float medium_cos(float x) { return __gen_ocl_internal_medium_cos(x); }
+
+/* pow on the domain the library dispatches to the medium path: x positive
+ * normal, y finite, the results range is covered by drawing log2(result) */
+static void sweep_pow(ulp_stat &stat, uint64_t n)
+{
+  uint64_t seed = 0x9e3779b97f4a7c15ull;
+  for (uint64_t i = 0; i < n; i++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    const uint32_t r0 = (uint32_t) (seed >> 32), r1 = (uint32_t) seed;
+    uint32_t ux = 0x00800000u + r0 % (0x7f800000u - 0x00800000u);
+    float x, y;
+    memcpy(&x, &ux, sizeof(x));
+    /* Either any y or one giving a result in the float range */
+    const double lx = std::log2((double) x);
+    if ((i & 3) == 0 || lx == 0.0) {
+      uint32_t uy = r1 & 0x7fffffffu;
+      if (uy >= 0x7f800000u) uy -= 0x7f800000u;
+      memcpy(&y, &uy, sizeof(y));
+      y = flush(i & 2 ? -y : y);
+    } else
+      y = (float) ((((double) r1 / 4294967296.0) * 256.0 - 128.0) / lx);
+    record(stat, ulp_error(__gen_ocl_internal_medium_pow(x, y),
+                           std::pow((double) x, (double) y)), x, y);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  const double bound = argc > 1 ? atof(argv[1]) : 4.0;
+  ulp_stat stats[] = { "exp", "log", "sin", "cos", "pow" };
+  sweep(stats[0], medium_exp, ref_exp, INFINITY);
+  sweep(stats[1], medium_log, ref_log, INFINITY);
+  sweep(stats[2], medium_sin, ref_sin, MEDIUM_TRIG_MAX);
+  sweep(stats[3], medium_cos, ref_cos, MEDIUM_TRIG_MAX);
+  sweep_pow(stats[4], 1ull << 28);
+
+  int failed = 0;
+  for (const ulp_stat &stat : stats) {
+    printf("%-4s %12llu values  max %.3f ulp at x = %a", stat.name,
+           (unsigned long long) stat.count, stat.max, stat.worst[0]);
+    if (&stat == &stats[4])
+      printf(" y = %a", stat.worst[1]);
+    printf("\n");
+    failed |= !(stat.max <= bound);
+  }
+  return failed;
+}
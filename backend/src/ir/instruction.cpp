@@ -579,6 +579,36 @@ namespace ir {
         bool         ifBlock;
     };
 
+    class ALIGNED_INSTRUCTION PrefetchInstruction :
+      public MemInstruction,
+      public NDstPolicy<PrefetchInstruction, 0>
+    {
+      public:
+        PrefetchInstruction(Register offset,
+                            AddressSpace addrSpace,
+                            AddressMode AM)
+          : MemInstruction(AM, addrSpace, false, TYPE_U8, offset)
+        {
+          this->opcode = OP_PREFETCH;
+        }
+        INLINE unsigned getSrcNum() const { return getBaseSrcNum(); }
+        INLINE Register getSrc(const Function &fn, unsigned id) const {
+          if (id == 0) return offset;
+          if (hasExtraBtiReg() && id == 1) return BtiReg;
+          GBE_ASSERTM(false, "PrefetchInstruction::getSrc() out-of-range");
+          return ir::Register(0);
+        }
+        INLINE void     setSrc(Function &fn, unsigned id, Register reg) {
+          GBE_ASSERT(id < getSrcNum());
+          if (id == 0) { offset = reg;   return; }
+          if (id == 1) { setBtiReg(reg); return; }
+        }
+        INLINE bool wellFormed(const Function &fn, std::string &why) const;
+        INLINE void out(std::ostream &out, const Function &fn) const;
+
+        Register dst[0];
+    };
+
     class ALIGNED_INSTRUCTION SampleInstruction : // TODO
       public BasePolicy,
       public TupleSrcPolicy<SampleInstruction>,
@@ -1434,6 +1464,15 @@ namespace ir {
       return wellFormedLoadStore(*this, fn, whyNot);
     }
 
+    INLINE bool PrefetchInstruction::wellFormed(const Function &fn, std::string &whyNot) const
+    {
+      if (UNLIKELY(this->getAddressRegister() >= fn.regNum())) {
+        whyNot = "Out-of-bound offset register index";
+        return false;
+      }
+      return true;
+    }
+
     // TODO
     INLINE bool SampleInstruction::wellFormed(const Function &fn, std::string &why) const
     { return true; }
@@ -1820,6 +1859,18 @@ namespace ir {
       }
     }
 
+    INLINE void PrefetchInstruction::out(std::ostream &out, const Function &fn) const {
+      this->outOpcode(out);
+      out << "." << AS << " %" << this->getSrc(fn, 0);
+      AddressMode am = this->getAddressMode();
+      out << " bti:";
+      if ( am == AM_DynamicBti) {
+        out << " %" << this->getBtiReg();
+      } else {
+        out << this->getSurfaceIndex();
+      }
+    }
+
     INLINE void ReadARFInstruction::out(std::ostream &out, const Function &fn) const {
       this->outOpcode(out);
       out << " %" << this->getDst(fn, 0) << " arf:" << arf;
@@ -2136,6 +2187,10 @@ START_INTROSPECTION(StoreInstruction)
 #include "ir/instruction.hxx"
 END_INTROSPECTION(StoreInstruction)
 
+START_INTROSPECTION(PrefetchInstruction)
+#include "ir/instruction.hxx"
+END_INTROSPECTION(PrefetchInstruction)
+
 START_INTROSPECTION(SyncInstruction)
 #include "ir/instruction.hxx"
 END_INTROSPECTION(SyncInstruction)
@@ -2336,7 +2391,8 @@ END_FUNCTION(Instruction, Register)
            opcode == OP_STORE_PROFILING ||
            opcode == OP_WAIT ||
            opcode == OP_PRINTF ||
-           opcode == OP_MBWRITE;
+           opcode == OP_MBWRITE ||
+           opcode == OP_PREFETCH;
   }
 
 #define DECL_MEM_FN(CLASS, RET, PROTOTYPE, CALL) \
@@ -2654,6 +2710,13 @@ DECL_MEM_FN(MemInstruction, void,     setBtiReg(Register reg), setBtiReg(reg))
 
 #undef DECL_EMIT_FUNCTION
 
+  // PREFETCH
+  Instruction PREFETCH(Register offset, AddressSpace space, AddressMode AM, unsigned SurfaceIndex) {
+    internal::PrefetchInstruction insn = internal::PrefetchInstruction(offset, space, AM);
+    insn.setSurfaceIndex(SurfaceIndex);
+    return insn.convert();
+  }
+
   // FENCE
   Instruction SYNC(uint32_t parameters) {
     return internal::SyncInstruction(parameters).convert();
@@ -384,6 +384,17 @@ namespace ir {
     bool isBlock() const;
   };
 
+  /*! Prefetch instruction. The source is the address of the cache line to
+   *  bring closer. Nothing is written back and nothing waits for it
+   */
+  class PrefetchInstruction : public MemInstruction {
+  public:
+    /*! Where the address register goes */
+    static const uint32_t addressIndex = 0;
+    /*! Return true if the given instruction is an instance of this class */
+    static bool isClassOf(const Instruction &insn);
+  };
+
   /*! Load immediate instruction loads an typed immediate value into the given
    *  register. Since double and uint64_t values will not fit into an
    *  instruction, the immediate themselves are stored in the function core.
@@ -866,6 +877,8 @@ namespace ir {
   /*! store.type.space offset {src1,...,src_valueNum} value {bti}*/
   Instruction STORE(Type type, Tuple src, Register offset, AddressSpace space, uint32_t valueNum, bool dwAligned, AddressMode, unsigned SurfaceIndex, bool isBlock = false);
   Instruction STORE(Type type, Tuple src, Register offset, AddressSpace space, uint32_t valueNum, bool dwAligned, AddressMode, Register bti);
+  /*! prefetch.space offset {bti} */
+  Instruction PREFETCH(Register offset, AddressSpace space, AddressMode, unsigned SurfaceIndex);
   /*! loadi.type dst value */
   Instruction LOADI(Type type, Register dst, ImmediateIndex value);
   /*! sync.params... (see Sync instruction) */
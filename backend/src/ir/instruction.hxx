@@ -117,3 +117,4 @@ DECL_INSN(PRINTF, PrintfInstruction)
 DECL_INSN(MBREAD, MediaBlockReadInstruction)
 DECL_INSN(MBWRITE, MediaBlockWriteInstruction)
 DECL_INSN(BFREV, UnaryInstruction)
+DECL_INSN(PREFETCH, PrefetchInstruction)
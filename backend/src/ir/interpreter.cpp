@@ -0,0 +1,963 @@
+/*
+ * Copyright © 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file interpreter.cpp
+ *
+ * Memory is flat: the program constants, the buffer arguments and the private
+ * stacks are given disjoint address ranges, so the address alone selects the
+ * buffer whatever BTI the instruction uses. Local memory is separate and
+ * addressed from 0 like the SLM.
+ */
+
+#include <cmath>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <sstream>
+#include "sys/map.hpp"
+#include "sys/set.hpp"
+#include "ir/interpreter.hpp"
+#include "ir/profile.hpp"
+#include "ir/constant.hpp"
+
+namespace gbe {
+namespace ir {
+
+  /*! Lines used for the coalescing statistics */
+  static const uint32_t cacheLineSize = 64;
+  /*! SLM banks are one dword wide */
+  static const uint32_t slmBankNum = 16;
+  /*! Gap left between two buffers to catch overflows */
+  static const uint64_t regionGap = 64 * 1024;
+  static const uint32_t maxLaneNum = 32;
+
+  static const char *opcodeName[] = {
+#define DECL_INSN(INSN, FAMILY) #INSN,
+#include "ir/instruction.hxx"
+#undef DECL_INSN
+  };
+
+#define FOR_EACH_LANE(LANE, MASK) \
+  for (uint32_t LANE = 0; LANE < simdWidth; ++LANE) \
+    if ((MASK) & (1u << LANE))
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Typed views of the 64 bits held by a lane
+  ///////////////////////////////////////////////////////////////////////////
+
+  static INLINE bool isFloatType(Type type) {
+    return type == TYPE_HALF || type == TYPE_FLOAT || type == TYPE_DOUBLE;
+  }
+
+  static INLINE bool isSignedType(Type type) {
+    return type == TYPE_S8 || type == TYPE_S16 || type == TYPE_S32 || type == TYPE_S64;
+  }
+
+  static INLINE uint32_t typeBits(Type type) {
+    switch (type) {
+      case TYPE_BOOL: return 1;
+      case TYPE_S8: case TYPE_U8: return 8;
+      case TYPE_S16: case TYPE_U16: case TYPE_HALF: return 16;
+      case TYPE_S32: case TYPE_U32: case TYPE_FLOAT: return 32;
+      default: return 64;
+    }
+  }
+
+  static INLINE uint64_t typeMask(Type type) {
+    const uint32_t bits = typeBits(type);
+    return bits == 64 ? ~0ull : (1ull << bits) - 1;
+  }
+
+  static INLINE uint64_t uval(Type type, uint64_t bits) { return bits & typeMask(type); }
+
+  static INLINE int64_t sval(Type type, uint64_t bits) {
+    const uint32_t shift = 64 - typeBits(type);
+    return isSignedType(type) ? int64_t(bits << shift) >> shift : int64_t(uval(type, bits));
+  }
+
+  static float halfToFloat(uint16_t h) {
+    const uint32_t sign = uint32_t(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1f, mant = h & 0x3ff, bits;
+    if (exp == 0x1f)
+      bits = sign | 0x7f800000 | (mant << 13);
+    else if (exp != 0)
+      bits = sign | ((exp + 112) << 23) | (mant << 13);
+    else if (mant == 0)
+      bits = sign;
+    else {
+      // Denormal, normalize it
+      exp = 113;
+      while (!(mant & 0x400)) { mant <<= 1; exp--; }
+      bits = sign | (exp << 23) | ((mant & 0x3ff) << 13);
+    }
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+  }
+
+  static uint16_t floatToHalf(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    const uint16_t sign = (bits >> 16) & 0x8000;
+    const int32_t exp = int32_t((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mant = bits & 0x7fffff;
+    if (((bits >> 23) & 0xff) == 0xff)
+      return sign | 0x7c00 | (mant ? 0x200 : 0);
+    if (exp >= 0x1f)
+      return sign | 0x7c00;
+    if (exp <= 0) {
+      if (exp < -10)
+        return sign;
+      mant |= 0x800000;
+      const uint32_t shift = 14 - exp;
+      uint32_t h = mant >> shift;
+      const uint32_t rest = mant & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+      if (rest > halfway || (rest == halfway && (h & 1)))
+        h++;
+      return sign | h;
+    }
+    uint32_t h = (uint32_t(exp) << 10) | (mant >> 13);
+    const uint32_t rest = mant & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (h & 1)))
+      h++; // May carry into the exponent, which is still right
+    return sign | h;
+  }
+
+  static INLINE double fval(Type type, uint64_t bits) {
+    switch (type) {
+      case TYPE_DOUBLE: { double d; memcpy(&d, &bits, sizeof(d)); return d; }
+      case TYPE_FLOAT: { float f; const uint32_t u = bits; memcpy(&f, &u, sizeof(f)); return f; }
+      case TYPE_HALF: return halfToFloat(uint16_t(bits));
+      default: return isSignedType(type) ? double(sval(type, bits)) : double(uval(type, bits));
+    }
+  }
+
+  static INLINE uint64_t fromFloat(Type type, double v) {
+    switch (type) {
+      case TYPE_DOUBLE: { uint64_t u; memcpy(&u, &v, sizeof(u)); return u; }
+      case TYPE_FLOAT: { const float f = float(v); uint32_t u; memcpy(&u, &f, sizeof(u)); return u; }
+      case TYPE_HALF: return floatToHalf(float(v));
+      default: GBE_ASSERT(0); return 0;
+    }
+  }
+
+  /*! Float to integer conversions saturate like the Gen MOV does */
+  static INLINE uint64_t floatToInt(Type type, double v) {
+    if (type == TYPE_BOOL)
+      return v != 0.0;
+    if (std::isnan(v))
+      return 0;
+    const uint32_t bits = typeBits(type);
+    v = std::trunc(v);
+    if (isSignedType(type)) {
+      const double lo = -std::ldexp(1.0, bits - 1), hi = std::ldexp(1.0, bits - 1);
+      if (v <= lo) return uval(type, uint64_t(1) << (bits - 1));
+      if (v >= hi) return typeMask(type) >> 1;
+      return uval(type, uint64_t(int64_t(v)));
+    }
+    if (v <= 0.0) return 0;
+    if (v >= std::ldexp(1.0, bits)) return typeMask(type);
+    return uint64_t(v);
+  }
+
+  /*! Clamp a wide integer to the range of the type */
+  static INLINE uint64_t saturate(Type type, __int128 v) {
+    const uint32_t bits = typeBits(type);
+    __int128 lo, hi;
+    if (isSignedType(type)) {
+      lo = -(__int128(1) << (bits - 1));
+      hi = (__int128(1) << (bits - 1)) - 1;
+    } else {
+      lo = 0;
+      hi = (__int128(1) << bits) - 1;
+    }
+    return uval(type, uint64_t(std::min(std::max(v, lo), hi)));
+  }
+
+  static INLINE __int128 wide(Type type, uint64_t bits) {
+    return isSignedType(type) ? __int128(sval(type, bits)) : __int128(uval(type, bits));
+  }
+
+  static uint64_t evalUnary(Opcode op, Type type, uint64_t a) {
+    if (isFloatType(type)) {
+      const double x = fval(type, a);
+      double r;
+      switch (op) {
+        case OP_MOV: return uval(type, a);
+        case OP_COS: r = std::cos(x); break;
+        case OP_SIN: r = std::sin(x); break;
+        case OP_LOG: r = std::log2(x); break;
+        case OP_EXP: r = std::exp2(x); break;
+        case OP_SQR: r = std::sqrt(x); break;
+        case OP_RSQ: r = 1.0 / std::sqrt(x); break;
+        case OP_RCP: r = 1.0 / x; break;
+        case OP_ABS: r = std::fabs(x); break;
+        case OP_RNDD: r = std::floor(x); break;
+        case OP_RNDE: r = std::rint(x); break;
+        case OP_RNDU: r = std::ceil(x); break;
+        case OP_RNDZ: r = std::trunc(x); break;
+        default: return uval(type, a);
+      }
+      return fromFloat(type, r);
+    }
+
+    const uint32_t bits = typeBits(type);
+    const uint64_t u = uval(type, a);
+    switch (op) {
+      case OP_ABS: return uval(type, sval(type, a) < 0 ? -sval(type, a) : sval(type, a));
+      case OP_BSWAP: return uval(type, __builtin_bswap64(u) >> (64 - bits));
+      case OP_CBIT: return __builtin_popcountll(u);
+      case OP_LZD: return u ? __builtin_clzll(u) - (64 - bits) : bits;
+      case OP_FBL: return u ? __builtin_ctzll(u) : 0xffffffff;
+      case OP_FBH: {
+        // Signed values look for the first bit which differs from the sign
+        const uint64_t v = isSignedType(type) && sval(type, a) < 0 ? uval(type, ~u) : u;
+        return v ? __builtin_clzll(v) - (64 - bits) : 0xffffffff;
+      }
+      case OP_BFREV: {
+        uint64_t r = 0;
+        for (uint32_t i = 0; i < bits; ++i)
+          r |= ((u >> i) & 1) << (bits - 1 - i);
+        return r;
+      }
+      default: return u;
+    }
+  }
+
+  static uint64_t evalBinary(Opcode op, Type type, uint64_t a, uint64_t b) {
+    if (isFloatType(type)) {
+      const double x = fval(type, a), y = fval(type, b);
+      double r;
+      switch (op) {
+        case OP_ADD: r = x + y; break;
+        case OP_SUB: r = x - y; break;
+        case OP_MUL: r = x * y; break;
+        case OP_DIV: r = x / y; break;
+        case OP_REM: r = std::fmod(x, y); break;
+        case OP_POW: r = std::pow(x, y); break;
+        default: r = 0; GBE_ASSERT(0);
+      }
+      return fromFloat(type, r);
+    }
+
+    const uint32_t bits = typeBits(type);
+    const bool s = isSignedType(type);
+    const uint64_t ua = uval(type, a), ub = uval(type, b);
+    const int64_t sa = sval(type, a), sb = sval(type, b);
+    const __int128 wa = wide(type, a), wb = wide(type, b);
+    switch (op) {
+      case OP_ADD: return uval(type, ua + ub);
+      case OP_SUB: return uval(type, ua - ub);
+      case OP_MUL: return uval(type, ua * ub);
+      case OP_AND: return ua & ub;
+      case OP_OR: return ua | ub;
+      case OP_XOR: return ua ^ ub;
+      case OP_SHL: return uval(type, ua << (ub % bits));
+      case OP_SHR: return ua >> (ub % bits);
+      case OP_ASR: return uval(type, sa >> (ub % bits));
+      case OP_DIV:
+        if (ub == 0) return typeMask(type);
+        if (s && sb == -1) return uval(type, -uint64_t(sa));
+        return s ? uval(type, sa / sb) : ua / ub;
+      case OP_REM:
+        if (ub == 0) return ua;
+        if (s && sb == -1) return 0;
+        return s ? uval(type, sa % sb) : ua % ub;
+      case OP_ADDSAT: return saturate(type, wa + wb);
+      case OP_SUBSAT: return saturate(type, wa - wb);
+      case OP_MUL_HI:
+      case OP_I64_MUL_HI:
+        if (s)
+          return uval(type, uint64_t((__int128(sa) * sb) >> bits));
+        return uval(type, uint64_t((static_cast<unsigned __int128>(ua) * ub) >> bits));
+      case OP_HADD:
+      case OP_I64HADD: return uval(type, uint64_t((wa + wb) >> 1));
+      case OP_RHADD:
+      case OP_I64RHADD: return uval(type, uint64_t((wa + wb + 1) >> 1));
+      case OP_UPSAMPLE_SHORT:
+      case OP_UPSAMPLE_INT:
+      case OP_UPSAMPLE_LONG:
+        return uval(type, (ua << (bits / 2)) | (ub & ((1ull << (bits / 2)) - 1)));
+      default: GBE_ASSERT(0); return 0;
+    }
+  }
+
+  static bool evalCompare(Opcode op, Type type, uint64_t a, uint64_t b) {
+    if (isFloatType(type)) {
+      const double x = fval(type, a), y = fval(type, b);
+      switch (op) {
+        case OP_EQ: return x == y;
+        case OP_NE: return x != y;
+        case OP_LE: return x <= y;
+        case OP_LT: return x < y;
+        case OP_GE: return x >= y;
+        case OP_GT: return x > y;
+        case OP_ORD: return !std::isnan(x) && !std::isnan(y);
+        default: GBE_ASSERT(0); return false;
+      }
+    }
+    const __int128 x = wide(type, a), y = wide(type, b);
+    switch (op) {
+      case OP_EQ: return x == y;
+      case OP_NE: return x != y;
+      case OP_LE: return x <= y;
+      case OP_LT: return x < y;
+      case OP_GE: return x >= y;
+      case OP_GT: return x > y;
+      case OP_ORD: return true;
+      default: GBE_ASSERT(0); return false;
+    }
+  }
+
+  static uint64_t evalConvert(Opcode op, Type dstType, Type srcType, uint64_t a) {
+    if (isFloatType(srcType)) {
+      const double x = fval(srcType, a);
+      return isFloatType(dstType) ? fromFloat(dstType, x) : floatToInt(dstType, x);
+    }
+    if (isFloatType(dstType))
+      return fromFloat(dstType, fval(srcType, a));
+    if (dstType == TYPE_BOOL)
+      return uval(srcType, a) != 0;
+    if (op == OP_SAT_CVT)
+      return saturate(dstType, wide(srcType, a));
+    return uval(dstType, uint64_t(sval(srcType, a)));
+  }
+
+  static uint64_t evalAtomic(AtomicOps op, Type type, uint64_t old, uint64_t src0, uint64_t src1) {
+    switch (op) {
+      case ATOMIC_OP_AND: return old & src0;
+      case ATOMIC_OP_OR: return old | src0;
+      case ATOMIC_OP_XOR: return old ^ src0;
+      case ATOMIC_OP_XCHG: return src0;
+      case ATOMIC_OP_INC: return old + 1;
+      case ATOMIC_OP_DEC:
+      case ATOMIC_OP_PREDEC: return old - 1;
+      case ATOMIC_OP_ADD: return old + src0;
+      case ATOMIC_OP_SUB: return old - src0;
+      case ATOMIC_OP_IMAX: return sval(type, old) > sval(type, src0) ? old : src0;
+      case ATOMIC_OP_IMIN: return sval(type, old) < sval(type, src0) ? old : src0;
+      case ATOMIC_OP_UMAX: return uval(type, old) > uval(type, src0) ? old : src0;
+      case ATOMIC_OP_UMIN: return uval(type, old) < uval(type, src0) ? old : src0;
+      case ATOMIC_OP_CMPXCHG: return uval(type, old) == uval(type, src0) ? src1 : old;
+      case ATOMIC_OP_FADD: return fromFloat(TYPE_FLOAT, fval(TYPE_FLOAT, old) + fval(TYPE_FLOAT, src0));
+      case ATOMIC_OP_FSUB: return fromFloat(TYPE_FLOAT, fval(TYPE_FLOAT, old) - fval(TYPE_FLOAT, src0));
+      default: GBE_ASSERT(0); return old;
+    }
+  }
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Threads and memory
+  ///////////////////////////////////////////////////////////////////////////
+
+  struct Interpreter::Thread {
+    vector<uint64_t> regs;     //!< Register values, simdWidth lanes per register
+    uint32_t pc[maxLaneNum];   //!< Next instruction of each lane
+    uint32_t localID[maxLaneNum];
+    uint64_t insnNum;          //!< SIMD instructions since the last barrier
+    bool waiting;              //!< Stopped at a barrier
+    bool done;
+    Thread(void) : insnNum(0), waiting(false), done(false) {}
+  };
+
+  struct Interpreter::Memory {
+    struct Region {
+      uint64_t base, size;
+      char *data;
+    };
+    vector<Region> regions;
+    vector<char> slm;
+
+    uint64_t add(uint64_t base, char *data, uint64_t size) {
+      regions.push_back({base, size, data});
+      return ALIGN(base + size + regionGap, regionGap);
+    }
+
+    char *translate(AddressSpace space, uint64_t addr, uint32_t size) {
+      if (space == MEM_LOCAL)
+        return addr + size <= slm.size() ? &slm[addr] : nullptr;
+      for (const auto &region : regions)
+        if (addr >= region.base && addr + size <= region.base + region.size)
+          return region.data + (addr - region.base);
+      // Generic pointers may point to the SLM
+      if ((space == MEM_GENERIC || space == MEM_MIXED) && addr + size <= slm.size())
+        return &slm[addr];
+      return nullptr;
+    }
+  };
+
+  Interpreter::Interpreter(const Unit &unit, const Function &fn) :
+    unit(unit), fn(fn), simdWidth(16), insnNum(0), maxInsnNum(0), threadNum(0),
+    workItemNum(0), barrierNum(0), barrierImbalance(0), barrierMaxImbalance(0), barrierWait(0)
+  {
+    // Lay the blocks out like the backend does. Lanes disabled by an IF
+    // resume after the matching ELSE or ENDIF
+    labelPos.resize(fn.labelNum(), ~0u);
+    fn.foreachBlock([&](const BasicBlock &bb) {
+      labelPos[bb.getLabelIndex()] = insns.size();
+      for (const auto &insn : bb) {
+        insns.push_back(&insn);
+        if (insn.getOpcode() == OP_ENDIF)
+          labelPos[cast<BranchInstruction>(insn).getLabelIndex()] = insns.size();
+        else if (insn.getOpcode() == OP_ELSE)
+          labelPos[bb.thisElseLabel] = insns.size();
+      }
+    });
+    stats.resize(insns.size());
+  }
+
+  Interpreter::~Interpreter(void) {}
+
+  bool Interpreter::run(const InterpreterLaunch &launch, vector<InterpreterArg> &args, std::string &error)
+  {
+    simdWidth = launch.simdWidth;
+    maxInsnNum = insnNum + launch.maxInsnNum;
+    if (simdWidth == 0 || simdWidth > maxLaneNum) {
+      error = "unsupported SIMD width";
+      return false;
+    }
+    if (args.size() != fn.argNum()) {
+      error = "kernel " + fn.getName() + " takes " + std::to_string(fn.argNum()) + " arguments";
+      return false;
+    }
+
+    // Program scope constants are addressed from 0 in OpenCL 1.2 programs
+    const bool legacy = unit.getOclVersion() < 200;
+    Memory mem;
+    vector<char> constants(unit.getConstantSet().getDataSize());
+    if (!constants.empty())
+      unit.getConstantSet().getData(constants.data());
+    const uint64_t constantBase = legacy ? 0 : regionGap;
+    uint64_t next = mem.add(constantBase, constants.data(), constants.size());
+
+    vector<uint64_t> argValues(args.size(), 0);
+    uint32_t slmSize = fn.getSLMSize();
+    for (uint32_t argID = 0; argID < args.size(); ++argID) {
+      const FunctionArgument &arg = fn.getArg(argID);
+      InterpreterArg &value = args[argID];
+      switch (arg.type) {
+        case FunctionArgument::GLOBAL_POINTER:
+        case FunctionArgument::CONSTANT_POINTER:
+          argValues[argID] = next;
+          next = mem.add(next, value.data.data(), value.data.size());
+          break;
+        case FunctionArgument::LOCAL_POINTER:
+          slmSize = ALIGN(slmSize, std::max(arg.align, 4u));
+          argValues[argID] = slmSize;
+          slmSize += value.localSize;
+          break;
+        case FunctionArgument::VALUE:
+        case FunctionArgument::STRUCTURE:
+          memcpy(&argValues[argID], value.data.data(), std::min<size_t>(value.data.size(), 8));
+          break;
+        default:
+          error = "argument " + arg.name + ": images, samplers and pipes are not supported";
+          return false;
+      }
+    }
+
+    uint32_t groupNum[3], groupItemNum = 1;
+    for (uint32_t dim = 0; dim < 3; ++dim) {
+      groupNum[dim] = (launch.globalSize[dim] + launch.localSize[dim] - 1) / launch.localSize[dim];
+      groupItemNum *= launch.localSize[dim];
+    }
+    const uint32_t groupThreadNum = (groupItemNum + simdWidth - 1) / simdWidth;
+    const uint64_t stackSize = fn.getStackSize();
+    vector<char> stack(stackSize * groupThreadNum * simdWidth);
+    const uint64_t stackBase = next;
+    next = mem.add(stackBase, stack.data(), stack.size());
+    if (unit.getPointerSize() == POINTER_32_BITS && next > 0xffffffffull) {
+      error = "the buffers do not fit in a 32 bits address space";
+      return false;
+    }
+
+    const uint32_t regNum = fn.regNum();
+    for (uint32_t gz = 0; gz < groupNum[2]; ++gz)
+    for (uint32_t gy = 0; gy < groupNum[1]; ++gy)
+    for (uint32_t gx = 0; gx < groupNum[0]; ++gx) {
+      const uint32_t group[3] = {gx, gy, gz};
+      uint32_t lsize[3], itemNum = 1;
+      for (uint32_t dim = 0; dim < 3; ++dim) {
+        lsize[dim] = std::min(launch.localSize[dim], launch.globalSize[dim] - group[dim] * launch.localSize[dim]);
+        itemNum *= lsize[dim];
+      }
+      const uint32_t threadN = (itemNum + simdWidth - 1) / simdWidth;
+      mem.slm.assign(slmSize, 0);
+
+      vector<Thread> threads(threadN);
+      for (uint32_t tid = 0; tid < threadN; ++tid) {
+        Thread &thread = threads[tid];
+        thread.regs.resize(regNum * simdWidth, 0);
+        auto set = [&](Register reg, uint32_t lane, uint64_t value) {
+          if (reg.value() < regNum)
+            thread.regs[reg.value() * simdWidth + lane] = value;
+        };
+        for (uint32_t lane = 0; lane < simdWidth; ++lane) {
+          const uint32_t id = tid * simdWidth + lane;
+          thread.localID[lane] = id;
+          thread.pc[lane] = id < itemNum ? 0 : insns.size();
+          const uint32_t lid[3] = {id % lsize[0], id / lsize[0] % lsize[1], id / (lsize[0] * lsize[1])};
+          for (uint32_t dim = 0; dim < 3; ++dim) {
+            set(Register(ocl::lid0.value() + dim), lane, lid[dim]);
+            set(Register(ocl::groupid0.value() + dim), lane, group[dim]);
+            set(Register(ocl::numgroup0.value() + dim), lane, groupNum[dim]);
+            set(Register(ocl::lsize0.value() + dim), lane, lsize[dim]);
+            set(Register(ocl::enqlsize0.value() + dim), lane, launch.localSize[dim]);
+            set(Register(ocl::gsize0.value() + dim), lane, launch.globalSize[dim]);
+            set(Register(ocl::goffset0.value() + dim), lane, launch.globalOffset[dim]);
+          }
+          const uint64_t laneStack = stackSize * id;
+          set(ocl::stackptr, lane, legacy ? stackBase + laneStack : laneStack);
+          set(ocl::stackbuffer, lane, stackBase);
+          set(ocl::stacksize, lane, stack.size());
+          set(ocl::threadn, lane, threadN);
+          set(ocl::threadid, lane, tid);
+          set(ocl::workdim, lane, launch.workDim);
+          set(ocl::zero, lane, 0);
+          set(ocl::one, lane, 1);
+          set(ocl::constant_addrspace, lane, constantBase);
+          for (uint32_t argID = 0; argID < args.size(); ++argID)
+            set(fn.getArg(argID).reg, lane, argValues[argID]);
+          for (const auto &pushed : fn.getPushMap()) {
+            const vector<char> &data = args[pushed.second.argID].data;
+            const uint32_t offset = pushed.second.offset;
+            const uint32_t size = getFamilySize(fn.getRegisterFamily(pushed.first));
+            uint64_t value = 0;
+            if (offset < data.size())
+              memcpy(&value, &data[offset], std::min<size_t>(size, data.size() - offset));
+            set(pushed.first, lane, value);
+          }
+        }
+      }
+      threadNum += threadN;
+      workItemNum += itemNum;
+
+      // Threads run until they all wait at the barrier, then are released
+      for (;;) {
+        for (auto &thread : threads)
+          if (!thread.done && !thread.waiting && !runThread(thread, mem, error))
+            return false;
+        uint64_t minInsn = ~0ull, maxInsn = 0, waiting = 0;
+        for (const auto &thread : threads) {
+          if (!thread.waiting)
+            continue;
+          minInsn = std::min(minInsn, thread.insnNum);
+          maxInsn = std::max(maxInsn, thread.insnNum);
+          waiting++;
+        }
+        if (waiting == 0)
+          break;
+        barrierNum++;
+        barrierImbalance += maxInsn - minInsn;
+        barrierMaxImbalance = std::max(barrierMaxImbalance, maxInsn - minInsn);
+        for (auto &thread : threads) {
+          if (!thread.waiting)
+            continue;
+          barrierWait += maxInsn - thread.insnNum;
+          thread.insnNum = 0;
+          thread.waiting = false;
+        }
+      }
+    }
+    return true;
+  }
+
+  bool Interpreter::runThread(Thread &thread, Memory &mem, std::string &error)
+  {
+    const uint32_t end = insns.size();
+    for (;;) {
+      // Lanes reconverge on the lowest instruction
+      uint32_t pc = end, mask = 0, running = 0;
+      for (uint32_t lane = 0; lane < simdWidth; ++lane) {
+        if (thread.pc[lane] >= end)
+          continue;
+        running |= 1u << lane;
+        if (thread.pc[lane] < pc) {
+          pc = thread.pc[lane];
+          mask = 0;
+        }
+        if (thread.pc[lane] == pc)
+          mask |= 1u << lane;
+      }
+      if (pc == end) {
+        thread.done = true;
+        return true;
+      }
+
+      if (insns[pc]->getOpcode() != OP_LABEL) {
+        InsnStats &insnStats = stats[pc];
+        insnStats.execNum++;
+        insnStats.laneNum += __builtin_popcount(mask);
+        if (mask != running)
+          insnStats.divergentNum++;
+        thread.insnNum++;
+        if (++insnNum > maxInsnNum) {
+          error = "instruction limit reached, endless loop?";
+          return false;
+        }
+      }
+      if (!execute(thread, mem, pc, mask, error))
+        return false;
+      if (thread.waiting)
+        return true;
+    }
+  }
+
+  void Interpreter::recordAccess(InsnStats &insnStats, AddressSpace space, const uint64_t *addr,
+                                 uint32_t mask, uint32_t size) const
+  {
+    set<uint64_t> lines, dwords;
+    FOR_EACH_LANE(lane, mask) {
+      for (uint64_t line = addr[lane] / cacheLineSize; line <= (addr[lane] + size - 1) / cacheLineSize; ++line)
+        lines.insert(line);
+      if (space == MEM_LOCAL)
+        for (uint64_t dw = addr[lane] / 4; dw <= (addr[lane] + size - 1) / 4; ++dw)
+          dwords.insert(dw);
+    }
+    insnStats.lineNum += lines.size();
+    if (space != MEM_LOCAL)
+      return;
+
+    // Distinct dwords of a bank are read one per cycle, same dwords broadcast
+    uint32_t perBank[slmBankNum] = {0}, cycles = 0;
+    for (auto dw : dwords)
+      cycles = std::max(cycles, ++perBank[dw % slmBankNum]);
+    const uint32_t ideal = (dwords.size() + slmBankNum - 1) / slmBankNum;
+    insnStats.conflictNum += cycles - ideal;
+  }
+
+  bool Interpreter::execute(Thread &thread, Memory &mem, uint32_t pc, uint32_t mask, std::string &error)
+  {
+    const Instruction &insn = *insns[pc];
+    const Opcode op = insn.getOpcode();
+    auto lanes = [&](Register reg) { return &thread.regs[reg.value() * simdWidth]; };
+    auto fail = [&](const char *why) {
+      std::ostringstream out;
+      const uint32_t lane = __builtin_ctz(mask);
+      out << why << " at instruction " << pc << " (" << insn << "), local id " << thread.localID[lane];
+      error = out.str();
+      return false;
+    };
+    uint32_t nextPC = pc + 1;
+
+    switch (op) {
+      case OP_LABEL:
+      case OP_ENDIF:
+      case OP_WAIT:
+      case OP_CALC_TIMESTAMP:
+      case OP_STORE_PROFILING:
+      case OP_PREFETCH:
+        break;
+      case OP_PRINTF:
+        if (insn.getDstNum())
+          FOR_EACH_LANE(lane, mask) lanes(insn.getDst())[lane] = 0;
+        break;
+      case OP_SIMD_SIZE:
+        FOR_EACH_LANE(lane, mask) lanes(insn.getDst())[lane] = simdWidth;
+        break;
+      case OP_SIMD_ID:
+        FOR_EACH_LANE(lane, mask) lanes(insn.getDst())[lane] = lane;
+        break;
+      case OP_SIMD_ANY:
+      case OP_SIMD_ALL: {
+        const uint64_t *src = lanes(insn.getSrc(0));
+        bool any = false, all = true;
+        FOR_EACH_LANE(lane, mask) {
+          any = any || (src[lane] & 1);
+          all = all && (src[lane] & 1);
+        }
+        FOR_EACH_LANE(lane, mask) lanes(insn.getDst())[lane] = op == OP_SIMD_ANY ? any : all;
+        break;
+      }
+      case OP_MOV: case OP_COS: case OP_SIN: case OP_LOG: case OP_EXP: case OP_SQR:
+      case OP_RSQ: case OP_RCP: case OP_ABS: case OP_RNDD: case OP_RNDE: case OP_RNDU:
+      case OP_RNDZ: case OP_BSWAP: case OP_FBH: case OP_FBL: case OP_CBIT: case OP_LZD:
+      case OP_BFREV: {
+        const Type type = cast<UnaryInstruction>(insn).getType();
+        const uint64_t *src = lanes(insn.getSrc(0));
+        uint64_t *dst = lanes(insn.getDst());
+        FOR_EACH_LANE(lane, mask) dst[lane] = evalUnary(op, type, src[lane]);
+        break;
+      }
+      case OP_POW: case OP_MUL: case OP_ADD: case OP_ADDSAT: case OP_SUB: case OP_SUBSAT:
+      case OP_DIV: case OP_REM: case OP_SHL: case OP_SHR: case OP_ASR: case OP_OR:
+      case OP_XOR: case OP_AND: case OP_MUL_HI: case OP_I64_MUL_HI: case OP_HADD:
+      case OP_RHADD: case OP_I64HADD: case OP_I64RHADD: case OP_UPSAMPLE_SHORT:
+      case OP_UPSAMPLE_INT: case OP_UPSAMPLE_LONG: {
+        const Type type = cast<BinaryInstruction>(insn).getType();
+        const uint64_t *src0 = lanes(insn.getSrc(0)), *src1 = lanes(insn.getSrc(1));
+        uint64_t *dst = lanes(insn.getDst());
+        FOR_EACH_LANE(lane, mask) dst[lane] = evalBinary(op, type, src0[lane], src1[lane]);
+        break;
+      }
+      case OP_MAD:
+      case OP_LRP: {
+        const Type type = cast<TernaryInstruction>(insn).getType();
+        const uint64_t *src0 = lanes(insn.getSrc(0)), *src1 = lanes(insn.getSrc(1));
+        const uint64_t *src2 = lanes(insn.getSrc(2));
+        uint64_t *dst = lanes(insn.getDst());
+        FOR_EACH_LANE(lane, mask) {
+          if (op == OP_LRP) {
+            const double a = fval(type, src0[lane]);
+            dst[lane] = fromFloat(type, a * fval(type, src1[lane]) + (1.0 - a) * fval(type, src2[lane]));
+          } else if (isFloatType(type))
+            dst[lane] = fromFloat(type, fval(type, src0[lane]) * fval(type, src1[lane]) + fval(type, src2[lane]));
+          else
+            dst[lane] = uval(type, src0[lane] * src1[lane] + src2[lane]);
+        }
+        break;
+      }
+      case OP_SEL: {
+        const Type type = cast<SelectInstruction>(insn).getType();
+        const uint64_t *pred = lanes(insn.getSrc(0));
+        const uint64_t *src0 = lanes(insn.getSrc(SelectInstruction::src0Index));
+        const uint64_t *src1 = lanes(insn.getSrc(SelectInstruction::src1Index));
+        uint64_t *dst = lanes(insn.getDst());
+        FOR_EACH_LANE(lane, mask) dst[lane] = uval(type, (pred[lane] & 1) ? src0[lane] : src1[lane]);
+        break;
+      }
+      case OP_EQ: case OP_NE: case OP_LE: case OP_LT: case OP_GE: case OP_GT: case OP_ORD: {
+        const Type type = cast<CompareInstruction>(insn).getType();
+        const uint64_t *src0 = lanes(insn.getSrc(0)), *src1 = lanes(insn.getSrc(1));
+        uint64_t *dst = lanes(insn.getDst());
+        FOR_EACH_LANE(lane, mask) dst[lane] = evalCompare(op, type, src0[lane], src1[lane]);
+        break;
+      }
+      case OP_CVT:
+      case OP_SAT_CVT:
+      case OP_F16TO32:
+      case OP_F32TO16: {
+        const ConvertInstruction &cvt = cast<ConvertInstruction>(insn);
+        const Type dstType = cvt.getDstType(), srcType = cvt.getSrcType();
+        const uint64_t *src = lanes(insn.getSrc(0));
+        uint64_t *dst = lanes(insn.getDst());
+        FOR_EACH_LANE(lane, mask) {
+          if (op == OP_F16TO32)
+            dst[lane] = fromFloat(TYPE_FLOAT, halfToFloat(uint16_t(src[lane])));
+          else if (op == OP_F32TO16)
+            dst[lane] = floatToHalf(float(fval(TYPE_FLOAT, src[lane])));
+          else
+            dst[lane] = evalConvert(op, dstType, srcType, src[lane]);
+        }
+        break;
+      }
+      case OP_BITCAST: {
+        const BitCastInstruction &bitcast = cast<BitCastInstruction>(insn);
+        const uint32_t srcSize = getFamilySize(getFamily(bitcast.getSrcType()));
+        const uint32_t dstSize = getFamilySize(getFamily(bitcast.getDstType()));
+        char bytes[Instruction::MAX_SRC_NUM * 8];
+        FOR_EACH_LANE(lane, mask) {
+          for (uint32_t i = 0; i < insn.getSrcNum(); ++i)
+            memcpy(bytes + i * srcSize, &lanes(insn.getSrc(i))[lane], srcSize);
+          for (uint32_t i = 0; i < insn.getDstNum(); ++i) {
+            uint64_t value = 0;
+            memcpy(&value, bytes + i * dstSize, dstSize);
+            lanes(insn.getDst(i))[lane] = value;
+          }
+        }
+        break;
+      }
+      case OP_SIMD_SHUFFLE: {
+        const Type type = cast<SimdShuffleInstruction>(insn).getType();
+        const uint64_t *src0 = lanes(insn.getSrc(0)), *src1 = lanes(insn.getSrc(1));
+        uint64_t *dst = lanes(insn.getDst());
+        uint64_t values[maxLaneNum];
+        FOR_EACH_LANE(lane, mask) values[lane] = uval(type, src0[uval(TYPE_U32, src1[lane]) % simdWidth]);
+        FOR_EACH_LANE(lane, mask) dst[lane] = values[lane];
+        break;
+      }
+      case OP_LOADI: {
+        const LoadImmInstruction &loadi = cast<LoadImmInstruction>(insn);
+        const Immediate &imm = loadi.getImmediate();
+        uint64_t value;
+        switch (loadi.getType()) {
+          case TYPE_FLOAT: value = fromFloat(TYPE_FLOAT, imm.getFloatValue()); break;
+          case TYPE_DOUBLE: value = fromFloat(TYPE_DOUBLE, imm.getDoubleValue()); break;
+          case TYPE_HALF: value = imm.getHalfValue().getVal(); break;
+          case TYPE_LARGE_INT: return fail("unsupported immediate");
+          default: value = uval(loadi.getType(), imm.getUnsignedIntegerValue());
+        }
+        FOR_EACH_LANE(lane, mask) lanes(insn.getDst())[lane] = value;
+        break;
+      }
+      case OP_LOAD:
+      case OP_STORE: {
+        const MemInstruction &memInsn = reinterpret_cast<const MemInstruction &>(insn);
+        const bool load = op == OP_LOAD;
+        if (load ? cast<LoadInstruction>(insn).isBlock() : cast<StoreInstruction>(insn).isBlock())
+          return fail("block reads and writes are not supported");
+        const Type type = memInsn.getValueType();
+        const uint32_t size = getFamilySize(getFamily(type));
+        const uint32_t valueNum = load ? cast<LoadInstruction>(insn).getValueNum()
+                                       : cast<StoreInstruction>(insn).getValueNum();
+        const AddressSpace space = memInsn.getAddressSpace();
+        const uint64_t *addr = lanes(memInsn.getAddressRegister());
+        recordAccess(stats[pc], space, addr, mask, size * valueNum);
+        FOR_EACH_LANE(lane, mask) {
+          char *data = mem.translate(space, addr[lane], size * valueNum);
+          if (data == nullptr)
+            return fail("out of bounds access");
+          for (uint32_t i = 0; i < valueNum; ++i) {
+            if (load) {
+              uint64_t value = 0;
+              memcpy(&value, data + i * size, size);
+              lanes(cast<LoadInstruction>(insn).getValue(i))[lane] = value;
+            } else
+              memcpy(data + i * size, &lanes(cast<StoreInstruction>(insn).getValue(i))[lane], size);
+          }
+        }
+        break;
+      }
+      case OP_ATOMIC: {
+        const AtomicInstruction &atomic = cast<AtomicInstruction>(insn);
+        const AtomicOps atomicOp = atomic.getAtomicOpcode();
+        const Type type = atomic.getValueType();
+        const uint32_t size = getFamilySize(getFamily(type));
+        const AddressSpace space = atomic.getAddressSpace();
+        const uint64_t *addr = lanes(atomic.getAddressRegister());
+        const uint32_t payloadNum = atomicOp == ATOMIC_OP_INC || atomicOp == ATOMIC_OP_DEC ? 0 :
+                                    atomicOp == ATOMIC_OP_CMPXCHG ? 2 : 1;
+        recordAccess(stats[pc], space, addr, mask, size);
+        // Lanes are serialized in order
+        FOR_EACH_LANE(lane, mask) {
+          char *data = mem.translate(space, addr[lane], size);
+          if (data == nullptr)
+            return fail("out of bounds atomic");
+          uint64_t old = 0;
+          memcpy(&old, data, size);
+          const uint64_t src0 = payloadNum > 0 ? lanes(insn.getSrc(1))[lane] : 0;
+          const uint64_t src1 = payloadNum > 1 ? lanes(insn.getSrc(2))[lane] : 0;
+          const uint64_t value = evalAtomic(atomicOp, type, old, src0, src1);
+          memcpy(data, &value, size);
+          lanes(insn.getDst())[lane] = old;
+        }
+        break;
+      }
+      case OP_SYNC:
+        if (cast<SyncInstruction>(insn).getParameters() & SYNC_WORKGROUP_EXEC)
+          thread.waiting = true;
+        break;
+      case OP_BRA:
+      case OP_IF:
+      case OP_WHILE:
+      case OP_ELSE: {
+        const BranchInstruction &bra = cast<BranchInstruction>(insn);
+        const uint32_t target = labelPos[bra.getLabelIndex()];
+        if (target == ~0u)
+          return fail("unresolved label");
+        uint32_t taken = mask;
+        if (bra.isPredicated()) {
+          const uint64_t *pred = lanes(bra.getPredicateIndex());
+          taken = 0;
+          FOR_EACH_LANE(lane, mask)
+            if (bool(pred[lane] & 1) != bra.getInversePredicated())
+              taken |= 1u << lane;
+          // IF keeps the lanes whose predicate is set
+          if (op == OP_IF)
+            taken = mask & ~taken;
+        }
+        if (taken != 0 && taken != mask)
+          stats[pc].splitNum++;
+        FOR_EACH_LANE(lane, mask) thread.pc[lane] = (taken & (1u << lane)) ? target : pc + 1;
+        return true;
+      }
+      case OP_RET:
+        nextPC = insns.size();
+        break;
+      default:
+        return fail("unsupported instruction");
+    }
+
+    FOR_EACH_LANE(lane, mask) thread.pc[lane] = nextPC;
+    return true;
+  }
+
+  void Interpreter::outputStatistics(std::ostream &out) const
+  {
+    char line[256];
+    uint64_t execNum = 0, laneNum = 0, divergentNum = 0, splitNum = 0, branchNum = 0;
+    map<std::string, uint64_t> mix;
+    for (uint32_t pc = 0; pc < insns.size(); ++pc) {
+      const InsnStats &s = stats[pc];
+      const Opcode op = insns[pc]->getOpcode();
+      execNum += s.execNum;
+      laneNum += s.laneNum;
+      divergentNum += s.divergentNum;
+      if (op == OP_BRA || op == OP_IF || op == OP_WHILE) {
+        branchNum += s.execNum;
+        splitNum += s.splitNum;
+      }
+      if (s.execNum)
+        mix[opcodeName[op]] += s.execNum;
+    }
+
+    out << "Kernel " << fn.getName() << ": " << workItemNum << " work-items in "
+        << threadNum << " SIMD" << simdWidth << " threads" << std::endl;
+    if (execNum == 0)
+      return;
+    snprintf(line, sizeof(line), "  %" PRIu64 " instructions, lane utilization %.1f%%, "
+             "divergent %.1f%%, divergent branches %.1f%%\n", execNum,
+             100.0 * laneNum / (execNum * simdWidth), 100.0 * divergentNum / execNum,
+             branchNum ? 100.0 * splitNum / branchNum : 0.0);
+    out << line;
+    if (barrierNum) {
+      snprintf(line, sizeof(line), "  %" PRIu64 " barriers, imbalance %.1f avg %" PRIu64
+               " max instructions, %.1f%% of the thread time waiting\n", barrierNum,
+               double(barrierImbalance) / barrierNum, barrierMaxImbalance,
+               100.0 * barrierWait / (execNum + barrierWait));
+      out << line;
+    }
+
+    vector<std::pair<uint64_t, std::string>> sorted;
+    for (const auto &it : mix)
+      sorted.push_back(std::make_pair(it.second, it.first));
+    std::sort(sorted.rbegin(), sorted.rend());
+    out << "  instruction mix:" << std::endl;
+    for (const auto &it : sorted) {
+      snprintf(line, sizeof(line), "    %-16s %12" PRIu64 " %5.1f%%\n", it.second.c_str(),
+               it.first, 100.0 * it.first / execNum);
+      out << line;
+    }
+
+    out << "  per instruction (executions, lane utilization, lines or SLM conflicts per execution):"
+        << std::endl;
+    for (uint32_t pc = 0; pc < insns.size(); ++pc) {
+      const InsnStats &s = stats[pc];
+      if (s.execNum == 0)
+        continue;
+      const Instruction &insn = *insns[pc];
+      std::ostringstream text;
+      text << insn;
+      std::string memory;
+      if (insn.getOpcode() == OP_LOAD || insn.getOpcode() == OP_STORE || insn.getOpcode() == OP_ATOMIC) {
+        snprintf(line, sizeof(line), " lines %.2f", double(s.lineNum) / s.execNum);
+        memory = line;
+        if (reinterpret_cast<const MemInstruction &>(insn).getAddressSpace() == MEM_LOCAL) {
+          snprintf(line, sizeof(line), " conflicts %.2f", double(s.conflictNum) / s.execNum);
+          memory += line;
+        }
+      }
+      snprintf(line, sizeof(line), "    %5u %12" PRIu64 " %5.1f%%%s  ", pc, s.execNum,
+               100.0 * s.laneNum / (s.execNum * simdWidth), memory.c_str());
+      out << line << text.str() << std::endl;
+    }
+  }
+
+} /* namespace ir */
+} /* namespace gbe */
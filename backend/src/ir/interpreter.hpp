@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file interpreter.hpp
+ *
+ * Runs a Gen IR function on the CPU for a given NDRange and records dynamic
+ * execution statistics. Lanes are grouped into SIMD threads like the Gen
+ * backend does and diverged lanes reconverge on the lowest instruction
+ * (the same policy as the backend block IP), so the masks seen here are the
+ * ones the hardware would execute with.
+ */
+#ifndef __GBE_IR_INTERPRETER_HPP__
+#define __GBE_IR_INTERPRETER_HPP__
+
+#include <ostream>
+#include <string>
+#include "sys/vector.hpp"
+#include "ir/function.hpp"
+#include "ir/unit.hpp"
+
+namespace gbe {
+namespace ir {
+
+  /*! Value of a kernel argument for an interpreted launch */
+  struct InterpreterArg {
+    vector<char> data;  //!< Buffer contents, or the bytes of a value / structure
+    uint32_t localSize; //!< Size of a __local buffer
+    InterpreterArg(void) : localSize(0) {}
+  };
+
+  /*! NDRange of an interpreted launch */
+  struct InterpreterLaunch {
+    uint32_t workDim;
+    uint32_t globalSize[3];
+    uint32_t localSize[3];
+    uint32_t globalOffset[3];
+    uint32_t simdWidth;  //!< Lanes per hardware thread (8 or 16)
+    uint64_t maxInsnNum; //!< Gives up past this number of SIMD instructions
+    InterpreterLaunch(void) : workDim(1), simdWidth(16), maxInsnNum(1ull << 32) {
+      for (uint32_t i = 0; i < 3; ++i) {
+        globalSize[i] = localSize[i] = 1;
+        globalOffset[i] = 0;
+      }
+    }
+  };
+
+  /*! Gen IR interpreter */
+  class Interpreter : public NonCopyable
+  {
+  public:
+    Interpreter(const Unit &unit, const Function &fn);
+    ~Interpreter(void);
+    /*! Run the launch. Buffers of args are updated in place */
+    bool run(const InterpreterLaunch &launch, vector<InterpreterArg> &args, std::string &error);
+    /*! Output the statistics gathered by the previous runs */
+    void outputStatistics(std::ostream &out) const;
+
+    /*! Dynamic statistics of one instruction */
+    struct InsnStats {
+      uint64_t execNum;      //!< SIMD executions
+      uint64_t laneNum;      //!< Active lanes summed over the executions
+      uint64_t divergentNum; //!< Executions with fewer active than running lanes
+      uint64_t splitNum;     //!< Branch executions which split the lanes
+      uint64_t lineNum;      //!< Distinct 64B lines touched by memory accesses
+      uint64_t conflictNum;  //!< Extra SLM cycles caused by bank conflicts
+      InsnStats(void) : execNum(0), laneNum(0), divergentNum(0), splitNum(0),
+                        lineNum(0), conflictNum(0) {}
+    };
+
+  private:
+    struct Thread;
+    struct Memory;
+    /*! Run a thread until it retires or reaches a barrier */
+    bool runThread(Thread &thread, Memory &mem, std::string &error);
+    /*! Execute the instruction at pc with the given lanes */
+    bool execute(Thread &thread, Memory &mem, uint32_t pc, uint32_t mask, std::string &error);
+    /*! Record the lines and bank conflicts of a memory access */
+    void recordAccess(InsnStats &stats, AddressSpace space, const uint64_t *addr,
+                      uint32_t mask, uint32_t size) const;
+    const Unit &unit;
+    const Function &fn;
+    vector<const Instruction *> insns; //!< Instructions in layout order
+    vector<uint32_t> labelPos;         //!< Label to instruction index
+    vector<InsnStats> stats;           //!< Per instruction
+    uint32_t simdWidth;
+    uint64_t insnNum;                  //!< SIMD instructions run so far
+    uint64_t maxInsnNum;
+    uint64_t threadNum;                //!< Hardware threads run
+    uint64_t workItemNum;
+    uint64_t barrierNum;               //!< Work group barriers released
+    uint64_t barrierImbalance;         //!< Sum of the max - min instructions before each barrier
+    uint64_t barrierMaxImbalance;
+    uint64_t barrierWait;              //!< Instruction slots the threads waited at barriers
+    GBE_CLASS(Interpreter);
+  };
+
+} /* namespace ir */
+} /* namespace gbe */
+
+#endif /* __GBE_IR_INTERPRETER_HPP__ */
@@ -0,0 +1,416 @@
+/*
+ * Copyright © 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file licm.cpp
+ */
+
+#include "ir/licm.hpp"
+#include "ir/function.hpp"
+#include "ir/profile.hpp"
+#include "sys/set.hpp"
+#include "sys/vector.hpp"
+
+namespace gbe {
+namespace ir {
+
+  /*! The payload and the curbe are written before the kernel starts, but
+   *  these special registers are written by the generated code */
+  static bool isVariantSpecialRegister(Register reg) {
+    return reg == ocl::stackptr || reg == ocl::blockip || reg == ocl::dwblockip ||
+           reg == ocl::barrierid || reg == ocl::retVal ||
+           (reg >= ocl::profilingts0 && reg <= ocl::profilingts4);
+  }
+
+  /*! Moves the invariant instructions of the loops of one function */
+  class LoopInvariantHoister
+  {
+  public:
+    /*! Count the definitions and uses of all the registers */
+    LoopInvariantHoister(Function &fn);
+    /*! Process the loops from the innermost ones */
+    void hoist(void);
+  private:
+    /*! Find the body and the preheader of a single entry loop */
+    bool findLoop(const Loop &loop);
+    /*! Single definition LOADI */
+    bool isImmediate(Register reg) const;
+    /*! Not written in the current loop */
+    bool isInvariant(Register reg) const;
+    /*! Pure ALU instruction of the loop whose sources are invariant */
+    bool isInvariant(const Instruction &insn) const;
+    /*! Move the invariant instruction at the end of the preheader */
+    void moveToPreheader(Instruction &insn);
+    /*! Replace a (iv * factor) or (iv << factor) by an induction variable */
+    bool reduceStrength(Instruction &insn);
+    /*! iv is "MOV iv, copy" in the header and the only write of copy in the
+     *  loop is "MOV copy, next" with "ADD next, iv, step" */
+    bool findInduction(Register iv, Register &copy, Register &step, BasicBlock *&latch) const;
+    /*! Load (step * factor) or (step << factor) when both are immediates */
+    bool loadConstantDelta(Opcode opcode, Type type, Register step, Register factor, Register delta);
+    /*! Register with the value of reg at the preheader insertion point */
+    Register getPreheaderValue(Register reg);
+    /*! Last instruction before the branch of the block */
+    static Instruction *getInsertPoint(BasicBlock &bb);
+    /*! Insert the instruction after prev and update the definitions */
+    Instruction *insert(const Instruction &insn, Instruction *prev);
+    /*! Remove one use and the immediate when it is not used anymore */
+    void dropUse(Register reg);
+    /*! Allocate a register of the same family */
+    Register newRegister(Register like);
+    Function &fn;
+    vector<uint32_t> defNum;         //!< Number of writes per register
+    vector<uint32_t> useNum;         //!< Number of reads per register
+    vector<Instruction*> defInsn;    //!< Last write of each register
+    set<const BasicBlock*> body;     //!< Blocks of the current loop
+    set<Register> loopDefs;          //!< Registers written in the current loop
+    BasicBlock *header;              //!< Entry block of the current loop
+    BasicBlock *preheader;           //!< Only predecessor outside the loop
+    Instruction *insertPoint;        //!< Where to append in the preheader
+  };
+
+  LoopInvariantHoister::LoopInvariantHoister(Function &fn) :
+    fn(fn), header(NULL), preheader(NULL), insertPoint(NULL)
+  {
+    const uint32_t regNum = fn.regNum();
+    defNum.resize(regNum, 0);
+    useNum.resize(regNum, 0);
+    defInsn.resize(regNum, NULL);
+    fn.foreachInstruction([&](Instruction &insn) {
+      for (uint32_t dstID = 0; dstID < insn.getDstNum(); ++dstID) {
+        const Register dst = insn.getDst(dstID);
+        defNum[dst]++;
+        defInsn[dst] = &insn;
+      }
+      for (uint32_t srcID = 0; srcID < insn.getSrcNum(); ++srcID)
+        useNum[insn.getSrc(srcID)]++;
+    });
+  }
+
+  bool LoopInvariantHoister::findLoop(const Loop &loop) {
+    set<LabelIndex> labels;
+    for (auto label : loop.bbs) labels.insert(label);
+
+    // The latches are the header predecessors in the loop, all the other
+    // blocks reach one of them without going through the header
+    vector<const BasicBlock*> stack;
+    header = &fn.getBlock(loop.bbs[0]);
+    preheader = NULL;
+    body.clear();
+    body.insert(header);
+    bool hasLatch = false;
+    for (auto pred : header->getPredecessorSet()) {
+      if (labels.contains(pred->getLabelIndex())) {
+        hasLatch = true;
+        if (body.insert(pred).second) stack.push_back(pred);
+      } else if (preheader != NULL)
+        return false;
+      else
+        preheader = pred;
+    }
+    if (preheader == NULL || hasLatch == false)
+      return false;
+    while (stack.empty() == false) {
+      const BasicBlock *bb = stack.back();
+      stack.pop_back();
+      for (auto pred : bb->getPredecessorSet()) {
+        // Another entry than the header
+        if (labels.contains(pred->getLabelIndex()) == false)
+          return false;
+        if (body.insert(pred).second) stack.push_back(pred);
+      }
+    }
+
+    loopDefs.clear();
+    for (auto bb : body)
+      for (const auto &insn : *bb)
+        for (uint32_t dstID = 0; dstID < insn.getDstNum(); ++dstID)
+          loopDefs.insert(insn.getDst(dstID));
+    insertPoint = getInsertPoint(*preheader);
+    return true;
+  }
+
+  bool LoopInvariantHoister::isImmediate(Register reg) const {
+    return defNum[reg] == 1 && defInsn[reg]->getOpcode() == OP_LOADI;
+  }
+
+  bool LoopInvariantHoister::isInvariant(Register reg) const {
+    return loopDefs.contains(reg) == false && isVariantSpecialRegister(reg) == false;
+  }
+
+  bool LoopInvariantHoister::isInvariant(const Instruction &insn) const {
+    switch (insn.getOpcode()) {
+      case OP_MOV: case OP_CVT:
+      case OP_ADD: case OP_SUB: case OP_MUL:
+      case OP_SHL: case OP_SHR: case OP_ASR:
+      case OP_AND: case OP_OR: case OP_XOR:
+        break;
+      default:
+        return false;
+    }
+    // The flags are not values we can keep alive across the loop
+    const Register dst = insn.getDst(0);
+    if (defNum[dst] != 1 || dst < ocl::regNum || fn.getRegisterFamily(dst) == FAMILY_BOOL)
+      return false;
+    for (uint32_t srcID = 0; srcID < insn.getSrcNum(); ++srcID) {
+      const Register src = insn.getSrc(srcID);
+      if (fn.getRegisterFamily(src) == FAMILY_BOOL)
+        return false;
+      if (isInvariant(src) == false && isImmediate(src) == false)
+        return false;
+    }
+    return true;
+  }
+
+  Instruction *LoopInvariantHoister::getInsertPoint(BasicBlock &bb) {
+    Instruction *last = bb.getLastInstruction();
+    if (last->isMemberOf<BranchInstruction>())
+      return static_cast<Instruction*>(last->prev);
+    return last;
+  }
+
+  Instruction *LoopInvariantHoister::insert(const Instruction &insn, Instruction *prev) {
+    Instruction copy(insn), *inserted = NULL;
+    copy.insert(prev, &inserted);
+    inserted->setDBGInfo(insn.DBGInfo);
+    for (uint32_t dstID = 0; dstID < inserted->getDstNum(); ++dstID) {
+      const Register dst = inserted->getDst(dstID);
+      defNum[dst]++;
+      defInsn[dst] = inserted;
+    }
+    for (uint32_t srcID = 0; srcID < inserted->getSrcNum(); ++srcID)
+      useNum[inserted->getSrc(srcID)]++;
+    return inserted;
+  }
+
+  void LoopInvariantHoister::dropUse(Register reg) {
+    GBE_ASSERT(useNum[reg] > 0);
+    if (--useNum[reg] != 0 || isImmediate(reg) == false)
+      return;
+    Instruction *loadi = defInsn[reg];
+    defNum[reg] = 0;
+    defInsn[reg] = NULL;
+    loopDefs.erase(reg);
+    loadi->remove();
+  }
+
+  Register LoopInvariantHoister::newRegister(Register like) {
+    const Register reg = fn.newRegister(fn.getRegisterFamily(like));
+    defNum.push_back(0);
+    useNum.push_back(0);
+    defInsn.push_back(NULL);
+    return reg;
+  }
+
+  Register LoopInvariantHoister::getPreheaderValue(Register reg) {
+    // The instruction selection only folds the immediates loaded in the
+    // same block, so give each user its own copy
+    if (isImmediate(reg) == false)
+      return reg;
+    const Register imm = newRegister(reg);
+    Instruction loadi(*defInsn[reg]);
+    loadi.setDst(0, imm);
+    loadi.setDBGInfo(defInsn[reg]->DBGInfo);
+    insertPoint = insert(loadi, insertPoint);
+    return imm;
+  }
+
+  void LoopInvariantHoister::moveToPreheader(Instruction &insn) {
+    Instruction moved(insn);
+    for (uint32_t srcID = 0; srcID < insn.getSrcNum(); ++srcID)
+      moved.setSrc(srcID, getPreheaderValue(insn.getSrc(srcID)));
+    moved.setDBGInfo(insn.DBGInfo);
+    insertPoint = insert(moved, insertPoint);
+    for (uint32_t srcID = 0; srcID < insn.getSrcNum(); ++srcID)
+      dropUse(insn.getSrc(srcID));
+    const Register dst = insn.getDst(0);
+    defNum[dst]--;
+    loopDefs.erase(dst);
+    insn.remove();
+  }
+
+  bool LoopInvariantHoister::findInduction(Register iv, Register &copy, Register &step,
+                                           BasicBlock *&latch) const
+  {
+    if (defNum[iv] != 1 || loopDefs.contains(iv) == false)
+      return false;
+    const Instruction *phi = defInsn[iv];
+    if (phi->getOpcode() != OP_MOV || phi->getParent() != header)
+      return false;
+    copy = phi->getSrc(0);
+
+    // The only write of the copy in the loop is at the end of a latch
+    const Instruction *update = NULL;
+    for (auto bb : body)
+      for (const auto &insn : *bb)
+        for (uint32_t dstID = 0; dstID < insn.getDstNum(); ++dstID) {
+          if (insn.getDst(dstID) != copy) continue;
+          if (update != NULL) return false;
+          update = &insn;
+        }
+    if (update == NULL || update->getOpcode() != OP_MOV)
+      return false;
+    latch = const_cast<BasicBlock*>(update->getParent());
+    if (header->getPredecessorSet().contains(latch) == false)
+      return false;
+
+    // next = iv + step
+    const Register next = update->getSrc(0);
+    if (defNum[next] != 1 || loopDefs.contains(next) == false)
+      return false;
+    const Instruction *add = defInsn[next];
+    if (add->getOpcode() != OP_ADD)
+      return false;
+    if (add->getSrc(0) == iv)
+      step = add->getSrc(1);
+    else if (add->getSrc(1) == iv)
+      step = add->getSrc(0);
+    else
+      return false;
+    return isInvariant(step) || isImmediate(step);
+  }
+
+  bool LoopInvariantHoister::reduceStrength(Instruction &insn) {
+    const Opcode opcode = insn.getOpcode();
+    if (opcode != OP_MUL && opcode != OP_SHL)
+      return false;
+    const Type type = cast<BinaryInstruction>(insn).getType();
+    if (type != TYPE_S32 && type != TYPE_U32 && type != TYPE_S64 && type != TYPE_U64)
+      return false;
+    const Register dst = insn.getDst(0);
+    if (defNum[dst] != 1)
+      return false;
+
+    // Only the left source of a shift is an induction variable
+    const uint32_t ivNum = opcode == OP_MUL ? 2 : 1;
+    for (uint32_t ivID = 0; ivID < ivNum; ++ivID) {
+      const Register iv = insn.getSrc(ivID);
+      const Register factor = insn.getSrc(1 - ivID);
+      if (isInvariant(factor) == false && isImmediate(factor) == false)
+        continue;
+      Register copy, step;
+      BasicBlock *latch = NULL;
+      if (findInduction(iv, copy, step, latch) == false)
+        continue;
+
+      // The product follows the copy of the induction variable
+      const Register product = newRegister(dst);
+      const Register init = getPreheaderValue(factor);
+      insertPoint = insert(opcode == OP_MUL ? MUL(type, product, copy, init) :
+                                              SHL(type, product, copy, init),
+                           insertPoint);
+      const Register delta = newRegister(dst);
+      if (isImmediate(step) == false || isImmediate(factor) == false ||
+          loadConstantDelta(opcode, type, step, factor, delta) == false) {
+        const Register stepValue = getPreheaderValue(step);
+        const Register stepFactor = getPreheaderValue(factor);
+        insertPoint = insert(opcode == OP_MUL ? MUL(type, delta, stepValue, stepFactor) :
+                                                SHL(type, delta, stepValue, stepFactor),
+                             insertPoint);
+      }
+      insert(ADD(type, product, product, delta), getInsertPoint(*latch));
+
+      // Like the PHI copies, the product is written under different masks
+      preheader->definedPhiRegs.insert(product);
+      latch->definedPhiRegs.insert(product);
+
+      // The product is only updated at the end of the latch, so the loop
+      // can read it instead of the result. Not after the loop since the
+      // lanes leaving from the latch also update it
+      vector<std::pair<Instruction*, uint32_t>> uses;
+      fn.foreachBlock([&](BasicBlock &bb) {
+        if (body.contains(&bb) == false) return;
+        bb.foreach([&](Instruction &user) {
+          for (uint32_t srcID = 0; srcID < user.getSrcNum(); ++srcID)
+            if (user.getSrc(srcID) == dst)
+              uses.push_back(std::make_pair(&user, srcID));
+        });
+      });
+      if (uses.size() == useNum[dst]) {
+        for (auto use : uses)
+          use.first->setSrc(use.second, product);
+        useNum[product] += uses.size();
+        useNum[dst] = 0;
+        defInsn[dst] = NULL;
+      } else {
+        Instruction mov = MOV(type, dst, product);
+        mov.setDBGInfo(insn.DBGInfo);
+        insert(mov, &insn);
+      }
+      dropUse(iv);
+      dropUse(factor);
+      defNum[dst]--;
+      insn.remove();
+      return true;
+    }
+    return false;
+  }
+
+  bool LoopInvariantHoister::loadConstantDelta(Opcode opcode, Type type, Register step,
+                                              Register factor, Register delta)
+  {
+    const Instruction &stepInsn = *defInsn[step], &factorInsn = *defInsn[factor];
+    const Immediate stepImm = cast<LoadImmInstruction>(stepInsn).getImmediate();
+    const Immediate factorImm = cast<LoadImmInstruction>(factorInsn).getImmediate();
+    if (stepImm.getType() != type || factorImm.getType() != type)
+      return false;
+    // Gen masks the shift count, the host does not
+    if (opcode == OP_SHL &&
+        uint64_t(factorImm.getIntegerValue()) >= getFamilySize(getFamily(type)) * 8)
+      return false;
+    const Immediate imm(opcode == OP_MUL ? IMM_MUL : IMM_SHL, stepImm, factorImm, type);
+    Instruction loadi = LOADI(type, delta, fn.newImmediate(imm));
+    loadi.setDBGInfo(factorInsn.DBGInfo);
+    insertPoint = insert(loadi, insertPoint);
+    return true;
+  }
+
+  void LoopInvariantHoister::hoist(void) {
+    const vector<Loop*> &loops = fn.getLoops();
+    for (auto it = loops.rbegin(); it != loops.rend(); ++it) {
+      if (findLoop(**it) == false)
+        continue;
+
+      // Hoisting an instruction may make its users invariant
+      bool changed;
+      do {
+        changed = false;
+        fn.foreachBlock([&](BasicBlock &bb) {
+          if (body.contains(&bb) == false) return;
+          bb.foreach([&](Instruction &insn) {
+            if (isInvariant(insn) == false) return;
+            moveToPreheader(insn);
+            changed = true;
+          });
+        });
+      } while (changed);
+
+      fn.foreachBlock([&](BasicBlock &bb) {
+        if (body.contains(&bb) == false) return;
+        bb.foreach([&](Instruction &insn) { reduceStrength(insn); });
+      });
+    }
+  }
+
+  void hoistLoopInvariants(Function &fn) {
+    LoopInvariantHoister hoister(fn);
+    hoister.hoist();
+  }
+
+} /* namespace ir */
+} /* namespace gbe */
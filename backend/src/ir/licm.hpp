@@ -0,0 +1,63 @@
+/*
+ * Copyright © 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file licm.hpp
+ *  Loop invariant code motion on the Gen IR
+ */
+
+#ifndef __GBE_IR_LICM_HPP__
+#define __GBE_IR_LICM_HPP__
+
+namespace gbe {
+namespace ir {
+
+  // Structure to update
+  class Function;
+
+  /*! Move the loop invariant ALU instructions of the loops to their
+   *  preheaders and strength reduce the induction variable products. The
+   *  address computation of a kernel like:
+   *
+   *  for (int k = 0; k < n; k++)
+   *    sum += src[get_global_id(0) * stride + k];
+   *
+   *  reads the payload (local id, group id, local size, global offset) and
+   *  the curbe arguments which are never written in the function, so
+   *  get_global_id(0) * stride and the base address are computed once before
+   *  the loop. The (k * 4) byte offset is then computed as:
+   *
+   *  preheader:
+   *    MUL offset_copy, k_copy, 4
+   *    MUL delta, 1, 4
+   *  loop:
+   *    MOV offset, offset_copy
+   *    ...
+   *    ADD offset_copy, offset_copy, delta
+   *
+   *  Only pure ALU instructions with a single definition in the function are
+   *  moved. The immediates (LOADI) are not hoisted but copied next to their
+   *  new users, the instruction selection still folds them per block.
+   *  The function CFG and loops must be computed (Context::endFunction)
+   */
+  void hoistLoopInvariants(Function &fn);
+
+} /* namespace ir */
+} /* namespace gbe */
+
+#endif /* __GBE_IR_LICM_HPP__ */
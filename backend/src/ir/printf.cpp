@@ -87,15 +87,15 @@ namespace gbe
 #define PRINT_SOMETHING(target_ty, conv)  do {                          \
       if (!vec_i)                                                       \
         pf_str = pf_str + std::string(#conv);                           \
-      printf(pf_str.c_str(), log.getData<target_ty>());                 \
+      fprintf(out, pf_str.c_str(), log.getData<target_ty>());           \
     } while (0)
 
-    static void printOutOneStatement(PrintfSet::PrintfFmt& fmt, PrintfLog& log)
+    static void printOutOneStatement(PrintfSet::PrintfFmt& fmt, PrintfLog& log, FILE* out)
     {
       std::string pf_str = "";
       for (auto& slot : fmt) {
         if (slot.type == PRINTF_SLOT_TYPE_STRING) {
-          printf("%s", slot.str.c_str());
+          fprintf(out, "%s", slot.str.c_str());
           continue;
         }
         assert(slot.type == PRINTF_SLOT_TYPE_STATE);
@@ -107,7 +107,7 @@ namespace gbe
 
         for (int vec_i = 0; vec_i < vec_num; vec_i++) {
           if (vec_i)
-            printf(",");
+            fprintf(out, ",");
 
           switch (slot.state.conversion_specifier) {
             case PRINTF_CONVERSION_D:
@@ -177,7 +177,7 @@ namespace gbe
 
             case PRINTF_CONVERSION_S:
               pf_str = pf_str + "s";
-              printf(pf_str.c_str(), slot.state.str.c_str());
+              fprintf(out, pf_str.c_str(), slot.state.str.c_str());
               break;
 
             default:
@@ -189,19 +189,12 @@ namespace gbe
       }
     }
 
-    void PrintfSet::outputPrintf(void* buf_addr)
+    void PrintfSet::outputPrintf(const void* log_addr, FILE* out)
     {
       LockOutput lock;
-      uint32_t totalSZ = ((uint32_t *)buf_addr)[0];
-      char* p = (char*)buf_addr + sizeof(uint32_t);
-
-      for (uint32_t parsed = 4; parsed < totalSZ; ) {
-        PrintfLog log(p);
-        GBE_ASSERT(fmts.find(log.statementNum) != fmts.end());
-        printOutOneStatement(fmts[log.statementNum], log);
-        parsed += log.size;
-        p += log.size;
-      }
+      PrintfLog log((const char *)log_addr);
+      GBE_ASSERT(fmts.find(log.statementNum) != fmts.end());
+      printOutOneStatement(fmts[log.statementNum], log, out);
     }
   } /* namespace ir */
 } /* namespace gbe */
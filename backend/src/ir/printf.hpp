@@ -24,6 +24,8 @@
 #define __GBE_IR_PRINTF_HPP__
 
 #include <string.h>
+#include <stdio.h>
+#include "backend/program.h"
 #include "sys/map.hpp"
 #include "sys/vector.hpp"
 
@@ -151,7 +153,7 @@ namespace gbe
       const char* content;
 
       PrintfLog(const char* p) {
-        GBE_ASSERT(*((uint32_t *)p) == 0xAABBCCDD);
+        GBE_ASSERT(*((uint32_t *)p) == GBE_PRINTF_LOG_MAGIC);
         magic = *((uint32_t *)p);
         p += sizeof(uint32_t);
         size = *((uint32_t *)p);
@@ -243,7 +245,8 @@ namespace gbe
         return 0;
       }
 
-      void outputPrintf(void* buf_addr);
+      /*! Format one record of the printf buffer */
+      void outputPrintf(const void* log, FILE* out);
 
     private:
       std::map<uint32_t, PrintfFmt> fmts;
@@ -25,6 +25,10 @@
 #include "ir/profiling.hpp"
 #include "src/cl_device_data.h"
 #include <inttypes.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include "sys/cvar.hpp"
 
 namespace gbe
 {
@@ -32,7 +36,86 @@ namespace ir
 {
   pthread_mutex_t ProfilingInfo::lock = PTHREAD_MUTEX_INITIALIZER;
 
+  /*! "text" for the report dump, "json" for a Chrome trace, "bin" for the
+   *  compact binary records and "summary" for the aggregated figures only */
+  SVAR(OCL_PROFILING_FORMAT, "text");
+  /*! Prefix of the json and bin files, one file per launch */
+  SVAR(OCL_PROFILING_FILE, "beignet_profile");
+  /*! Timestamp frequency used to convert the cycles into microseconds */
+  IVAR(OCL_PROFILING_CLOCK_MHZ, 1, 1000, 10000);
+
+  static const char profilingBinMagic[8] = {'G', 'B', 'E', 'P', 'R', 'O', 'F', '1'};
+  static uint32_t profilingLaunchNum = 0;
+
   void ProfilingInfo::outputProfilingInfo(void * logBuf)
+  {
+    if (OCL_PROFILING_FORMAT != "json" && OCL_PROFILING_FORMAT != "bin" &&
+        OCL_PROFILING_FORMAT != "summary") {
+      outputText(logBuf);
+      return;
+    }
+
+    vector<ThreadRecord> records;
+    decodeItems(logBuf, records);
+
+    LockOutput lock;
+    if (OCL_PROFILING_FORMAT != "summary") {
+      const bool json = OCL_PROFILING_FORMAT == "json";
+      char fileName[512];
+      snprintf(fileName, sizeof(fileName), "%s-%s-%u.%s", OCL_PROFILING_FILE.c_str(),
+               kernelName.c_str(), profilingLaunchNum++, json ? "json" : "bin");
+      FILE *f = fopen(fileName, json ? "w" : "wb");
+      if (f == NULL) {
+        fprintf(stderr, "Beignet: cannot open the profiling output %s.\n", fileName);
+      } else {
+        if (json)
+          outputChromeTrace(f, records);
+        else
+          outputBinary(f, records);
+        fclose(f);
+        printf("Profiling of kernel %s written to %s\n", kernelName.c_str(), fileName);
+      }
+    }
+    outputSummary(records);
+  }
+
+  void ProfilingInfo::decodeItems(void* logBuf, vector<ThreadRecord> &records) const
+  {
+    const uint32_t logNum = *reinterpret_cast<uint32_t*>(logBuf);
+    const ProfilingReportItem* log = reinterpret_cast<ProfilingReportItem*>((char*)logBuf + 4);
+
+    records.resize(logNum);
+    for (uint32_t i = 0; i < logNum; i++, log++) {
+      ThreadRecord &r = records[i];
+      r.simd = log->simdType == ProfilingSimdType16 ? 16 : 8;
+      if (IS_IVYBRIDGE(deviceID) || IS_HASWELL(deviceID)) {
+        r.slice = IS_HASWELL(deviceID) ? log->genInfo.gen7.slice_id : 0;
+        r.subslice = log->genInfo.gen7.half_slice_id;
+        r.eu = log->genInfo.gen7.eu_id;
+        r.thread = log->genInfo.gen7.thread_id;
+      } else {
+        r.slice = log->genInfo.gen8.slice_id;
+        r.subslice = log->genInfo.gen8.subslice_id;
+        r.eu = log->genInfo.gen8.eu_id;
+        r.thread = log->genInfo.gen8.thread_id;
+      }
+      r.prolog = ((uint64_t)log->timestampPrologHi << 32) | log->timestampPrologLo;
+      r.epilog = ((uint64_t)log->timestampEpilogHi << 32) | log->timestampEpilogLo;
+      r.dispatchMask = log->dispatchMask;
+      r.gid[0] = log->gidXStart; r.gid[1] = log->gidXEnd;
+      r.gid[2] = log->gidYStart; r.gid[3] = log->gidYEnd;
+      r.gid[4] = log->gidZStart; r.gid[5] = log->gidZEnd;
+      // A point is stamped the first time it is reached, 0 means never
+      r.pointMask = 0;
+      for (uint32_t p = 0; p < MaxTimestampProfilingPoints; p++) {
+        r.ts[p] = log->userTimestamp[p];
+        if (r.ts[p] != 0)
+          r.pointMask |= 1u << p;
+      }
+    }
+  }
+
+  void ProfilingInfo::outputText(void * logBuf) const
   {
     LockOutput lock;
     uint32_t logNum = *reinterpret_cast<uint32_t*>(logBuf);
@@ -71,5 +154,171 @@ namespace ir
       log++;
     }
   }
+  /*! Hardware thread slot, unique over the device */
+  static INLINE uint32_t threadSlot(const ProfilingInfo::ThreadRecord &r) {
+    return (((r.slice * 4 + r.subslice) * 16 + r.eu) * 8) + r.thread;
+  }
+
+  /*! p-th percentile of sorted values */
+  static INLINE uint64_t percentile(const vector<uint64_t> &sorted, uint32_t p) {
+    return sorted[(sorted.size() - 1) * p / 100];
+  }
+
+  /*! Reached points of a thread in time order */
+  static uint32_t sortPoints(const ProfilingInfo::ThreadRecord &r, uint32_t *points) {
+    uint32_t n = 0;
+    for (uint32_t p = 0; p < ProfilingInfo::MaxTimestampProfilingPoints; p++)
+      if (r.pointMask & (1u << p))
+        points[n++] = p;
+    std::sort(points, points + n, [&r](uint32_t a, uint32_t b) { return r.ts[a] < r.ts[b]; });
+    return n;
+  }
+
+  void ProfilingInfo::outputChromeTrace(FILE *f, const vector<ThreadRecord> &records) const
+  {
+    const double mhz = OCL_PROFILING_CLOCK_MHZ;
+    uint64_t base = UINT64_MAX;
+    std::set<uint32_t> slices, slots;
+    for (const auto &r : records) {
+      base = std::min(base, r.prolog);
+      slices.insert(r.slice);
+      slots.insert(threadSlot(r));
+    }
+
+    // Slices are processes and hardware threads are threads of the trace
+    fprintf(f, "{\"otherData\":{\"kernel\":\"%s\",\"deviceID\":\"0x%x\",\"clockMHz\":%d},\n",
+            kernelName.c_str(), deviceID, OCL_PROFILING_CLOCK_MHZ);
+    fprintf(f, "\"traceEvents\":[\n");
+    const char *sep = "";
+    for (auto slice : slices) {
+      fprintf(f, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"slice %u\"}}",
+              sep, slice, slice);
+      sep = ",\n";
+    }
+    for (auto slot : slots) {
+      fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,"
+              "\"args\":{\"name\":\"subslice %u eu %u thread %u\"}}",
+              sep, slot / 512, slot, slot / 128 % 4, slot / 8 % 16, slot % 8);
+      sep = ",\n";
+    }
+
+    for (const auto &r : records) {
+      const uint32_t slot = threadSlot(r);
+      const double start = (r.prolog - base) / mhz;
+      fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+              "\"args\":{\"simd\":%u,\"dispatchMask\":\"0x%x\",\"gid\":\"%u~%u %u~%u %u~%u\"}}",
+              sep, kernelName.c_str(), r.slice, slot, start, (r.epilog - r.prolog) / mhz,
+              r.simd, r.dispatchMask, r.gid[0], r.gid[1], r.gid[2], r.gid[3], r.gid[4], r.gid[5]);
+      sep = ",\n";
+      // A region ends at a point and starts at the previous one reached
+      uint32_t points[MaxTimestampProfilingPoints];
+      const uint32_t n = sortPoints(r, points);
+      uint32_t prev = 0;
+      for (uint32_t i = 0; i < n; i++) {
+        const uint32_t ts = r.ts[points[i]];
+        fprintf(f, ",\n{\"name\":\"ts%u\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                points[i], r.slice, slot, start + prev / mhz, (ts - prev) / mhz);
+        prev = ts;
+      }
+    }
+    fprintf(f, "\n]}\n");
+  }
+
+  template <typename T>
+  static INLINE void writeBinary(FILE *f, T value) {
+    fwrite(&value, sizeof(T), 1, f);
+  }
+
+  /* Little endian layout:
+   *   header: "GBEPROF1", u32 deviceID, u32 clock MHz, u32 thread number,
+   *           u32 name length, name
+   *   thread: u64 prolog, u32 duration, u8 simd, slice, subslice, eu, thread,
+   *           u8 0, u16 dispatch mask, u32 gid x/y/z start and end,
+   *           u32 point mask, u32 timestamp of each point in the mask
+   */
+  void ProfilingInfo::outputBinary(FILE *f, const vector<ThreadRecord> &records) const
+  {
+    fwrite(profilingBinMagic, sizeof(profilingBinMagic), 1, f);
+    writeBinary<uint32_t>(f, deviceID);
+    writeBinary<uint32_t>(f, OCL_PROFILING_CLOCK_MHZ);
+    writeBinary<uint32_t>(f, records.size());
+    writeBinary<uint32_t>(f, kernelName.size());
+    fwrite(kernelName.c_str(), kernelName.size(), 1, f);
+
+    for (const auto &r : records) {
+      writeBinary<uint64_t>(f, r.prolog);
+      writeBinary<uint32_t>(f, r.epilog - r.prolog);
+      writeBinary<uint8_t>(f, r.simd);
+      writeBinary<uint8_t>(f, r.slice);
+      writeBinary<uint8_t>(f, r.subslice);
+      writeBinary<uint8_t>(f, r.eu);
+      writeBinary<uint8_t>(f, r.thread);
+      writeBinary<uint8_t>(f, 0);
+      writeBinary<uint16_t>(f, r.dispatchMask);
+      fwrite(r.gid, sizeof(r.gid), 1, f);
+      writeBinary<uint32_t>(f, r.pointMask);
+      for (uint32_t p = 0; p < MaxTimestampProfilingPoints; p++)
+        if (r.pointMask & (1u << p))
+          writeBinary<uint32_t>(f, r.ts[p]);
+    }
+  }
+
+  void ProfilingInfo::outputSummary(const vector<ThreadRecord> &records) const
+  {
+    printf("Profiling summary of kernel %s: %u threads\n", kernelName.c_str(), (uint32_t)records.size());
+    if (records.empty())
+      return;
+
+    uint64_t first = UINT64_MAX, last = 0;
+    for (const auto &r : records) {
+      first = std::min(first, r.prolog);
+      last = std::max(last, r.epilog);
+    }
+    const uint64_t span = std::max<uint64_t>(last - first, 1);
+    printf(" span: %" PRIu64 " cycles (%.3f us at %d MHz)\n", span,
+           (double)span / OCL_PROFILING_CLOCK_MHZ, OCL_PROFILING_CLOCK_MHZ);
+
+    vector<uint64_t> skew, latency, region[MaxTimestampProfilingPoints];
+    std::map<uint32_t, std::pair<uint32_t, uint64_t>> euBusy; // threads and busy cycles
+    for (const auto &r : records) {
+      skew.push_back(r.prolog - first);
+      latency.push_back(r.epilog - r.prolog);
+      auto &eu = euBusy[threadSlot(r) / 8];
+      eu.first++;
+      eu.second += r.epilog - r.prolog;
+      uint32_t points[MaxTimestampProfilingPoints];
+      const uint32_t n = sortPoints(r, points);
+      uint32_t prev = 0;
+      for (uint32_t i = 0; i < n; i++) {
+        region[points[i]].push_back(r.ts[points[i]] - prev);
+        prev = r.ts[points[i]];
+      }
+    }
+
+    auto outputPercentiles = [](const char *name, vector<uint64_t> &values) {
+      std::sort(values.begin(), values.end());
+      printf(" %-24s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n", name,
+             percentile(values, 50), percentile(values, 90), percentile(values, 99), values.back());
+    };
+    printf(" %-24s %10s %10s %10s %10s\n", "cycles", "p50", "p90", "p99", "max");
+    outputPercentiles("dispatch skew", skew);
+    outputPercentiles("thread latency", latency);
+    for (uint32_t p = 0; p < MaxTimestampProfilingPoints; p++) {
+      if (region[p].empty())
+        continue;
+      char name[32];
+      snprintf(name, sizeof(name), "region ts%u (%u thr)", p, (uint32_t)region[p].size());
+      outputPercentiles(name, region[p]);
+    }
+
+    // Average number of resident threads of each EU over the launch
+    printf(" EU occupancy (threads resident on average, threads run):\n");
+    for (const auto &eu : euBusy) {
+      const double occupancy = (double)eu.second.second / span;
+      const std::string bar(std::min(40, (int)(occupancy * 5 + 0.5)), '#');
+      printf("  slice %u subslice %u eu %2u: %5.2f %6u %s\n", eu.first / 64, eu.first / 16 % 4,
+             eu.first % 16, occupancy, eu.second.first, bar.c_str());
+    }
+  }
 }
 }
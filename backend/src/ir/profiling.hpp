@@ -23,6 +23,8 @@
 #define __GBE_IR_PROFILING_HPP__
 
 #include <string.h>
+#include <stdio.h>
+#include <string>
 #include "sys/map.hpp"
 #include "sys/vector.hpp"
 #include "unit.hpp"
@@ -81,6 +83,7 @@ namespace gbe
         this->bti = other.bti;
         this->profilingType = other.profilingType;
         this->deviceID = other.deviceID;
+        this->kernelName = other.kernelName;
       }
 
       ProfilingInfo(void) {
@@ -116,12 +119,37 @@ namespace gbe
       uint32_t getDeviceID() const {
         return deviceID;
       }
+      void setKernelName(const std::string &name) {
+        kernelName = name;
+      }
+      const std::string &getKernelName() const {
+        return kernelName;
+      }
+      /*! Output the report items of a launch in the OCL_PROFILING_FORMAT */
       void outputProfilingInfo(void* logBuf);
 
+      /*! A report item with the device specific fields decoded */
+      struct ThreadRecord {
+        uint64_t prolog, epilog;  //!< Thread start and end in timestamp cycles
+        uint32_t simd;
+        uint32_t slice, subslice; //!< Half slice on gen7
+        uint32_t eu, thread;
+        uint32_t dispatchMask;
+        uint32_t gid[6];          //!< x, y, z start and end
+        uint32_t pointMask;       //!< User points reached by the thread
+        uint32_t ts[MaxTimestampProfilingPoints];
+      };
+
     private:
+      void decodeItems(void* logBuf, vector<ThreadRecord> &records) const;
+      void outputText(void* logBuf) const;
+      void outputChromeTrace(FILE *f, const vector<ThreadRecord> &records) const;
+      void outputBinary(FILE *f, const vector<ThreadRecord> &records) const;
+      void outputSummary(const vector<ThreadRecord> &records) const;
       uint32_t bti;
       uint32_t profilingType;
       uint32_t deviceID;
+      std::string kernelName;
       friend struct LockOutput;
       static pthread_mutex_t lock;
       GBE_CLASS(ProfilingInfo);
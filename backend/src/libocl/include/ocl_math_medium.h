@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2012 - 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __OCL_MATH_MEDIUM_H__
+#define __OCL_MATH_MEDIUM_H__
+
+#include "ocl_types.h"
+
+/* Medium precision math, selected by the -cl-medium-precision-math build
+ * option, between the strict and the -cl-fast-relaxed-math native paths.
+ * The implementations only use float additions, multiplications, one
+ * division for log and pow, and integer operations, so that the
+ * gbe_math_ulp host harness measures the same code. Denormals are flushed
+ * like Gen does. The maximum errors below are the ones the harness measures
+ * against double precision results, exhaustively for the one argument
+ * functions and on a sampled sweep for pow.
+ */
+
+/* |x| bound of the medium sin and cos, larger arguments take the strict
+ * Payne-Hanek reduction */
+#define MEDIUM_TRIG_MAX 0x1.f4p7f
+
+/* 1.03 ulp, all the floats */
+OVERLOADABLE float __gen_ocl_internal_medium_exp(float x);
+/* 0.84 ulp, all the floats */
+OVERLOADABLE float __gen_ocl_internal_medium_log(float x);
+/* 2.31 ulp, |x| < MEDIUM_TRIG_MAX */
+OVERLOADABLE float __gen_ocl_internal_medium_sin(float x);
+/* 2.31 ulp, |x| < MEDIUM_TRIG_MAX */
+OVERLOADABLE float __gen_ocl_internal_medium_cos(float x);
+/* 0.91 ulp, finite positive normal x and finite y */
+OVERLOADABLE float __gen_ocl_internal_medium_pow(float x, float y);
+
+#endif /* __OCL_MATH_MEDIUM_H__ */
@@ -20,35 +20,124 @@
 #include "ocl_sync.h"
 #include "ocl_workitem.h"
 
-#define BODY(SRC_STRIDE, DST_STRIDE) \
+#include "ocl_simd.h"
+
+/* The sub-group block messages of the copies. Unlike the CONST public block
+ * read, the read must stay after the stores it has to observe */
+PURE uint4 __gen_ocl_sub_group_block_read_ui_mem4_ordered(const global uint *p);
+void __gen_ocl_sub_group_block_write_ui_mem4(global uint *p, uint4 data);
+void __gen_ocl_sub_group_block_write_ui_local4(local uint *p, uint4 data);
+
+/* Contiguous copies of 4 bytes multiple types are done by blocks of 4 dwords
+ * per lane. Each sub-group moves every get_num_sub_groups() block with OWord
+ * block messages, two blocks at a time so both reads are in flight before the
+ * first write. The SLM side must be OWord aligned, and all the sub-groups must
+ * be full as the messages ignore the execution mask. The dwords after the last
+ * whole block are left to the element loop, the number of dwords copied is
+ * returned. */
+INLINE uint __gen_ocl_async_block_ok(size_t num, uint type_size, uint slm_addr)
+{
+  uint size = get_local_size(2) * get_local_size(1) * get_local_size(0);
+  return type_size % 4 == 0 && (slm_addr & 15) == 0 &&
+         size % get_simd_size() == 0 &&
+         num * type_size >= get_simd_size() * 16;
+}
+
+INLINE uint __gen_ocl_async_block_to_local(local uint *dst, const global uint *src, uint n)
+{
+  uint block = get_simd_size() * 4;
+  uint blocks = n / block;
+  uint step = get_num_sub_groups();
+  uint i = get_sub_group_id();
+  for (; i + step < blocks; i += 2 * step) {
+    uint4 a = __gen_ocl_sub_group_block_read_ui_mem4_ordered(src + i * block);
+    uint4 b = __gen_ocl_sub_group_block_read_ui_mem4_ordered(src + (i + step) * block);
+    __gen_ocl_sub_group_block_write_ui_local4(dst + i * block, a);
+    __gen_ocl_sub_group_block_write_ui_local4(dst + (i + step) * block, b);
+  }
+  if (i < blocks) {
+    uint4 a = __gen_ocl_sub_group_block_read_ui_mem4_ordered(src + i * block);
+    __gen_ocl_sub_group_block_write_ui_local4(dst + i * block, a);
+  }
+  return blocks * block;
+}
+
+/* The SLM side is read with plain gathers in the block layout, lane l holds
+ * the dwords l, l + simd, l + 2 * simd and l + 3 * simd of the block. The
+ * global block write needs an OWord aligned destination. */
+INLINE uint __gen_ocl_async_block_to_global(global uint *dst, const local uint *src, uint n)
+{
+  uint simd = get_simd_size();
+  uint block = simd * 4;
+  uint blocks = n / block;
+  uint step = get_num_sub_groups();
+  const local uint *lane = src + get_sub_group_local_id();
+  for (uint i = get_sub_group_id(); i < blocks; i += step) {
+    const local uint *p = lane + i * block;
+    uint4 data = (uint4)(p[0], p[simd], p[2 * simd], p[3 * simd]);
+    __gen_ocl_sub_group_block_write_ui_mem4(dst + i * block, data);
+  }
+  return blocks * block;
+}
+
+/* Element loop from element FIRST. The strides are folded into the pointer
+ * increments, and the strided copies do two elements per iteration so the
+ * second load does not wait for the first store. */
+#define BODY(SRC_STRIDE, DST_STRIDE, FIRST) \
   uint size = get_local_size(2) * get_local_size(1) * get_local_size(0); \
-  uint count = num / size;  \
   uint offset = get_local_id(2) * get_local_size(1) + get_local_id(1);  \
-  offset = offset * get_local_size(0) + get_local_id(0); \
-  for(uint i=0; i<count; i+=1) { \
-    *(dst + offset * DST_STRIDE) = *(src + offset * SRC_STRIDE); \
-    offset += size;                                 \
+  offset = offset * get_local_size(0) + get_local_id(0) + (FIRST); \
+  if (offset < num) { \
+    size_t src_step = (size_t)size * (SRC_STRIDE); \
+    size_t dst_step = (size_t)size * (DST_STRIDE); \
+    src += offset * (SRC_STRIDE); \
+    dst += offset * (DST_STRIDE); \
+    uint count = (num - offset + size - 1) / size; \
+    if ((SRC_STRIDE) != 1 || (DST_STRIDE) != 1) { \
+      for (; count >= 2; count -= 2) { \
+        __typeof__(*dst) a = src[0], b = src[src_step]; \
+        dst[0] = a; \
+        dst[dst_step] = b; \
+        src += 2 * src_step; \
+        dst += 2 * dst_step; \
+      } \
+    } \
+    for (uint i = 0; i < count; i++) { \
+      *dst = *src; \
+      src += src_step; \
+      dst += dst_step; \
+    } \
   } \
-  if(offset < num) \
-    *(dst + offset * DST_STRIDE) = *(src + offset * SRC_STRIDE); \
   return 0;
 
 #define DEFN(TYPE) \
 OVERLOADABLE event_t async_work_group_copy (local TYPE *dst,  const global TYPE *src, \
 							 size_t num, event_t event) { \
-  BODY(1, 1); \
+  uint first = 0; \
+  if (__gen_ocl_async_block_ok(num, sizeof(TYPE), (uint)(size_t)dst)) \
+    first = __gen_ocl_async_block_to_local((local uint *)dst, (const global uint *)src, \
+                                           num * sizeof(TYPE) / 4) * 4 / sizeof(TYPE); \
+  BODY(1, 1, first); \
 } \
 OVERLOADABLE event_t async_work_group_copy (global TYPE *dst,  const local TYPE *src, \
 							  size_t num, event_t event) { \
-  BODY(1, 1); \
+  uint first = 0; \
+  if (__gen_ocl_async_block_ok(num, sizeof(TYPE), (uint)(size_t)src) && ((size_t)dst & 15) == 0) \
+    first = __gen_ocl_async_block_to_global((global uint *)dst, (const local uint *)src, \
+                                            num * sizeof(TYPE) / 4) * 4 / sizeof(TYPE); \
+  BODY(1, 1, first); \
 } \
 OVERLOADABLE event_t async_work_group_strided_copy (local TYPE *dst,  const global TYPE *src, \
 								 size_t num, size_t src_stride, event_t event) { \
-  BODY(src_stride, 1); \
+  if (src_stride == 1) \
+    return async_work_group_copy(dst, src, num, event); \
+  BODY(src_stride, 1, 0); \
 } \
 OVERLOADABLE event_t async_work_group_strided_copy (global TYPE *dst,  const local TYPE *src, \
 								  size_t num, size_t dst_stride, event_t event) { \
-  BODY(1, dst_stride); \
+  if (dst_stride == 1) \
+    return async_work_group_copy(dst, src, num, event); \
+  BODY(1, dst_stride, 0); \
 }
 #define DEF(TYPE) \
   DEFN(TYPE); DEFN(TYPE##2); DEFN(TYPE##3); DEFN(TYPE##4); DEFN(TYPE##8); DEFN(TYPE##16);
@@ -70,8 +159,16 @@ OVERLOADABLE void wait_group_events (int num_events, event_t *event_list) {
   barrier(CLK_LOCAL_MEM_FENCE | CLK_GLOBAL_MEM_FENCE);
 }
 
+void __gen_ocl_prefetch(const global void *p);
+
+/* One read without response per 64 bytes cache line */
 #define DEFN(TYPE) \
-OVERLOADABLE void prefetch(const global TYPE *p, size_t num) { }
+OVERLOADABLE void prefetch(const global TYPE *p, size_t num) { \
+  const global uchar *line = (const global uchar *)p - ((size_t)p & 63); \
+  const global uchar *end = (const global uchar *)(p + num); \
+  for (; line < end; line += 64) \
+    __gen_ocl_prefetch(line); \
+}
 #define DEF(TYPE) \
 DEFN(TYPE); DEFN(TYPE##2); DEFN(TYPE##3); DEFN(TYPE##4); DEFN(TYPE##8); DEFN(TYPE##16)
 DEF(char);
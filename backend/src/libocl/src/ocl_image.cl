@@ -297,6 +297,7 @@ GEN_VALIDATE_ARRAY_INDEX(int, read_write image1d_buffer_t)
 
 bool __gen_ocl_sampler_need_fix(sampler_t);
 bool __gen_ocl_sampler_need_rounding_fix(sampler_t);
+bool __gen_ocl_sampler_is_trivial(sampler_t);
 
 bool __gen_sampler_need_fix(const sampler_t sampler)
 {
@@ -308,6 +309,14 @@ bool __gen_sampler_need_rounding_fix(const sampler_t sampler)
   return __gen_ocl_sampler_need_rounding_fix(sampler);
 }
 
+// An unnormalized, CLK_ADDRESS_NONE and CLK_FILTER_NEAREST sampler only
+// fetches the texel at the integer coordinate, which a LD message does without
+// any sampler state. Only true for the samplers known at compile time.
+bool __gen_sampler_is_trivial(const sampler_t sampler)
+{
+  return __gen_ocl_sampler_is_trivial(sampler);
+}
+
 INLINE_OVERLOADABLE float __gen_fixup_float_coord(float tmpCoord)
 {
   if (tmpCoord < 0 && tmpCoord > -0x1p-20f)
@@ -439,9 +448,11 @@ INLINE_OVERLOADABLE float3 __gen_fixup_neg_boundary(float3 coord)
 #ifdef GEN7_SAMPLER_CLAMP_BORDER_WORKAROUND
 #define GEN_FIX_FLOAT_ROUNDING 1
 #define GEN_FIX_INT_CLAMPING 1
+#define GEN_LD_TRIVIAL_SAMPLER 1
 #else
 #define GEN_FIX_FLOAT_ROUNDING 0
 #define GEN_FIX_INT_CLAMPING 0
+#define GEN_LD_TRIVIAL_SAMPLER 0
 #endif
 
 #define convert_float1 convert_float
@@ -455,7 +466,8 @@ INLINE_OVERLOADABLE float3 __gen_fixup_neg_boundary(float3 coord)
                                         coord_type coord)                     \
   {                                                                           \
     coord = __gen_validate_array_index(coord, cl_image);                      \
-    if (int_clamping_fix && __gen_sampler_need_fix(sampler))                  \
+    if ((int_clamping_fix && __gen_sampler_need_fix(sampler)) ||              \
+        (GEN_LD_TRIVIAL_SAMPLER && __gen_sampler_is_trivial(sampler)))        \
       return __gen_ocl_read_image ##suffix(cl_image, sampler,                 \
                                            convert_int ##n(coord), 1);        \
     return __gen_ocl_read_image ##suffix(cl_image, sampler,                   \
@@ -496,6 +508,9 @@ INLINE_OVERLOADABLE float3 __gen_fixup_neg_boundary(float3 coord)
     coord = __gen_validate_array_index(coord, cl_image);                      \
     sampler_t defaultSampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_NONE \
                                | CLK_FILTER_NEAREST;                          \
+    if (GEN_LD_TRIVIAL_SAMPLER)                                               \
+      return __gen_ocl_read_image ##suffix(                                   \
+               cl_image, defaultSampler, convert_int ##n (coord), 1);         \
     return __gen_ocl_read_image ##suffix(                                     \
              cl_image, defaultSampler, convert_float ##n (coord), 0);         \
   }
@@ -552,6 +567,9 @@ DECL_IMAGE_TYPE(image2d_array_t, 3)
     int2 effectCoord;                                                         \
     effectCoord.s0 = coord % 8192;                                            \
     effectCoord.s1 = coord / 8192;                                            \
+    if (GEN_LD_TRIVIAL_SAMPLER)                                               \
+      return __gen_ocl_read_image ##suffix(                                   \
+               cl_image, defaultSampler, effectCoord, 1);                     \
     return __gen_ocl_read_image ##suffix(                                     \
              cl_image, defaultSampler, convert_float2(effectCoord), 0);       \
   }
@@ -612,6 +630,18 @@ INLINE_OVERLOADABLE int4 __gen_fixup_1darray_coord(int2 coord, image1d_array_t i
   return newCoord;
 }
 
+#if (__OPENCL_C_VERSION__ >= 200)
+INLINE_OVERLOADABLE int4 __gen_fixup_1darray_coord(int2 coord, read_write image1d_array_t image)
+{
+  int4 newCoord;
+  newCoord.s0 = coord.s0;
+  newCoord.s1 = 0;
+  newCoord.s2 = coord.s1;
+  newCoord.s3 = 0;
+  return newCoord;
+}
+#endif
+
 // For integer coordinates
 #define DECL_READ_IMAGE0_1DArray(int_clamping_fix,                            \
                                  image_data_type, suffix, coord_type)         \
@@ -620,7 +650,8 @@ INLINE_OVERLOADABLE int4 __gen_fixup_1darray_coord(int2 coord, image1d_array_t i
                                         coord_type coord)                     \
   {                                                                           \
     coord = __gen_validate_array_index(coord, cl_image);                      \
-    if (int_clamping_fix && __gen_sampler_need_fix(sampler)) {                \
+    if ((int_clamping_fix && __gen_sampler_need_fix(sampler)) ||              \
+        (GEN_LD_TRIVIAL_SAMPLER && __gen_sampler_is_trivial(sampler))) {      \
       int4 newCoord = __gen_fixup_1darray_coord(coord, cl_image);             \
       return __gen_ocl_read_image ##suffix(cl_image, sampler, newCoord, 2);   \
     }                                                                         \
@@ -654,13 +685,30 @@ INLINE_OVERLOADABLE int4 __gen_fixup_1darray_coord(int2 coord, image1d_array_t i
                                           convert_float2 (tmpCoord), 0);      \
   }
 
+#define DECL_READ_IMAGE_NOSAMPLER_1DArray(access_qual, image_data_type,     \
+                                          suffix, coord_type)                 \
+  OVERLOADABLE image_data_type read_image ##suffix(access_qual image1d_array_t cl_image, \
+                                               coord_type coord)              \
+  {                                                                           \
+    coord = __gen_validate_array_index(coord, cl_image);                      \
+    sampler_t defaultSampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_NONE \
+                               | CLK_FILTER_NEAREST;                          \
+    if (GEN_LD_TRIVIAL_SAMPLER) {                                             \
+      int4 newCoord = __gen_fixup_1darray_coord(coord, cl_image);             \
+      return __gen_ocl_read_image ##suffix(                                   \
+               cl_image, defaultSampler, newCoord, 2);                        \
+    }                                                                         \
+    return __gen_ocl_read_image ##suffix(                                     \
+             cl_image, defaultSampler, convert_float2 (coord), 0);            \
+  }
+
 #if (__OPENCL_C_VERSION__ >= 200)
 #define DECL_IMAGE_1DArray(int_clamping_fix, image_data_type, suffix)         \
   DECL_READ_IMAGE0_1DArray(int_clamping_fix, image_data_type, suffix, int2)   \
   DECL_READ_IMAGE1_1DArray(int_clamping_fix, image_data_type,                 \
                            suffix, float2)                                    \
-  DECL_READ_IMAGE_NOSAMPLER(read_only, image1d_array_t, image_data_type, suffix, int2, 2) \
-  DECL_READ_IMAGE_NOSAMPLER(read_write, image1d_array_t, image_data_type, suffix, int2, 2)\
+  DECL_READ_IMAGE_NOSAMPLER_1DArray(read_only, image_data_type, suffix, int2) \
+  DECL_READ_IMAGE_NOSAMPLER_1DArray(read_write, image_data_type, suffix, int2) \
   DECL_WRITE_IMAGE(write_only, image1d_array_t, image_data_type, suffix, int2) \
   DECL_WRITE_IMAGE(read_write, image1d_array_t, image_data_type, suffix, int2)
 #else
@@ -668,7 +716,7 @@ INLINE_OVERLOADABLE int4 __gen_fixup_1darray_coord(int2 coord, image1d_array_t i
   DECL_READ_IMAGE0_1DArray(int_clamping_fix, image_data_type, suffix, int2)   \
   DECL_READ_IMAGE1_1DArray(int_clamping_fix, image_data_type,                 \
                            suffix, float2)                                    \
-  DECL_READ_IMAGE_NOSAMPLER(read_only, image1d_array_t, image_data_type, suffix, int2, 2) \
+  DECL_READ_IMAGE_NOSAMPLER_1DArray(read_only, image_data_type, suffix, int2) \
   DECL_WRITE_IMAGE(write_only, image1d_array_t, image_data_type, suffix, int2)
 #endif
 
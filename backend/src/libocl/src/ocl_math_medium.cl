@@ -0,0 +1,260 @@
+/*
+ * Copyright © 2012 - 2014 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "ocl_math_medium.h"
+
+/* This file is also compiled for the host by gbe_math_ulp, keep it to plain
+ * C: no vector types, builtins or address spaces, and no mad() as the
+ * rounding of the harness must be the one of Gen. */
+
+INLINE uint __gen_ocl_medium_bits(float x)
+{
+  union { float f; uint u; } v;
+  v.f = x;
+  return v.u;
+}
+
+INLINE float __gen_ocl_medium_float(uint x)
+{
+  union { float f; uint u; } v;
+  v.u = x;
+  return v.f;
+}
+
+/* Keep the 12 high bits of the mantissa, products of two such floats are
+ * exact */
+INLINE float __gen_ocl_medium_high(float x)
+{
+  return __gen_ocl_medium_float(__gen_ocl_medium_bits(x) & 0xfffff000);
+}
+
+/* Round to the nearest integer, |x| < 2^22 */
+INLINE float __gen_ocl_medium_rint(float x)
+{
+  const float shifter = 0x1.8p23f;
+  return (x + shifter) - shifter;
+}
+
+/* 2^n for n in [-252, 254], in two steps so that no factor overflows */
+INLINE float __gen_ocl_medium_scale(float x, int n)
+{
+  const int n1 = n >> 1;
+  const float s1 = __gen_ocl_medium_float((uint)(n1 + 127) << 23);
+  const float s2 = __gen_ocl_medium_float((uint)(n - n1 + 127) << 23);
+  return x * s1 * s2;
+}
+
+/* exp(r) - 1 - r for |r| <= ln2 / 2 */
+INLINE float __gen_ocl_medium_expm1_tail(float r)
+{
+  const float
+  P2 = 0x1.000000p-1f,
+  P3 = 0x1.555556p-3f,
+  P4 = 0x1.555556p-5f,
+  P5 = 0x1.111112p-7f,
+  P6 = 0x1.6c16c2p-10f,
+  P7 = 0x1.a01a02p-13f;
+  return r * r * (P2 + r * (P3 + r * (P4 + r * (P5 + r * (P6 + r * P7)))));
+}
+
+OVERLOADABLE float __gen_ocl_internal_medium_exp(float x)
+{
+  const float
+  log2e  = 0x1.715476p+0f,
+  ln2_hi = 0x1.62e400p-1f,  /* 6.9314575195e-01, 16 bits */
+  ln2_lo = 0x1.7f7d18p-20f, /* 1.4286067653e-06 */
+  o_threshold = 0x1.62e42ep+6f,
+  u_threshold = -0x1.5d589ep+6f; /* exp(u_threshold) = FLT_MIN */
+
+  /* x = j * ln2 + r, |r| <= ln2 / 2 */
+  const float j = __gen_ocl_medium_rint(x * log2e);
+  const float r = (x - j * ln2_hi) - j * ln2_lo;
+  const float p = 1.0f + (r + __gen_ocl_medium_expm1_tail(r));
+  float result = __gen_ocl_medium_scale(p, (int)j);
+
+  result = x > o_threshold ? __gen_ocl_medium_float(0x7f800000) : result;
+  result = x < u_threshold ? 0.0f : result;
+  return x != x ? x : result;
+}
+
+OVERLOADABLE float __gen_ocl_internal_medium_log(float x)
+{
+  const float
+  ln2_hi = 0x1.62e300p-1f,  /* 6.9313812256e-01 */
+  ln2_lo = 0x1.2fefa2p-17f, /* 9.0580006145e-06 */
+  Lg1 = 0xaaaaaa.0p-24f,
+  Lg2 = 0xccce13.0p-25f,
+  Lg3 = 0x91e9ee.0p-25f,
+  Lg4 = 0xf89e26.0p-26f;
+
+  /* x = 2^k * m, m in [sqrt(2)/2, sqrt(2)) */
+  const uint ix = __gen_ocl_medium_bits(x);
+  const int k = ((int)ix - 0x3f3504f3) >> 23;
+  const float m = __gen_ocl_medium_float(ix - ((uint)k << 23));
+  const float dk = (float)k;
+
+  /* log(m) = f - f^2 / 2 + s * (f^2 / 2 + R(s)), s = f / (2 + f) */
+  const float f = m - 1.0f;
+  const float s = f / (2.0f + f);
+  const float z = s * s;
+  const float w = z * z;
+  const float R = z * (Lg1 + w * Lg3) + w * (Lg2 + w * Lg4);
+  const float hfsq = 0.5f * f * f;
+  float result = dk * ln2_hi - ((hfsq - (s * (hfsq + R) + dk * ln2_lo)) - f);
+
+  /* infinity, NaN and negative, then zero and flushed denormals */
+  result = ix == 0x7f800000 ? x : result;
+  result = ix > 0x7f800000 ? __gen_ocl_medium_float(0x7fc00000) : result;
+  return (ix & 0x7fffffff) < 0x00800000 ? __gen_ocl_medium_float(0xff800000) : result;
+}
+
+/* sin(r) - r and cos(r) - 1 for |r| <= pi / 4 */
+INLINE float __gen_ocl_medium_sin_tail(float r)
+{
+  const float
+  S1 = -1.6666667163e-01f, /* 0xbe2aaaab */
+  S2 =  8.3333337680e-03f, /* 0x3c088889 */
+  S3 = -1.9841270114e-04f, /* 0xb9500d01 */
+  S4 =  2.7557314297e-06f; /* 0x3638ef1b */
+  const float z = r * r;
+  return z * r * (S1 + z * (S2 + z * (S3 + z * S4)));
+}
+
+INLINE float __gen_ocl_medium_cos_tail(float r)
+{
+  const float
+  C1 =  4.1666667908e-02f, /* 0x3d2aaaab */
+  C2 = -1.3888889225e-03f, /* 0xbab60b61 */
+  C3 =  2.4801587642e-05f, /* 0x37d00d01 */
+  C4 = -2.7557314297e-07f; /* 0xb493f27c */
+  const float z = r * r;
+  return z * z * (C1 + z * (C2 + z * (C3 + z * C4))) - 0.5f * z;
+}
+
+/* x = j * pi / 2 + r, |r| <= pi / 4, returns j */
+INLINE int __gen_ocl_medium_rem_pio2(float x, float *r)
+{
+  /* pi/2 = 0.C90FDAA22168C234C4p+1, the two first parts have 16 bits so
+   * that their products by j < 2^8 are exact */
+  const float
+  invpio2 = 0x1.45f306p-1f,
+  pio2_1 = 0x1.921e00p+0f,
+  pio2_2 = 0x1.b54400p-16f,
+  pio2_3 = 0x1.0b4612p-34f;
+  const float j = __gen_ocl_medium_rint(x * invpio2);
+  *r = ((x - j * pio2_1) - j * pio2_2) - j * pio2_3;
+  return (int)j;
+}
+
+OVERLOADABLE float __gen_ocl_internal_medium_sin(float x)
+{
+  float r;
+  const int j = __gen_ocl_medium_rem_pio2(x, &r);
+  const float s = r + __gen_ocl_medium_sin_tail(r);
+  const float c = 1.0f + __gen_ocl_medium_cos_tail(r);
+  const float v = j & 1 ? c : s;
+  return j & 2 ? -v : v;
+}
+
+OVERLOADABLE float __gen_ocl_internal_medium_cos(float x)
+{
+  float r;
+  const int j = __gen_ocl_medium_rem_pio2(x, &r);
+  const float s = r + __gen_ocl_medium_sin_tail(r);
+  const float c = 1.0f + __gen_ocl_medium_cos_tail(r);
+  const float v = j & 1 ? s : c;
+  return (j + 1) & 2 ? -v : v;
+}
+
+OVERLOADABLE float __gen_ocl_internal_medium_pow(float x, float y)
+{
+  /* log2(x) = t1 + t2 and y * log2(x) = p_h + p_l in double float, the
+   * splitting into 12 bits high parts is the one of fdlibm's powf */
+  const float
+  L1 = 6.0000002384e-01f, /* 0x3f19999a */
+  L2 = 4.2857143283e-01f, /* 0x3edb6db7 */
+  L3 = 3.3333334327e-01f, /* 0x3eaaaaab */
+  L4 = 2.7272811532e-01f, /* 0x3e8ba305 */
+  L5 = 2.3066075146e-01f, /* 0x3e6c3255 */
+  L6 = 2.0697501302e-01f, /* 0x3e53f142 */
+  cp   =  9.6179670095e-01f, /* 0x3f76384f =2/(3ln2) */
+  cp_h =  9.6191406250e-01f, /* 0x3f764000 =12b cp */
+  cp_l = -1.1736857402e-04f, /* 0xb8f623c6 =tail of cp_h */
+  lg2   =  6.9314718246e-01f, /* 0x3f317218 */
+  lg2_h =  6.93145752e-01f,   /* 0x3f317200 */
+  lg2_l =  1.42860654e-06f,   /* 0x35bfbe8c */
+  dp_h1 =  5.84960938e-01f,   /* 0x3f15c000 =log2(1.5) high */
+  dp_l1 =  1.56322085e-06f;   /* 0x35d1cfdc =log2(1.5) low */
+
+  /* x = 2^n * m, m in [sqrt(2)/2, sqrt(3/2)) around 1 or [sqrt(3/2),
+   * sqrt(3)) around 1.5 */
+  const uint ix = __gen_ocl_medium_bits(x);
+  const uint im = ix & 0x007fffff;
+  const int n = ((int)(ix >> 23) - 127) + (im >= 0x5db3d7 ? 1 : 0);
+  const float m = __gen_ocl_medium_float((im | 0x3f800000) - (im >= 0x5db3d7 ? 0x00800000 : 0));
+  const int around_1_5 = im > 0x1cc471 && im < 0x5db3d7;
+  const float bp = around_1_5 ? 1.5f : 1.0f;
+  const float dp_h = around_1_5 ? dp_h1 : 0.0f;
+  const float dp_l = around_1_5 ? dp_l1 : 0.0f;
+
+  /* s = s_h + s_l = (m - bp) / (m + bp) */
+  const float u = m - bp;
+  const float v = 1.0f / (m + bp);
+  const float s = u * v;
+  const float s_h = __gen_ocl_medium_high(s);
+  float t_h = __gen_ocl_medium_high(m + bp);
+  float t_l = m - (t_h - bp);
+  const float s_l = v * ((u - s_h * t_h) - s_h * t_l);
+
+  /* log(m / bp) = 2 s + 2 s^3 / 3 + ... = 2 / 3 * s * (3 + s^2 + r) */
+  float s2 = s * s;
+  float r = s2 * s2 * (L1 + s2 * (L2 + s2 * (L3 + s2 * (L4 + s2 * (L5 + s2 * L6)))));
+  r += s_l * (s_h + s);
+  s2 = s_h * s_h;
+  t_h = __gen_ocl_medium_high(3.0f + s2 + r);
+  t_l = r - ((t_h - 3.0f) - s2);
+  const float pu = s_h * t_h;
+  const float pv = s_l * t_h + t_l * s;
+  float p_h = __gen_ocl_medium_high(pu + pv);
+  float p_l = pv - (p_h - pu);
+  const float z_h = cp_h * p_h;
+  const float z_l = cp_l * p_h + p_l * cp + dp_l;
+  const float dn = (float)n;
+  const float t1 = __gen_ocl_medium_high(((z_h + z_l) + dp_h) + dn);
+  const float t2 = z_l - (((t1 - dn) - dp_h) - z_h);
+
+  /* y * log2(x) */
+  const float y1 = __gen_ocl_medium_high(y);
+  p_l = (y - y1) * t1 + y * t2;
+  p_h = y1 * t1;
+  const float z = p_l + p_h;
+
+  /* 2^(p_h + p_l) = 2^j * exp((p_h - j + p_l) * ln2) */
+  const float j = __gen_ocl_medium_rint(z < -256.0f ? -256.0f : z > 256.0f ? 256.0f : z);
+  p_h -= j;
+  const float t = __gen_ocl_medium_float(__gen_ocl_medium_bits(p_l + p_h) & 0xffff8000);
+  const float e_h = t * lg2_h;
+  const float e_l = (p_l - (t - p_h)) * lg2 + t * lg2_l;
+  const float e = e_h + e_l;
+  const float e_w = e_l - (e - e_h);
+  const float tail = __gen_ocl_medium_expm1_tail(e) + e_w * (1.0f + e);
+  float result = __gen_ocl_medium_scale(1.0f + (e + tail), (int)j);
+
+  /* the scaling overflows and underflows by itself close to the bounds */
+  result = z > 129.0f ? __gen_ocl_medium_float(0x7f800000) : result;
+  return z < -150.0f ? 0.0f : result;
+}
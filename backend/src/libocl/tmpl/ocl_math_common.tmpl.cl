@@ -21,6 +21,7 @@
 #include "ocl_common.h"
 #include "ocl_integer.h"
 #include "ocl_convert.h"
+#include "ocl_math_medium.h"
 
 /*
  * ====================================================
@@ -34,6 +35,7 @@
  */
 
 extern constant int __ocl_math_fastpath_flag;
+extern constant int __ocl_math_medium_flag;
 
 CONST float __gen_ocl_fabs(float x) __asm("llvm.fabs" ".f32");
 CONST float __gen_ocl_sin(float x) __asm("llvm.sin" ".f32");
@@ -465,6 +467,8 @@ OVERLOADABLE float sin(float x)
 {
   if (__ocl_math_fastpath_flag)
     return __gen_ocl_internal_fastpath_sin(x);
+  if (__ocl_math_medium_flag && __gen_ocl_fabs(x) < MEDIUM_TRIG_MAX)
+    return __gen_ocl_internal_medium_sin(x);
 
   float y;
   float na ;
@@ -497,6 +501,8 @@ OVERLOADABLE float cos(float x)
 {
   if (__ocl_math_fastpath_flag)
     return __gen_ocl_internal_fastpath_cos(x);
+  if (__ocl_math_medium_flag && __gen_ocl_fabs(x) < MEDIUM_TRIG_MAX)
+    return __gen_ocl_internal_medium_cos(x);
 
   float y;
   float na ;
@@ -3067,6 +3073,9 @@ OVERLOADABLE float pown(float x, int n) {
 }
 
 OVERLOADABLE float pow(float x, float y) {
+  /* The special cases of pow stay on the strict path */
+  if (__ocl_math_medium_flag && x >= FLT_MIN && x <= FLT_MAX && fabs(y) <= FLT_MAX)
+    return __gen_ocl_internal_medium_pow(x, y);
   if (!__ocl_math_fastpath_flag)
     return __gen_ocl_internal_pow(x,y);
   else {
@@ -3153,6 +3162,8 @@ OVERLOADABLE float log(float x) {
   /* Use native instruction when it has enough precision */
   if((x > 0x1.1p0) || (x <= 0))
     return __gen_ocl_internal_fastpath_log(x);
+  if (__ocl_math_medium_flag)
+    return __gen_ocl_internal_medium_log(x);
 
   return  __gen_ocl_internal_log(x);
 }
@@ -3186,6 +3197,8 @@ OVERLOADABLE float exp(float x) {
   /* Use native instruction when it has enough precision */
   if (fabs(x) < 0x1.6p1)
     return __gen_ocl_internal_fastpath_exp(x);
+  if (__ocl_math_medium_flag)
+    return __gen_ocl_internal_medium_exp(x);
 
   return __gen_ocl_internal_simple_exp(x);
 }
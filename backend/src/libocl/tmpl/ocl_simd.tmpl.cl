@@ -419,12 +419,21 @@ OVERLOADABLE void intel_sub_group_block_write_us8(image2d_t p, int2 cord, ushort
 {
   __gen_ocl_sub_group_block_write_us_image8(p, cord.x, cord.y, data);
 }
+/* When the sub-groups fill the SIMD width, the indexes wrap at get_simd_size()
+ * and a constant c is a rotation of the lanes, done with register regions */
 #define SHUFFLE_DOWN(TYPE) \
 OVERLOADABLE TYPE intel_sub_group_shuffle_down(TYPE x, TYPE y, uint c) { \
   TYPE res0, res1; \
-  res0 = intel_sub_group_shuffle(x, (get_sub_group_local_id() + c)%get_max_sub_group_size()); \
-  res1 = intel_sub_group_shuffle(y, (get_sub_group_local_id() + c)%get_max_sub_group_size()); \
-  bool inRange = ((int)c + (int)get_sub_group_local_id() > 0) && (((int)c + (int)get_sub_group_local_id() < (int) get_max_sub_group_size())); \
+  uint lid = get_sub_group_local_id(); \
+  uint sz = get_max_sub_group_size(); \
+  bool inRange = ((int)c + (int)lid > 0) && (((int)c + (int)lid < (int) sz)); \
+  if (sz == get_simd_size()) { \
+    res0 = intel_sub_group_shuffle(x, (lid + c) % get_simd_size()); \
+    res1 = intel_sub_group_shuffle(y, (lid + c) % get_simd_size()); \
+    return inRange ? res0 : res1; \
+  } \
+  res0 = intel_sub_group_shuffle(x, (lid + c) % sz); \
+  res1 = intel_sub_group_shuffle(y, (lid + c) % sz); \
   return inRange ? res0 : res1; \
 }
 SHUFFLE_DOWN(float)
@@ -437,9 +446,17 @@ SHUFFLE_DOWN(ushort)
 #define SHUFFLE_UP(TYPE) \
 OVERLOADABLE TYPE intel_sub_group_shuffle_up(TYPE x, TYPE y, uint c) { \
   TYPE res0, res1; \
-  res0 = intel_sub_group_shuffle(x, (get_max_sub_group_size() + get_sub_group_local_id() - c)%get_max_sub_group_size()); \
-  res1 = intel_sub_group_shuffle(y, (get_max_sub_group_size() + get_sub_group_local_id() - c)%get_max_sub_group_size()); \
-  bool inRange = ((int)c - (int)get_sub_group_local_id() > 0) && (((int)c - (int)get_sub_group_local_id() < (int) get_max_sub_group_size())); \
+  uint lid = get_sub_group_local_id(); \
+  uint sz = get_max_sub_group_size(); \
+  bool inRange = ((int)c - (int)lid > 0) && (((int)c - (int)lid < (int) sz)); \
+  if (sz == get_simd_size()) { \
+    /* get_simd_size() divides 2^32, lid - c wraps like lid + simd - c */ \
+    res0 = intel_sub_group_shuffle(x, (lid - c) % get_simd_size()); \
+    res1 = intel_sub_group_shuffle(y, (lid - c) % get_simd_size()); \
+    return inRange ? res0 : res1; \
+  } \
+  res0 = intel_sub_group_shuffle(x, (sz + lid - c) % sz); \
+  res1 = intel_sub_group_shuffle(y, (sz + lid - c) % sz); \
   return inRange ? res0 : res1; \
 }
 SHUFFLE_UP(float)
@@ -448,9 +465,11 @@ SHUFFLE_UP(uint)
 SHUFFLE_UP(short)
 SHUFFLE_UP(ushort)
 #undef SHUFFLE_UP
+/* An id past the sub-group is undefined, wrapping at get_simd_size() makes a
+ * constant c a permutation of the lanes */
 #define SHUFFLE_XOR(TYPE) \
 OVERLOADABLE TYPE intel_sub_group_shuffle_xor(TYPE x, uint c) { \
-  return intel_sub_group_shuffle(x, (get_sub_group_local_id() ^ c) % get_max_sub_group_size()); \
+  return intel_sub_group_shuffle(x, (get_sub_group_local_id() ^ c) % get_simd_size()); \
 }
 SHUFFLE_XOR(float)
 SHUFFLE_XOR(int)
@@ -37,6 +37,7 @@ namespace gbe
 {
   static Module* createOclBitCodeModule(LLVMContext& ctx,
                                                  bool strictMath,
+                                                 bool mediumMath,
                                                  uint32_t oclVersion)
   {
     std::string bitCodeFiles = oclVersion >= 200 ?
@@ -74,6 +75,10 @@ namespace gbe
     assert(mathFastFlag);
     Type* intTy = IntegerType::get(ctx, 32);
     mathFastFlag->setInitializer(ConstantInt::get(intTy, strictMath ? 0 : 1));
+    // Absent from the libraries built before the medium precision math
+    llvm::GlobalVariable* mathMediumFlag = oclLib->getGlobalVariable("__ocl_math_medium_flag");
+    if (mathMediumFlag)
+      mathMediumFlag->setInitializer(ConstantInt::get(intTy, mediumMath ? 1 : 0));
 
     return oclLib;
   }
@@ -151,7 +156,7 @@ namespace gbe
   }
 
 
-  Module* runBitCodeLinker(Module *mod, bool strictMath, ir::Unit &unit)
+  Module* runBitCodeLinker(Module *mod, bool strictMath, bool mediumMath, ir::Unit &unit)
   {
     LLVMContext& ctx = mod->getContext();
     std::set<std::string> materializedFuncs;
@@ -160,7 +165,7 @@ namespace gbe
     uint32_t oclVersion = getModuleOclVersion(mod);
     ir::PointerSize size = oclVersion >= 200 ? ir::POINTER_64_BITS : ir::POINTER_32_BITS;
     unit.setPointerSize(size);
-    Module* clonedLib = createOclBitCodeModule(ctx, strictMath, oclVersion);
+    Module* clonedLib = createOclBitCodeModule(ctx, strictMath, mediumMath, oclVersion);
     if (clonedLib == NULL)
       return NULL;
 
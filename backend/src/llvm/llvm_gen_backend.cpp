@@ -78,6 +78,7 @@
 #include "ir/unit.hpp"
 #include "ir/half.hpp"
 #include "ir/liveness.hpp"
+#include "ir/licm.hpp"
 #include "ir/value.hpp"
 #include "sys/set.hpp"
 #include "sys/cvar.hpp"
@@ -749,9 +750,11 @@ namespace gbe
     void emitSubGroupInst(CallInst &I, CallSite &CS, ir::WorkGroupOps opcode);
     // Emit subgroup instructions
     void emitBlockReadWriteMemInst(CallInst &I, CallSite &CS, bool isWrite, uint8_t vec_size, ir::Type = ir::TYPE_U32);
+    void emitPrefetchInst(CallInst &I, CallSite &CS);
     void emitBlockReadWriteImageInst(CallInst &I, CallSite &CS, bool isWrite, uint8_t vec_size, ir::Type = ir::TYPE_U32);
 
     uint8_t appendSampler(CallSite::arg_iterator AI);
+    bool isConstantSampler(CallSite::arg_iterator AI);
     uint8_t getImageID(CallInst &I);
 
     // These instructions are not supported at all
@@ -2936,6 +2939,7 @@ namespace gbe
 
   BVAR(OCL_OPTIMIZE_PHI_MOVES, true);
   BVAR(OCL_OPTIMIZE_LOADI, true);
+  BVAR(OCL_OPTIMIZE_LOOP_INVARIANTS, true);
 
   static const Instruction *getInstructionUseLocal(const Value *v) {
     // Local variable can only be used in one kernel function. So, if we find
@@ -3235,6 +3239,9 @@ namespace gbe
       emitBasicBlock(&BB);
     ctx.endFunction();
 
+    // Before the liveness since it moves definitions out of the loops
+    if (OCL_OPTIMIZE_LOOP_INVARIANTS) ir::hoistLoopInvariants(fn);
+
     // Liveness can be shared when we optimized the immediates and the MOVs
     ir::Liveness liveness(fn);
 
@@ -4066,6 +4073,7 @@ namespace gbe
       case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_MEM2:
       case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_MEM4:
       case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_MEM8:
+      case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_MEM4_ORDERED:
       case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_IMAGE:
       case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_IMAGE2:
       case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_IMAGE4:
@@ -4126,10 +4134,15 @@ namespace gbe
       case GEN_OCL_CALC_TIMESTAMP:
       case GEN_OCL_STORE_PROFILING:
       case GEN_OCL_DEBUGWAIT:
+      case GEN_OCL_PREFETCH:
       case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_MEM:
       case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_MEM2:
       case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_MEM4:
       case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_MEM8:
+      case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_LOCAL:
+      case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_LOCAL2:
+      case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_LOCAL4:
+      case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_LOCAL8:
       case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_IMAGE:
       case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_IMAGE2:
       case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_IMAGE4:
@@ -4347,14 +4360,16 @@ namespace gbe
     else if (f.gettidMapSLM() < 0 && opcode >= ir::WORKGROUP_OP_ANY && opcode <= ir::WORKGROUP_OP_EXCLUSIVE_MAX) {
       /* 1. For thread SLM based communication (default):
        * Threads will use SLM to write partial results computed individually
-         and then read the whole set. Because the read is done in chunks of 4
-         extra padding is required.
+         and then read the whole set. Each read gathers the slots of 8 threads,
+         so the thread count is rounded up to 8, and the 64-bit partials take
+         8 bytes slots.
 
          When we come to here, the global thread local vars should have all been
          allocated, so it's safe for us to steal a piece of SLM for this usage. */
 
-      // at most 64 thread for one subslice, along with extra padding
-      uint32_t mapSize = sizeof(uint32_t) * (64 + 4);
+      // at most 64 thread for one subslice
+      const uint32_t maxThreadNum = 64;
+      uint32_t mapSize = sizeof(uint64_t) * ALIGN(maxThreadNum, 8);
       f.setUseSLM(true);
       uint32_t oldSlm = f.getSLMSize();
       f.setSLMSize(oldSlm + mapSize);
@@ -4457,7 +4472,7 @@ namespace gbe
 
     Value *llvmPtr = *(AI++);
     ir::AddressSpace addrSpace = addressSpaceLLVMToGen(llvmPtr->getType()->getPointerAddressSpace());
-    GBE_ASSERT(addrSpace == ir::MEM_GLOBAL);
+    GBE_ASSERT(addrSpace == ir::MEM_GLOBAL || addrSpace == ir::MEM_LOCAL);
     ir::Register pointer = this->getRegister(llvmPtr);
 
     ir::Register ptr{};
@@ -4465,7 +4480,13 @@ namespace gbe
     unsigned SurfaceIndex = 0xff;
 
     ir::AddressMode AM;
-    if (legacyMode) {
+    if (addrSpace == ir::MEM_LOCAL) {
+      // SLM has no stateless access, the block message always uses the SLM
+      // surface with the local offset as address
+      AM = ir::AM_StaticBti;
+      SurfaceIndex = BTI_LOCAL;
+      ptr = pointer;
+    } else if (legacyMode) {
       Value *bti = getBtiRegister(llvmPtr);
       Value *ptrBase = getPointerBase(llvmPtr);
       ir::Register baseReg = this->getRegister(ptrBase);
@@ -4506,6 +4527,40 @@ namespace gbe
     GBE_ASSERT(AI == AE);
   }
 
+  void GenWriter::emitPrefetchInst(CallInst &I, CallSite &CS) {
+    CallSite::arg_iterator AI = CS.arg_begin();
+    CallSite::arg_iterator AE = CS.arg_end();
+    GBE_ASSERT(AI != AE);
+
+    Value *llvmPtr = *(AI++);
+    ir::AddressSpace addrSpace = addressSpaceLLVMToGen(llvmPtr->getType()->getPointerAddressSpace());
+    // Only the memory behind the caches is worth warming
+    if (addrSpace != ir::MEM_GLOBAL && addrSpace != ir::MEM_CONSTANT)
+      return;
+    ir::Register pointer = this->getRegister(llvmPtr);
+
+    ir::Register ptr = pointer;
+    unsigned SurfaceIndex = 0xff;
+    ir::AddressMode AM = ir::AM_Stateless;
+    if (legacyMode) {
+      Value *bti = getBtiRegister(llvmPtr);
+      // A hint is not worth the loop over the surfaces of a mixed pointer
+      if (!isa<ConstantInt>(bti))
+        return;
+      Value *ptrBase = getPointerBase(llvmPtr);
+      AM = ir::AM_StaticBti;
+      SurfaceIndex = cast<ConstantInt>(bti)->getZExtValue();
+      addrSpace = btiToGen(SurfaceIndex);
+      if (!isa<ConstantPointerNull>(ptrBase)) {
+        ptr = ctx.reg(ctx.getPointerFamily());
+        ctx.SUB(ir::TYPE_U32, ptr, pointer, this->getRegister(ptrBase));
+      }
+    }
+    ctx.PREFETCH(ptr, addrSpace, AM, SurfaceIndex);
+
+    GBE_ASSERT(AI == AE);
+  }
+
   void GenWriter::emitBlockReadWriteImageInst(CallInst &I, CallSite &CS, bool isWrite, uint8_t vec_size, ir::Type type) {
     CallSite::arg_iterator AI = CS.arg_begin();
     CallSite::arg_iterator AE = CS.arg_end();
@@ -4568,6 +4623,16 @@ namespace gbe
     return index;
   }
 
+  /* the sampler is known at compile time and not a kernel argument */
+  bool GenWriter::isConstantSampler(CallSite::arg_iterator AI) {
+#if LLVM_VERSION_MAJOR * 10 + LLVM_VERSION_MINOR >= 40
+    auto *TC = dyn_cast<CallInst>(*AI);
+    return TC && isa<Constant>(TC->getOperand(0));
+#else
+    return isa<Constant>(*AI);
+#endif
+  }
+
   uint8_t GenWriter::getImageID(CallInst &I) {
     const ir::Register imageReg = this->getRegister(I.getOperand(0));
     return ctx.getFunction().getImageSet()->getIdx(imageReg);
@@ -4997,7 +5062,7 @@ namespace gbe
             const uint8_t imageID = getImageID(I);
             GBE_ASSERT(AI != AE); ++AI;
             GBE_ASSERT(AI != AE);
-            const uint8_t sampler = this->appendSampler(AI);
+            auto samplerArg = AI;
             ++AI; GBE_ASSERT(AI != AE);
             uint32_t coordNum;
             const ir::Type coordType = getVectorInfo(ctx, *AI, coordNum);
@@ -5020,6 +5085,13 @@ namespace gbe
             bool isFloatCoord = coordType == ir::TYPE_FLOAT;
             bool requiredFloatCoord = samplerOffset == 0;
 
+            // The LD message does not read the sampler state, a constant
+            // sampler only used by LD reads does not need a sampler slot.
+            // The kernel argument samplers are still bound.
+            uint8_t sampler = 0;
+            if (samplerOffset == 0 || !isConstantSampler(samplerArg))
+              sampler = this->appendSampler(samplerArg);
+
             GBE_ASSERT(isFloatCoord == requiredFloatCoord);
 
             vector<ir::Register> dstTupleData, srcTupleData;
@@ -5437,6 +5509,8 @@ namespace gbe
             ctx.WAIT();
             break;
           }
+          case GEN_OCL_PREFETCH:
+            this->emitPrefetchInst(I, CS); break;
           case GEN_OCL_WORK_GROUP_ALL: this->emitWorkGroupInst(I, CS, ir::WORKGROUP_OP_ALL); break;
           case GEN_OCL_WORK_GROUP_ANY: this->emitWorkGroupInst(I, CS, ir::WORKGROUP_OP_ANY); break;
           case GEN_OCL_WORK_GROUP_BROADCAST:
@@ -5496,6 +5570,7 @@ namespace gbe
           case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_MEM2:
             this->emitBlockReadWriteMemInst(I, CS, false, 2); break;
           case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_MEM4:
+          case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_MEM4_ORDERED:
             this->emitBlockReadWriteMemInst(I, CS, false, 4); break;
           case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_MEM8:
             this->emitBlockReadWriteMemInst(I, CS, false, 8); break;
@@ -5507,6 +5582,14 @@ namespace gbe
             this->emitBlockReadWriteMemInst(I, CS, true, 4); break;
           case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_MEM8:
             this->emitBlockReadWriteMemInst(I, CS, true, 8); break;
+          case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_LOCAL:
+            this->emitBlockReadWriteMemInst(I, CS, true, 1); break;
+          case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_LOCAL2:
+            this->emitBlockReadWriteMemInst(I, CS, true, 2); break;
+          case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_LOCAL4:
+            this->emitBlockReadWriteMemInst(I, CS, true, 4); break;
+          case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_LOCAL8:
+            this->emitBlockReadWriteMemInst(I, CS, true, 8); break;
           case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_IMAGE:
             this->emitBlockReadWriteImageInst(I, CS, false, 1); break;
           case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_IMAGE2:
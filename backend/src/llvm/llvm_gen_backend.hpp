@@ -153,6 +153,9 @@ namespace gbe
   /*! Remove the GEP instructions */
   GenBasicBlockPass *createRemoveGEPPass(const ir::Unit &unit);
 
+  /*! Pad the __local arrays with SLM bank conflicts, report the others in log */
+  llvm::ModulePass *createSLMPaddingPass(const ir::Unit &unit, std::string &log);
+
   /*! Merge load/store if possible */
   GenBasicBlockPass *createLoadStoreOptimizationPass();
 
@@ -173,7 +176,7 @@ namespace gbe
   llvm::FunctionPass* createSamplerFixPass();
 
   /*! Add all the function call of ocl to our bitcode. */
-  llvm::Module* runBitCodeLinker(llvm::Module *mod, bool strictMath, ir::Unit &unit);
+  llvm::Module* runBitCodeLinker(llvm::Module *mod, bool strictMath, bool mediumMath, ir::Unit &unit);
 
   /*! Get the moudule's opencl version form meta data. */
   uint32_t getModuleOclVersion(const llvm::Module *M);
@@ -19,6 +19,8 @@
  * sampler type, we need some extra work around operations to
  * make sure to get correct pixel value. But for some other
  * sampler, we don't need those work around code.
+ * It also solves __gen_ocl_sampler_is_trivial(), the reads with
+ * such a sampler are done by a LD message without sampler state.
  */
 
 #include "llvm_includes.hpp"
@@ -142,6 +144,30 @@ namespace gbe {
         }
         I->replaceAllUsesWith(needFixVal);
         changed = true;
+      } else if (fnName.compare("__gen_ocl_sampler_is_trivial") == 0) {
+
+        //  return ((sampler & CLK_NORMALIZED_COORDS_TRUE) == 0 &&
+        //          (sampler & __CLK_ADDRESS_MASK) == CLK_ADDRESS_NONE &&
+        //          (sampler & __CLK_FILTER_MASK) == CLK_FILTER_NEAREST);
+        // Only folded for the constant samplers: a kernel argument sampler
+        // keeps the sample message instead of both messages and a branch.
+        bool isTrivial = false;
+#if LLVM_VERSION_MAJOR * 10 + LLVM_VERSION_MINOR >= 40
+        CallInst *init = dyn_cast<CallInst>(I->getOperand(0));
+        const ConstantInt *ci = nullptr;
+        if (init && init->getCalledValue()->getName() == "__gen_ocl_int_to_sampler")
+          ci = dyn_cast<ConstantInt>(init->getOperand(0));
+#else
+        const ConstantInt *ci = dyn_cast<ConstantInt>(I->getOperand(0));
+#endif
+        if (ci) {
+          uint32_t samplerInt = ci->getZExtValue();
+          isTrivial = (samplerInt & CLK_NORMALIZED_COORDS_TRUE) == 0 &&
+                      (samplerInt & __CLK_ADDRESS_MASK) == CLK_ADDRESS_NONE &&
+                      (samplerInt & __CLK_FILTER_MASK) == CLK_FILTER_NEAREST;
+        }
+        I->replaceAllUsesWith(ConstantInt::get(boolTy, isTrivial));
+        changed = true;
       }
       return changed;
     }
@@ -707,6 +707,10 @@ namespace gbe {
           case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_MEM2:
           case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_MEM4:
           case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_MEM8:
+          case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_LOCAL:
+          case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_LOCAL2:
+          case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_LOCAL4:
+          case GEN_OCL_SUB_GROUP_BLOCK_WRITE_UI_LOCAL8:
           case GEN_OCL_SUB_GROUP_BLOCK_WRITE_US_MEM:
           case GEN_OCL_SUB_GROUP_BLOCK_WRITE_US_MEM2:
           case GEN_OCL_SUB_GROUP_BLOCK_WRITE_US_MEM4:
@@ -719,6 +723,7 @@ namespace gbe {
           case GEN_OCL_VME:
           case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_MEM2:
           case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_MEM4:
+          case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_MEM4_ORDERED:
           case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_MEM8:
           case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_IMAGE2:
           case GEN_OCL_SUB_GROUP_BLOCK_READ_UI_IMAGE4:
@@ -0,0 +1,564 @@
+/*
+ * Copyright © 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file llvm_slm_padding.cpp
+ *
+ *  SLM bank conflict analysis of the __local loads and stores. The SLM has 16
+ *  banks of one dword, the lanes of a message which read different dwords of
+ *  the same bank are serialized. The address of each access is written as
+ *  base + stride * get_local_id(0), where the base is the same for all the
+ *  lanes of a hardware thread (kernel arguments, group ids or loop counters,
+ *  and local ids 1 and 2 when the required local size 0 is a multiple of
+ *  16), and the conflict degree of the stride is computed for 16
+ *  consecutive lanes.
+ *
+ *  A __local array like float tile[16][16] read column-wise (tile[lid0][k])
+ *  has a stride of 64 bytes, all the lanes hit the same bank. When all the
+ *  uses of the array are loads and stores of its elements (the address does
+ *  not escape), the rows are padded (tile[16][17]) with the padding which
+ *  removes the most conflicts. A flattened access (tile[0][k] with k >= 16)
+ *  would reach another element once padded, so all the indices but the
+ *  first dimension must be provably in their dimension: constants, or local
+ *  ids bounded by the required work group size. The pass runs before the GEP lowering, so the
+ *  address computations and the SLM layout of the Gen IR writer use the
+ *  padded type. The remaining conflicts are reported in the build log.
+ */
+
+#include "llvm_includes.hpp"
+
+#include "llvm/llvm_gen_backend.hpp"
+#include "ir/unit.hpp"
+#include "sys/map.hpp"
+#include "sys/set.hpp"
+#include "sys/cvar.hpp"
+
+#include <sstream>
+
+using namespace llvm;
+
+namespace gbe
+{
+  BVAR(OCL_SLM_PADDING, true);
+
+  /*! Number of banks (of one dword) of the SLM */
+  static const uint32_t slmBankNum = 16;
+  /*! Lanes of the messages we consider (SIMD16) */
+  static const uint32_t slmLaneNum = 16;
+  /*! The padded arrays must still fit in the SLM */
+  static const uint32_t slmMaxSize = 64 * 1024;
+
+  /*! Largest number of different dwords accessed in one bank by the lanes
+   *  accessing size bytes at lane * stride */
+  static uint32_t getConflictDegree(int64_t stride, uint32_t size) {
+    map<uint32_t, set<int64_t>> banks;
+    uint32_t degree = 1;
+    for (uint32_t lane = 0; lane < slmLaneNum; ++lane) {
+      const int64_t addr = stride * lane;
+      const int64_t first = addr >= 0 ? addr / 4 : (addr - 3) / 4;
+      const int64_t last = first + (size + 3) / 4 - 1;
+      for (int64_t dw = first; dw <= last; ++dw) {
+        const uint32_t bank = ((dw % slmBankNum) + slmBankNum) % slmBankNum;
+        banks[bank].insert(dw);
+        degree = std::max(degree, (uint32_t) banks[bank].size());
+      }
+    }
+    return degree;
+  }
+
+  class SLMPadding : public ModulePass
+  {
+  public:
+    static char ID;
+    SLMPadding(const ir::Unit &unit, std::string &log) :
+      ModulePass(ID), unit(unit), log(log) {}
+
+    void getAnalysisUsage(AnalysisUsage &AU) const {
+    }
+
+#if LLVM_VERSION_MAJOR * 10 + LLVM_VERSION_MINOR >= 40
+    virtual StringRef getPassName() const
+#else
+    virtual const char *getPassName() const
+#endif
+    {
+      return "SPIR backend: SLM bank conflict padding";
+    }
+
+    virtual bool runOnModule(Module &M);
+
+  private:
+    /*! Lane coefficient of an integer or a pointer, false if unknown */
+    bool getLaneCoeff(Value *v, int64_t &coeff);
+    bool computeLaneCoeff(Value *v, int64_t &coeff);
+    /*! Lane coefficient of each index of a GEP, in elements */
+    bool getIndexCoeffs(GetElementPtrInst *gep, vector<int64_t> &coeffs);
+    /*! Sum of the conflict degrees of the accesses of an array whose last
+     *  dimension is padded by pad elements */
+    uint32_t getPaddedCost(ArrayType *ty, const vector<vector<int64_t>> &accesses,
+                           const vector<uint32_t> &sizes, uint32_t pad);
+    /*! The array type with the last dimension padded */
+    Type *getPaddedType(Type *ty, uint32_t pad);
+    /*! Pad the array if its address does not escape and it removes conflicts */
+    bool padArray(Module &M, GlobalVariable *gv);
+    /*! Array or argument accessed by the pointer (NULL if unknown) */
+    Value *getObject(Value *ptr);
+    /*! Says if the integer is in [0, bound) for all the work items */
+    bool isInRange(Value *v, uint64_t bound);
+    /*! Required local size of the function, 0 when unknown */
+    uint32_t getReqdLocalSize(Function *F, uint32_t dim);
+
+    const ir::Unit &unit;
+    std::string &log;
+    /*! Values being computed (loop PHIs) */
+    set<Value*> visiting;
+    /*! Coefficients which do not depend on a PHI being computed */
+    map<Value*, std::pair<bool, int64_t>> laneCoeffs;
+    /*! reqd_work_group_size of the kernels */
+    map<Function*, vector<uint32_t>> reqdLocalSizes;
+  };
+
+  uint32_t SLMPadding::getReqdLocalSize(Function *F, uint32_t dim) {
+    auto it = reqdLocalSizes.find(F);
+    if (it == reqdLocalSizes.end()) {
+      vector<uint32_t> sizes(3, 0);
+#if LLVM_VERSION_MAJOR * 10 + LLVM_VERSION_MINOR >= 39
+      if (MDNode *attrNode = F->getMetadata("reqd_work_group_size")) {
+        for (uint32_t i = 0; i < 3; ++i)
+          sizes[i] = mdconst::extract<ConstantInt>(attrNode->getOperand(i))->getZExtValue();
+      }
+#else
+      NamedMDNode *clKernels = F->getParent()->getNamedMetadata("opencl.kernels");
+      for (uint32_t x = 0; clKernels && x < clKernels->getNumOperands(); ++x) {
+        MDNode *node = clKernels->getOperand(x);
+#if LLVM_VERSION_MAJOR * 10 + LLVM_VERSION_MINOR <= 35
+        if (node->getOperand(0) != F)
+          continue;
+#else
+        auto *V = cast<ValueAsMetadata>(node->getOperand(0));
+        if (V == nullptr || V->getValue() != F)
+          continue;
+#endif
+        for (uint32_t j = 1; j < node->getNumOperands(); ++j) {
+          auto *attrNode = dyn_cast_or_null<MDNode>(node->getOperand(j));
+          auto *attrName = attrNode ? dyn_cast_or_null<MDString>(attrNode->getOperand(0)) : nullptr;
+          if (attrName == nullptr || attrName->getString() != "reqd_work_group_size")
+            continue;
+          for (uint32_t i = 0; i < 3; ++i)
+#if LLVM_VERSION_MAJOR * 10 + LLVM_VERSION_MINOR <= 35
+            sizes[i] = cast<ConstantInt>(attrNode->getOperand(i + 1))->getZExtValue();
+#else
+            sizes[i] = mdconst::extract<ConstantInt>(attrNode->getOperand(i + 1))->getZExtValue();
+#endif
+        }
+      }
+#endif
+      it = reqdLocalSizes.insert(std::make_pair(F, sizes)).first;
+    }
+    return it->second[dim];
+  }
+
+  bool SLMPadding::isInRange(Value *v, uint64_t bound) {
+    if (ConstantInt *imm = dyn_cast<ConstantInt>(v))
+      return imm->getSExtValue() >= 0 && (uint64_t) imm->getSExtValue() < bound;
+
+    if (CallInst *call = dyn_cast<CallInst>(v)) {
+      Function *F = call->getCalledFunction();
+      if (F == NULL || F->getName().find("__gen_ocl_get_local_id") != 0)
+        return false;
+      Function *kernel = call->getParent()->getParent();
+      uint32_t size = 0;
+      switch (intrinsicMap.find(F->getName().str())) {
+        case GEN_OCL_GET_LOCAL_ID0: size = getReqdLocalSize(kernel, 0); break;
+        case GEN_OCL_GET_LOCAL_ID1: size = getReqdLocalSize(kernel, 1); break;
+        case GEN_OCL_GET_LOCAL_ID2: size = getReqdLocalSize(kernel, 2); break;
+        default: break;
+      }
+      return size != 0 && size <= bound;
+    }
+
+    if (isa<ZExtInst>(v) || isa<SExtInst>(v))
+      return isInRange(cast<CastInst>(v)->getOperand(0), bound);
+    // The bound must stay positive in the smaller type
+    if (TruncInst *trunc = dyn_cast<TruncInst>(v)) {
+      const uint32_t bits = trunc->getType()->getIntegerBitWidth();
+      return bits > 1 && bound <= (1ull << std::min(bits - 1, 62u)) &&
+             isInRange(trunc->getOperand(0), bound);
+    }
+
+    if (SelectInst *sel = dyn_cast<SelectInst>(v))
+      return isInRange(sel->getTrueValue(), bound) && isInRange(sel->getFalseValue(), bound);
+
+    if (BinaryOperator *bin = dyn_cast<BinaryOperator>(v)) {
+      // x & y is not larger than x or y when they are not negative
+      if (bin->getOpcode() == Instruction::And)
+        return isInRange(bin->getOperand(0), bound) || isInRange(bin->getOperand(1), bound);
+      if (bin->getOpcode() == Instruction::URem) {
+        ConstantInt *imm = dyn_cast<ConstantInt>(bin->getOperand(1));
+        return imm != NULL && imm->getZExtValue() != 0 && imm->getZExtValue() <= bound;
+      }
+    }
+    return false;
+  }
+
+  bool SLMPadding::getLaneCoeff(Value *v, int64_t &coeff) {
+    auto it = laneCoeffs.find(v);
+    if (it != laneCoeffs.end()) {
+      coeff = it->second.second;
+      return it->second.first;
+    }
+    const bool affine = this->computeLaneCoeff(v, coeff);
+    if (visiting.empty())
+      laneCoeffs[v] = std::make_pair(affine, coeff);
+    return affine;
+  }
+
+  bool SLMPadding::computeLaneCoeff(Value *v, int64_t &coeff) {
+    coeff = 0;
+    if (isa<Constant>(v) || isa<Argument>(v))
+      return true;
+
+    if (CallInst *call = dyn_cast<CallInst>(v)) {
+      Function *F = call->getCalledFunction();
+      if (F == NULL || F->getName().find("__gen_ocl_get_") != 0)
+        return false;
+      switch (intrinsicMap.find(F->getName().str())) {
+        case GEN_OCL_GET_LOCAL_ID0:
+        {
+          const uint32_t size = getReqdLocalSize(call->getParent()->getParent(), 0);
+          coeff = 1;
+          return size == 0 || size % slmLaneNum == 0;
+        }
+        // The lanes of a thread have consecutive local ids 0 and the same
+        // local ids 1 and 2 only when the rows are made of whole threads
+        case GEN_OCL_GET_LOCAL_ID1:
+        case GEN_OCL_GET_LOCAL_ID2:
+        {
+          const uint32_t size = getReqdLocalSize(call->getParent()->getParent(), 0);
+          return size != 0 && size % slmLaneNum == 0;
+        }
+        case GEN_OCL_GET_GROUP_ID0:
+        case GEN_OCL_GET_GROUP_ID1:
+        case GEN_OCL_GET_GROUP_ID2:
+        case GEN_OCL_GET_NUM_GROUPS0:
+        case GEN_OCL_GET_NUM_GROUPS1:
+        case GEN_OCL_GET_NUM_GROUPS2:
+        case GEN_OCL_GET_LOCAL_SIZE0:
+        case GEN_OCL_GET_LOCAL_SIZE1:
+        case GEN_OCL_GET_LOCAL_SIZE2:
+        case GEN_OCL_GET_ENQUEUED_LOCAL_SIZE0:
+        case GEN_OCL_GET_ENQUEUED_LOCAL_SIZE1:
+        case GEN_OCL_GET_ENQUEUED_LOCAL_SIZE2:
+        case GEN_OCL_GET_GLOBAL_SIZE0:
+        case GEN_OCL_GET_GLOBAL_SIZE1:
+        case GEN_OCL_GET_GLOBAL_SIZE2:
+        case GEN_OCL_GET_GLOBAL_OFFSET0:
+        case GEN_OCL_GET_GLOBAL_OFFSET1:
+        case GEN_OCL_GET_GLOBAL_OFFSET2:
+          return true;
+        default:
+          return false;
+      }
+    }
+
+    if (CastInst *cast = dyn_cast<CastInst>(v))
+      return getLaneCoeff(cast->getOperand(0), coeff);
+
+    if (BinaryOperator *bin = dyn_cast<BinaryOperator>(v)) {
+      int64_t c0, c1;
+      if (!getLaneCoeff(bin->getOperand(0), c0) || !getLaneCoeff(bin->getOperand(1), c1))
+        return false;
+      ConstantInt *imm0 = dyn_cast<ConstantInt>(bin->getOperand(0));
+      ConstantInt *imm1 = dyn_cast<ConstantInt>(bin->getOperand(1));
+      switch (bin->getOpcode()) {
+        case Instruction::Add: coeff = c0 + c1; return true;
+        case Instruction::Sub: coeff = c0 - c1; return true;
+        case Instruction::Mul:
+          if (c0 == 0 && c1 == 0) return true;
+          if (imm1) { coeff = c0 * imm1->getSExtValue(); return true; }
+          if (imm0) { coeff = c1 * imm0->getSExtValue(); return true; }
+          return false;
+        case Instruction::Shl:
+          if (imm1 && imm1->getZExtValue() < 32) {
+            coeff = c0 << imm1->getZExtValue();
+            return true;
+          }
+          return c0 == 0 && c1 == 0;
+        // Other operations of uniform values are uniform
+        default:
+          return c0 == 0 && c1 == 0;
+      }
+    }
+
+    if (GetElementPtrInst *gep = dyn_cast<GetElementPtrInst>(v)) {
+      vector<int64_t> coeffs;
+      if (!getLaneCoeff(gep->getPointerOperand(), coeff) || !getIndexCoeffs(gep, coeffs))
+        return false;
+      Type *ty = gep->getPointerOperand()->getType();
+      for (uint32_t i = 0; i < coeffs.size(); ++i) {
+        // Struct indices are constants, their coefficient is 0
+        if (ty->isStructTy()) {
+          ty = getEltType(ty, cast<ConstantInt>(gep->getOperand(i + 1))->getZExtValue());
+          continue;
+        }
+        ty = getEltType(ty, 0);
+        uint32_t size = getTypeByteSize(unit, ty);
+        size += getPadding(size, getAlignmentByte(unit, ty));
+        coeff += coeffs[i] * size;
+      }
+      return true;
+    }
+
+    // Loop counters and pointers, all the incoming values must agree. The PHI
+    // being computed counts as uniform
+    if (PHINode *phi = dyn_cast<PHINode>(v)) {
+      if (visiting.find(phi) != visiting.end())
+        return true;
+      visiting.insert(phi);
+      bool affine = true;
+      for (uint32_t i = 0; affine && i < phi->getNumIncomingValues(); ++i) {
+        int64_t c;
+        affine = getLaneCoeff(phi->getIncomingValue(i), c) && (i == 0 || c == coeff);
+        coeff = c;
+      }
+      visiting.erase(phi);
+      return affine;
+    }
+
+    if (SelectInst *sel = dyn_cast<SelectInst>(v)) {
+      int64_t c0, c1;
+      return getLaneCoeff(sel->getTrueValue(), c0) && getLaneCoeff(sel->getFalseValue(), c1) &&
+             c0 == 0 && c1 == 0;
+    }
+    return false;
+  }
+
+  bool SLMPadding::getIndexCoeffs(GetElementPtrInst *gep, vector<int64_t> &coeffs) {
+    for (uint32_t i = 1; i < gep->getNumOperands(); ++i) {
+      int64_t c;
+      if (!getLaneCoeff(gep->getOperand(i), c))
+        return false;
+      coeffs.push_back(c);
+    }
+    return true;
+  }
+
+  Type *SLMPadding::getPaddedType(Type *ty, uint32_t pad) {
+    ArrayType *arrayTy = cast<ArrayType>(ty);
+    Type *eltTy = arrayTy->getElementType();
+    if (!eltTy->isArrayTy())
+      return ArrayType::get(eltTy, arrayTy->getNumElements() + pad);
+    return ArrayType::get(getPaddedType(eltTy, pad), arrayTy->getNumElements());
+  }
+
+  uint32_t SLMPadding::getPaddedCost(ArrayType *ty, const vector<vector<int64_t>> &accesses,
+                                     const vector<uint32_t> &sizes, uint32_t pad) {
+    // Byte size of one element of each dimension, the first GEP index steps
+    // over the whole array
+    Type *paddedTy = getPaddedType(ty, pad);
+    vector<int64_t> strides;
+    for (Type *t = paddedTy; ; t = getEltType(t, 0)) {
+      strides.push_back(getTypeByteSize(unit, t));
+      if (!t->isArrayTy())
+        break;
+    }
+    uint32_t cost = 0;
+    for (uint32_t i = 0; i < accesses.size(); ++i) {
+      int64_t stride = 0;
+      for (uint32_t dim = 0; dim < accesses[i].size(); ++dim)
+        stride += accesses[i][dim] * strides[dim];
+      cost += getConflictDegree(stride, sizes[i]);
+    }
+    return cost;
+  }
+
+  bool SLMPadding::padArray(Module &M, GlobalVariable *gv) {
+    // Only the arrays of arrays whose elements are accessed directly
+    ArrayType *ty = dyn_cast<ArrayType>(gv->getType()->getElementType());
+    if (ty == NULL || !ty->getElementType()->isArrayTy() || !isa<UndefValue>(gv->getInitializer()))
+      return false;
+    uint32_t dimNum = 0, rowSize = 0;
+    Type *eltTy = ty;
+    for (; eltTy->isArrayTy(); eltTy = getEltType(eltTy, 0)) {
+      rowSize = cast<ArrayType>(eltTy)->getNumElements();
+      dimNum++;
+    }
+    if (eltTy->isAggregateType())
+      return false;
+
+    vector<GetElementPtrInst*> geps;
+    vector<vector<int64_t>> accesses;
+    vector<uint32_t> sizes;
+    for (auto it = gv->use_begin(); it != gv->use_end(); ++it) {
+#if LLVM_VERSION_MAJOR * 10 + LLVM_VERSION_MINOR >= 35
+      User *user = it->getUser();
+#else
+      User *user = *it;
+#endif
+      GetElementPtrInst *gep = dyn_cast<GetElementPtrInst>(user);
+      if (gep == NULL || gep->getPointerOperand() != gv || gep->getNumIndices() != dimNum + 1)
+        return false;
+      ConstantInt *first = dyn_cast<ConstantInt>(gep->getOperand(1));
+      if (first == NULL || !first->isZero())
+        return false;
+      // The padding moves the elements reached through an index out of its
+      // dimension
+      Type *dimTy = getEltType(ty, 0);
+      for (uint32_t i = 3; i < gep->getNumOperands(); ++i, dimTy = getEltType(dimTy, 0))
+        if (!isInRange(gep->getOperand(i), cast<ArrayType>(dimTy)->getNumElements()))
+          return false;
+      for (auto uit = gep->use_begin(); uit != gep->use_end(); ++uit) {
+#if LLVM_VERSION_MAJOR * 10 + LLVM_VERSION_MINOR >= 35
+        User *gepUser = uit->getUser();
+#else
+        User *gepUser = *uit;
+#endif
+        StoreInst *store = dyn_cast<StoreInst>(gepUser);
+        if (!isa<LoadInst>(gepUser) && (store == NULL || store->getValueOperand() == gep))
+          return false;
+      }
+      geps.push_back(gep);
+      vector<int64_t> coeffs;
+      if (getIndexCoeffs(gep, coeffs)) {
+        accesses.push_back(coeffs);
+        sizes.push_back(getTypeByteSize(unit, eltTy));
+      }
+    }
+    if (accesses.size() == 0)
+      return false;
+
+    // The smallest padding which removes the most conflicts
+    const uint32_t eltSize = getTypeByteSize(unit, eltTy);
+    const uint32_t maxPad = std::max(slmBankNum * 4 / eltSize, 1u);
+    const uint32_t cost = getPaddedCost(ty, accesses, sizes, 0);
+    uint32_t bestCost = cost, bestPad = 0;
+    for (uint32_t pad = 1; pad <= maxPad && bestCost > accesses.size(); ++pad) {
+      if (getTypeByteSize(unit, getPaddedType(ty, pad)) > slmMaxSize)
+        break;
+      const uint32_t padCost = getPaddedCost(ty, accesses, sizes, pad);
+      if (padCost < bestCost) {
+        bestCost = padCost;
+        bestPad = pad;
+      }
+    }
+    if (bestPad == 0)
+      return false;
+
+    const std::string fnName = geps[0]->getParent()->getParent()->getName().str();
+    Type *paddedTy = getPaddedType(ty, bestPad);
+    GlobalVariable *padded = new GlobalVariable(M, paddedTy, gv->isConstant(), gv->getLinkage(),
+                                                UndefValue::get(paddedTy), "", gv,
+                                                gv->getThreadLocalMode(),
+                                                gv->getType()->getAddressSpace());
+    padded->copyAttributesFrom(gv);
+    padded->takeName(gv);
+    for (auto gep : geps) {
+      vector<Value*> indices;
+      for (uint32_t i = 1; i < gep->getNumOperands(); ++i)
+        indices.push_back(gep->getOperand(i));
+#if LLVM_VERSION_MAJOR * 10 + LLVM_VERSION_MINOR >= 37
+      GetElementPtrInst *paddedGEP = GetElementPtrInst::Create(paddedTy, padded, indices, "", gep);
+#else
+      GetElementPtrInst *paddedGEP = GetElementPtrInst::Create(padded, indices, "", gep);
+#endif
+      paddedGEP->setIsInBounds(gep->isInBounds());
+      paddedGEP->takeName(gep);
+      gep->replaceAllUsesWith(paddedGEP);
+      gep->eraseFromParent();
+    }
+    gv->eraseFromParent();
+
+    std::ostringstream msg;
+    msg << fnName << ":(GBE): note: the rows of __local '" << padded->getName().str()
+        << "' are padded from " << rowSize << " to " << rowSize + bestPad << " elements, its " << accesses.size()
+        << " accesses take " << bestCost << " SLM bank cycles instead of " << cost << ".\n";
+    log += msg.str();
+    return true;
+  }
+
+  Value *SLMPadding::getObject(Value *ptr) {
+    while (true) {
+      if (isa<GlobalVariable>(ptr) || isa<Argument>(ptr))
+        return ptr;
+      if (GetElementPtrInst *gep = dyn_cast<GetElementPtrInst>(ptr))
+        ptr = gep->getPointerOperand();
+      else if (CastInst *cast = dyn_cast<CastInst>(ptr))
+        ptr = cast->getOperand(0);
+      else
+        return NULL;
+    }
+  }
+
+  bool SLMPadding::runOnModule(Module &M) {
+    bool changed = false;
+
+    if (OCL_SLM_PADDING) {
+      vector<GlobalVariable*> locals;
+      for (auto &gv : M.getGlobalList())
+        if (gv.getType()->getAddressSpace() == 3 && gv.hasInitializer())
+          locals.push_back(&gv);
+      for (auto gv : locals)
+        changed |= this->padArray(M, gv);
+      // The GEPs of the padded arrays were replaced
+      laneCoeffs.clear();
+    }
+
+    // Report the remaining conflicts, once per array and stride
+    for (auto &F : M) {
+      set<std::pair<Value*, int64_t>> reported;
+      for (auto &BB : F) {
+        for (auto &I : BB) {
+          Value *ptr = NULL;
+          Type *valueTy = NULL;
+          if (LoadInst *load = dyn_cast<LoadInst>(&I)) {
+            ptr = load->getPointerOperand();
+            valueTy = load->getType();
+          } else if (StoreInst *store = dyn_cast<StoreInst>(&I)) {
+            ptr = store->getPointerOperand();
+            valueTy = store->getValueOperand()->getType();
+          } else
+            continue;
+          if (ptr->getType()->getPointerAddressSpace() != 3)
+            continue;
+          int64_t stride;
+          if (!this->getLaneCoeff(ptr, stride))
+            continue;
+          const uint32_t degree = getConflictDegree(stride, getTypeByteSize(unit, valueTy));
+          if (degree == 1)
+            continue;
+          Value *object = this->getObject(ptr);
+          if (!reported.insert(std::make_pair(object, stride)).second)
+            continue;
+          std::ostringstream msg;
+          msg << F.getName().str() << ":(GBE): warning: " << degree
+              << "-way SLM bank conflict, the work items access __local ";
+          if (object && object->hasName())
+            msg << "'" << object->getName().str() << "' ";
+          msg << "with a stride of " << stride << " bytes.\n";
+          log += msg.str();
+        }
+      }
+    }
+    return changed;
+  }
+
+  ModulePass *createSLMPaddingPass(const ir::Unit &unit, std::string &log) {
+    return new SLMPadding(unit, log);
+  }
+
+  char SLMPadding::ID = 0;
+} /* namespace gbe */
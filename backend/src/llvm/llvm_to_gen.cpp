@@ -257,7 +257,7 @@ namespace gbe
   }
 
   bool llvmToGen(ir::Unit &unit, const void* module,
-                 int optLevel, bool strictMath, int profiling, std::string &errors)
+                 int optLevel, bool strictMath, bool mediumMath, int profiling, std::string &errors)
   {
     std::string errInfo;
     std::unique_ptr<llvm::raw_fd_ostream> o = nullptr;
@@ -288,7 +288,7 @@ namespace gbe
 
     /* Before do any thing, we first filter in all CL functions in bitcode. */
     /* Also set unit's pointer size in runBitCodeLinker */
-    M.reset(runBitCodeLinker(cl_mod, strictMath, unit));
+    M.reset(runBitCodeLinker(cl_mod, strictMath, mediumMath, unit));
 
     if (M == nullptr)
       return true;
@@ -314,6 +314,7 @@ namespace gbe
 
     runFuntionPass(mod, libraryInfo, DL);
     runModulePass(mod, libraryInfo, DL, optLevel);
+    std::string slmLog;
 #if LLVM_VERSION_MAJOR * 10 + LLVM_VERSION_MINOR >= 37
     legacy::PassManager passes;
 #else
@@ -349,6 +350,7 @@ namespace gbe
     passes.add(createConstantPropagationPass());   // propagate constant after scalarize/legalize
     passes.add(createExpandConstantExprPass());    // constant prop may generate ConstantExpr
     passes.add(createPromoteIntegersPass());       // align integer size to power of two
+    passes.add(createSLMPaddingPass(unit, slmLog)); // Pad __local arrays before the GEP lowering
     passes.add(createRemoveGEPPass(unit));         // Constant prop may generate gep
     passes.add(createDeadInstEliminationPass());   // Remove simplified instructions
     passes.add(createCFGSimplificationPass());     // Merge & remove BBs
@@ -373,7 +375,7 @@ namespace gbe
 #endif
     passes.add(createGenPass(unit));
     passes.run(mod);
-    errors = dc.str();
+    errors = dc.str() + slmLog;
     if(dc.has_errors()){
       unit.setValid(false);
       delete libraryInfo;
@@ -36,7 +36,7 @@ namespace gbe {
   /*! Convert the LLVM IR code to a GEN IR code,
 		  optLevel 0 equal to clang -O1 and 1 equal to clang -O2*/
   bool llvmToGen(ir::Unit &unit, const void* module,
-                 int optLevel, bool strictMath, int profiling, std::string &errors);
+                 int optLevel, bool strictMath, bool mediumMath, int profiling, std::string &errors);
 } /* namespace gbe */
 
 #endif /* __GBE_IR_LLVM_TO_GEN_HPP__ */
@@ -6,6 +6,7 @@
 #include <sys/time.h>
 #include <iomanip>
 #include <algorithm>
+#include <limits>
 
 using namespace std;
 
@@ -105,6 +106,24 @@ static void benchmark_expected(WG_FUNCTION wg_func,
     for(uint32_t i = 1; i < wg_local_size; i++)
       expected[i] = min(input[i], expected[i - 1]);
   }
+  else if(wg_func == WG_SCAN_EXCLUSIVE_ADD)
+  {
+    expected[0] = 0;
+    for(uint32_t i = 1; i < wg_local_size; i++)
+      expected[i] = input[i - 1] + expected[i - 1];
+  }
+  else if(wg_func == WG_SCAN_EXCLUSIVE_MAX)
+  {
+    expected[0] = numeric_limits<T>::min();
+    for(uint32_t i = 1; i < wg_local_size; i++)
+      expected[i] = max(input[i - 1], expected[i - 1]);
+  }
+  else if(wg_func == WG_SCAN_EXCLUSIVE_MIN)
+  {
+    expected[0] = numeric_limits<T>::max();
+    for(uint32_t i = 1; i < wg_local_size; i++)
+      expected[i] = min(input[i - 1], expected[i - 1]);
+  }
 }
 
 /*
@@ -279,92 +298,31 @@ double benchmark_workgroup_broadcast_2D_long(void)
 MAKE_BENCHMARK_FROM_FUNCTION(benchmark_workgroup_broadcast_2D_long, "GB/S");
 
 /*
- * Benchmark workgroup reduce add
+ * Benchmark workgroup reduce and scans, for every op and integer type
  */
-double benchmark_workgroup_reduce_add_int(void)
-{
-  cl_int *input = NULL;
-  cl_int *expected = NULL;
-  OCL_CREATE_KERNEL_FROM_FILE("bench_workgroup",
-                  "bench_workgroup_reduce_add_int");
-  return benchmark_generic(WG_REDUCE_ADD, input, expected);
-}
-MAKE_BENCHMARK_FROM_FUNCTION(benchmark_workgroup_reduce_add_int, "GB/S");
-double benchmark_workgroup_reduce_add_long(void)
-{
-  cl_long *input = NULL;
-  cl_long *expected = NULL;
-  OCL_CREATE_KERNEL_FROM_FILE("bench_workgroup",
-                  "bench_workgroup_reduce_add_long");
-  return benchmark_generic(WG_REDUCE_ADD, input, expected);
-}
-MAKE_BENCHMARK_FROM_FUNCTION(benchmark_workgroup_reduce_add_long, "GB/S");
-
-/*
- * Benchmark workgroup reduce min
- */
-double benchmark_workgroup_reduce_min_int(void)
-{
-  cl_int *input = NULL;
-  cl_int *expected = NULL;
-  OCL_CREATE_KERNEL_FROM_FILE("bench_workgroup",
-                  "bench_workgroup_reduce_min_int");
-  return benchmark_generic(WG_REDUCE_MIN, input, expected);
-}
-MAKE_BENCHMARK_FROM_FUNCTION(benchmark_workgroup_reduce_min_int, "GB/S");
-double benchmark_workgroup_reduce_min_long(void)
-{
-  cl_long *input = NULL;
-  cl_long *expected = NULL;
-  OCL_CREATE_KERNEL_FROM_FILE("bench_workgroup",
-                  "bench_workgroup_reduce_min_long");
-  return benchmark_generic(WG_REDUCE_MIN, input, expected);
-}
-MAKE_BENCHMARK_FROM_FUNCTION(benchmark_workgroup_reduce_min_long, "GB/S");
-
-/*
- * Benchmark workgroup scan inclusive add
- */
-double benchmark_workgroup_scan_inclusive_add_int(void)
-{
-  cl_int *input = NULL;
-  cl_int *expected = NULL;
-  OCL_CREATE_KERNEL_FROM_FILE("bench_workgroup",
-                  "bench_workgroup_scan_inclusive_add_int");
-  return benchmark_generic(WG_SCAN_INCLUSIVE_ADD, input, expected);
-}
-MAKE_BENCHMARK_FROM_FUNCTION(benchmark_workgroup_scan_inclusive_add_int, "GB/S");
-double benchmark_workgroup_scan_inclusive_add_long(void)
-{
-  cl_long *input = NULL;
-  cl_long *expected = NULL;
-  OCL_CREATE_KERNEL_FROM_FILE("bench_workgroup",
-                  "bench_workgroup_scan_inclusive_add_long");
-  return benchmark_generic(WG_SCAN_INCLUSIVE_ADD, input, expected);
-}
-MAKE_BENCHMARK_FROM_FUNCTION(benchmark_workgroup_scan_inclusive_add_long, "GB/S");
-
-/*
- * Benchmark workgroup scan inclusive min
- */
-double benchmark_workgroup_scan_inclusive_min_int(void)
-{
-  cl_int *input = NULL;
-  cl_int *expected = NULL;
-  OCL_CREATE_KERNEL_FROM_FILE("bench_workgroup",
-                  "bench_workgroup_scan_inclusive_min_int");
-  return benchmark_generic(WG_SCAN_INCLUSIVE_MIN, input, expected);
-}
-MAKE_BENCHMARK_FROM_FUNCTION(benchmark_workgroup_scan_inclusive_min_int, "GB/S");
-double benchmark_workgroup_scan_inclusive_min_long(void)
-{
-  cl_long *input = NULL;
-  cl_long *expected = NULL;
-  OCL_CREATE_KERNEL_FROM_FILE("bench_workgroup",
-                  "bench_workgroup_scan_inclusive_min_long");
-  return benchmark_generic(WG_SCAN_INCLUSIVE_MIN, input, expected);
-}
-MAKE_BENCHMARK_FROM_FUNCTION(benchmark_workgroup_scan_inclusive_min_long, "GB/S");
-
-
-
+#define BENCHMARK_WORKGROUP(FUNC, WG_FUNC, TYPE, CL_TYPE) \
+double benchmark_workgroup_##FUNC##_##TYPE(void) \
+{ \
+  CL_TYPE *input = NULL; \
+  CL_TYPE *expected = NULL; \
+  OCL_CREATE_KERNEL_FROM_FILE("bench_workgroup", \
+                  "bench_workgroup_" #FUNC "_" #TYPE); \
+  return benchmark_generic(WG_FUNC, input, expected); \
+} \
+MAKE_BENCHMARK_FROM_FUNCTION(benchmark_workgroup_##FUNC##_##TYPE, "GB/S");
+
+#define BENCHMARK_WORKGROUP_TYPES(FUNC, WG_FUNC) \
+  BENCHMARK_WORKGROUP(FUNC, WG_FUNC, int, cl_int) \
+  BENCHMARK_WORKGROUP(FUNC, WG_FUNC, uint, cl_uint) \
+  BENCHMARK_WORKGROUP(FUNC, WG_FUNC, long, cl_long) \
+  BENCHMARK_WORKGROUP(FUNC, WG_FUNC, ulong, cl_ulong)
+
+BENCHMARK_WORKGROUP_TYPES(reduce_add, WG_REDUCE_ADD)
+BENCHMARK_WORKGROUP_TYPES(reduce_min, WG_REDUCE_MIN)
+BENCHMARK_WORKGROUP_TYPES(reduce_max, WG_REDUCE_MAX)
+BENCHMARK_WORKGROUP_TYPES(scan_inclusive_add, WG_SCAN_INCLUSIVE_ADD)
+BENCHMARK_WORKGROUP_TYPES(scan_inclusive_min, WG_SCAN_INCLUSIVE_MIN)
+BENCHMARK_WORKGROUP_TYPES(scan_inclusive_max, WG_SCAN_INCLUSIVE_MAX)
+BENCHMARK_WORKGROUP_TYPES(scan_exclusive_add, WG_SCAN_EXCLUSIVE_ADD)
+BENCHMARK_WORKGROUP_TYPES(scan_exclusive_min, WG_SCAN_EXCLUSIVE_MIN)
+BENCHMARK_WORKGROUP_TYPES(scan_exclusive_max, WG_SCAN_EXCLUSIVE_MAX)
@@ -203,6 +203,14 @@ typedef CL_API_ENTRY cl_int
 #define CL_KERNEL_SPILL_MEM_SIZE_INTEL                  0x4109
 #define CL_KERNEL_COMPILE_SUB_GROUP_SIZE_INTEL          0x410A
 
+/* Kernel static data of an NDRange event, from clGetEventProfilingInfo (cl_ulong) */
+#define CL_PROFILING_KERNEL_SIMD_WIDTH_INTEL            0x4180
+#define CL_PROFILING_KERNEL_GRF_SIZE_INTEL              0x4181
+#define CL_PROFILING_KERNEL_SPILL_SIZE_INTEL            0x4182
+#define CL_PROFILING_KERNEL_SCRATCH_SIZE_INTEL          0x4183
+#define CL_PROFILING_KERNEL_THREAD_NUM_INTEL            0x4184
+#define CL_PROFILING_KERNEL_SLM_SIZE_INTEL              0x4185
+
 #ifdef __cplusplus
 }
 #endif
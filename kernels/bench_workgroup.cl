@@ -98,142 +98,37 @@ kernel void bench_workgroup_broadcast_2D_long(global long *src,
 }
 
 /*
- * Benchmark workgroup reduce add
+ * Benchmark workgroup reduce and scans, for every op and integer type
  */
-kernel void bench_workgroup_reduce_add_int(
-  global int *src,
-  global int *dst,
-  int reduce_loop)
-{
-  int val;
-  int result;
-
-  for(; reduce_loop > 0; reduce_loop--){
-    val = src[get_global_id(0)];
-    result = work_group_reduce_add(val);
-  }
-
-  dst[get_global_id(0)] = result;
-}
-
-kernel void bench_workgroup_reduce_add_long(
-  global long *src,
-  global long *dst,
-  int reduce_loop)
-{
-  long val;
-  long result;
-
-  for(; reduce_loop > 0; reduce_loop--){
-    val = src[get_global_id(0)];
-    result = work_group_reduce_add(val);
-  }
-
-  dst[get_global_id(0)] = result;
-}
-
-/*
- * Benchmark workgroup reduce min
- */
-kernel void bench_workgroup_reduce_min_int(
-  global int *src,
-  global int *dst,
-  int reduce_loop)
-{
-  int val;
-  int result;
-
-  for(; reduce_loop > 0; reduce_loop--){
-    val = src[get_global_id(0)];
-    result = work_group_reduce_min(val);
-  }
-
-  dst[get_global_id(0)] = result;
-}
-
-kernel void bench_workgroup_reduce_min_long(
-  global long *src,
-  global long *dst,
-  int reduce_loop)
-{
-  long val;
-  long result;
-
-  for(; reduce_loop > 0; reduce_loop--){
-    val = src[get_global_id(0)];
-    result = work_group_reduce_min(val);
-  }
-
-  dst[get_global_id(0)] = result;
-}
-
-/*
- * Benchmark workgroup scan inclusive add
- */
-kernel void bench_workgroup_scan_inclusive_add_int(
-  global int *src,
-  global int *dst,
-  int reduce_loop)
-{
-  int val;
-  int result;
-
-  for(; reduce_loop > 0; reduce_loop--){
-    val = src[get_global_id(0)];
-    result = work_group_scan_inclusive_add(val);
-  }
-
-  dst[get_global_id(0)] = result;
-}
-
-kernel void bench_workgroup_scan_inclusive_add_long(
-  global long *src,
-  global long *dst,
-  int reduce_loop)
-{
-  long val;
-  long result;
-
-  for(; reduce_loop > 0; reduce_loop--){
-    val = src[get_global_id(0)];
-    result = work_group_scan_inclusive_add(val);
-  }
-
-  dst[get_global_id(0)] = result;
-}
-
-/*
- * Benchmark workgroup scan inclusive min
- */
-kernel void bench_workgroup_scan_inclusive_min_int(
-  global int *src,
-  global int *dst,
-  int reduce_loop)
-{
-  int val;
-  int result;
-
-  for(; reduce_loop > 0; reduce_loop--){
-    val = src[get_global_id(0)];
-    result = work_group_scan_inclusive_add(val);
-  }
-
-  dst[get_global_id(0)] = result;
-}
-
-kernel void bench_workgroup_scan_inclusive_min_long(
-  global long *src,
-  global long *dst,
-  int reduce_loop)
-{
-  long val;
-  long result;
-
-  for(; reduce_loop > 0; reduce_loop--){
-    val = src[get_global_id(0)];
-    result = work_group_scan_inclusive_add(val);
-  }
-
-  dst[get_global_id(0)] = result;
+#define BENCH_WORKGROUP(FUNC, TYPE) \
+kernel void bench_workgroup_##FUNC##_##TYPE( \
+  global TYPE *src, \
+  global TYPE *dst, \
+  int reduce_loop) \
+{ \
+  TYPE val; \
+  TYPE result; \
+ \
+  for(; reduce_loop > 0; reduce_loop--){ \
+    val = src[get_global_id(0)]; \
+    result = work_group_##FUNC(val); \
+  } \
+ \
+  dst[get_global_id(0)] = result; \
 }
 
+#define BENCH_WORKGROUP_TYPES(FUNC) \
+  BENCH_WORKGROUP(FUNC, int) \
+  BENCH_WORKGROUP(FUNC, uint) \
+  BENCH_WORKGROUP(FUNC, long) \
+  BENCH_WORKGROUP(FUNC, ulong)
+
+BENCH_WORKGROUP_TYPES(reduce_add)
+BENCH_WORKGROUP_TYPES(reduce_min)
+BENCH_WORKGROUP_TYPES(reduce_max)
+BENCH_WORKGROUP_TYPES(scan_inclusive_add)
+BENCH_WORKGROUP_TYPES(scan_inclusive_min)
+BENCH_WORKGROUP_TYPES(scan_inclusive_max)
+BENCH_WORKGROUP_TYPES(scan_exclusive_add)
+BENCH_WORKGROUP_TYPES(scan_exclusive_min)
+BENCH_WORKGROUP_TYPES(scan_exclusive_max)
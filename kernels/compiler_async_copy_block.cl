@@ -0,0 +1,22 @@
+/* 16 blocks of 64 dwords (or 32 of 32 dwords in SIMD8) and a tail of 7 */
+#define N 1031
+
+kernel void
+compiler_async_copy_block(__global uint *dst, __global const uint *src)
+{
+  __local uint aligned[N] __attribute__((aligned(16)));
+  __local uint misaligned[N + 1] __attribute__((aligned(16)));
+  const size_t in = get_group_id(0) * N;
+  const size_t out = 2 * in;
+  event_t event;
+
+  /* Block messages and the element loop for the tail, then the element loop
+   * alone as the SLM side is not OWord aligned */
+  event = async_work_group_copy(aligned, src + in, N, 0);
+  event = async_work_group_copy(misaligned + 1, src + in, N, event);
+  wait_group_events(1, &event);
+
+  event = async_work_group_copy(dst + out, aligned, N, 0);
+  event = async_work_group_copy(dst + out + N, misaligned + 1, N, event);
+  wait_group_events(1, &event);
+}
@@ -0,0 +1,16 @@
+/* Unpack and repack 3:5:8 fields, the shapes the backend selects as BFE and BFI2 */
+kernel void compiler_bitfield_extract(global uint *src, global uint *shift, global uint *dst) {
+  int i = get_global_id(0);
+  uint x = src[i];
+  dst[4*i+0] = (x >> 3) & 0x1f;
+  dst[4*i+1] = (x >> 8) & 0xff;
+  dst[4*i+2] = (x >> 20) & 0xfff;
+  dst[4*i+3] = (x >> shift[i]) & 0x7f;
+}
+
+kernel void compiler_bitfield_insert(global uint *src, global uint *field, global uint *dst) {
+  int i = get_global_id(0);
+  uint a = src[i], b = field[i];
+  dst[2*i+0] = (a & ~0xff00u) | ((b << 8) & 0xff00u);
+  dst[2*i+1] = (a & ~0x1f8u) | ((b & 0x3f) << 3);
+}
@@ -0,0 +1,11 @@
+/* The column-wise tile reads conflict in the SLM banks, the tile rows get
+ * padded. The required work group size bounds the tile indices */
+__kernel __attribute__((reqd_work_group_size(16, 16, 1)))
+void compiler_local_transpose(__global const float *src, __global float *dst, int width) {
+  __local float tile[16][16];
+  const int lx = get_local_id(0), ly = get_local_id(1);
+  const int gx = get_group_id(0) * 16, gy = get_group_id(1) * 16;
+  tile[ly][lx] = src[(gy + ly) * width + gx + lx];
+  barrier(CLK_LOCAL_MEM_FENCE);
+  dst[(gx + ly) * width + gy + lx] = tile[lx][ly];
+}
@@ -0,0 +1,19 @@
+kernel void compiler_long_hadd(global ulong *src1, global ulong *src2, global ulong *dst) {
+  int i = get_global_id(0);
+  dst[i] = hadd(src1[i], src2[i]);
+}
+
+kernel void compiler_long_rhadd(global ulong *src1, global ulong *src2, global ulong *dst) {
+  int i = get_global_id(0);
+  dst[i] = rhadd(src1[i], src2[i]);
+}
+
+kernel void compiler_long_hadd_signed(global long *src1, global long *src2, global long *dst) {
+  int i = get_global_id(0);
+  dst[i] = hadd(src1[i], src2[i]);
+}
+
+kernel void compiler_long_rhadd_signed(global long *src1, global long *src2, global long *dst) {
+  int i = get_global_id(0);
+  dst[i] = rhadd(src1[i], src2[i]);
+}
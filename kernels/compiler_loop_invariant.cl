@@ -0,0 +1,12 @@
+/* The addresses derive from the global id in the loops, with a trip count
+ * depending on the lane */
+kernel void compiler_loop_invariant(global int *dst, global const int *src,
+                                    int stride, int n)
+{
+  int gid = get_global_id(0);
+  int sum = 0;
+  for (int k = 0; k < n + (gid & 3); k++)
+    for (int j = 0; j < 3; j++)
+      sum += src[gid * stride + k * 3 + j] * (j + 1);
+  dst[gid] = sum;
+}
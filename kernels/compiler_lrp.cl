@@ -0,0 +1,5 @@
+kernel void compiler_lrp(global float *dst, global float *a, global float *b, global float *c)
+{
+  int i = get_global_id(0);
+  dst[i] = a[i] * b[i] + (1.0f - a[i]) * c[i];
+}
@@ -0,0 +1,11 @@
+void __gen_ocl_prefetch(const global void *p);
+
+kernel void compiler_prefetch(global int *dst, global int *src)
+{
+  int gid = get_global_id(0);
+  int base = get_group_id(0) * get_local_size(0);
+  /* Warm the whole group's slice, then a raw line hint for the next one */
+  prefetch(src + base, get_local_size(0));
+  __gen_ocl_prefetch(src + base + get_local_size(0));
+  dst[gid] = src[gid] * 2 + 1;
+}
@@ -0,0 +1,17 @@
+__kernel void
+compiler_read_image_ld(__read_only image2d_t src,
+                       sampler_t sampler0,
+                       __global float4 *dst0,
+                       __global float4 *dst1,
+                       __global float4 *dst2)
+{
+  const sampler_t sampler1 = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_NONE | CLK_FILTER_NEAREST;
+  int x = get_global_id(0);
+  int y = get_global_id(1);
+  int2 coord = (int2)(get_global_size(0) - 1 - x, y);
+  int id = y * get_global_size(0) + x;
+
+  dst0[id] = read_imagef(src, sampler0, coord);
+  dst1[id] = read_imagef(src, sampler1, coord);
+  dst2[id] = read_imagef(src, coord);
+}
@@ -0,0 +1,17 @@
+__kernel void compiler_sub_group_shuffle_const(global int *dst, int c)
+{
+  int i = get_global_id(0);
+  if (i == 0)
+    dst[0] = get_max_sub_group_size();
+  dst++;
+
+  int from = i;
+  dst[i*8] = intel_sub_group_shuffle_xor(from, 1);
+  dst[i*8+1] = intel_sub_group_shuffle_xor(from, 2);
+  dst[i*8+2] = intel_sub_group_shuffle_xor(from, 4);
+  dst[i*8+3] = intel_sub_group_shuffle_xor(from, 8);
+  dst[i*8+4] = intel_sub_group_shuffle_down(from, -from, 1);
+  dst[i*8+5] = intel_sub_group_shuffle_down(from, -from, 5);
+  dst[i*8+6] = intel_sub_group_shuffle_up(from, -from, 3);
+  dst[i*8+7] = sub_group_broadcast(from, c);
+}
@@ -104,6 +104,8 @@ LOCAL_SRC_FILES:= \
     cl_event.c \
     cl_enqueue.c \
     cl_image.c \
+    cl_image_copy.c \
+    cl_printf.c \
     cl_mem.c \
     cl_platform_id.c \
     cl_extensions.c \
@@ -121,6 +123,7 @@ LOCAL_SRC_FILES:= \
     intel/intel_gpgpu.c \
     intel/intel_batchbuffer.c \
     intel/intel_driver.c \
+    null/null_driver.c \
     performance.c
 
 LOCAL_SHARED_LIBRARIES := \
@@ -74,6 +74,18 @@ cl_free(void *ptr)
   ptr = NULL;
 }
 
+LOCAL void
+cl_alloc_untrack(void)
+{
+  atomic_dec(&cl_alloc_n);
+}
+
+LOCAL void
+cl_alloc_track(void)
+{
+  atomic_inc(&cl_alloc_n);
+}
+
 LOCAL size_t
 cl_report_unfreed(void)
 {
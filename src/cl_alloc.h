@@ -38,6 +38,11 @@ extern void *cl_realloc(void *ptr, size_t sz);
 /* Free a pointer allocated with cl_*alloc */
 extern void  cl_free(void *ptr);
 
+/* Take a block parked in an internal cache out of the allocation count, and
+ * put it back when the cache hands it out again */
+extern void cl_alloc_untrack(void);
+extern void cl_alloc_track(void);
+
 /* We count the number of allocation. This function report the number of
  * allocation still unfreed
  */
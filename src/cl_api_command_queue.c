@@ -17,6 +17,7 @@
  */
 #include "cl_command_queue.h"
 #include "cl_device_id.h"
+#include "cl_printf.h"
 #include "CL/cl.h"
 #include <stdio.h>
 
@@ -202,11 +203,17 @@ clFlush(cl_command_queue command_queue)
 cl_int
 clFinish(cl_command_queue command_queue)
 {
+  cl_int err;
+
   if (!CL_OBJECT_IS_COMMAND_QUEUE(command_queue)) {
     return CL_INVALID_COMMAND_QUEUE;
   }
 
-  return cl_command_queue_wait_finish(command_queue);
+  err = cl_command_queue_wait_finish(command_queue);
+  /* Kernel printf output may still be in the drain thread */
+  if (err == CL_SUCCESS)
+    cl_printf_sync(command_queue);
+  return err;
 }
 
 cl_int
@@ -19,6 +19,7 @@
 #include "cl_context.h"
 #include "cl_command_queue.h"
 #include "CL/cl.h"
+#include "CL/cl_intel.h"
 #include <stdio.h>
 
 cl_event
@@ -312,6 +313,18 @@ clGetEventProfilingInfo(cl_event event,
     return CL_INVALID_VALUE;
   }
 
+  if (param_name >= CL_PROFILING_KERNEL_SIMD_WIDTH_INTEL &&
+      param_name <= CL_PROFILING_KERNEL_SLM_SIZE_INTEL) {
+    if (event->event_type != CL_COMMAND_NDRANGE_KERNEL ||
+        cl_kernel_perf_get_info(&event->perf, param_name, &ret_val) != CL_SUCCESS)
+      return CL_INVALID_VALUE;
+    if (param_value)
+      *(cl_ulong *)param_value = ret_val;
+    if (param_value_size_ret)
+      *param_value_size_ret = sizeof(cl_ulong);
+    return CL_SUCCESS;
+  }
+
   if (param_name < CL_PROFILING_COMMAND_QUEUED ||
       param_name > CL_PROFILING_COMMAND_COMPLETE) {
     return CL_INVALID_VALUE;
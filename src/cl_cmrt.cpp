@@ -204,6 +204,10 @@ static bool CreateCmrtMemory(cl_mem mem)
   if (mem->cmrt_mem != NULL)
     return true;
 
+  /* CmRT wraps the whole bo, so it can't be a shared one. */
+  if (!IS_IMAGE(mem) && cl_mem_pool_detach(mem) != CL_SUCCESS)
+    return false;
+
   CmDevice* cmrt_device = (CmDevice*)(mem->ctx->device->cmrt_device);
   int result;
   CmOsResource osResource;
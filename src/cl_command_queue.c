@@ -29,8 +29,8 @@
 #include "cl_driver.h"
 #include "cl_khr_icd.h"
 #include "cl_event.h"
-#include "performance.h"
 #include "cl_cmrt.h"
+#include "cl_printf.h"
 
 #include <assert.h>
 #include <stdio.h>
@@ -85,6 +85,7 @@ cl_command_queue_delete(cl_command_queue queue)
   /* Before we destroy the queue, we should make sure all
      the commands in the queue are finished. */
   cl_command_queue_wait_finish(queue);
+  cl_printf_sync(queue);
   cl_context_remove_queue(queue->ctx, queue);
 
   cl_command_queue_destroy_enqueue(queue);
@@ -128,7 +129,7 @@ cl_command_queue_bind_image(cl_command_queue queue, cl_kernel k, cl_gpgpu gpgpu,
   for (i = 0; i < k->image_sz; i++) {
     int id = k->images[i].arg_idx;
     struct _cl_mem_image *image;
-    assert(interp_kernel_get_arg_type(k->opaque, id) == GBE_ARG_IMAGE);
+    assert(k->arg_desc[id].type == GBE_ARG_IMAGE);
 
     image = cl_mem_image(k->args[id].mem);
     set_image_info(k->curbe, &k->images[i], image);
@@ -167,16 +168,16 @@ cl_command_queue_bind_surface(cl_command_queue queue, cl_kernel k, cl_gpgpu gpgp
   enum gbe_arg_type arg_type; /* kind of argument */
   for (i = 0; i < k->arg_n; ++i) {
     int32_t offset; // location of the address in the curbe
-    arg_type = interp_kernel_get_arg_type(k->opaque, i);
+    arg_type = k->arg_desc[i].type;
     if (!(arg_type == GBE_ARG_GLOBAL_PTR ||
           (arg_type == GBE_ARG_CONSTANT_PTR && ocl_version >= 200) ||
           arg_type == GBE_ARG_PIPE) ||
         !k->args[i].mem)
       continue;
-    offset = interp_kernel_get_curbe_offset(k->opaque, GBE_CURBE_KERNEL_ARGUMENT, i);
+    offset = k->arg_desc[i].curbe_offset;
     if (offset < 0)
       continue;
-    bti = interp_kernel_get_arg_bti(k->opaque, i);
+    bti = k->arg_desc[i].bti;
     if(*max_bti < bti)
       *max_bti = bti;
     if (k->args[i].mem->type == CL_MEM_SUBBUFFER_TYPE) {
@@ -247,8 +248,6 @@ cl_command_queue_ND_range(cl_command_queue queue,
                           const size_t *local_wk_sz,
                           const size_t *local_wk_sz_use)
 {
-  if(b_output_kernel_perf)
-    time_start(queue->ctx, cl_kernel_get_name(k), queue);
   const int32_t ver = cl_driver_get_ver(queue->ctx->drv);
   cl_int err = CL_SUCCESS;
 
@@ -270,7 +269,7 @@ error:
 }
 
 LOCAL int
-cl_command_queue_flush_gpgpu(cl_gpgpu gpgpu)
+cl_command_queue_flush_gpgpu(cl_command_queue queue, cl_gpgpu gpgpu)
 {
   void* printf_info = cl_gpgpu_get_printf_info(gpgpu);
   void* profiling_info;
@@ -278,14 +277,9 @@ cl_command_queue_flush_gpgpu(cl_gpgpu gpgpu)
   if (cl_gpgpu_flush(gpgpu) < 0)
     return CL_OUT_OF_RESOURCES;
 
-  if (printf_info && interp_get_printf_num(printf_info)) {
-    void *addr = cl_gpgpu_map_printf_buffer(gpgpu);
-    interp_output_printf(printf_info, addr);
-    cl_gpgpu_unmap_printf_buffer(gpgpu);
-  }
-
+  /* Owns printf_info from now on */
   if (printf_info) {
-    interp_release_printf_info(printf_info);
+    cl_printf_output(queue, gpgpu, printf_info);
     cl_gpgpu_set_printf_info(gpgpu, NULL);
   }
 
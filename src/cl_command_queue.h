@@ -51,6 +51,7 @@ typedef struct _cl_command_queue {
   cl_command_queue_properties props;   /* Queue properties */
   cl_mem perf;                         /* Where to put the perf counters */
   cl_uint size;                        /* Store the specified size for queueu */
+  cl_uint printf_stream_n;             /* Printf buffers not drained yet, under the drain lock */
 } _cl_command_queue;;
 
 #define CL_OBJECT_COMMAND_QUEUE_MAGIC 0x83650a12b79ce4efLL
@@ -81,7 +82,7 @@ extern cl_int cl_command_queue_ND_range(cl_command_queue queue,
 /* The memory object where to report the performance */
 extern cl_int cl_command_queue_set_report_buffer(cl_command_queue, cl_mem);
 /* Flush for the specified gpgpu */
-extern int cl_command_queue_flush_gpgpu(cl_gpgpu);
+extern int cl_command_queue_flush_gpgpu(cl_command_queue, cl_gpgpu);
 /* Bind all the surfaces in the GPGPU state */
 extern cl_int cl_command_queue_bind_surface(cl_command_queue, cl_kernel, cl_gpgpu, uint32_t *);
 /* Bind all the image surfaces in the GPGPU state */
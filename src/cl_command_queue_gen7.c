@@ -27,6 +27,7 @@
 #include "cl_utils.h"
 #include "cl_alloc.h"
 #include "cl_device_enqueue.h"
+#include "cl_printf.h"
 
 #include <assert.h>
 #include <stdio.h>
@@ -40,20 +41,19 @@ static INLINE size_t cl_kernel_compute_batch_sz(cl_kernel k) { return 256+256; }
  *  same work group. Right now, it consists in local IDs and block IPs
  */
 static cl_int
-cl_set_varying_payload(const cl_kernel ker,
-                       char *data,
-                       const size_t *local_wk_sz,
-                       size_t simd_sz,
-                       size_t cst_sz,
-                       size_t thread_n)
+cl_build_varying_payload(const cl_kernel ker,
+                         cl_varying_payload payload,
+                         const size_t *local_wk_sz,
+                         size_t simd_sz,
+                         size_t cst_sz,
+                         size_t thread_n)
 {
-  uint32_t *ids[3] = {NULL,NULL,NULL};
-  uint16_t *block_ips = NULL;
-  uint32_t *thread_ids = NULL;
-  size_t i, j, k, curr = 0;
+  size_t i = 0, j = 0, k = 0, t, l, curr = 0;
+  size_t local_sz = local_wk_sz[0] * local_wk_sz[1] * local_wk_sz[2];
   int32_t id_offset[3], ip_offset, tid_offset;
-  cl_int err = CL_SUCCESS;
   int32_t dw_ip_offset = -1;
+  cl_int err = CL_SUCCESS;
+  char *data = NULL;
 
   id_offset[0] = interp_kernel_get_curbe_offset(ker->opaque, GBE_CURBE_LOCAL_ID_X, 0);
   id_offset[1] = interp_kernel_get_curbe_offset(ker->opaque, GBE_CURBE_LOCAL_ID_Y, 0);
@@ -65,66 +65,118 @@ cl_set_varying_payload(const cl_kernel ker,
   assert(ip_offset < 0 || dw_ip_offset < 0);
   assert(ip_offset >= 0 || dw_ip_offset >= 0);
 
-  if (id_offset[0] >= 0)
-    TRY_ALLOC(ids[0], (uint32_t*) alloca(sizeof(uint32_t)*thread_n*simd_sz));
-  if (id_offset[1] >= 0)
-    TRY_ALLOC(ids[1], (uint32_t*) alloca(sizeof(uint32_t)*thread_n*simd_sz));
-  if (id_offset[2] >= 0)
-    TRY_ALLOC(ids[2], (uint32_t*) alloca(sizeof(uint32_t)*thread_n*simd_sz));
-  TRY_ALLOC(block_ips, (uint16_t*) alloca(sizeof(uint16_t)*thread_n*simd_sz));
-  if (tid_offset >= 0) {
-    TRY_ALLOC(thread_ids, (uint32_t*) alloca(sizeof(uint32_t)*thread_n));
-    memset(thread_ids, 0, sizeof(uint32_t)*thread_n);
-  }
-  /* 0xffff means that the lane is inactivated */
-  memset(block_ips, 0xff, sizeof(int16_t)*thread_n*simd_sz);
-
-
-  /* Compute the IDs and the block IPs */
-  for (k = 0; k < local_wk_sz[2]; ++k)
-  for (j = 0; j < local_wk_sz[1]; ++j)
-  for (i = 0; i < local_wk_sz[0]; ++i, ++curr) {
-    if (id_offset[0] >= 0)
-      ids[0][curr] = i;
-    if (id_offset[1] >= 0)
-      ids[1][curr] = j;
-    if (id_offset[2] >= 0)
-      ids[2][curr] = k;
-    block_ips[curr] = 0;
-    if (thread_ids)
-      thread_ids[curr/simd_sz] = curr/simd_sz;
-  }
+  TRY_ALLOC(data, (char*) cl_calloc(thread_n, cst_sz));
+  cl_free(payload->data);
+  payload->data = data;
 
-  /* Copy them to the curbe buffer */
-  curr = 0;
-  for (i = 0; i < thread_n; ++i, data += cst_sz) {
+  payload->range_n = 0;
+#define ADD_RANGE(OFFSET, SIZE)                                  \
+  if ((OFFSET) >= 0) {                                           \
+    payload->range_offset[payload->range_n] = (OFFSET);          \
+    payload->range_size[payload->range_n] = (SIZE);              \
+    payload->range_n++;                                          \
+  }
+  ADD_RANGE(id_offset[0], sizeof(uint32_t) * simd_sz);
+  ADD_RANGE(id_offset[1], sizeof(uint32_t) * simd_sz);
+  ADD_RANGE(id_offset[2], sizeof(uint32_t) * simd_sz);
+  ADD_RANGE(ip_offset, sizeof(uint16_t) * simd_sz);
+  ADD_RANGE(dw_ip_offset, sizeof(uint32_t) * simd_sz);
+  ADD_RANGE(tid_offset, sizeof(uint32_t));
+#undef ADD_RANGE
+
+  /* Walk the work items in order, the IDs are just incremented instead of
+   * being divided out of the linear index. */
+  for (t = 0; t < thread_n; ++t, data += cst_sz) {
     uint32_t *ids0 = (uint32_t *) (data + id_offset[0]);
     uint32_t *ids1 = (uint32_t *) (data + id_offset[1]);
     uint32_t *ids2 = (uint32_t *) (data + id_offset[2]);
     uint16_t *ips  = (uint16_t *) (data + ip_offset);
     uint32_t *dw_ips  = (uint32_t *) (data + dw_ip_offset);
 
-    if (thread_ids)
-      *(uint32_t *)(data + tid_offset) = thread_ids[i];
+    if (tid_offset >= 0)
+      *(uint32_t *)(data + tid_offset) = t;
 
-    for (j = 0; j < simd_sz; ++j, ++curr) {
+    for (l = 0; l < simd_sz; ++l) {
+      /* 0xffff means that the lane is inactivated */
+      if (curr >= local_sz) {
+        if (ip_offset >= 0)
+          ips[l] = 0xffff;
+        if (dw_ip_offset >= 0)
+          dw_ips[l] = 0xffff;
+        continue;
+      }
       if (id_offset[0] >= 0)
-        ids0[j] = ids[0][curr];
+        ids0[l] = i;
       if (id_offset[1] >= 0)
-        ids1[j] = ids[1][curr];
+        ids1[l] = j;
       if (id_offset[2] >= 0)
-        ids2[j] = ids[2][curr];
+        ids2[l] = k;
       if (ip_offset >= 0)
-        ips[j] = block_ips[curr];
+        ips[l] = 0;
       if (dw_ip_offset >= 0)
-        dw_ips[j] = block_ips[curr];
+        dw_ips[l] = 0;
+      ++curr;
+      if (++i == local_wk_sz[0]) {
+        i = 0;
+        if (++j == local_wk_sz[1]) {
+          j = 0;
+          ++k;
+        }
+      }
     }
   }
 
+  memcpy(payload->local_wk_sz, local_wk_sz, sizeof(payload->local_wk_sz));
+  payload->simd_sz = simd_sz;
+  payload->cst_sz = cst_sz;
+  payload->thread_n = thread_n;
+
 error:
   return err;
 }
 
+static cl_int
+cl_set_varying_payload(const cl_kernel ker,
+                       char *data,
+                       const size_t *local_wk_sz,
+                       size_t simd_sz,
+                       size_t cst_sz,
+                       size_t thread_n)
+{
+  cl_varying_payload payload;
+  cl_int err = CL_SUCCESS;
+  const char *src;
+  size_t i;
+  uint32_t r;
+
+  /* The cache is shared by all the launches of the kernel, keep it across
+     the check, the rebuild and the copy */
+  CL_OBJECT_LOCK(ker);
+  payload = ker->varying_payload;
+  if (payload == NULL)
+    TRY_ALLOC(payload, ker->varying_payload = CALLOC(_cl_varying_payload));
+
+  /* The curbe layout is fixed for a kernel, only the sizes may change. */
+  if (payload->data == NULL ||
+      payload->local_wk_sz[0] != local_wk_sz[0] ||
+      payload->local_wk_sz[1] != local_wk_sz[1] ||
+      payload->local_wk_sz[2] != local_wk_sz[2] ||
+      payload->simd_sz != simd_sz ||
+      payload->cst_sz != cst_sz ||
+      payload->thread_n != thread_n)
+    TRY (cl_build_varying_payload, ker, payload, local_wk_sz, simd_sz, cst_sz, thread_n);
+
+  /* Copy them to the curbe buffer */
+  src = payload->data;
+  for (i = 0; i < thread_n; ++i, data += cst_sz, src += cst_sz)
+    for (r = 0; r < payload->range_n; ++r)
+      memcpy(data + payload->range_offset[r], src + payload->range_offset[r], payload->range_size[r]);
+
+error:
+  CL_OBJECT_UNLOCK(ker);
+  return err;
+}
+
 static int
 cl_upload_constant_buffer(cl_command_queue queue, cl_kernel ker, cl_gpgpu gpgpu)
 {
@@ -148,7 +200,7 @@ cl_upload_constant_buffer(cl_command_queue queue, cl_kernel ker, cl_gpgpu gpgpu)
   size_t offset = 0;
   uint32_t raw_size = 0, aligned_size =0;
   gbe_program prog = ker->program->opaque;
-  const int32_t arg_n = interp_kernel_get_arg_num(ker->opaque);
+  const int32_t arg_n = ker->arg_n;
   size_t global_const_size = interp_program_get_global_constant_size(prog);
   raw_size = global_const_size;
   // Surface state need 4 byte alignment, and Constant argument's buffer size
@@ -159,9 +211,9 @@ cl_upload_constant_buffer(cl_command_queue queue, cl_kernel ker, cl_gpgpu gpgpu)
   if(global_const_size == 0) aligned_size = 8;
 
   for (arg = 0; arg < arg_n; ++arg) {
-    const enum gbe_arg_type type = interp_kernel_get_arg_type(ker->opaque, arg);
-    if (type == GBE_ARG_CONSTANT_PTR && ker->args[arg].mem) {
-      uint32_t alignment = interp_kernel_get_arg_align(ker->opaque, arg);
+    const cl_kernel_arg_desc *desc = &ker->arg_desc[arg];
+    if (desc->type == GBE_ARG_CONSTANT_PTR && ker->args[arg].mem) {
+      uint32_t alignment = desc->align;
       assert(alignment != 0);
       cl_mem mem = ker->args[arg].mem;
       raw_size += mem->size;
@@ -194,20 +246,20 @@ cl_upload_constant_buffer(cl_command_queue queue, cl_kernel ker, cl_gpgpu gpgpu)
   /* upload constant buffer argument */
   int32_t curbe_offset = 0;
   for (arg = 0; arg < arg_n; ++arg) {
-    const enum gbe_arg_type type = interp_kernel_get_arg_type(ker->opaque, arg);
-    if (type == GBE_ARG_CONSTANT_PTR && ker->args[arg].mem) {
+    const cl_kernel_arg_desc *desc = &ker->arg_desc[arg];
+    if (desc->type == GBE_ARG_CONSTANT_PTR && ker->args[arg].mem) {
       cl_mem mem = ker->args[arg].mem;
-      uint32_t alignment = interp_kernel_get_arg_align(ker->opaque, arg);
-      offset = ALIGN(offset, alignment);
-      curbe_offset = interp_kernel_get_curbe_offset(ker->opaque, GBE_CURBE_KERNEL_ARGUMENT, arg);
+      offset = ALIGN(offset, desc->align);
+      curbe_offset = desc->curbe_offset;
       if (curbe_offset < 0)
         continue;
       *(uint32_t *) (ker->curbe + curbe_offset) = offset;
 
-      cl_buffer_map(mem->bo, 1);
-      void * addr = cl_buffer_get_virtual(mem->bo);
+      void * addr = cl_mem_map(mem, 0);
+      if (mem->type == CL_MEM_SUBBUFFER_TYPE)
+        addr = (char *)addr + ((struct _cl_mem_buffer *)mem)->sub_offset;
       memcpy(cst_addr + offset, addr, mem->size);
-      cl_buffer_unmap(mem->bo);
+      cl_mem_unmap(mem);
       offset += mem->size;
     }
   }
@@ -249,17 +301,16 @@ cl_curbe_fill(cl_kernel ker,
 #undef UPLOAD
 
   /* Handle the various offsets to SLM */
-  const int32_t arg_n = interp_kernel_get_arg_num(ker->opaque);
+  const int32_t arg_n = ker->arg_n;
   int32_t arg, slm_offset = interp_kernel_get_slm_size(ker->opaque);
   ker->local_mem_sz = 0;
   for (arg = 0; arg < arg_n; ++arg) {
-    const enum gbe_arg_type type = interp_kernel_get_arg_type(ker->opaque, arg);
-    if (type != GBE_ARG_LOCAL_PTR)
+    const cl_kernel_arg_desc *desc = &ker->arg_desc[arg];
+    if (desc->type != GBE_ARG_LOCAL_PTR)
       continue;
-    uint32_t align = interp_kernel_get_arg_align(ker->opaque, arg);
-    assert(align != 0);
-    slm_offset = ALIGN(slm_offset, align);
-    offset = interp_kernel_get_curbe_offset(ker->opaque, GBE_CURBE_KERNEL_ARGUMENT, arg);
+    assert(desc->align != 0);
+    slm_offset = ALIGN(slm_offset, desc->align);
+    offset = desc->curbe_offset;
     if (offset < 0)
       continue;
     uint32_t *slmptr = (uint32_t *) (ker->curbe + offset);
@@ -337,21 +388,6 @@ cl_bind_profiling(cl_gpgpu gpgpu, uint32_t simd_sz, cl_kernel ker, size_t global
 }
 
 
-static int
-cl_alloc_printf(cl_gpgpu gpgpu, cl_kernel ker, void* printf_info, int printf_num, size_t global_sz) {
-  /* An guess size. */
-  size_t buf_size = global_sz * sizeof(int) * 16 * printf_num;
-  if (buf_size > 16*1024*1024) //at most.
-    buf_size = 16*1024*1024;
-  if (buf_size < 1*1024*1024) // at least.
-    buf_size = 1*1024*1024;
-
-  if (cl_gpgpu_set_printf_buffer(gpgpu, buf_size, interp_get_printf_buf_bti(printf_info)) != 0)
-	return -1;
-
-  return 0;
-}
-
 LOCAL cl_int
 cl_command_queue_ND_range_gen7(cl_command_queue queue,
                                cl_kernel ker,
@@ -418,16 +454,14 @@ cl_command_queue_ND_range_gen7(cl_command_queue queue,
   printf_info = interp_dup_printfset(ker->opaque);
   cl_gpgpu_set_printf_info(gpgpu, printf_info);
 
-  /* Setup the kernel */
-  if (queue->props & CL_QUEUE_PROFILING_ENABLE)
-    err = cl_gpgpu_state_init(gpgpu, ctx->devices[0]->max_compute_unit * ctx->devices[0]->max_thread_per_unit, cst_sz / 32, 1);
-  else
-    err = cl_gpgpu_state_init(gpgpu, ctx->devices[0]->max_compute_unit * ctx->devices[0]->max_thread_per_unit, cst_sz / 32, 0);
+  /* Setup the kernel. The timestamps are also needed by the kernel perf summary */
+  err = cl_gpgpu_state_init(gpgpu, ctx->devices[0]->max_compute_unit * ctx->devices[0]->max_thread_per_unit, cst_sz / 32,
+                            (queue->props & CL_QUEUE_PROFILING_ENABLE) || cl_kernel_perf_enabled());
   if (err != 0)
     goto error;
   printf_num = interp_get_printf_num(printf_info);
   if (printf_num) {
-    if (cl_alloc_printf(gpgpu, ker, printf_info, printf_num, global_size) != 0)
+    if (cl_printf_alloc(gpgpu, printf_info, global_size) != CL_SUCCESS)
       goto error;
   }
   if (interp_get_profiling_bti(ker->opaque) != 0) {
@@ -492,6 +526,10 @@ cl_command_queue_ND_range_gen7(cl_command_queue queue,
   event->exec_data.queue = queue;
   event->exec_data.gpgpu = gpgpu;
   event->exec_data.type = EnqueueNDRangeKernel;
+  cl_kernel_perf_fill(&event->perf, ker, simd_sz,
+                      thread_n * (global_wk_sz_use[0] / local_wk_sz_use[0]) *
+                      (global_wk_sz_use[1] / local_wk_sz_use[1]) * (global_wk_sz_use[2] / local_wk_sz_use[2]),
+                      kernel.slm_sz, ctx->devices[0]->max_compute_unit * ctx->devices[0]->max_thread_per_unit);
 
   return CL_SUCCESS;
 
@@ -30,6 +30,7 @@
 #include "cl_khr_icd.h"
 #include "cl_kernel.h"
 #include "cl_program.h"
+#include "cl_printf.h"
 
 #include "CL/cl.h"
 #include "CL/cl_gl.h"
@@ -72,26 +73,107 @@ cl_context_remove_queue(cl_context ctx, cl_command_queue queue) {
   queue->ctx = NULL;
 }
 
+LOCAL cl_context_obj_shard
+cl_context_get_obj_shard(_cl_context_obj_shard *shards, const void *obj)
+{
+  /* Objects come from malloc, drop the low bits which are always the same. */
+  size_t h = (size_t)obj >> 6;
+  h ^= h >> 7;
+  return &shards[h & (CL_CONTEXT_OBJ_SHARD_NUM - 1)];
+}
+
+static void
+cl_context_shard_add(_cl_context_obj_shard *shards, cl_base_object obj)
+{
+  cl_context_obj_shard shard = cl_context_get_obj_shard(shards, obj);
+  pthread_mutex_lock(&shard->lock);
+  list_add_tail(&shard->objs, &obj->node);
+  pthread_mutex_unlock(&shard->lock);
+}
+
+static void
+cl_context_shard_remove(_cl_context_obj_shard *shards, cl_base_object obj)
+{
+  cl_context_obj_shard shard = cl_context_get_obj_shard(shards, obj);
+  pthread_mutex_lock(&shard->lock);
+  list_node_del(&obj->node);
+  pthread_mutex_unlock(&shard->lock);
+}
+
+static void
+cl_context_shards_init(_cl_context_obj_shard *shards)
+{
+  int i;
+  for (i = 0; i < CL_CONTEXT_OBJ_SHARD_NUM; i++) {
+    pthread_mutex_init(&shards[i].lock, NULL);
+    list_init(&shards[i].objs);
+  }
+}
+
+static void
+cl_context_shards_destroy(_cl_context_obj_shard *shards)
+{
+  int i;
+  for (i = 0; i < CL_CONTEXT_OBJ_SHARD_NUM; i++) {
+    assert(list_empty(&shards[i].objs));
+    pthread_mutex_destroy(&shards[i].lock);
+  }
+}
+
+static inline itree_head *
+cl_context_get_ptr_index(cl_context ctx, cl_mem mem)
+{
+  return mem->type == CL_MEM_SVM_TYPE ? &ctx->svm_ptrs : &ctx->mem_ptrs;
+}
+
+/* Need to hold the ptr_lock for write */
+static void
+cl_context_index_mem_ptr(cl_context ctx, cl_mem mem)
+{
+  itree_head *index = cl_context_get_ptr_index(ctx, mem);
+
+  if (itree_node_in_tree(&mem->ptr_node))
+    itree_remove(index, &mem->ptr_node);
+  if (mem->host_ptr == NULL || mem->size == 0)
+    return;
+  itree_insert(index, &mem->ptr_node, (size_t)mem->host_ptr,
+               (size_t)mem->host_ptr + mem->size);
+}
+
 LOCAL void
 cl_context_add_mem(cl_context ctx, cl_mem mem) {
   assert(mem->ctx == NULL);
   cl_context_add_ref(ctx);
 
-  CL_OBJECT_LOCK(ctx);
-  list_add_tail(&ctx->mem_objects, &mem->base.node);
-  ctx->mem_object_num++;
-  CL_OBJECT_UNLOCK(ctx);
+  cl_context_shard_add(ctx->mem_objects, &mem->base);
+  atomic_inc(&ctx->mem_object_num);
+  if (mem->host_ptr) {
+    pthread_rwlock_wrlock(&ctx->ptr_lock);
+    cl_context_index_mem_ptr(ctx, mem);
+    pthread_rwlock_unlock(&ctx->ptr_lock);
+  }
 
   mem->ctx = ctx;
 }
 
+LOCAL void
+cl_context_update_mem_ptr(cl_context ctx, cl_mem mem) {
+  assert(mem->ctx == ctx);
+  pthread_rwlock_wrlock(&ctx->ptr_lock);
+  cl_context_index_mem_ptr(ctx, mem);
+  pthread_rwlock_unlock(&ctx->ptr_lock);
+}
+
 LOCAL void
 cl_context_remove_mem(cl_context ctx, cl_mem mem) {
   assert(mem->ctx == ctx);
-  CL_OBJECT_LOCK(ctx);
-  list_node_del(&mem->base.node);
-  ctx->mem_object_num--;
-  CL_OBJECT_UNLOCK(ctx);
+  cl_context_shard_remove(ctx->mem_objects, &mem->base);
+  atomic_dec(&ctx->mem_object_num);
+  if (itree_node_in_tree(&mem->ptr_node)) {
+    pthread_rwlock_wrlock(&ctx->ptr_lock);
+    itree_remove(cl_context_get_ptr_index(ctx, mem), &mem->ptr_node);
+    pthread_rwlock_unlock(&ctx->ptr_lock);
+  }
 
   cl_context_delete(ctx);
   mem->ctx = NULL;
@@ -127,10 +209,8 @@ cl_context_add_event(cl_context ctx, cl_event event) {
   assert(event->ctx == NULL);
   cl_context_add_ref(ctx);
 
-  CL_OBJECT_LOCK(ctx);
-  list_add_tail(&ctx->events, &event->base.node);
-  ctx->event_num++;
-  CL_OBJECT_UNLOCK(ctx);
+  cl_context_shard_add(ctx->events, &event->base);
+  atomic_inc(&ctx->event_num);
 
   event->ctx = ctx;
 }
@@ -138,10 +218,8 @@ cl_context_add_event(cl_context ctx, cl_event event) {
 LOCAL void
 cl_context_remove_event(cl_context ctx, cl_event event) {
   assert(event->ctx == ctx);
-  CL_OBJECT_LOCK(ctx);
-  list_node_del(&event->base.node);
-  ctx->event_num--;
-  CL_OBJECT_UNLOCK(ctx);
+  cl_context_shard_remove(ctx->events, &event->base);
+  atomic_dec(&ctx->event_num);
 
   cl_context_delete(ctx);
   event->ctx = NULL;
@@ -329,17 +407,24 @@ cl_context_new(struct _cl_context_prop *props, cl_uint dev_num, cl_device_id* al
 {
   cl_context ctx = NULL;
 
-  TRY_ALLOC_NO_ERR (ctx, CALLOC(struct _cl_context));
+  /* The registry shards need their cache line alignment */
+  TRY_ALLOC_NO_ERR (ctx, cl_aligned_malloc(sizeof(struct _cl_context), 64));
+  memset(ctx, 0, sizeof(struct _cl_context));
   CL_OBJECT_INIT_BASE(ctx, CL_OBJECT_CONTEXT_MAGIC);
   ctx->devices = all_dev;
   ctx->device_num = dev_num;
   list_init(&ctx->queues);
-  list_init(&ctx->mem_objects);
+  cl_context_shards_init(ctx->mem_objects);
+  pthread_rwlock_init(&ctx->ptr_lock, NULL);
+  itree_init(&ctx->mem_ptrs);
+  itree_init(&ctx->svm_ptrs);
   list_init(&ctx->samplers);
-  list_init(&ctx->events);
+  cl_context_shards_init(ctx->events);
   list_init(&ctx->programs);
   ctx->queue_modify_disable = CL_FALSE;
   TRY_ALLOC_NO_ERR (ctx->drv, cl_driver_new(props));
+  ctx->mem_pool = cl_mem_pool_new();
+  TRY_ALLOC_NO_ERR (ctx->printf_drain, cl_printf_drain_new());
   ctx->props = *props;
   ctx->ver = cl_driver_get_ver(ctx->drv);
 
@@ -392,7 +477,13 @@ cl_context_delete(cl_context ctx)
 
   cl_free(ctx->prop_user);
   cl_free(ctx->devices);
+  cl_mem_pool_delete(ctx->mem_pool);
+  cl_printf_drain_delete(ctx->printf_drain);
   cl_driver_delete(ctx->drv);
+  cl_context_shards_destroy(ctx->mem_objects);
+  assert(ctx->mem_ptrs.root == NULL && ctx->svm_ptrs.root == NULL);
+  pthread_rwlock_destroy(&ctx->ptr_lock);
+  cl_context_shards_destroy(ctx->events);
   CL_OBJECT_DESTROY_BASE(ctx);
   cl_free(ctx);
 }
@@ -448,7 +539,7 @@ cl_context_get_static_kernel_from_bin(cl_context ctx, cl_int index,
       ctx->internal_kernels[index] = cl_program_create_kernel(ctx->internal_prgs[index],
                                                               "__cl_fill_region_align8_16", NULL);
     } else {
-      ctx->internal_kernels[index] = cl_kernel_dup(ctx->internal_prgs[index]->ker[0]);
+      ctx->internal_kernels[index] = cl_kernel_dup(cl_program_get_kernel(ctx->internal_prgs[index], 0));
     }
   }
   ker = ctx->internal_kernels[index];
@@ -459,36 +550,30 @@ unlock:
 }
 
 
+static cl_mem
+cl_context_find_mem_from_ptr(cl_context ctx, itree_head *index, const void * p)
+{
+  itree_node *node;
+
+  pthread_rwlock_rdlock(&ctx->ptr_lock);
+  node = itree_find(index, (size_t)p);
+  pthread_rwlock_unlock(&ctx->ptr_lock);
+  if (node == NULL)
+    return NULL;
+  return list_entry(node, _cl_mem, ptr_node);
+}
+
 cl_mem
 cl_context_get_svm_from_ptr(cl_context ctx, const void * p)
 {
-  struct list_node *pos;
-  cl_mem buf;
-
-  list_for_each (pos, (&ctx->mem_objects)) {
-    buf = (cl_mem)list_entry(pos, _cl_base_object, node);
-    if(buf->host_ptr == NULL) continue;
-    if(buf->is_svm == 0) continue;
-    if(buf->type != CL_MEM_SVM_TYPE) continue;
-    if((size_t)buf->host_ptr <= (size_t)p &&
-       (size_t)p < ((size_t)buf->host_ptr + buf->size))
-      return buf;
-  }
-  return NULL;
+  return cl_context_find_mem_from_ptr(ctx, &ctx->svm_ptrs, p);
 }
 
 cl_mem
 cl_context_get_mem_from_ptr(cl_context ctx, const void * p)
 {
-  struct list_node *pos;
-  cl_mem buf;
-
-  list_for_each (pos, (&ctx->mem_objects)) {
-    buf = (cl_mem)list_entry(pos, _cl_base_object, node);
-    if(buf->host_ptr == NULL) continue;
-    if((size_t)buf->host_ptr <= (size_t)p &&
-       (size_t)p < ((size_t)buf->host_ptr + buf->size))
-      return buf;
-  }
-  return NULL;
+  cl_mem mem = cl_context_find_mem_from_ptr(ctx, &ctx->svm_ptrs, p);
+  if (mem == NULL)
+    mem = cl_context_find_mem_from_ptr(ctx, &ctx->mem_ptrs, p);
+  return mem;
 }
@@ -94,6 +94,18 @@ struct _cl_context_prop {
   };
 };
 
+/* The mem object and event registries are hit on every buffer/event creation
+   and release, so they are split into shards, each with its own lock, and the
+   shard is chosen by hashing the object address. */
+#define CL_CONTEXT_OBJ_SHARD_NUM 16
+
+typedef struct _cl_context_obj_shard {
+  pthread_mutex_t lock;             /* Protect the objects list of this shard */
+  list_head objs;                   /* The objects hashed to this shard */
+} __attribute__((aligned(64))) _cl_context_obj_shard; /* One shard per cache line */
+
+typedef _cl_context_obj_shard *cl_context_obj_shard;
+
 #define IS_EGL_CONTEXT(ctx)  (ctx->props.gl_type == CL_GL_EGL_DISPLAY)
 #define EGL_DISP(ctx)   (EGLDisplay)(ctx->props.egl_display)
 #define EGL_CTX(ctx)    (EGLContext)(ctx->props.gl_context)
@@ -106,12 +118,19 @@ struct _cl_context {
   list_head queues;                 /* All command queues currently allocated */
   cl_uint queue_num;                /* All queue number currently allocated */
   cl_uint queue_modify_disable;     /* Temp disable queue list change. */
-  list_head mem_objects;            /* All memory object currently allocated */
-  cl_uint mem_object_num;           /* All memory number currently allocated */
+  _cl_context_obj_shard mem_objects[CL_CONTEXT_OBJ_SHARD_NUM];
+                                    /* All memory object currently allocated */
+  atomic_t mem_object_num;          /* All memory number currently allocated */
+  pthread_rwlock_t ptr_lock;        /* Protect the host_ptr indexes below */
+  itree_head mem_ptrs;              /* host_ptr range of all mem objects except SVM */
+  itree_head svm_ptrs;              /* host_ptr range of all SVM objects */
+  struct _cl_mem_pool *mem_pool;    /* Sub-allocator for small buffers, NULL if disabled */
+  struct _cl_printf_drain *printf_drain; /* Kernel printf drain thread */
   list_head samplers;               /* All sampler object currently allocated */
   cl_uint sampler_num;              /* All sampler number currently allocated */
-  list_head events;                 /* All event object currently allocated */
-  cl_uint event_num;                /* All event number currently allocated */
+  _cl_context_obj_shard events[CL_CONTEXT_OBJ_SHARD_NUM];
+                                    /* All event object currently allocated */
+  atomic_t event_num;               /* All event number currently allocated */
   list_head programs;               /* All programs currently allocated */
   cl_uint program_num;              /* All program number currently allocated */
 
@@ -139,11 +158,15 @@ extern void cl_context_add_queue(cl_context ctx, cl_command_queue queue);
 extern void cl_context_remove_queue(cl_context ctx, cl_command_queue queue);
 extern void cl_context_add_mem(cl_context ctx, cl_mem mem);
 extern void cl_context_remove_mem(cl_context ctx, cl_mem mem);
+/* Must be called when the host_ptr of a mem already in the context changes */
+extern void cl_context_update_mem_ptr(cl_context ctx, cl_mem mem);
 extern void cl_context_add_sampler(cl_context ctx, cl_sampler sampler);
 extern void cl_context_remove_sampler(cl_context ctx, cl_sampler sampler);
 extern void cl_context_add_event(cl_context ctx, cl_event sampler);
 extern void cl_context_remove_event(cl_context ctx, cl_event sampler);
 extern void cl_context_add_program(cl_context ctx, cl_program program);
+/* Get the registry shard the object belongs to */
+extern cl_context_obj_shard cl_context_get_obj_shard(_cl_context_obj_shard *shards, const void *obj);
 extern void cl_context_remove_program(cl_context ctx, cl_program program);
 
 /* Implement OpenCL function */
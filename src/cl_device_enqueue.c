@@ -40,11 +40,14 @@ cl_device_enqueue_fix_offset(cl_kernel ker) {
 
     if(!ker->args[i].is_svm) {
       mem = ker->args[i].mem;
+      /* The bo address must match the host address, so it can't be shared. */
+      cl_mem_pool_detach(mem);
       ptr = cl_mem_map(mem, 0);
       cl_buffer_set_softpin_offset(mem->bo, (size_t)ptr);
       cl_buffer_set_bo_use_full_range(mem->bo, 1);
       cl_buffer_disable_reuse(mem->bo);
       mem->host_ptr = ptr;
+      cl_context_update_mem_ptr(mem->ctx, mem);
       cl_mem_unmap(mem);
       ker->device_enqueue_infos[ker->device_enqueue_info_n++] = ptr;
     } else {
@@ -178,7 +181,7 @@ cl_device_enqueue_parse_result(cl_command_queue queue, cl_gpgpu gpgpu)
     }
     clEnqueueNDRangeKernel(queue, child_ker, dim + 1, fixed_global_off,
                            fixed_global_sz, fixed_local_sz, 0, NULL, &evt);
-    cl_command_queue_flush_gpgpu(gpgpu);
+    cl_command_queue_flush_gpgpu(queue, gpgpu);
     cl_kernel_delete(child_ker);
   }
 
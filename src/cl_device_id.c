@@ -29,6 +29,7 @@
 #include "CL/cl_intel.h"
 #include "cl_gbe_loader.h"
 #include "cl_alloc.h"
+#include "null/null_driver.h"
 
 #include <assert.h>
 #include <stdio.h>
@@ -948,6 +949,9 @@ cl_self_test(cl_device_id device, cl_self_test_res atomic_in_l3_flag)
   "}"; // using __local to catch the "no SLM on Haswell" problem
   static int tested = 0;
   static cl_self_test_res ret = SELF_TEST_OTHER_FAIL;
+  /* Nothing executes on the null driver, the result could only be wrong */
+  if (null_driver_enabled())
+    return SELF_TEST_PASS;
   if (tested != 0)
     return ret;
   tested = 1;
@@ -299,10 +299,14 @@ extern cl_gpgpu_map_profiling_buffer_cb *cl_gpgpu_map_profiling_buffer;
 typedef void (cl_gpgpu_unmap_profiling_buffer_cb)(cl_gpgpu);
 extern cl_gpgpu_unmap_profiling_buffer_cb *cl_gpgpu_unmap_profiling_buffer;
 
-/* Set the printf buffer */
-typedef int (cl_gpgpu_set_printf_buffer_cb)(cl_gpgpu, uint32_t, uint8_t);
+/* Set the printf buffer (size, ring mask, bti), see GBE_PRINTF_BUF_HEADER_SIZE */
+typedef int (cl_gpgpu_set_printf_buffer_cb)(cl_gpgpu, uint32_t, uint32_t, uint8_t);
 extern cl_gpgpu_set_printf_buffer_cb *cl_gpgpu_set_printf_buffer;
 
+/* Get the printf buffer with one more reference on it */
+typedef cl_buffer (cl_gpgpu_ref_printf_buffer_cb)(cl_gpgpu);
+extern cl_gpgpu_ref_printf_buffer_cb *cl_gpgpu_ref_printf_buffer;
+
 /* get the printf buffer offset in the apeture*/
 typedef unsigned long (cl_gpgpu_reloc_printf_buffer_cb)(cl_gpgpu, uint32_t, uint32_t);
 extern cl_gpgpu_reloc_printf_buffer_cb *cl_gpgpu_reloc_printf_buffer;
@@ -431,12 +435,30 @@ extern cl_buffer_get_subdata_cb *cl_buffer_get_subdata;
 typedef int (cl_buffer_wait_rendering_cb) (cl_buffer);
 extern cl_buffer_wait_rendering_cb *cl_buffer_wait_rendering;
 
+/* Check whether the GPU still uses the buffer */
+typedef int (cl_buffer_is_busy_cb) (cl_buffer);
+extern cl_buffer_is_busy_cb *cl_buffer_is_busy;
+
 typedef int (cl_buffer_get_fd_cb)(cl_buffer, int *fd);
 extern cl_buffer_get_fd_cb *cl_buffer_get_fd;
 
 typedef int (cl_buffer_get_tiling_align_cb)(cl_context ctx, uint32_t tiling_mode, uint32_t dim);
 extern cl_buffer_get_tiling_align_cb *cl_buffer_get_tiling_align;
 
+/* Bit 6 swizzling the memory controller applies to tiled buffers */
+typedef enum cl_buffer_swizzle {
+  CL_SWIZZLE_NONE = 0,
+  CL_SWIZZLE_9,          /* bit6 ^= bit9 */
+  CL_SWIZZLE_9_10,       /* bit6 ^= bit9 ^ bit10 */
+  CL_SWIZZLE_9_11,       /* bit6 ^= bit9 ^ bit11 */
+  CL_SWIZZLE_9_10_11,    /* bit6 ^= bit9 ^ bit10 ^ bit11 */
+  CL_SWIZZLE_UNKNOWN     /* depends on the physical address, can't detile on the CPU */
+} cl_buffer_swizzle_t;
+
+/* Get the bit 6 swizzling mode of a tiled buffer */
+typedef cl_buffer_swizzle_t (cl_buffer_get_swizzle_cb)(cl_buffer);
+extern cl_buffer_get_swizzle_cb *cl_buffer_get_swizzle;
+
 typedef cl_buffer (cl_buffer_get_buffer_from_fd_cb)(cl_context ctx, int fd, int size);
 extern cl_buffer_get_buffer_from_fd_cb *cl_buffer_get_buffer_from_fd;
 
@@ -25,6 +25,7 @@
 #include "cl_utils.h"
 #include "cl_alloc.h"
 #include "cl_device_enqueue.h"
+#include "cl_image_copy.h"
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
@@ -46,7 +47,7 @@ cl_enqueue_read_buffer(enqueue_data *data, cl_int status)
   //and it is randomly. So temporary disable it, use map/copy/unmap to read.
   //Should re-enable it after find root cause.
   if (0 && !mem->is_userptr) {
-    if (cl_buffer_get_subdata(mem->bo, data->offset + buffer->sub_offset,
+    if (cl_buffer_get_subdata(mem->bo, mem->offset + data->offset + buffer->sub_offset,
                               data->size, data->ptr) != 0)
       err = CL_MAP_FAILURE;
   } else {
@@ -140,7 +141,7 @@ cl_enqueue_write_buffer(enqueue_data *data, cl_int status)
       cl_mem_unmap_auto(mem);
     }
   } else {
-    if (cl_buffer_subdata(mem->bo, data->offset + buffer->sub_offset,
+    if (cl_buffer_subdata(mem->bo, mem->offset + data->offset + buffer->sub_offset,
                           data->size, data->const_ptr) != 0)
       err = CL_MAP_FAILURE;
   }
@@ -216,6 +217,11 @@ cl_enqueue_read_image(enqueue_data *data, cl_int status)
   if (status != CL_COMPLETE)
     return err;
 
+  /* Detile on the CPU rather than reading through the uncached GTT map */
+  if (cl_image_tiled_read(image, origin, region, data->ptr,
+                          data->row_pitch, data->slice_pitch) == CL_SUCCESS)
+    return err;
+
   if (!(src_ptr = cl_mem_map_auto(mem, 0))) {
     err = CL_MAP_FAILURE;
     goto error;
@@ -261,6 +267,10 @@ cl_enqueue_write_image(enqueue_data *data, cl_int status)
   if (status != CL_COMPLETE)
     return err;
 
+  if (cl_image_tiled_write(image, data->origin, data->region, data->const_ptr,
+                           data->row_pitch, data->slice_pitch) == CL_SUCCESS)
+    return err;
+
   if (!(dst_ptr = cl_mem_map_auto(mem, 1))) {
     err = CL_MAP_FAILURE;
     goto error;
@@ -568,7 +578,7 @@ cl_enqueue_ndrange(enqueue_data *data, cl_int status)
   cl_int err = CL_SUCCESS;
 
   if (status == CL_SUBMITTED) {
-    err = cl_command_queue_flush_gpgpu(data->gpgpu);
+    err = cl_command_queue_flush_gpgpu(data->queue, data->gpgpu);
     //if it is the last ndrange of an cl enqueue api,
     //check the device enqueue information.
     if (data->mid_event_of_enq == 0) {
@@ -22,6 +22,125 @@
 #include "cl_alloc.h"
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
+
+/* Events are created and released for nearly every enqueue, so the released
+   ones are kept in a small per thread free list instead of going back to the
+   allocator every time. Cached events are not counted as allocated, and every
+   list, the main thread's included, is freed when the library is unloaded. */
+#define CL_EVENT_FREELIST_SIZE 64
+
+typedef struct _cl_event_freelist {
+  list_node node;                   /* Link in the list of all the free lists */
+  int num;
+  cl_event events[CL_EVENT_FREELIST_SIZE];
+} __attribute__((aligned(64))) _cl_event_freelist; /* One list per cache line */
+
+typedef _cl_event_freelist *cl_event_freelist;
+
+static pthread_key_t cl_event_freelist_key;
+static pthread_once_t cl_event_freelist_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t cl_event_freelist_lock = PTHREAD_MUTEX_INITIALIZER;
+static list_head cl_event_freelists = {{&cl_event_freelists.head_node, &cl_event_freelists.head_node}};
+static cl_bool cl_event_freelist_key_valid = CL_FALSE;
+static cl_bool cl_event_freelist_closed = CL_FALSE;
+
+/* The list and the cached events are out of the cl_alloc count already */
+static void
+cl_event_freelist_free(cl_event_freelist list)
+{
+  int i;
+
+  list_node_del(&list->node);
+  for (i = 0; i < list->num; i++)
+    free(list->events[i]);
+  free(list);
+}
+
+static void
+cl_event_freelist_destroy(void *data)
+{
+  pthread_mutex_lock(&cl_event_freelist_lock);
+  cl_event_freelist_free(data);
+  pthread_mutex_unlock(&cl_event_freelist_lock);
+}
+
+static void
+cl_event_freelist_key_init(void)
+{
+  if (pthread_key_create(&cl_event_freelist_key, cl_event_freelist_destroy) == 0)
+    cl_event_freelist_key_valid = CL_TRUE;
+}
+
+/* Thread exit only runs the key destructor for the other threads, so release
+   whatever is left, the main thread's list included, at unload */
+static void __attribute__((destructor))
+cl_event_freelist_shutdown(void)
+{
+  list_node *pos, *n;
+
+  pthread_mutex_lock(&cl_event_freelist_lock);
+  cl_event_freelist_closed = CL_TRUE;
+  if (cl_event_freelist_key_valid)
+    pthread_key_delete(cl_event_freelist_key);
+  list_for_each_safe(pos, n, &cl_event_freelists) {
+    cl_event_freelist_free(list_entry(pos, _cl_event_freelist, node));
+  }
+  pthread_mutex_unlock(&cl_event_freelist_lock);
+}
+
+static cl_event_freelist
+cl_event_get_freelist(void)
+{
+  cl_event_freelist list;
+
+  pthread_once(&cl_event_freelist_once, cl_event_freelist_key_init);
+  if (!cl_event_freelist_key_valid || cl_event_freelist_closed)
+    return NULL;
+
+  list = pthread_getspecific(cl_event_freelist_key);
+  if (list == NULL) {
+    list = cl_aligned_malloc(sizeof(_cl_event_freelist), 64);
+    if (list == NULL)
+      return NULL;
+    memset(list, 0, sizeof(_cl_event_freelist));
+    cl_alloc_untrack();
+
+    pthread_mutex_lock(&cl_event_freelist_lock);
+    list_add_tail(&cl_event_freelists, &list->node);
+    pthread_mutex_unlock(&cl_event_freelist_lock);
+    pthread_setspecific(cl_event_freelist_key, list);
+  }
+  return list;
+}
+
+static cl_event
+cl_event_alloc(void)
+{
+  cl_event_freelist list = cl_event_get_freelist();
+  cl_event e;
+
+  if (list == NULL || list->num == 0)
+    return cl_calloc(1, sizeof(_cl_event));
+
+  e = list->events[--list->num];
+  cl_alloc_track();
+  memset(e, 0, sizeof(_cl_event));
+  return e;
+}
+
+static void
+cl_event_free(cl_event e)
+{
+  cl_event_freelist list = cl_event_get_freelist();
+
+  if (list == NULL || list->num == CL_EVENT_FREELIST_SIZE) {
+    cl_free(e);
+    return;
+  }
+  list->events[list->num++] = e;
+  cl_alloc_untrack();
+}
 
 // TODO: Need to move it to some device related file later.
 static void
@@ -149,7 +268,7 @@ cl_event_new(cl_context ctx, cl_command_queue queue, cl_command_type type,
              cl_uint num_events, cl_event *event_list)
 {
   int i;
-  cl_event e = cl_calloc(1, sizeof(_cl_event));
+  cl_event e = cl_event_alloc();
   if (e == NULL)
     return NULL;
 
@@ -232,7 +351,7 @@ cl_event_delete(cl_event event)
   cl_context_remove_event(event->ctx, event);
 
   CL_OBJECT_DESTROY_BASE(event);
-  cl_free(event);
+  cl_event_free(event);
 }
 
 LOCAL cl_event
@@ -607,6 +726,8 @@ cl_event_exec(cl_event event, cl_int exec_to_status, cl_bool ignore_depends)
         /* record the timestamp before actually doing something. */
         cl_event_update_timestamp(event, s);
       }
+      if (s == CL_COMPLETE && event->perf.slot)
+        cl_kernel_perf_record(event);
 
       ret = cl_event_set_status(event, s);
       assert(ret == CL_SUCCESS);
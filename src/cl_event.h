@@ -23,6 +23,7 @@
 
 #include "cl_base_object.h"
 #include "cl_enqueue.h"
+#include "performance.h"
 #include "CL/cl.h"
 
 typedef void(CL_CALLBACK *cl_event_notify_cb)(cl_event event, cl_int event_command_exec_status, void *user_data);
@@ -50,6 +51,7 @@ typedef struct _cl_event {
   list_node enqueue_node;     /* The node in the enqueue list. */
   cl_ulong timestamp[5];      /* The time stamps for profiling. */
   enqueue_data exec_data; /* Context for execute this event. */
+  cl_kernel_perf_info perf;   /* Kernel static data of an NDRange event */
 } _cl_event;
 
 #define CL_OBJECT_EVENT_MAGIC 0x8324a9f810ebf90fLL
@@ -37,6 +37,7 @@ gbe_program_clean_llvm_resource_cb *compiler_program_clean_llvm_resource = NULL;
 
 //function pointer from libgbeinterp.so
 gbe_program_new_from_binary_cb *interp_program_new_from_binary = NULL;
+gbe_program_new_from_mapped_binary_cb *interp_program_new_from_mapped_binary = NULL;
 gbe_program_get_global_constant_size_cb *interp_program_get_global_constant_size = NULL;
 gbe_program_get_global_constant_data_cb *interp_program_get_global_constant_data = NULL;
 gbe_program_get_global_reloc_count_cb *interp_program_get_global_reloc_count = NULL;
@@ -46,6 +47,8 @@ gbe_program_get_kernel_num_cb *interp_program_get_kernel_num = NULL;
 gbe_program_get_kernel_by_name_cb *interp_program_get_kernel_by_name = NULL;
 gbe_program_get_kernel_cb *interp_program_get_kernel = NULL;
 gbe_program_get_device_enqueue_kernel_name_cb *interp_program_get_device_enqueue_kernel_name = NULL;
+gbe_program_get_kernel_name_cb *interp_program_get_kernel_name = NULL;
+gbe_program_get_ocl_version_cb *interp_program_get_ocl_version = NULL;
 gbe_kernel_get_name_cb *interp_kernel_get_name = NULL;
 gbe_kernel_get_attributes_cb *interp_kernel_get_attributes = NULL;
 gbe_kernel_get_code_cb *interp_kernel_get_code = NULL;
@@ -60,6 +63,7 @@ gbe_kernel_get_curbe_offset_cb *interp_kernel_get_curbe_offset = NULL;
 gbe_kernel_get_curbe_size_cb *interp_kernel_get_curbe_size = NULL;
 gbe_kernel_get_stack_size_cb *interp_kernel_get_stack_size = NULL;
 gbe_kernel_get_scratch_size_cb *interp_kernel_get_scratch_size = NULL;
+gbe_kernel_get_grf_size_cb *interp_kernel_get_grf_size = NULL;
 gbe_kernel_get_required_work_group_size_cb *interp_kernel_get_required_work_group_size = NULL;
 gbe_kernel_use_slm_cb *interp_kernel_use_slm = NULL;
 gbe_kernel_get_slm_size_cb *interp_kernel_get_slm_size = NULL;
@@ -108,6 +112,10 @@ struct GbeLoaderInitializer
     if (interp_program_new_from_binary == NULL)
       return false;
 
+    interp_program_new_from_mapped_binary = *(gbe_program_new_from_mapped_binary_cb**)dlsym(dlhInterp, "gbe_program_new_from_mapped_binary");
+    if (interp_program_new_from_mapped_binary == NULL)
+      return false;
+
     interp_program_get_global_constant_size = *(gbe_program_get_global_constant_size_cb**)dlsym(dlhInterp, "gbe_program_get_global_constant_size");
     if (interp_program_get_global_constant_size == NULL)
       return false;
@@ -144,6 +152,14 @@ struct GbeLoaderInitializer
     if (interp_program_get_device_enqueue_kernel_name == NULL)
       return false;
 
+    interp_program_get_kernel_name = *(gbe_program_get_kernel_name_cb**)dlsym(dlhInterp, "gbe_program_get_kernel_name");
+    if (interp_program_get_kernel_name == NULL)
+      return false;
+
+    interp_program_get_ocl_version = *(gbe_program_get_ocl_version_cb**)dlsym(dlhInterp, "gbe_program_get_ocl_version");
+    if (interp_program_get_ocl_version == NULL)
+      return false;
+
     interp_kernel_get_name = *(gbe_kernel_get_name_cb**)dlsym(dlhInterp, "gbe_kernel_get_name");
     if (interp_kernel_get_name == NULL)
       return false;
@@ -200,6 +216,10 @@ struct GbeLoaderInitializer
     if (interp_kernel_get_scratch_size == NULL)
       return false;
 
+    interp_kernel_get_grf_size = *(gbe_kernel_get_grf_size_cb**)dlsym(dlhInterp, "gbe_kernel_get_grf_size");
+    if (interp_kernel_get_grf_size == NULL)
+      return false;
+
     interp_kernel_get_required_work_group_size = *(gbe_kernel_get_required_work_group_size_cb**)dlsym(dlhInterp, "gbe_kernel_get_required_work_group_size");
     if (interp_kernel_get_required_work_group_size == NULL)
       return false;
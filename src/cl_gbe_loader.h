@@ -37,6 +37,7 @@ extern gbe_program_new_from_llvm_cb *compiler_program_new_from_llvm;
 extern gbe_program_clean_llvm_resource_cb *compiler_program_clean_llvm_resource;
 
 extern gbe_program_new_from_binary_cb *interp_program_new_from_binary;
+extern gbe_program_new_from_mapped_binary_cb *interp_program_new_from_mapped_binary;
 extern gbe_program_get_global_constant_size_cb *interp_program_get_global_constant_size;
 extern gbe_program_get_global_constant_data_cb *interp_program_get_global_constant_data;
 extern gbe_program_get_global_reloc_count_cb *interp_program_get_global_reloc_count;
@@ -46,6 +47,8 @@ extern gbe_program_get_kernel_num_cb *interp_program_get_kernel_num;
 extern gbe_program_get_kernel_by_name_cb *interp_program_get_kernel_by_name;
 extern gbe_program_get_kernel_cb *interp_program_get_kernel;
 extern gbe_program_get_device_enqueue_kernel_name_cb *interp_program_get_device_enqueue_kernel_name;
+extern gbe_program_get_kernel_name_cb *interp_program_get_kernel_name;
+extern gbe_program_get_ocl_version_cb *interp_program_get_ocl_version;
 extern gbe_kernel_get_name_cb *interp_kernel_get_name;
 extern gbe_kernel_get_attributes_cb *interp_kernel_get_attributes;
 extern gbe_kernel_get_code_cb *interp_kernel_get_code;
@@ -60,6 +63,7 @@ extern gbe_kernel_get_curbe_offset_cb *interp_kernel_get_curbe_offset;
 extern gbe_kernel_get_curbe_size_cb *interp_kernel_get_curbe_size;
 extern gbe_kernel_get_stack_size_cb *interp_kernel_get_stack_size;
 extern gbe_kernel_get_scratch_size_cb *interp_kernel_get_scratch_size;
+extern gbe_kernel_get_grf_size_cb *interp_kernel_get_grf_size;
 extern gbe_kernel_get_required_work_group_size_cb *interp_kernel_get_required_work_group_size;
 extern gbe_kernel_use_slm_cb *interp_kernel_use_slm;
 extern gbe_kernel_get_slm_size_cb *interp_kernel_get_slm_size;
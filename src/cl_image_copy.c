@@ -0,0 +1,276 @@
+/*
+ * Copyright © 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+
+#include "cl_image_copy.h"
+#include "cl_driver.h"
+#include "cl_utils.h"
+
+/* Tile geometry, see the "Tiling" section of the PRM:
+ *  - X tile: 4KB, 512B x 8 rows, each row is linear.
+ *  - Y tile: 4KB, 128B x 32 rows, made of 8 OWORD (16B) columns of 32 rows.
+ * Tiles are laid out row major and a tiled row pitch is a multiple of the
+ * tile width. */
+#define CL_TILE_SIZE          4096
+#define CL_TILE_X_WIDTH       512
+#define CL_TILE_X_HEIGHT      8
+#define CL_TILE_Y_WIDTH       128
+#define CL_TILE_Y_HEIGHT      32
+#define CL_TILE_Y_COLUMN      16
+
+/* Regions bigger than this are split across several threads */
+#define CL_TILED_COPY_MT_THRESHOLD (4 * 1024 * 1024)
+#define CL_TILED_COPY_MAX_THREADS  8
+
+typedef struct cl_tiled_copy {
+  char *tiled;                  /* CPU mapping of the image bo */
+  char *linear;                 /* host memory */
+  size_t pitch;                 /* tiled row pitch */
+  size_t slice_rows;            /* tiled slice pitch in rows */
+  size_t x, y, z;               /* origin, x in bytes */
+  size_t w, h;                  /* region, w in bytes */
+  size_t linear_row_pitch;
+  size_t linear_slice_pitch;
+  cl_image_tiling_t tiling;
+  cl_buffer_swizzle_t swizzle;
+  int to_linear;                /* read from the image */
+} cl_tiled_copy;
+
+typedef struct cl_tiled_copy_job {
+  const cl_tiled_copy *copy;
+  size_t first, last;           /* [first, last) rows of the flattened region */
+} cl_tiled_copy_job;
+
+static INLINE size_t
+cl_tiled_offset(const cl_tiled_copy *c, size_t x, size_t y)
+{
+  size_t off;
+
+  if (c->tiling == CL_TILE_X)
+    off = ((y / CL_TILE_X_HEIGHT) * (c->pitch / CL_TILE_X_WIDTH) + x / CL_TILE_X_WIDTH) * CL_TILE_SIZE +
+          (y % CL_TILE_X_HEIGHT) * CL_TILE_X_WIDTH + x % CL_TILE_X_WIDTH;
+  else
+    off = ((y / CL_TILE_Y_HEIGHT) * (c->pitch / CL_TILE_Y_WIDTH) + x / CL_TILE_Y_WIDTH) * CL_TILE_SIZE +
+          (x % CL_TILE_Y_WIDTH / CL_TILE_Y_COLUMN) * (CL_TILE_Y_COLUMN * CL_TILE_Y_HEIGHT) +
+          (y % CL_TILE_Y_HEIGHT) * CL_TILE_Y_COLUMN + x % CL_TILE_Y_COLUMN;
+
+  /* The bo is page aligned, so bits 9-11 of the offset are the ones of the
+     physical address the memory controller swizzles with. */
+  switch (c->swizzle) {
+    case CL_SWIZZLE_9: off ^= (off >> 3) & 64; break;
+    case CL_SWIZZLE_9_10: off ^= ((off >> 3) ^ (off >> 4)) & 64; break;
+    case CL_SWIZZLE_9_11: off ^= ((off >> 3) ^ (off >> 5)) & 64; break;
+    case CL_SWIZZLE_9_10_11: off ^= ((off >> 3) ^ (off >> 4) ^ (off >> 5)) & 64; break;
+    default: break;
+  }
+  return off;
+}
+
+/* Copy n bytes which are contiguous in the tiled layout. The tiled side of
+   a span is 16B aligned except at the region edges, the linear side may be
+   anything. */
+static INLINE void
+cl_tiled_load_span(char *dst, const char *tiled, size_t n)
+{
+#ifdef __SSE4_1__
+  size_t head = (16 - ((uintptr_t)tiled & 15)) & 15;
+  if (head >= n) {
+    memcpy(dst, tiled, n);
+    return;
+  }
+  memcpy(dst, tiled, head);
+  dst += head; tiled += head; n -= head;
+  for (; n >= 16; n -= 16, dst += 16, tiled += 16)
+    _mm_storeu_si128((__m128i *)dst, _mm_stream_load_si128((__m128i *)tiled));
+#endif
+  memcpy(dst, tiled, n);
+}
+
+static INLINE void
+cl_tiled_store_span(char *tiled, const char *src, size_t n)
+{
+#ifdef __SSE4_1__
+  size_t head = (16 - ((uintptr_t)tiled & 15)) & 15;
+  if (head >= n) {
+    memcpy(tiled, src, n);
+    return;
+  }
+  memcpy(tiled, src, head);
+  src += head; tiled += head; n -= head;
+  for (; n >= 16; n -= 16, src += 16, tiled += 16)
+    _mm_stream_si128((__m128i *)tiled, _mm_loadu_si128((const __m128i *)src));
+#endif
+  memcpy(tiled, src, n);
+}
+
+static void
+cl_tiled_copy_row(const cl_tiled_copy *c, size_t y, char *linear)
+{
+  size_t span;
+  size_t x = c->x;
+  const size_t end = c->x + c->w;
+
+  /* Largest run of bytes which stays contiguous in the tiled layout. With
+     swizzling, bit 6 may flip so X tile rows break every 64 bytes. */
+  if (c->tiling == CL_TILE_Y)
+    span = CL_TILE_Y_COLUMN;
+  else
+    span = c->swizzle == CL_SWIZZLE_NONE ? CL_TILE_X_WIDTH : 64;
+
+  while (x < end) {
+    const size_t n = MIN(span - (x & (span - 1)), end - x);
+    char *tiled = c->tiled + cl_tiled_offset(c, x, y);
+    if (c->to_linear)
+      cl_tiled_load_span(linear, tiled, n);
+    else
+      cl_tiled_store_span(tiled, linear, n);
+    linear += n;
+    x += n;
+  }
+}
+
+static void *
+cl_tiled_copy_rows(void *arg)
+{
+  const cl_tiled_copy_job *job = arg;
+  const cl_tiled_copy *c = job->copy;
+  size_t r;
+
+  for (r = job->first; r < job->last; r++) {
+    const size_t z = r / c->h, y = r % c->h;
+    char *linear = c->linear + z * c->linear_slice_pitch + y * c->linear_row_pitch;
+    cl_tiled_copy_row(c, (c->z + z) * c->slice_rows + c->y + y, linear);
+  }
+#ifdef __SSE4_1__
+  /* Streaming stores are weakly ordered */
+  if (!c->to_linear)
+    _mm_sfence();
+#endif
+  return NULL;
+}
+
+static int
+cl_tiled_copy_thread_num(void)
+{
+  static int thread_num = 0;
+
+  if (thread_num == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    thread_num = n < 1 ? 1 : MIN(n, CL_TILED_COPY_MAX_THREADS);
+  }
+  return thread_num;
+}
+
+static void
+cl_tiled_copy_run(const cl_tiled_copy *c, size_t depth)
+{
+  cl_tiled_copy_job jobs[CL_TILED_COPY_MAX_THREADS];
+  pthread_t threads[CL_TILED_COPY_MAX_THREADS];
+  const size_t rows = c->h * depth;
+  size_t thread_num = 1, started, i;
+
+  if (c->w * rows >= CL_TILED_COPY_MT_THRESHOLD)
+    thread_num = MIN((size_t)cl_tiled_copy_thread_num(), rows);
+
+  for (i = 0; i < thread_num; i++) {
+    jobs[i].copy = c;
+    jobs[i].first = rows * i / thread_num;
+    jobs[i].last = rows * (i + 1) / thread_num;
+  }
+
+  for (started = 1; started < thread_num; started++)
+    if (pthread_create(&threads[started], NULL, cl_tiled_copy_rows, &jobs[started]) != 0)
+      break;
+
+  /* Run the first job and whatever could not be handed to a thread here */
+  cl_tiled_copy_rows(&jobs[0]);
+  for (i = started; i < thread_num; i++)
+    cl_tiled_copy_rows(&jobs[i]);
+  for (i = 1; i < started; i++)
+    pthread_join(threads[i], NULL);
+}
+
+static cl_int
+cl_image_tiled_copy(struct _cl_mem_image *image,
+                    const size_t *origin, const size_t *region,
+                    char *linear, size_t linear_row_pitch, size_t linear_slice_pitch,
+                    int to_linear)
+{
+  cl_mem mem = &image->base;
+  cl_tiled_copy c;
+  size_t tile_w;
+
+  if (image->tiling == CL_NO_TILE || mem->is_userptr || image->offset != 0)
+    return CL_INVALID_OPERATION;
+
+  tile_w = image->tiling == CL_TILE_X ? CL_TILE_X_WIDTH : CL_TILE_Y_WIDTH;
+  if (image->row_pitch % tile_w != 0)
+    return CL_INVALID_OPERATION;
+  if ((origin[2] != 0 || region[2] > 1) && image->slice_pitch % image->row_pitch != 0)
+    return CL_INVALID_OPERATION;
+
+  c.swizzle = cl_buffer_get_swizzle(mem->bo);
+  if (c.swizzle == CL_SWIZZLE_UNKNOWN)
+    return CL_INVALID_OPERATION;
+
+  if (cl_buffer_map(mem->bo, to_linear ? 0 : 1) != 0)
+    return CL_INVALID_OPERATION;
+
+  c.tiled = cl_buffer_get_virtual(mem->bo);
+  c.linear = linear;
+  c.pitch = image->row_pitch;
+  c.slice_rows = image->slice_pitch / image->row_pitch;
+  c.x = origin[0] * image->bpp;
+  c.y = origin[1];
+  c.z = origin[2];
+  c.w = region[0] * image->bpp;
+  c.h = region[1];
+  c.linear_row_pitch = linear_row_pitch;
+  c.linear_slice_pitch = linear_slice_pitch;
+  c.tiling = image->tiling;
+  c.to_linear = to_linear;
+  cl_tiled_copy_run(&c, region[2]);
+
+  cl_buffer_unmap(mem->bo);
+  return CL_SUCCESS;
+}
+
+LOCAL cl_int
+cl_image_tiled_read(struct _cl_mem_image *image,
+                    const size_t *origin, const size_t *region,
+                    void *dst, size_t dst_row_pitch, size_t dst_slice_pitch)
+{
+  return cl_image_tiled_copy(image, origin, region, dst,
+                             dst_row_pitch, dst_slice_pitch, 1);
+}
+
+LOCAL cl_int
+cl_image_tiled_write(struct _cl_mem_image *image,
+                     const size_t *origin, const size_t *region,
+                     const void *src, size_t src_row_pitch, size_t src_slice_pitch)
+{
+  return cl_image_tiled_copy(image, origin, region, (char *)src,
+                             src_row_pitch, src_slice_pitch, 0);
+}
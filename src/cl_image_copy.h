@@ -0,0 +1,38 @@
+/*
+ * Copyright © 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CL_IMAGE_COPY_H__
+#define __CL_IMAGE_COPY_H__
+
+#include "cl_mem.h"
+
+/* Copy a region of a tiled image to linear host memory. The bo is read
+ * through a CPU mapping and detiled on the host instead of going through
+ * the (uncached) GTT mapping. origin/region are in pixels like the CL API.
+ * Returns CL_INVALID_OPERATION when the tiling layout is not handled, the
+ * caller must then fall back to cl_mem_map_auto. */
+cl_int cl_image_tiled_read(struct _cl_mem_image *image,
+                           const size_t *origin, const size_t *region,
+                           void *dst, size_t dst_row_pitch, size_t dst_slice_pitch);
+
+/* Same as cl_image_tiled_read, from linear host memory into the image */
+cl_int cl_image_tiled_write(struct _cl_mem_image *image,
+                            const size_t *origin, const size_t *region,
+                            const void *src, size_t src_row_pitch, size_t src_slice_pitch);
+
+#endif /* __CL_IMAGE_COPY_H__ */
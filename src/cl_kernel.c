@@ -61,6 +61,10 @@ cl_kernel_delete(cl_kernel k)
   if (k->ref_its_program) cl_program_delete(k->program);
   /* Release the curbe if allocated */
   if (k->curbe) cl_free(k->curbe);
+  if (k->varying_payload) {
+    cl_free(k->varying_payload->data);
+    cl_free(k->varying_payload);
+  }
   /* Release the argument array if required */
   if (k->args) {
     for (i = 0; i < k->arg_n; ++i)
@@ -68,6 +72,10 @@ cl_kernel_delete(cl_kernel k)
         cl_mem_delete(k->args[i].mem);
     cl_free(k->args);
   }
+  /* The dups only borrow the descriptors, they keep the program (and so the
+     kernel built by cl_kernel_setup) alive */
+  if (k->arg_desc && !k->ref_its_program)
+    cl_free(k->arg_desc);
   if (k->image_sz)
     cl_free(k->images);
 
@@ -124,6 +132,7 @@ cl_kernel_add_ref(cl_kernel k)
 LOCAL cl_int
 cl_kernel_set_arg(cl_kernel k, cl_uint index, size_t sz, const void *value)
 {
+  const cl_kernel_arg_desc *desc; /* cached argument metadata */
   int32_t offset;            /* where to patch */
   enum gbe_arg_type arg_type; /* kind of argument */
   size_t arg_sz;              /* size of the argument */
@@ -132,8 +141,26 @@ cl_kernel_set_arg(cl_kernel k, cl_uint index, size_t sz, const void *value)
 
   if (UNLIKELY(index >= k->arg_n))
     return CL_INVALID_ARG_INDEX;
-  arg_type = interp_kernel_get_arg_type(k->opaque, index);
-  arg_sz = interp_kernel_get_arg_size(k->opaque, index);
+  desc = &k->arg_desc[index];
+  arg_type = desc->type;
+  arg_sz = desc->size;
+  offset = desc->curbe_offset;
+
+  /* Fast path for plain values, by far the most common case */
+  if (LIKELY(arg_type == GBE_ARG_VALUE && !(k->vme && index == 0))) {
+    if (UNLIKELY(arg_sz != sz))
+      return CL_INVALID_ARG_SIZE;
+    if (UNLIKELY(value == NULL))
+      return CL_INVALID_ARG_VALUE;
+    if (offset >= 0) {
+      assert(offset + sz <= k->curbe_sz);
+      memcpy(k->curbe + offset, value, sz);
+    }
+    k->args[index].local_sz = 0;
+    k->args[index].is_set = 1;
+    k->args[index].mem = NULL;
+    return CL_SUCCESS;
+  }
 
   if (k->vme && index == 0) {
     //the best method is to return the arg type of GBE_ARG_ACCELERATOR_INTEL
@@ -177,8 +204,7 @@ cl_kernel_set_arg(cl_kernel k, cl_uint index, size_t sz, const void *value)
       mem = *(cl_mem*)value;
     if(arg_type == GBE_ARG_PIPE) {
       _cl_mem_pipe* pipe= cl_mem_pipe(mem);
-      size_t type_size = (size_t)interp_kernel_get_arg_info(k->opaque, index,5);
-      if(pipe->packet_size != type_size)
+      if(pipe->packet_size != desc->type_size)
           return CL_INVALID_ARG_VALUE;
     }
     if(value != NULL && mem) {
@@ -191,32 +217,20 @@ cl_kernel_set_arg(cl_kernel k, cl_uint index, size_t sz, const void *value)
     }
   }
 
-  /* Copy the structure or the value directly into the curbe */
+  /* Copy the accelerator descriptor directly into the curbe */
   if (arg_type == GBE_ARG_VALUE) {
-    if (k->vme && index == 0) {
-      cl_accelerator_intel accel;
-      memcpy(&accel, value, sz);
-      offset = interp_kernel_get_curbe_offset(k->opaque, GBE_CURBE_KERNEL_ARGUMENT, index);
-      if (offset >= 0) {
-        assert(offset + sz <= k->curbe_sz);
-        memcpy(k->curbe + offset, &(accel->desc.me), arg_sz);
-      }
-      k->args[index].local_sz = 0;
-      k->args[index].is_set = 1;
-      k->args[index].mem = NULL;
-      k->accel = accel;
-      return CL_SUCCESS;
-    } else {
-      offset = interp_kernel_get_curbe_offset(k->opaque, GBE_CURBE_KERNEL_ARGUMENT, index);
-      if (offset >= 0) {
-        assert(offset + sz <= k->curbe_sz);
-        memcpy(k->curbe + offset, value, sz);
-      }
-      k->args[index].local_sz = 0;
-      k->args[index].is_set = 1;
-      k->args[index].mem = NULL;
-      return CL_SUCCESS;
+    cl_accelerator_intel accel;
+    assert(k->vme && index == 0);
+    memcpy(&accel, value, sz);
+    if (offset >= 0) {
+      assert(offset + sz <= k->curbe_sz);
+      memcpy(k->curbe + offset, &(accel->desc.me), arg_sz);
     }
+    k->args[index].local_sz = 0;
+    k->args[index].is_set = 1;
+    k->args[index].mem = NULL;
+    k->accel = accel;
+    return CL_SUCCESS;
   }
 
   /* For a local pointer just save the size */
@@ -236,7 +250,6 @@ cl_kernel_set_arg(cl_kernel k, cl_uint index, size_t sz, const void *value)
     k->args[index].mem = NULL;
     k->args[index].sampler = sampler;
     cl_set_sampler_arg_slot(k, index, sampler);
-    offset = interp_kernel_get_curbe_offset(k->opaque, GBE_CURBE_KERNEL_ARGUMENT, index);
     if (offset >= 0) {
       assert(offset + 4 <= k->curbe_sz);
       memcpy(k->curbe + offset, &sampler->clkSamplerValue, 4);
@@ -249,7 +262,6 @@ cl_kernel_set_arg(cl_kernel k, cl_uint index, size_t sz, const void *value)
 
   if(value == NULL || mem == NULL) {
     /* for buffer object GLOBAL_PTR CONSTANT_PTR, it maybe NULL */
-    int32_t offset = interp_kernel_get_curbe_offset(k->opaque, GBE_CURBE_KERNEL_ARGUMENT, index);
     if (offset >= 0)
       *((uint32_t *)(k->curbe + offset)) = 0;
     assert(arg_type == GBE_ARG_GLOBAL_PTR || arg_type == GBE_ARG_CONSTANT_PTR);
@@ -273,7 +285,7 @@ cl_kernel_set_arg(cl_kernel k, cl_uint index, size_t sz, const void *value)
   if(mem->is_svm)
     k->args[index].ptr = mem->host_ptr;
   k->args[index].local_sz = 0;
-  k->args[index].bti = interp_kernel_get_arg_bti(k->opaque, index);
+  k->args[index].bti = desc->bti;
   return CL_SUCCESS;
 }
 
@@ -282,14 +294,12 @@ LOCAL cl_int
 cl_kernel_set_arg_svm_pointer(cl_kernel k, cl_uint index, const void *value)
 {
   enum gbe_arg_type arg_type; /* kind of argument */
-  //size_t arg_sz;              /* size of the argument */
   cl_context ctx = k->program->ctx;
   cl_mem mem= cl_context_get_svm_from_ptr(ctx, value);
 
   if (UNLIKELY(index >= k->arg_n))
     return CL_INVALID_ARG_INDEX;
-  arg_type = interp_kernel_get_arg_type(k->opaque, index);
-  //arg_sz = interp_kernel_get_arg_size(k->opaque, index);
+  arg_type = k->arg_desc[index].type;
 
   if(arg_type != GBE_ARG_GLOBAL_PTR && arg_type != GBE_ARG_CONSTANT_PTR )
     return CL_INVALID_ARG_VALUE;
@@ -306,7 +316,7 @@ cl_kernel_set_arg_svm_pointer(cl_kernel k, cl_uint index, const void *value)
   k->args[index].is_set = 1;
   k->args[index].is_svm = 1;
   k->args[index].local_sz = 0;
-  k->args[index].bti = interp_kernel_get_arg_bti(k->opaque, index);
+  k->args[index].bti = k->arg_desc[index].bti;
   return 0;
 }
 
@@ -466,8 +476,30 @@ cl_kernel_setup(cl_kernel k, gbe_kernel opaque)
     interp_kernel_get_image_data(k->opaque, k->images);
   } else
     k->images = NULL;
+
+  /* Cache the argument metadata, see cl_kernel_arg_desc */
+  if (k->arg_desc)
+    cl_free(k->arg_desc);
+  k->arg_desc = NULL;
+  if (k->arg_n > 0) {
+    uint32_t i;
+    TRY_ALLOC_NO_ERR(k->arg_desc, cl_aligned_malloc(k->arg_n * sizeof(k->arg_desc[0]), 64));
+    for (i = 0; i < k->arg_n; ++i) {
+      cl_kernel_arg_desc *desc = &k->arg_desc[i];
+      desc->type = interp_kernel_get_arg_type(k->opaque, i);
+      desc->size = interp_kernel_get_arg_size(k->opaque, i);
+      desc->align = interp_kernel_get_arg_align(k->opaque, i);
+      desc->bti = interp_kernel_get_arg_bti(k->opaque, i);
+      desc->curbe_offset = interp_kernel_get_curbe_offset(k->opaque, GBE_CURBE_KERNEL_ARGUMENT, i);
+      desc->type_size = desc->type == GBE_ARG_PIPE ?
+        (size_t)interp_kernel_get_arg_info(k->opaque, i, GBE_GET_ARG_INFO_TYPESIZE) : 0;
+    }
+  }
   return;
 error:
+  cl_free(k->images);
+  k->images = NULL;
+  k->image_sz = 0;
   cl_buffer_unreference(k->bo);
   k->bo = NULL;
 }
@@ -486,6 +518,7 @@ cl_kernel_dup(cl_kernel from)
   to->vme = from->vme;
   to->program = from->program;
   to->arg_n = from->arg_n;
+  to->arg_desc = from->arg_desc;
   to->curbe_sz = from->curbe_sz;
   to->sampler_sz = from->sampler_sz;
   to->image_sz = from->image_sz;
@@ -47,6 +47,37 @@ typedef struct cl_argument {
   uint32_t is_svm:1;    /* Indicate this argument is SVMPointer */
 } cl_argument;
 
+/* Argument metadata of a kernel. It never changes once the kernel is compiled
+ * so it is queried once from the compiler in cl_kernel_setup instead of going
+ * through the interp_* calls for every clSetKernelArg and every enqueue.
+ */
+typedef struct cl_kernel_arg_desc {
+  int32_t curbe_offset; /* Where the argument is patched, < 0 if not in the curbe */
+  uint32_t size;        /* Size of the argument */
+  uint32_t align;       /* Alignment of the pointed data for local / constant pointers */
+  uint32_t type_size;   /* Packet size for pipes */
+  uint8_t type;         /* enum gbe_arg_type */
+  uint8_t bti;          /* Binding table index for buffers */
+} cl_kernel_arg_desc;
+
+/* The per thread part of the curbe (local IDs, block IPs and thread ID) only
+ * depends on the work group size, so it is laid out once and reused by every
+ * launch with the same work group size.
+ */
+#define CL_VARYING_PAYLOAD_MAX_RANGE 6
+typedef struct _cl_varying_payload {
+  size_t local_wk_sz[3];      /* Work group size it was built for */
+  size_t simd_sz;             /* SIMD width it was built for */
+  size_t cst_sz;              /* Curbe size of one thread */
+  size_t thread_n;            /* Number of threads in the work group */
+  uint32_t range_n;           /* Number of varying ranges in each thread curbe */
+  uint32_t range_offset[CL_VARYING_PAYLOAD_MAX_RANGE];
+  uint32_t range_size[CL_VARYING_PAYLOAD_MAX_RANGE];
+  char *data;                 /* thread_n curbes, only the varying ranges are valid */
+} _cl_varying_payload;
+
+typedef _cl_varying_payload *cl_varying_payload;
+
 /* One OCL function */
 struct _cl_kernel {
   _cl_base_object base;
@@ -56,6 +87,7 @@ struct _cl_kernel {
   cl_accelerator_intel accel;     /* accelerator */
   char *curbe;                /* One curbe per kernel */
   size_t curbe_sz;            /* Size of it */
+  cl_varying_payload varying_payload; /* Cached per thread payload of the last launch */
   uint32_t samplers[GEN_MAX_SAMPLERS]; /* samplers defined in kernel & kernel args */
   size_t sampler_sz;          /* sampler size defined in kernel & kernel args. */
   struct ImageInfo *images;   /* images defined in kernel args */
@@ -67,6 +99,7 @@ struct _cl_kernel {
                                 (i.e. global_work_size argument to clEnqueueNDRangeKernel.)*/
   size_t stack_size;          /* stack size per work item. */
   cl_argument *args;          /* To track argument setting */
+  cl_kernel_arg_desc *arg_desc; /* Owned by the kernel built by cl_kernel_setup, shared by its dups */
   uint32_t arg_n:30;          /* Number of arguments */
   uint32_t ref_its_program:1; /* True only for the user kernel (created by clCreateKernel) */
   uint32_t vme:1;             /* True only if it is a built-in kernel for VME */
@@ -19,6 +19,7 @@
 
 #include "cl_mem.h"
 #include "cl_image.h"
+#include "cl_image_copy.h"
 #include "cl_context.h"
 #include "cl_utils.h"
 #include "cl_alloc.h"
@@ -102,6 +103,199 @@ cl_get_pipe_info(cl_mem mem,
   return CL_SUCCESS;
 }
 
+LOCAL struct _cl_mem_pool *
+cl_mem_pool_new(void)
+{
+  struct _cl_mem_pool *pool = NULL;
+  int enable_pool = 0;
+  int i;
+
+  // can't use BVAR (backend/src/sys/cvar.hpp) here as it's C++
+  const char *env = getenv("OCL_SMALL_BUFFER_POOL");
+  if (env != NULL) {
+    sscanf(env, "%i", &enable_pool);
+  }
+  if (!enable_pool)
+    return NULL;
+
+  pool = CALLOC(struct _cl_mem_pool);
+  if (pool == NULL)
+    return NULL;
+  for (i = 0; i < CL_MEM_POOL_CLASS_NUM; i++) {
+    pthread_mutex_init(&pool->lock[i], NULL);
+    list_init(&pool->slabs[i]);
+  }
+  return pool;
+}
+
+LOCAL void
+cl_mem_pool_delete(struct _cl_mem_pool *pool)
+{
+  struct _cl_mem_slab *slab;
+  int i;
+
+  if (pool == NULL)
+    return;
+
+  for (i = 0; i < CL_MEM_POOL_CLASS_NUM; i++) {
+    /* Only the cached empty slab can be left. */
+    while (!list_empty(&pool->slabs[i])) {
+      slab = list_entry(pool->slabs[i].head_node.n, _cl_mem_slab, node);
+      assert(slab->used == 0);
+      list_node_del(&slab->node);
+      cl_buffer_unreference(slab->bo);
+      cl_free(slab);
+    }
+    pthread_mutex_destroy(&pool->lock[i]);
+  }
+  cl_free(pool);
+}
+
+static struct _cl_mem_slab *
+cl_mem_pool_new_slab(cl_context ctx, uint32_t shift)
+{
+  struct _cl_mem_slab *slab = CALLOC(struct _cl_mem_slab);
+  uint32_t chunk_n = CL_MEM_POOL_SLAB_SIZE >> shift;
+  uint32_t i;
+
+  if (slab == NULL)
+    return NULL;
+
+  slab->bo = cl_buffer_alloc(cl_context_get_bufmgr(ctx), "CL memory pool", CL_MEM_POOL_SLAB_SIZE, 4096);
+  if (slab->bo == NULL) {
+    cl_free(slab);
+    return NULL;
+  }
+  slab->chunk_shift = shift;
+  /* Mark the bits past the last chunk as used, they never get allocated. */
+  for (i = chunk_n; i < CL_MEM_POOL_MASK_NUM * 64; i++)
+    slab->used_mask[i / 64] |= 1ull << (i % 64);
+  list_node_init(&slab->node);
+  return slab;
+}
+
+/* Try to put the data of a small buffer in a shared bo. Return CL_FALSE if
+   the buffer can not or should not be sub-allocated. */
+static cl_bool
+cl_mem_pool_alloc(cl_context ctx, cl_mem mem, size_t sz)
+{
+  struct _cl_mem_pool *pool = ctx->mem_pool;
+  struct _cl_mem_slab *slab = NULL;
+  uint32_t shift = CL_MEM_POOL_MIN_SHIFT;
+  uint32_t cls, i, bit;
+
+  if (pool == NULL || sz > (1 << CL_MEM_POOL_MAX_SHIFT))
+    return CL_FALSE;
+  if (mem->type != CL_MEM_BUFFER_TYPE ||
+      (mem->flags & (CL_MEM_USE_HOST_PTR | CL_MEM_ALLOC_HOST_PTR | CL_MEM_PINNABLE)))
+    return CL_FALSE;
+
+  while ((1 << shift) < sz)
+    shift++;
+  cls = shift - CL_MEM_POOL_MIN_SHIFT;
+
+  pthread_mutex_lock(&pool->lock[cls]);
+  /* Slabs with free chunks are kept at the head. */
+  if (!list_empty(&pool->slabs[cls])) {
+    slab = list_entry(pool->slabs[cls].head_node.n, _cl_mem_slab, node);
+    if (slab->used == (CL_MEM_POOL_SLAB_SIZE >> shift))
+      slab = NULL;
+  }
+  if (slab == NULL) {
+    slab = cl_mem_pool_new_slab(ctx, shift);
+    if (slab == NULL) {
+      pthread_mutex_unlock(&pool->lock[cls]);
+      return CL_FALSE;
+    }
+    list_add(&pool->slabs[cls], &slab->node);
+  }
+
+  for (i = 0; slab->used_mask[i] == ~0ull; i++)
+    ;
+  bit = __builtin_ctzll(~slab->used_mask[i]);
+  slab->used_mask[i] |= 1ull << bit;
+  slab->used++;
+  if (slab->used == (CL_MEM_POOL_SLAB_SIZE >> shift)) {
+    list_node_del(&slab->node);
+    list_add_tail(&pool->slabs[cls], &slab->node);
+  }
+  pthread_mutex_unlock(&pool->lock[cls]);
+
+  mem->bo = slab->bo;
+  cl_buffer_reference(mem->bo);
+  mem->offset = (size_t)(i * 64 + bit) << shift;
+  mem->slab = slab;
+  return CL_TRUE;
+}
+
+/* Give the chunk back to its slab. The caller still owns the bo reference. */
+static void
+cl_mem_pool_free(struct _cl_mem_pool *pool, cl_mem mem)
+{
+  struct _cl_mem_slab *slab = mem->slab;
+  uint32_t cls = slab->chunk_shift - CL_MEM_POOL_MIN_SHIFT;
+  uint32_t idx = mem->offset >> slab->chunk_shift;
+
+  pthread_mutex_lock(&pool->lock[cls]);
+  assert(slab->used_mask[idx / 64] & (1ull << (idx % 64)));
+  slab->used_mask[idx / 64] &= ~(1ull << (idx % 64));
+  slab->used--;
+  list_node_del(&slab->node);
+  if (slab->used == 0 && !list_empty(&pool->slabs[cls]) &&
+      list_entry(pool->slabs[cls].head_node.n, _cl_mem_slab, node)->used <
+      (CL_MEM_POOL_SLAB_SIZE >> slab->chunk_shift)) {
+    /* Another slab still has free chunks, no need to keep this one. */
+    cl_buffer_unreference(slab->bo);
+    cl_free(slab);
+  } else {
+    list_add(&pool->slabs[cls], &slab->node);
+  }
+  pthread_mutex_unlock(&pool->lock[cls]);
+
+  mem->slab = NULL;
+}
+
+LOCAL cl_int
+cl_mem_pool_detach(cl_mem mem)
+{
+  struct _cl_mem_buffer *buffer = (struct _cl_mem_buffer *)mem;
+  struct _cl_mem_buffer *sub;
+  cl_buffer bo;
+  void *src, *dst;
+
+  if (mem->type == CL_MEM_SUBBUFFER_TYPE) {
+    buffer = buffer->parent;
+    mem = &buffer->base;
+  }
+  if (mem->slab == NULL)
+    return CL_SUCCESS;
+
+  bo = cl_buffer_alloc(cl_context_get_bufmgr(mem->ctx), "CL memory object", mem->size, 64);
+  if (bo == NULL)
+    return CL_MEM_OBJECT_ALLOCATION_FAILURE;
+
+  cl_buffer_map(bo, 1);
+  dst = cl_buffer_get_virtual(bo);
+  src = cl_mem_map(mem, 0);
+  memcpy(dst, src, mem->size);
+  cl_mem_unmap(mem);
+  cl_buffer_unmap(bo);
+
+  pthread_mutex_lock(&buffer->sub_lock);
+  /* Sub-buffers borrow the parent bo, they hold no reference of their own */
+  for (sub = buffer->subs; sub != NULL; sub = sub->sub_next) {
+    sub->base.bo = bo;
+    sub->base.offset = 0;
+  }
+  pthread_mutex_unlock(&buffer->sub_lock);
+
+  cl_mem_pool_free(mem->ctx->mem_pool, mem);
+  cl_buffer_unreference(mem->bo);
+  mem->bo = bo;
+  mem->offset = 0;
+  return CL_SUCCESS;
+}
+
 LOCAL cl_mem
 cl_mem_allocate(enum cl_mem_type type,
                 cl_context ctx,
@@ -234,6 +428,9 @@ cl_mem_allocate(enum cl_mem_type type,
       bufCreated = 1;
     }
 
+    if (!bufCreated && !is_tiled && cl_mem_pool_alloc(ctx, mem, sz))
+      bufCreated = 1;
+
     if (!bufCreated)
       mem->bo = cl_buffer_alloc(bufmgr, "CL memory object", sz, alignment);
 #else
@@ -241,7 +438,7 @@ cl_mem_allocate(enum cl_mem_type type,
       // if the image if created from buffer, should use the bo directly to share same bo.
       mem->bo = buffer->bo;
       cl_mem_image(mem)->is_image_from_buffer = 1;
-    } else
+    } else if (is_tiled || !cl_mem_pool_alloc(ctx, mem, sz))
       mem->bo = cl_buffer_alloc(bufmgr, "CL memory object", sz, alignment);
 #endif
 
@@ -271,22 +468,23 @@ cl_mem_is_valid(cl_mem mem, cl_context ctx)
 {
   struct list_node *pos;
   cl_base_object pbase_object;
+  cl_context_obj_shard shard = cl_context_get_obj_shard(ctx->mem_objects, mem);
 
-  CL_OBJECT_LOCK(ctx);
-  list_for_each (pos, (&ctx->mem_objects)) {
+  pthread_mutex_lock(&shard->lock);
+  list_for_each (pos, (&shard->objs)) {
     pbase_object = list_entry(pos, _cl_base_object, node);
     if (pbase_object == (cl_base_object)mem) {
       if (UNLIKELY(!CL_OBJECT_IS_MEM(mem))) {
-        CL_OBJECT_UNLOCK(ctx);
+        pthread_mutex_unlock(&shard->lock);
         return CL_INVALID_MEM_OBJECT;
       }
 
-      CL_OBJECT_UNLOCK(ctx);
+      pthread_mutex_unlock(&shard->lock);
       return CL_SUCCESS;
     }
   }
 
-  CL_OBJECT_UNLOCK(ctx);
+  pthread_mutex_unlock(&shard->lock);
   return CL_INVALID_MEM_OBJECT;
 }
 
@@ -366,14 +564,16 @@ cl_mem_new_buffer(cl_context ctx,
     if (mem->is_userptr)
       memcpy(mem->host_ptr, data, sz);
     else
-      cl_buffer_subdata(mem->bo, 0, sz, data);
+      cl_buffer_subdata(mem->bo, mem->offset, sz, data);
   }
 
   if ((flags & CL_MEM_USE_HOST_PTR) && !mem->is_userptr)
     cl_buffer_subdata(mem->bo, 0, sz, data);
 
-  if (flags & CL_MEM_USE_HOST_PTR)
+  if (flags & CL_MEM_USE_HOST_PTR) {
     mem->host_ptr = data;
+    cl_context_update_mem_ptr(ctx, mem);
+  }
 
 exit:
   if (errcode_ret)
@@ -676,10 +876,39 @@ cl_mem_copy_image_region(const size_t *origin, const size_t *region,
   }
 }
 
+/* Copy between a tiled and a linear image, detiling on the CPU */
+static cl_int
+cl_mem_copy_image_to_image_tiled(const size_t *dst_origin,const size_t *src_origin, const size_t *region,
+                                 const struct _cl_mem_image *dst_image, const struct _cl_mem_image *src_image)
+{
+  cl_int err;
+  char *ptr;
+
+  if (src_image->tiling != CL_NO_TILE && dst_image->tiling == CL_NO_TILE) {
+    ptr = cl_mem_map_auto((cl_mem)dst_image, 1);
+    ptr += dst_image->bpp * dst_origin[0] + dst_image->row_pitch * dst_origin[1] + dst_image->slice_pitch * dst_origin[2];
+    err = cl_image_tiled_read((struct _cl_mem_image *)src_image, src_origin, region, ptr,
+                              dst_image->row_pitch, dst_image->slice_pitch);
+    cl_mem_unmap_auto((cl_mem)dst_image);
+  } else if (dst_image->tiling != CL_NO_TILE && src_image->tiling == CL_NO_TILE) {
+    ptr = cl_mem_map_auto((cl_mem)src_image, 0);
+    ptr += src_image->bpp * src_origin[0] + src_image->row_pitch * src_origin[1] + src_image->slice_pitch * src_origin[2];
+    err = cl_image_tiled_write((struct _cl_mem_image *)dst_image, dst_origin, region, ptr,
+                               src_image->row_pitch, src_image->slice_pitch);
+    cl_mem_unmap_auto((cl_mem)src_image);
+  } else
+    err = CL_INVALID_OPERATION;
+
+  return err;
+}
+
 void
 cl_mem_copy_image_to_image(const size_t *dst_origin,const size_t *src_origin, const size_t *region,
                            const struct _cl_mem_image *dst_image, const struct _cl_mem_image *src_image)
 {
+  if (cl_mem_copy_image_to_image_tiled(dst_origin, src_origin, region, dst_image, src_image) == CL_SUCCESS)
+    return;
+
   char* dst= cl_mem_map_auto((cl_mem)dst_image, 1);
   char* src= cl_mem_map_auto((cl_mem)src_image, 0);
   size_t dst_offset = dst_image->bpp * dst_origin[0] + dst_image->row_pitch * dst_origin[1] + dst_image->slice_pitch * dst_origin[2];
@@ -710,10 +939,14 @@ cl_mem_copy_image(struct _cl_mem_image *image,
 		  size_t slice_pitch,
 		  void* host_ptr)
 {
-  char* dst_ptr = cl_mem_map_auto((cl_mem)image, 1);
   size_t origin[3] = {0, 0, 0};
   size_t region[3] = {image->w, image->h, image->depth};
 
+  if (cl_image_tiled_write(image, origin, region, host_ptr, row_pitch, slice_pitch) == CL_SUCCESS)
+    return;
+
+  char* dst_ptr = cl_mem_map_auto((cl_mem)image, 1);
+
   cl_mem_copy_image_region(origin, region, dst_ptr, image->row_pitch, image->slice_pitch,
                            host_ptr, row_pitch, slice_pitch, image, CL_FALSE, CL_FALSE); //offset is 0
   cl_mem_unmap_auto((cl_mem)image);
@@ -973,6 +1206,7 @@ _cl_mem_new_image(cl_context ctx,
 
   if (flags & CL_MEM_USE_HOST_PTR && data) {
     mem->host_ptr = data;
+    cl_context_update_mem_ptr(ctx, mem);
     cl_mem_image(mem)->host_row_pitch = pitch;
     cl_mem_image(mem)->host_slice_pitch = slice_pitch;
     if (!enableUserptr)
@@ -1081,6 +1315,10 @@ _cl_mem_new_image_from_buffer(cl_context ctx,
     merged_flags &= ~(CL_MEM_HOST_WRITE_ONLY|CL_MEM_HOST_READ_ONLY|CL_MEM_HOST_NO_ACCESS);
     merged_flags |= flags & (CL_MEM_HOST_WRITE_ONLY|CL_MEM_HOST_READ_ONLY|CL_MEM_HOST_NO_ACCESS);
   }
+  /* Images need their own bo, move the buffer out of the small buffer pool. */
+  if (UNLIKELY((err = cl_mem_pool_detach(buffer)) != CL_SUCCESS))
+    goto error;
+
   struct _cl_mem_buffer *mem_buffer = (struct _cl_mem_buffer*)buffer;
   if (buffer->type == CL_MEM_SUBBUFFER_TYPE) {
     offset = ((struct _cl_mem_buffer *)buffer)->sub_offset;
@@ -1138,8 +1376,10 @@ _cl_mem_new_image_from_buffer(cl_context ctx,
   if (image_desc->image_type == CL_MEM_OBJECT_IMAGE1D_BUFFER)
     cl_mem_replace_buffer(buffer, image->bo);
   /* Now point to the right offset if buffer is a SUB_BUFFER. */
-  if (buffer->flags & CL_MEM_USE_HOST_PTR)
+  if (buffer->flags & CL_MEM_USE_HOST_PTR) {
     image->host_ptr = buffer->host_ptr + offset;
+    cl_context_update_mem_ptr(image->ctx, image);
+  }
   cl_mem_image(image)->offset = offset;
   cl_mem_add_ref(buffer);
   cl_mem_image(image)->buffer_1d = buffer;
@@ -1283,6 +1523,8 @@ cl_mem_delete(cl_mem mem)
     if (svm_mem != NULL)
       cl_mem_delete(svm_mem);
   } else if (LIKELY(mem->bo != NULL)) {
+    if (mem->slab)
+      cl_mem_pool_free(mem->ctx->mem_pool, mem);
     cl_buffer_unreference(mem->bo);
   }
 
@@ -2110,12 +2352,16 @@ cl_mem_copy_buffer_to_image(cl_command_queue queue, cl_event event, cl_mem buffe
 }
 
 
+/* Sub-allocated buffers start at mem->offset in the bo, that offset is
+   always 0 for the other non userptr objects. */
+#define CL_MEM_BO_OFFSET(mem) ((mem)->is_userptr ? 0 : (mem)->offset)
+
 LOCAL void*
 cl_mem_map(cl_mem mem, int write)
 {
   cl_buffer_map(mem->bo, write);
   assert(cl_buffer_get_virtual(mem->bo));
-  return cl_buffer_get_virtual(mem->bo);
+  return (char *)cl_buffer_get_virtual(mem->bo) + CL_MEM_BO_OFFSET(mem);
 }
 
 LOCAL cl_int
@@ -2131,7 +2377,7 @@ cl_mem_map_gtt(cl_mem mem)
   cl_buffer_map_gtt(mem->bo);
   assert(cl_buffer_get_virtual(mem->bo));
   mem->mapped_gtt = 1;
-  return cl_buffer_get_virtual(mem->bo);
+  return (char *)cl_buffer_get_virtual(mem->bo) + CL_MEM_BO_OFFSET(mem);
 }
 
 LOCAL void *
@@ -2139,7 +2385,7 @@ cl_mem_map_gtt_unsync(cl_mem mem)
 {
   cl_buffer_map_gtt_unsync(mem->bo);
   assert(cl_buffer_get_virtual(mem->bo));
-  return cl_buffer_get_virtual(mem->bo);
+  return (char *)cl_buffer_get_virtual(mem->bo) + CL_MEM_BO_OFFSET(mem);
 }
 
 LOCAL cl_int
@@ -2152,9 +2398,10 @@ cl_mem_unmap_gtt(cl_mem mem)
 LOCAL void*
 cl_mem_map_auto(cl_mem mem, int write)
 {
-  //if mem is not created from userptr, the offset should be always zero.
+  //if mem is not created from userptr, the offset should be always zero,
+  //unless the data is sub-allocated from the small buffer pool.
   if (!mem->is_userptr)
-    assert(mem->offset == 0);
+    assert(mem->offset == 0 || mem->type == CL_MEM_BUFFER_TYPE || mem->type == CL_MEM_SUBBUFFER_TYPE);
 
   if (IS_IMAGE(mem) && cl_mem_image(mem)->tiling != CL_NO_TILE)
     return cl_mem_map_gtt(mem);
@@ -83,6 +83,28 @@ enum cl_mem_type {
 #define IS_IMAGE(mem) (mem->type >= CL_MEM_IMAGE_TYPE)
 #define IS_GL_IMAGE(mem) (mem->type == CL_MEM_GL_IMAGE_TYPE)
 
+/* Small buffers can be packed into shared bo's (OCL_SMALL_BUFFER_POOL=1).
+   Each size class from 128 bytes (CL_DEVICE_MEM_BASE_ADDR_ALIGN) to 4KB
+   has its own list of slabs, a slab is one bo cut into equal chunks. */
+#define CL_MEM_POOL_MIN_SHIFT 7
+#define CL_MEM_POOL_MAX_SHIFT 12
+#define CL_MEM_POOL_CLASS_NUM (CL_MEM_POOL_MAX_SHIFT - CL_MEM_POOL_MIN_SHIFT + 1)
+#define CL_MEM_POOL_SLAB_SIZE (64 * 1024)
+#define CL_MEM_POOL_MASK_NUM ((CL_MEM_POOL_SLAB_SIZE >> CL_MEM_POOL_MIN_SHIFT) / 64)
+
+typedef struct _cl_mem_slab {
+  list_node node;           /* Node in the size class list, full slabs at the tail */
+  cl_buffer bo;             /* The shared bo */
+  uint32_t chunk_shift;     /* log2 of the chunk size */
+  uint32_t used;            /* Number of allocated chunks */
+  uint64_t used_mask[CL_MEM_POOL_MASK_NUM]; /* One bit per allocated chunk */
+} _cl_mem_slab;
+
+typedef struct _cl_mem_pool {
+  pthread_mutex_t lock[CL_MEM_POOL_CLASS_NUM];  /* One lock per size class */
+  list_head slabs[CL_MEM_POOL_CLASS_NUM];       /* The slabs of each size class */
+} _cl_mem_pool;
+
 typedef  struct _cl_mem {
   _cl_base_object base;
   enum cl_mem_type type;
@@ -99,6 +121,8 @@ typedef  struct _cl_mem {
   uint8_t is_userptr;       /* CL_MEM_USE_HOST_PTR is enabled */
   cl_bool is_svm;           /* This object  is svm */
   size_t offset;            /* offset of host_ptr to the page beginning, only for CL_MEM_USE_HOST_PTR*/
+  itree_node ptr_node;      /* Node in the context host_ptr index */
+  struct _cl_mem_slab *slab;/* The slab holding the data if sub-allocated, at offset in bo */
 
   uint8_t cmrt_mem_type;    /* CmBuffer, CmSurface2D, ... */
   void* cmrt_mem;
@@ -257,6 +281,15 @@ cl_mem_new_image(cl_context context,
 /* Unref the object and delete it if no more reference */
 extern void cl_mem_delete(cl_mem);
 
+/* Create the small buffer pool of a context, NULL if it is disabled */
+extern struct _cl_mem_pool *cl_mem_pool_new(void);
+
+/* Destroy the small buffer pool, all its buffers must have been released */
+extern void cl_mem_pool_delete(struct _cl_mem_pool *pool);
+
+/* Move a sub-allocated buffer (and its sub buffers) to a bo of its own */
+extern cl_int cl_mem_pool_detach(cl_mem mem);
+
 /* Destroy egl image. */
 extern void cl_mem_gl_delete(struct _cl_mem_gl_image *);
 
@@ -0,0 +1,348 @@
+/*
+ * Copyright © 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "cl_printf.h"
+#include "cl_context.h"
+#include "cl_command_queue.h"
+#include "cl_gbe_loader.h"
+#include "cl_alloc.h"
+#include "cl_utils.h"
+
+/* Without a ring, the buffer size is a guess from the global size */
+#define CL_PRINTF_BUF_MIN (1 * 1024 * 1024)
+#define CL_PRINTF_BUF_MAX (16 * 1024 * 1024)
+#define CL_PRINTF_RING_MIN (64 * 1024)
+#define CL_PRINTF_RING_MAX (1024 * 1024 * 1024)
+/* Period at which the drain thread polls the running kernels */
+#define CL_PRINTF_POLL_US 1000
+
+typedef struct cl_printf_stream {
+  list_node node;
+  cl_command_queue queue;     /* Queue the launch was enqueued in */
+  void *printf_info;          /* Formats of the kernel printf statements */
+  cl_buffer bo;               /* The printf buffer */
+  volatile uint32_t *reserved;/* Bytes of records reserved by the kernel */
+  char *data;                 /* Records */
+  uint32_t data_sz;           /* Size of the data area */
+  uint32_t mask;              /* Ring mask, all ones without a ring */
+  uint32_t consumed;          /* Bytes of records output so far */
+  uint32_t lost;              /* Bytes of records which could not be output */
+} cl_printf_stream;
+
+/* Drain thread of a context, started with its first ring */
+struct _cl_printf_drain {
+  pthread_mutex_t lock;
+  pthread_cond_t work;        /* Signaled when a stream is handed over */
+  pthread_cond_t idle;        /* Signaled when the streams of a queue are drained */
+  list_head pending;          /* Streams not seen by the drain thread yet */
+  pthread_t thread;
+  int thread_started;
+  int quit;                   /* Set at context release */
+};
+
+/* Settings read from the environment once */
+static struct {
+  FILE *out;                  /* Sink */
+  uint32_t ring_size;         /* 0 when the ring mode is disabled */
+} cl_printf;
+
+static pthread_once_t cl_printf_once = PTHREAD_ONCE_INIT;
+
+static void
+cl_printf_init(void)
+{
+  const char *env;
+  int ring_size = 0;
+  int fd;
+
+  cl_printf.out = stdout;
+
+  // can't use BVAR (backend/src/sys/cvar.hpp) here as it's C++
+  env = getenv("OCL_PRINTF_OUTPUT");
+  if (env != NULL && *env != '\0' && strcmp(env, "stdout") != 0) {
+    FILE *out;
+    if (strcmp(env, "stderr") == 0)
+      out = stderr;
+    else if (sscanf(env, "fd:%d", &fd) == 1)
+      out = fdopen(dup(fd), "w");
+    else
+      out = fopen(env, "w");
+    if (out != NULL)
+      cl_printf.out = out;
+    else
+      fprintf(stderr, "Beignet: cannot open the printf output %s, using stdout.\n", env);
+  }
+
+  env = getenv("OCL_PRINTF_RING_SIZE");
+  if (env != NULL)
+    sscanf(env, "%i", &ring_size);
+  if (ring_size > 0) {
+    /* The kernel wraps the offsets with a mask */
+    cl_printf.ring_size = CL_PRINTF_RING_MIN;
+    while (cl_printf.ring_size < (uint32_t)ring_size && cl_printf.ring_size < CL_PRINTF_RING_MAX)
+      cl_printf.ring_size <<= 1;
+  }
+}
+
+/* Output the complete records from s->consumed on. A record is complete once
+ * its end marker is written. When final is set, the kernel is done and
+ * whatever is not complete is lost. */
+static void
+cl_printf_stream_drain(cl_printf_stream *s, int final)
+{
+  const int ring = s->mask != ~0u;
+
+  for (;;) {
+    const uint32_t reserved = *s->reserved;
+    uint32_t *log, size;
+
+    if (s->consumed == reserved)
+      break;
+
+    /* The kernel went around the ring before we could output the records */
+    if (ring && reserved - s->consumed > s->data_sz) {
+      s->lost += reserved - s->consumed;
+      s->consumed = reserved;
+      break;
+    }
+
+    log = (uint32_t *)(s->data + (s->consumed & s->mask));
+    size = log[1];
+    if (log[0] != GBE_PRINTF_LOG_MAGIC ||
+        size < 16 || size > GBE_PRINTF_LOG_MAX_SIZE || (size & 3) ||
+        (!ring && s->consumed + size > s->data_sz) ||
+        log[size / 4 - 1] != GBE_PRINTF_LOG_END) {
+      if (!final)
+        break;
+      /* Written past the end of the buffer */
+      s->lost += reserved - s->consumed;
+      s->consumed = reserved;
+      break;
+    }
+
+    __sync_synchronize();
+    interp_output_printf(s->printf_info, log, cl_printf.out);
+    /* Records are recognized by their magic, do not see this one again */
+    if (ring)
+      memset(log, 0, size);
+    s->consumed += size;
+  }
+}
+
+static void
+cl_printf_stream_delete(cl_printf_stream *s)
+{
+  fflush(cl_printf.out);
+  if (s->lost)
+    fprintf(stderr, "Beignet: %u bytes of printf output lost, %s.\n", s->lost,
+            s->mask != ~0u ? "increase OCL_PRINTF_RING_SIZE" : "set OCL_PRINTF_RING_SIZE");
+
+  if (s->mask != ~0u)
+    cl_buffer_unmap_gtt(s->bo);
+  else
+    cl_buffer_unmap(s->bo);
+  cl_buffer_unreference(s->bo);
+  interp_release_printf_info(s->printf_info);
+  cl_free(s);
+}
+
+static void *
+cl_printf_thread(void *arg)
+{
+  cl_printf_drain d = arg;
+  list_head active;
+  list_node *pos, *n;
+
+  list_init(&active);
+  for (;;) {
+    pthread_mutex_lock(&d->lock);
+    while (list_empty(&d->pending) && list_empty(&active) && !d->quit)
+      pthread_cond_wait(&d->work, &d->lock);
+    /* The queues are gone, so is everything they enqueued */
+    if (d->quit && list_empty(&d->pending) && list_empty(&active)) {
+      pthread_mutex_unlock(&d->lock);
+      break;
+    }
+    list_merge(&active, &d->pending);
+    pthread_mutex_unlock(&d->lock);
+
+    list_for_each_safe(pos, n, &active) {
+      cl_printf_stream *s = list_entry(pos, cl_printf_stream, node);
+      /* Checked first so that nothing is written after the final pass */
+      const int final = !cl_buffer_is_busy(s->bo);
+      cl_command_queue queue = s->queue;
+
+      cl_printf_stream_drain(s, final);
+      if (!final)
+        continue;
+
+      list_node_del(&s->node);
+      cl_printf_stream_delete(s);
+      pthread_mutex_lock(&d->lock);
+      if (--queue->printf_stream_n == 0)
+        pthread_cond_broadcast(&d->idle);
+      pthread_mutex_unlock(&d->lock);
+    }
+
+    fflush(cl_printf.out);
+    if (!list_empty(&active))
+      usleep(CL_PRINTF_POLL_US);
+  }
+  return NULL;
+}
+
+LOCAL cl_int
+cl_printf_alloc(cl_gpgpu gpgpu, void *printf_info, size_t global_sz)
+{
+  const uint32_t printf_num = interp_get_printf_num(printf_info);
+  size_t buf_size;
+  uint32_t mask = ~0u;
+
+  pthread_once(&cl_printf_once, cl_printf_init);
+
+  if (cl_printf.ring_size) {
+    /* A record reserved at the end of the ring is written past it */
+    buf_size = GBE_PRINTF_BUF_HEADER_SIZE + cl_printf.ring_size +
+               ALIGN(GBE_PRINTF_LOG_MAX_SIZE, 4096);
+    mask = cl_printf.ring_size - 1;
+  } else {
+    /* An guess size. */
+    buf_size = global_sz * sizeof(int) * 16 * printf_num;
+    buf_size = MIN(MAX(buf_size, CL_PRINTF_BUF_MIN), CL_PRINTF_BUF_MAX);
+  }
+
+  if (cl_gpgpu_set_printf_buffer(gpgpu, buf_size, mask, interp_get_printf_buf_bti(printf_info)) != 0)
+    return CL_OUT_OF_RESOURCES;
+  return CL_SUCCESS;
+}
+
+LOCAL void
+cl_printf_output(cl_command_queue queue, cl_gpgpu gpgpu, void *printf_info)
+{
+  cl_printf_drain d = queue->ctx->printf_drain;
+  cl_printf_stream *s = NULL;
+  char *addr;
+
+  TRY_ALLOC_NO_ERR(s, CALLOC(cl_printf_stream));
+  s->queue = queue;
+  s->printf_info = printf_info;
+  s->bo = cl_gpgpu_ref_printf_buffer(gpgpu);
+  if (s->bo == NULL)
+    goto error;
+  s->data_sz = cl_buffer_get_size(s->bo) - GBE_PRINTF_BUF_HEADER_SIZE;
+  s->mask = ~0u;
+
+  if (cl_printf.ring_size == 0) {
+    /* Waits for the kernel */
+    if (cl_buffer_map(s->bo, 0) != 0)
+      goto error;
+    addr = cl_buffer_get_virtual(s->bo);
+    s->reserved = (uint32_t *)addr;
+    s->data = addr + GBE_PRINTF_BUF_HEADER_SIZE;
+    cl_printf_stream_drain(s, 1);
+    cl_printf_stream_delete(s);
+    return;
+  }
+
+  /* The ring is read while the kernel writes it */
+  if (cl_buffer_map_gtt_unsync(s->bo) != 0)
+    goto error;
+  addr = cl_buffer_get_virtual(s->bo);
+  s->reserved = (uint32_t *)addr;
+  s->data = addr + GBE_PRINTF_BUF_HEADER_SIZE;
+  s->data_sz = cl_printf.ring_size;
+  s->mask = cl_printf.ring_size - 1;
+
+  pthread_mutex_lock(&d->lock);
+  if (!d->thread_started) {
+    if (pthread_create(&d->thread, NULL, cl_printf_thread, d) == 0)
+      d->thread_started = 1;
+  }
+  if (d->thread_started) {
+    list_add_tail(&d->pending, &s->node);
+    queue->printf_stream_n++;
+    pthread_cond_signal(&d->work);
+    pthread_mutex_unlock(&d->lock);
+    return;
+  }
+  pthread_mutex_unlock(&d->lock);
+
+  /* No drain thread, output everything once the kernel is done */
+  cl_buffer_wait_rendering(s->bo);
+  cl_printf_stream_drain(s, 1);
+  cl_printf_stream_delete(s);
+  return;
+
+error:
+  if (s) {
+    if (s->bo)
+      cl_buffer_unreference(s->bo);
+    cl_free(s);
+  }
+  interp_release_printf_info(printf_info);
+}
+
+LOCAL void
+cl_printf_sync(cl_command_queue queue)
+{
+  cl_printf_drain d = queue->ctx->printf_drain;
+
+  pthread_mutex_lock(&d->lock);
+  while (queue->printf_stream_n)
+    pthread_cond_wait(&d->idle, &d->lock);
+  pthread_mutex_unlock(&d->lock);
+}
+
+LOCAL cl_printf_drain
+cl_printf_drain_new(void)
+{
+  cl_printf_drain d = NULL;
+
+  TRY_ALLOC_NO_ERR(d, CALLOC(struct _cl_printf_drain));
+  pthread_mutex_init(&d->lock, NULL);
+  pthread_cond_init(&d->work, NULL);
+  pthread_cond_init(&d->idle, NULL);
+  list_init(&d->pending);
+error:
+  return d;
+}
+
+LOCAL void
+cl_printf_drain_delete(cl_printf_drain d)
+{
+  if (d == NULL)
+    return;
+
+  if (d->thread_started) {
+    pthread_mutex_lock(&d->lock);
+    d->quit = 1;
+    pthread_cond_signal(&d->work);
+    pthread_mutex_unlock(&d->lock);
+    pthread_join(d->thread, NULL);
+  }
+  pthread_cond_destroy(&d->idle);
+  pthread_cond_destroy(&d->work);
+  pthread_mutex_destroy(&d->lock);
+  cl_free(d);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CL_PRINTF_H__
+#define __CL_PRINTF_H__
+
+#include "cl_driver.h"
+
+/* Kernel printf output.
+ *
+ * By default the printf buffer of a launch is sized from the global size and
+ * parsed once the kernel is done. With OCL_PRINTF_RING_SIZE set, the buffer is
+ * a ring of that many bytes which a host thread drains (and formats) while the
+ * kernel runs, so the output is neither truncated nor tied to one big
+ * allocation. OCL_PRINTF_OUTPUT selects the sink: a file name, "stderr" or
+ * "fd:N" (stdout by default). Each context has its own drain thread, joined
+ * when the context is released, and each queue waits only for its own output.
+ */
+
+typedef struct _cl_printf_drain *cl_printf_drain;
+
+/* Create the drain state of a context, the thread starts with the first ring */
+extern cl_printf_drain cl_printf_drain_new(void);
+
+/* Stop and join the drain thread, all the queues must be synced already */
+extern void cl_printf_drain_delete(cl_printf_drain d);
+
+/* Allocate and bind the printf buffer of a launch */
+extern cl_int cl_printf_alloc(cl_gpgpu gpgpu, void *printf_info, size_t global_sz);
+
+/* Output the printf records of a flushed launch and release its printf info.
+ * In ring mode this only hands the buffer to the drain thread. */
+extern void cl_printf_output(cl_command_queue queue, cl_gpgpu gpgpu, void *printf_info);
+
+/* Wait until the drain thread has output everything the queue handed it */
+extern void cl_printf_sync(cl_command_queue queue);
+
+#endif /* __CL_PRINTF_H__ */
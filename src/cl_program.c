@@ -68,9 +68,8 @@ cl_program_delete(cl_program p)
   /* We are not done with it yet */
   if ((ref = CL_OBJECT_DEC_REF(p)) > 1) return;
 
-  /* Destroy the sources and binary if still allocated */
+  /* Destroy the sources if still allocated */
   cl_program_release_sources(p);
-  cl_program_release_binary(p);
 
   /* Release the build options. */
   if (p->build_opts) {
@@ -89,7 +88,6 @@ cl_program_delete(cl_program p)
   else
 #endif
   {
-    cl_free(p->bin);               /* Free the blob */
     for (i = 0; i < p->ker_n; ++i) /* Free the kernels */
       cl_kernel_delete(p->ker[i]);
     cl_free(p->ker);
@@ -113,6 +111,9 @@ cl_program_delete(cl_program p)
       interp_program_delete(p->opaque);
   }
 
+  /* The kernels of a Gen binary refer to it, so it goes after the program */
+  cl_program_release_binary(p);
+
   CL_OBJECT_DESTROY_BASE(p);
   cl_free(p);
 }
@@ -153,32 +154,46 @@ static cl_int
 cl_program_load_gen_program(cl_program p)
 {
   cl_int err = CL_SUCCESS;
-  uint32_t i;
 
   assert(p->opaque != NULL);
   p->ker_n = interp_program_get_kernel_num(p->opaque);
 
-  /* Allocate the kernel array */
+  /* Allocate the kernel array. The kernels are set up by
+   * cl_program_get_kernel, which is also when the compiler generates their
+   * Gen code with OCL_LAZY_KERNEL_COMPILE */
   TRY_ALLOC (p->ker, CALLOC_ARRAY(cl_kernel, p->ker_n));
 
-  for (i = 0; i < p->ker_n; ++i) {
-    const gbe_kernel opaque = interp_program_get_kernel(p->opaque, i);
-    assert(opaque != NULL);
-    TRY_ALLOC (p->ker[i], cl_kernel_new(p));
-    cl_kernel_setup(p->ker[i], opaque);
-  }
-
 error:
   return err;
 }
 
+LOCAL cl_kernel
+cl_program_get_kernel(cl_program p, uint32_t index)
+{
+  cl_kernel k;
+  gbe_kernel opaque;
+
+  assert(index < p->ker_n);
+  CL_OBJECT_LOCK(p);
+  if (p->ker[index] == NULL) {
+    opaque = interp_program_get_kernel(p->opaque, index);
+    if (opaque != NULL && (k = cl_kernel_new(p)) != NULL) {
+      cl_kernel_setup(k, opaque);
+      p->ker[index] = k;
+    }
+  }
+  k = p->ker[index];
+  CL_OBJECT_UNLOCK(p);
+  return k;
+}
+
 #define BINARY_HEADER_LENGTH 5
 
 static const unsigned char binary_type_header[BHI_MAX][BINARY_HEADER_LENGTH]=  \
                                               {{'B','C', 0xC0, 0xDE},
                                                {1, 'B', 'C', 0xC0, 0xDE},
                                                {2, 'B', 'C', 0xC0, 0xDE},
-                                               {1, 'G','E', 'N', 'C'},
+                                               {2, 'G','E', 'N', 'C'},
                                                {'C','I', 'S', 'A'},
                                                };
 
@@ -193,8 +208,9 @@ LOCAL cl_bool headerCompare(const unsigned char *BufPtr, BINARY_HEADER_INDEX ind
   {
     matched = matched && (BufPtr[i] == binary_type_header[index][i]);
   }
+  /* Gen binaries of version 1 (serialized stream) are still readable */
   if(index == BHI_GEN_BINARY && matched) {
-    if(BufPtr[0] != binary_type_header[index][0]) {
+    if(BufPtr[0] != binary_type_header[index][0] && BufPtr[0] != 1) {
       DEBUGP(DL_WARNING, "Beignet binary format have been changed, please generate binary again.\n");
       matched = false;
     }
@@ -293,7 +309,9 @@ cl_program_create_from_binary(cl_context             ctx,
       goto error;
   }
 
-  TRY_ALLOC(program->binary, cl_calloc(lengths[0], sizeof(char)));
+  /* A gen binary is used in place: its payload follows an 8 bytes header and
+     must be 8 bytes aligned, so keep the copy on a cache line boundary */
+  TRY_ALLOC(program->binary, cl_aligned_malloc(lengths[0], 64));
   memcpy(program->binary, binaries[0], lengths[0]);
   program->binary_sz = lengths[0];
   program->source_type = FROM_BINARY;
@@ -332,7 +350,7 @@ cl_program_create_from_binary(cl_context             ctx,
     program->source_type = FROM_LLVM;
   }
   else if (isGenBinary((unsigned char*)program->binary)) {
-    program->opaque = interp_program_new_from_binary(program->ctx->devices[0]->device_id, program->binary, program->binary_sz);
+    program->opaque = interp_program_new_from_mapped_binary(program->ctx->devices[0]->device_id, program->binary, program->binary_sz);
     if (UNLIKELY(program->opaque == NULL)) {
       DEBUGP(DL_ERROR, "Incompatible binary, please delete the binary and generate again.");
       err = CL_INVALID_PROGRAM;
@@ -546,8 +564,6 @@ LOCAL cl_int
 cl_program_build(cl_program p, const char *options)
 {
   cl_int err = CL_SUCCESS;
-  int i = 0;
-  int copyed = 0;
 
   if (CL_OBJECT_GET_REF(p) > 1) {
     err = CL_INVALID_OPERATION;
@@ -622,7 +638,7 @@ cl_program_build(cl_program p, const char *options)
     /* Create all the kernels */
     TRY (cl_program_load_gen_program, p);
   } else if (p->source_type == FROM_BINARY && p->binary_type != CL_PROGRAM_BINARY_TYPE_EXECUTABLE) {
-    p->opaque = interp_program_new_from_binary(p->ctx->devices[0]->device_id, p->binary, p->binary_sz);
+    p->opaque = interp_program_new_from_mapped_binary(p->ctx->devices[0]->device_id, p->binary, p->binary_sz);
     if (UNLIKELY(p->opaque == NULL)) {
       err = CL_BUILD_PROGRAM_FAILURE;
       goto error;
@@ -633,20 +649,7 @@ cl_program_build(cl_program p, const char *options)
   }
   p->binary_type = CL_PROGRAM_BINARY_TYPE_EXECUTABLE;
 
-  for (i = 0; i < p->ker_n; i ++) {
-    const gbe_kernel opaque = interp_program_get_kernel(p->opaque, i);
-    p->bin_sz += interp_kernel_get_code_size(opaque);
-  }
-
-  TRY_ALLOC (p->bin, cl_calloc(p->bin_sz, sizeof(char)));
-  for (i = 0; i < p->ker_n; i ++) {
-    const gbe_kernel opaque = interp_program_get_kernel(p->opaque, i);
-    size_t sz = interp_kernel_get_code_size(opaque);
-
-    memcpy(p->bin + copyed, interp_kernel_get_code(opaque), sz);
-    copyed += sz;
-  }
-  uint32_t ocl_version = interp_kernel_get_ocl_version(interp_program_get_kernel(p->opaque, 0));
+  uint32_t ocl_version = interp_program_get_ocl_version(p->opaque);
   if (ocl_version >= 200 && (err = get_program_global_data(p)) != CL_SUCCESS)
     goto error;
 
@@ -669,7 +672,6 @@ cl_program_link(cl_context            context,
   cl_program p = NULL;
   cl_int err = CL_SUCCESS;
   cl_int i = 0;
-  int copyed = 0;
   cl_bool ret = 0;
   int avialable_program = 0;
   //Although we don't use options, but still need check options
@@ -742,21 +744,8 @@ cl_program_link(cl_context            context,
   /* Create all the kernels */
   TRY (cl_program_load_gen_program, p);
 
-  for (i = 0; i < p->ker_n; i ++) {
-    const gbe_kernel opaque = interp_program_get_kernel(p->opaque, i);
-    p->bin_sz += interp_kernel_get_code_size(opaque);
-  }
-
-  TRY_ALLOC (p->bin, cl_calloc(p->bin_sz, sizeof(char)));
-  for (i = 0; i < p->ker_n; i ++) {
-    const gbe_kernel opaque = interp_program_get_kernel(p->opaque, i);
-    size_t sz = interp_kernel_get_code_size(opaque);
-
-    memcpy(p->bin + copyed, interp_kernel_get_code(opaque), sz);
-    copyed += sz;
-  }
 
-  uint32_t ocl_version = interp_kernel_get_ocl_version(interp_program_get_kernel(p->opaque, 0));
+  uint32_t ocl_version = interp_program_get_ocl_version(p->opaque);
   if (ocl_version >= 200 && (err = get_program_global_data(p)) != CL_SUCCESS)
     goto error;
 
@@ -917,20 +906,23 @@ cl_program_create_kernel(cl_program p, const char *name, cl_int *errcode_ret)
 
   /* Find the program first */
   for (i = 0; i < p->ker_n; ++i) {
-    assert(p->ker[i]);
-    const char *ker_name = cl_kernel_get_name(p->ker[i]);
-    if (ker_name != NULL && strcmp(ker_name, name) == 0) {
-      from = p->ker[i];
+    const char *ker_name = interp_program_get_kernel_name(p->opaque, i);
+    if (ker_name != NULL && strcmp(ker_name, name) == 0)
       break;
-    }
   }
 
   /* We were not able to find this named kernel */
-  if (UNLIKELY(from == NULL)) {
+  if (UNLIKELY(i == p->ker_n)) {
     err = CL_INVALID_KERNEL_NAME;
     goto error;
   }
 
+  /* Or to generate its code */
+  if (UNLIKELY((from = cl_program_get_kernel(p, i)) == NULL)) {
+    err = CL_INVALID_PROGRAM_EXECUTABLE;
+    goto error;
+  }
+
   TRY_ALLOC(to, cl_kernel_dup(from));
 
 exit:
@@ -946,13 +938,22 @@ error:
 LOCAL cl_int
 cl_program_create_kernels_in_program(cl_program p, cl_kernel* ker)
 {
+  cl_int err = CL_SUCCESS;
   int i = 0;
 
   if(ker == NULL)
     return CL_SUCCESS;
 
   for (i = 0; i < p->ker_n; ++i) {
-    TRY_ALLOC_NO_ERR(ker[i], cl_kernel_dup(p->ker[i]));
+    cl_kernel from = cl_program_get_kernel(p, i);
+    if (UNLIKELY(from == NULL)) {
+      err = CL_INVALID_PROGRAM_EXECUTABLE;
+      goto error;
+    }
+    if (UNLIKELY((ker[i] = cl_kernel_dup(from)) == NULL)) {
+      err = CL_OUT_OF_HOST_MEMORY;
+      goto error;
+    }
   }
 
   return CL_SUCCESS;
@@ -963,7 +964,7 @@ error:
     ker[i--] = NULL;
   } while(i > 0);
 
-  return CL_OUT_OF_HOST_MEMORY;
+  return err;
 }
 
 LOCAL void
@@ -978,7 +979,7 @@ cl_program_get_kernel_names(cl_program p, size_t size, char *names, size_t *size
     return;
   }
 
-  ker_name = cl_kernel_get_name(p->ker[0]);
+  ker_name = interp_program_get_kernel_name(p->opaque, 0);
   if (ker_name != NULL)
     len = strlen(ker_name);
   else
@@ -995,7 +996,7 @@ cl_program_get_kernel_names(cl_program p, size_t size, char *names, size_t *size
   if(size_ret) *size_ret = len + 1;  //add NULL
 
   for (i = 1; i < p->ker_n; ++i) {
-    ker_name = cl_kernel_get_name(p->ker[i]);
+    ker_name = interp_program_get_kernel_name(p->opaque, i);
     if (ker_name != NULL)
       len = strlen(ker_name);
     else
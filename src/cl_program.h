@@ -52,13 +52,11 @@ typedef enum _BINARY_HEADER_INDEX {
 struct _cl_program {
   _cl_base_object base;
   gbe_program opaque;     /* (Opaque) program as ouput by the compiler */
-  cl_kernel *ker;         /* All kernels included by the OCL file */
+  cl_kernel *ker;         /* All kernels included by the OCL file, set up on first use */
   cl_program prev, next;  /* We chain the programs together */
   cl_context ctx;         /* Its parent context */
   cl_buffer  global_data;
   char * global_data_ptr;
-  char *bin;              /* The program copied verbatim */
-  size_t bin_sz;          /* Its size in memory */
   char *source;           /* Program sources */
   char *binary;           /* Program binary. */
   size_t binary_sz;       /* The binary size. */
@@ -93,6 +91,9 @@ extern void cl_program_add_ref(cl_program);
 /* Create a kernel for the OCL user */
 extern cl_kernel cl_program_create_kernel(cl_program, const char*, cl_int*);
 
+/* Get the kernel of the given index, NULL if its Gen code cannot be generated */
+extern cl_kernel cl_program_get_kernel(cl_program, uint32_t);
+
 /* creates kernel objects for all kernel functions in program. */
 extern cl_int cl_program_create_kernels_in_program(cl_program, cl_kernel*);
 
@@ -70,6 +70,162 @@ list_merge(struct list_head *head, struct list_head *to_merge)
   list_init(to_merge);
 }
 
+static inline int
+itree_height(const itree_node *node)
+{
+  return node ? node->height : 0;
+}
+
+static inline int
+itree_less(const itree_node *a, const itree_node *b)
+{
+  /* Break ties by address so equal intervals can still be removed one by one. */
+  return a->start < b->start || (a->start == b->start && a < b);
+}
+
+static void
+itree_update(itree_node *node)
+{
+  int lh = itree_height(node->left);
+  int rh = itree_height(node->right);
+  node->height = (lh > rh ? lh : rh) + 1;
+  node->max_end = node->end;
+  if (node->left && node->left->max_end > node->max_end)
+    node->max_end = node->left->max_end;
+  if (node->right && node->right->max_end > node->max_end)
+    node->max_end = node->right->max_end;
+}
+
+static itree_node *
+itree_rotate_right(itree_node *node)
+{
+  itree_node *l = node->left;
+  node->left = l->right;
+  l->right = node;
+  itree_update(node);
+  itree_update(l);
+  return l;
+}
+
+static itree_node *
+itree_rotate_left(itree_node *node)
+{
+  itree_node *r = node->right;
+  node->right = r->left;
+  r->left = node;
+  itree_update(node);
+  itree_update(r);
+  return r;
+}
+
+static itree_node *
+itree_balance(itree_node *node)
+{
+  int bf;
+
+  itree_update(node);
+  bf = itree_height(node->left) - itree_height(node->right);
+  if (bf > 1) {
+    if (itree_height(node->left->left) < itree_height(node->left->right))
+      node->left = itree_rotate_left(node->left);
+    return itree_rotate_right(node);
+  }
+  if (bf < -1) {
+    if (itree_height(node->right->right) < itree_height(node->right->left))
+      node->right = itree_rotate_right(node->right);
+    return itree_rotate_left(node);
+  }
+  return node;
+}
+
+static itree_node *
+itree_insert_node(itree_node *root, itree_node *node)
+{
+  if (root == NULL)
+    return node;
+
+  if (itree_less(node, root))
+    root->left = itree_insert_node(root->left, node);
+  else
+    root->right = itree_insert_node(root->right, node);
+  return itree_balance(root);
+}
+
+static itree_node *
+itree_remove_min(itree_node *root, itree_node **min)
+{
+  if (root->left == NULL) {
+    *min = root;
+    return root->right;
+  }
+  root->left = itree_remove_min(root->left, min);
+  return itree_balance(root);
+}
+
+static itree_node *
+itree_remove_node(itree_node *root, itree_node *node)
+{
+  itree_node *min;
+
+  assert(root);
+  if (root == node) {
+    if (root->right == NULL)
+      return root->left;
+    root->right = itree_remove_min(root->right, &min);
+    min->left = root->left;
+    min->right = root->right;
+    return itree_balance(min);
+  }
+
+  if (itree_less(node, root))
+    root->left = itree_remove_node(root->left, node);
+  else
+    root->right = itree_remove_node(root->right, node);
+  return itree_balance(root);
+}
+
+LOCAL void
+itree_insert(itree_head *tree, itree_node *node, size_t start, size_t end)
+{
+  assert(!itree_node_in_tree(node));
+  node->left = NULL;
+  node->right = NULL;
+  node->start = start;
+  node->end = end;
+  itree_update(node);
+  tree->root = itree_insert_node(tree->root, node);
+}
+
+LOCAL void
+itree_remove(itree_head *tree, itree_node *node)
+{
+  assert(itree_node_in_tree(node));
+  tree->root = itree_remove_node(tree->root, node);
+  node->left = NULL;
+  node->right = NULL;
+  node->height = 0;
+}
+
+LOCAL itree_node *
+itree_find(const itree_head *tree, size_t addr)
+{
+  itree_node *node = tree->root;
+
+  while (node) {
+    if (node->start <= addr && addr < node->end)
+      return node;
+    /* If some interval on the left ends after addr but none contains it,
+       all of them start after addr, and so does everything on the right. */
+    if (node->left && node->left->max_end > addr)
+      node = node->left;
+    else if (node->start <= addr)
+      node = node->right;
+    else
+      break;
+  }
+  return NULL;
+}
+
 LOCAL cl_int
 cl_get_info_helper(const void *src, size_t src_size, void *dst, size_t dst_size, size_t *ret_size)
 {
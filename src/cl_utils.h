@@ -426,6 +426,35 @@ extern void list_merge(struct list_head *head, struct list_head *to_merge);
   for (pos = (head)->head_node.n, ne = pos->n; pos != &((head)->head_node); \
        pos = ne, ne = pos->n)
 
+/* Define one interval tree node. The tree is an AVL tree ordered by the
+   interval start and augmented with the max end of each subtree, so finding
+   an interval containing some address is O(log n). */
+typedef struct itree_node {
+  struct itree_node *left;
+  struct itree_node *right;
+  size_t start;               /* First address of the interval */
+  size_t end;                 /* One past the last address of the interval */
+  size_t max_end;             /* Max end of all the intervals in this subtree */
+  int height;                 /* Subtree height, 0 when not in a tree */
+} itree_node;
+typedef struct itree_head {
+  itree_node *root;
+} itree_head;
+
+static inline void itree_init(itree_head *tree)
+{
+  tree->root = NULL;
+}
+static inline int itree_node_in_tree(const itree_node *node)
+{
+  return node->height != 0;
+}
+/* Insert the node with the interval [start, end). Overlap is allowed. */
+extern void itree_insert(itree_head *tree, itree_node *node, size_t start, size_t end);
+extern void itree_remove(itree_head *tree, itree_node *node);
+/* Find one node whose interval contains addr, NULL if none. */
+extern itree_node *itree_find(const itree_head *tree, size_t addr);
+
 extern cl_int cl_get_info_helper(const void *src, size_t src_size, void *dst,
                                  size_t dst_size, size_t *ret_size);
 #endif /* __CL_UTILS_H__ */
@@ -545,6 +545,21 @@ default:
 return CL_NO_TILE;
 }
 
+static cl_buffer_swizzle_t intel_buffer_get_swizzle(cl_buffer bo)
+{
+uint32_t tiling_mode, swizzle_mode;
+if (drm_intel_bo_get_tiling((drm_intel_bo*)bo, &tiling_mode, &swizzle_mode) != 0)
+  return CL_SWIZZLE_UNKNOWN;
+switch(swizzle_mode) {
+case I915_BIT_6_SWIZZLE_NONE: return CL_SWIZZLE_NONE;
+case I915_BIT_6_SWIZZLE_9: return CL_SWIZZLE_9;
+case I915_BIT_6_SWIZZLE_9_10: return CL_SWIZZLE_9_10;
+case I915_BIT_6_SWIZZLE_9_11: return CL_SWIZZLE_9_11;
+case I915_BIT_6_SWIZZLE_9_10_11: return CL_SWIZZLE_9_10_11;
+default: return CL_SWIZZLE_UNKNOWN;
+}
+}
+
 static uint32_t intel_buffer_get_tiling_align(cl_context ctx, uint32_t tiling_mode, uint32_t dim)
 {
 uint32_t gen_ver = ((intel_driver_t *)ctx->drv)->gen_ver;
@@ -1071,8 +1086,10 @@ cl_buffer_set_bo_use_full_range = (cl_buffer_set_bo_use_full_range_cb *) drm_int
   cl_buffer_subdata = (cl_buffer_subdata_cb *) drm_intel_bo_subdata;
   cl_buffer_get_subdata = (cl_buffer_get_subdata_cb *) drm_intel_bo_get_subdata;
   cl_buffer_wait_rendering = (cl_buffer_wait_rendering_cb *) drm_intel_bo_wait_rendering;
+  cl_buffer_is_busy = (cl_buffer_is_busy_cb *) drm_intel_bo_busy;
   cl_buffer_get_fd = (cl_buffer_get_fd_cb *) drm_intel_bo_gem_export_to_prime;
   cl_buffer_get_tiling_align = (cl_buffer_get_tiling_align_cb *)intel_buffer_get_tiling_align;
+  cl_buffer_get_swizzle = (cl_buffer_get_swizzle_cb *) intel_buffer_get_swizzle;
   cl_buffer_get_buffer_from_fd = (cl_buffer_get_buffer_from_fd_cb *) intel_share_buffer_from_fd;
   cl_buffer_get_image_from_fd = (cl_buffer_get_image_from_fd_cb *) intel_share_image_from_fd;
   intel_set_gpgpu_callbacks(intel_get_device_id());
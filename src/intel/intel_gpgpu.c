@@ -2373,7 +2373,7 @@ intel_gpgpu_get_profiling_info(intel_gpgpu_t *gpgpu)
 }
 
 static int
-intel_gpgpu_set_printf_buf(intel_gpgpu_t *gpgpu, uint32_t size, uint8_t bti)
+intel_gpgpu_set_printf_buf(intel_gpgpu_t *gpgpu, uint32_t size, uint32_t mask, uint8_t bti)
 {
   if (gpgpu->printf_b.bo)
     dri_bo_unreference(gpgpu->printf_b.bo);
@@ -2385,7 +2385,7 @@ intel_gpgpu_set_printf_buf(intel_gpgpu_t *gpgpu, uint32_t size, uint8_t bti)
   }
 
   memset(gpgpu->printf_b.bo->virtual, 0, size);
-  *(uint32_t *)(gpgpu->printf_b.bo->virtual) = 4; // first four is for the length.
+  ((uint32_t *)gpgpu->printf_b.bo->virtual)[1] = mask; // first dword is the length.
   drm_intel_bo_unmap(gpgpu->printf_b.bo);
   /* No need to bind, we do not need to emit reloc. */
   intel_gpgpu_setup_bti(gpgpu, gpgpu->printf_b.bo, 0, size, bti, I965_SURFACEFORMAT_RAW);
@@ -2427,6 +2427,14 @@ intel_gpgpu_unmap_printf_buf_addr(intel_gpgpu_t *gpgpu)
   drm_intel_bo_unmap(bo);
 }
 
+static drm_intel_bo*
+intel_gpgpu_ref_printf_buf(intel_gpgpu_t *gpgpu)
+{
+  if (gpgpu->printf_b.bo)
+    drm_intel_bo_reference(gpgpu->printf_b.bo);
+  return gpgpu->printf_b.bo;
+}
+
 static void
 intel_gpgpu_release_printf_buf(intel_gpgpu_t *gpgpu)
 {
@@ -2492,6 +2500,7 @@ intel_set_gpgpu_callbacks(int device_id)
   cl_gpgpu_map_profiling_buffer = (cl_gpgpu_map_profiling_buffer_cb *)intel_gpgpu_map_profiling_buf;
   cl_gpgpu_unmap_profiling_buffer = (cl_gpgpu_unmap_profiling_buffer_cb *)intel_gpgpu_unmap_profiling_buf_addr;
   cl_gpgpu_set_printf_buffer = (cl_gpgpu_set_printf_buffer_cb *)intel_gpgpu_set_printf_buf;
+  cl_gpgpu_ref_printf_buffer = (cl_gpgpu_ref_printf_buffer_cb *)intel_gpgpu_ref_printf_buf;
   cl_gpgpu_map_printf_buffer = (cl_gpgpu_map_printf_buffer_cb *)intel_gpgpu_map_printf_buf;
   cl_gpgpu_unmap_printf_buffer = (cl_gpgpu_unmap_printf_buffer_cb *)intel_gpgpu_unmap_printf_buf_addr;
   cl_gpgpu_release_printf_buffer = (cl_gpgpu_release_printf_buffer_cb *)intel_gpgpu_release_printf_buf;
@@ -0,0 +1,507 @@
+/*
+ * Copyright © 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+
+#include "null/null_driver.h"
+#include "cl_driver.h"
+#include "cl_device_data.h"
+#include "cl_context.h"
+#include "cl_alloc.h"
+#include "cl_utils.h"
+
+typedef struct null_driver {
+  int device_id;
+  uint32_t gen_ver;
+} null_driver_t;
+
+/* Host memory standing for a bo. The memory is always "mapped". */
+typedef struct null_bo {
+  atomic_t ref_n;
+  size_t size;
+  void *virtual;
+  uint32_t userptr:1;      /* virtual belongs to the application */
+} null_bo_t;
+
+typedef struct null_gpgpu {
+  null_driver_t *drv;
+  null_bo_t *constant_bo;
+  null_bo_t *printf_bo;
+  null_bo_t *profiling_bo;
+  void *printf_info;
+  void *profiling_info;
+  void *kernel;
+  uint64_t exec_ts[2];     /* "execution" start and end of the last walker */
+} null_gpgpu_t;
+
+typedef struct null_event {
+  int status;
+} null_event_t;
+
+static uint64_t
+null_get_timestamp(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+LOCAL int
+null_driver_enabled(void)
+{
+  static int enabled = -1;
+  if (enabled < 0) {
+    const char *env = getenv("OCL_NULL_DRIVER");
+    enabled = env != NULL && atoi(env) != 0;
+  }
+  return enabled;
+}
+
+/**************************************************************************
+ * Driver
+ **************************************************************************/
+static int
+null_get_device_id(void)
+{
+  const char *env = getenv("OCL_NULL_DEVICE_ID");
+  if (env != NULL)
+    return (int)strtol(env, NULL, 0);
+  return PCI_CHIP_SKYLAKE_ULT_GT2;
+}
+
+static void
+null_update_device_info(cl_device_id device)
+{
+  /* Nothing to query, keep the static description of the device */
+}
+
+static null_driver_t *
+null_driver_new(cl_context_prop props)
+{
+  null_driver_t *driver = CALLOC(null_driver_t);
+  if (driver == NULL)
+    return NULL;
+
+  driver->device_id = null_get_device_id();
+  if (IS_GEN9(driver->device_id))
+    driver->gen_ver = 9;
+  else if (IS_GEN8(driver->device_id))
+    driver->gen_ver = 8;
+  else if (IS_GEN75(driver->device_id))
+    driver->gen_ver = 75;
+  else
+    driver->gen_ver = 7;
+  return driver;
+}
+
+static void
+null_driver_delete(null_driver_t *driver)
+{
+  cl_free(driver);
+}
+
+static cl_buffer_mgr
+null_driver_get_bufmgr(null_driver_t *driver)
+{
+  return (cl_buffer_mgr)driver;
+}
+
+static uint32_t
+null_driver_get_ver(null_driver_t *driver)
+{
+  return driver->gen_ver;
+}
+
+static void
+null_driver_enlarge_stack_size(null_driver_t *driver, int32_t *stack_size)
+{
+}
+
+static void
+null_driver_set_atomic_flag(null_driver_t *driver, int atomic_flag)
+{
+}
+
+/**************************************************************************
+ * Buffer
+ **************************************************************************/
+static null_bo_t *
+null_buffer_alloc(cl_buffer_mgr bufmgr, const char *name, size_t size, size_t alignment)
+{
+  null_bo_t *bo = CALLOC(null_bo_t);
+  if (bo == NULL)
+    return NULL;
+
+  bo->virtual = cl_aligned_malloc(ALIGN(MAX(size, 1), 4096), MAX(alignment, 4096));
+  if (bo->virtual == NULL) {
+    cl_free(bo);
+    return NULL;
+  }
+  bo->size = size;
+  bo->ref_n = 1;
+  return bo;
+}
+
+static null_bo_t *
+null_buffer_alloc_userptr(cl_buffer_mgr bufmgr, const char *name, void *ptr, size_t size, unsigned long flags)
+{
+  null_bo_t *bo = CALLOC(null_bo_t);
+  if (bo == NULL)
+    return NULL;
+
+  bo->virtual = ptr;
+  bo->size = size;
+  bo->userptr = 1;
+  bo->ref_n = 1;
+  return bo;
+}
+
+static void
+null_buffer_reference(null_bo_t *bo)
+{
+  atomic_inc(&bo->ref_n);
+}
+
+static int
+null_buffer_unreference(null_bo_t *bo)
+{
+  if (bo == NULL || atomic_dec(&bo->ref_n) > 1)
+    return 0;
+  if (!bo->userptr)
+    cl_free(bo->virtual);
+  cl_free(bo);
+  return 0;
+}
+
+static int null_buffer_nop(null_bo_t *bo) { return 0; }
+static int null_buffer_map(null_bo_t *bo, uint32_t write_enable) { return 0; }
+static void *null_buffer_get_virtual(null_bo_t *bo) { return bo->virtual; }
+static size_t null_buffer_get_size(null_bo_t *bo) { return bo->size; }
+static int null_buffer_pin(null_bo_t *bo, uint32_t alignment) { return 0; }
+static int null_buffer_set_softpin_offset(null_bo_t *bo, uint64_t offset) { return 0; }
+static int null_buffer_set_full_range(null_bo_t *bo, uint32_t full_range) { return 0; }
+static int null_buffer_set_tiling(null_bo_t *bo, int tiling, size_t stride) { return 0; }
+static cl_buffer_swizzle_t null_buffer_get_swizzle(null_bo_t *bo) { return CL_SWIZZLE_NONE; }
+
+static int
+null_buffer_subdata(null_bo_t *bo, unsigned long offset, unsigned long size, const void *data)
+{
+  memcpy((char *)bo->virtual + offset, data, size);
+  return 0;
+}
+
+static int
+null_buffer_get_subdata(null_bo_t *bo, unsigned long offset, unsigned long size, void *data)
+{
+  memcpy(data, (char *)bo->virtual + offset, size);
+  return 0;
+}
+
+static uint32_t
+null_buffer_get_tiling_align(cl_context ctx, uint32_t tiling_mode, uint32_t dim)
+{
+  const uint32_t gen_ver = ((null_driver_t *)ctx->drv)->gen_ver;
+  const uint32_t tile_h = tiling_mode == CL_TILE_X ? 8 : 32;
+
+  assert(tiling_mode == CL_TILE_X || tiling_mode == CL_TILE_Y);
+  if (dim == 0)
+    return tiling_mode == CL_TILE_X ? 512 : 128;
+  else if (dim == 1)
+    return tile_h;
+  /* Same slice pitch alignment as the hardware driver */
+  return gen_ver == 9 ? tile_h : (gen_ver == 8 ? 4 : 2);
+}
+
+static int
+null_buffer_get_fd(null_bo_t *bo, int *fd)
+{
+  return -1;
+}
+
+static cl_buffer
+null_buffer_from_fd(cl_context ctx, int fd, int size)
+{
+  return NULL;
+}
+
+static cl_buffer
+null_image_from_fd(cl_context ctx, int fd, int size, struct _cl_mem_image *image)
+{
+  return NULL;
+}
+
+static cl_buffer
+null_buffer_from_libva(cl_context ctx, unsigned int bo_name, size_t *sz)
+{
+  return NULL;
+}
+
+static cl_buffer
+null_image_from_libva(cl_context ctx, unsigned int bo_name, struct _cl_mem_image *image)
+{
+  return NULL;
+}
+
+/**************************************************************************
+ * GPGPU
+ **************************************************************************/
+static null_gpgpu_t *
+null_gpgpu_new(null_driver_t *drv)
+{
+  null_gpgpu_t *gpgpu = CALLOC(null_gpgpu_t);
+  if (gpgpu)
+    gpgpu->drv = drv;
+  return gpgpu;
+}
+
+static void
+null_gpgpu_delete(null_gpgpu_t *gpgpu)
+{
+  if (gpgpu == NULL)
+    return;
+  null_buffer_unreference(gpgpu->constant_bo);
+  null_buffer_unreference(gpgpu->printf_bo);
+  null_buffer_unreference(gpgpu->profiling_bo);
+  cl_free(gpgpu);
+}
+
+static cl_buffer
+null_gpgpu_alloc_constant_buffer(null_gpgpu_t *gpgpu, uint32_t size, uint8_t bti)
+{
+  null_buffer_unreference(gpgpu->constant_bo);
+  gpgpu->constant_bo = null_buffer_alloc(NULL, "CONSTANT_BUFFER", size, 64);
+  return (cl_buffer)gpgpu->constant_bo;
+}
+
+static int
+null_gpgpu_set_printf_buffer(null_gpgpu_t *gpgpu, uint32_t size, uint32_t mask, uint8_t bti)
+{
+  null_buffer_unreference(gpgpu->printf_bo);
+  gpgpu->printf_bo = null_buffer_alloc(NULL, "Printf buffer", size, 4096);
+  if (gpgpu->printf_bo == NULL)
+    return -1;
+  memset(gpgpu->printf_bo->virtual, 0, size);
+  ((uint32_t *)gpgpu->printf_bo->virtual)[1] = mask; // first dword is the length.
+  return 0;
+}
+
+static null_bo_t *
+null_gpgpu_ref_printf_buffer(null_gpgpu_t *gpgpu)
+{
+  if (gpgpu->printf_bo)
+    null_buffer_reference(gpgpu->printf_bo);
+  return gpgpu->printf_bo;
+}
+
+static void *
+null_gpgpu_map_printf_buffer(null_gpgpu_t *gpgpu)
+{
+  return gpgpu->printf_bo->virtual;
+}
+
+static unsigned long
+null_gpgpu_release_printf_buffer(null_gpgpu_t *gpgpu)
+{
+  null_buffer_unreference(gpgpu->printf_bo);
+  gpgpu->printf_bo = NULL;
+  return 0;
+}
+
+static int
+null_gpgpu_set_profiling_buffer(null_gpgpu_t *gpgpu, uint32_t size, uint32_t offset, uint8_t bti)
+{
+  null_buffer_unreference(gpgpu->profiling_bo);
+  gpgpu->profiling_bo = null_buffer_alloc(NULL, "Profiling buffer", size, 64);
+  if (gpgpu->profiling_bo == NULL)
+    return -1;
+  memset(gpgpu->profiling_bo->virtual, 0, size);
+  return 0;
+}
+
+static void *
+null_gpgpu_map_profiling_buffer(null_gpgpu_t *gpgpu)
+{
+  return gpgpu->profiling_bo->virtual;
+}
+
+static int null_gpgpu_set_printf_info(null_gpgpu_t *gpgpu, void *info) { gpgpu->printf_info = info; return 0; }
+static void *null_gpgpu_get_printf_info(null_gpgpu_t *gpgpu) { return gpgpu->printf_info; }
+static int null_gpgpu_set_profiling_info(null_gpgpu_t *gpgpu, void *info) { gpgpu->profiling_info = info; return 0; }
+static void *null_gpgpu_get_profiling_info(null_gpgpu_t *gpgpu) { return gpgpu->profiling_info; }
+static void null_gpgpu_set_kernel(null_gpgpu_t *gpgpu, void *kernel) { gpgpu->kernel = kernel; }
+static void *null_gpgpu_get_kernel(null_gpgpu_t *gpgpu) { return gpgpu->kernel; }
+
+static void
+null_gpgpu_walker(null_gpgpu_t *gpgpu, uint32_t simd_sz, uint32_t thread_n,
+                  const size_t global_wk_off[3], const size_t global_dim_off[3],
+                  const size_t global_wk_sz[3], const size_t local_wk_sz[3])
+{
+  gpgpu->exec_ts[0] = gpgpu->exec_ts[1] = null_get_timestamp();
+}
+
+static int null_gpgpu_ok(null_gpgpu_t *gpgpu) { return 0; }
+static void null_gpgpu_nop(null_gpgpu_t *gpgpu) { }
+static void null_gpgpu_nop_ptr(void *ptr) { }
+static int null_gpgpu_state_init(null_gpgpu_t *gpgpu, uint32_t max_threads, uint32_t size_cs_entry, int profiling) { return 0; }
+static int null_gpgpu_set_scratch(null_gpgpu_t *gpgpu, uint32_t per_thread_size) { return 0; }
+static int null_gpgpu_upload_curbes(null_gpgpu_t *gpgpu, const void *data, uint32_t size) { return 0; }
+static int null_gpgpu_batch_reset(null_gpgpu_t *gpgpu, size_t sz) { return 0; }
+static void null_gpgpu_batch_end(null_gpgpu_t *gpgpu, int32_t flush_mode) { }
+static uint32_t null_gpgpu_get_cache_ctrl(void) { return 0; }
+static void *null_gpgpu_ref_batch_buf(null_gpgpu_t *gpgpu) { return gpgpu; }
+
+static void
+null_gpgpu_bind_buf(null_gpgpu_t *gpgpu, cl_buffer buf, uint32_t offset,
+                    uint32_t internal_offset, size_t size, uint8_t bti)
+{
+}
+
+static void
+null_gpgpu_bind_image(null_gpgpu_t *gpgpu, uint32_t id, cl_buffer obj_bo, uint32_t obj_bo_offset,
+                      uint32_t format, uint32_t bpp, uint32_t type, int32_t w, int32_t h, int32_t depth,
+                      int pitch, int32_t slice_pitch, cl_gpgpu_tiling tiling)
+{
+}
+
+static void null_gpgpu_bind_sampler(null_gpgpu_t *gpgpu, uint32_t *samplers, size_t sampler_sz) { }
+static void null_gpgpu_bind_vme_state(null_gpgpu_t *gpgpu, cl_accelerator_intel accel) { }
+static void null_gpgpu_set_stack(null_gpgpu_t *gpgpu, uint32_t offset, uint32_t size, uint32_t cchint) { }
+static void null_gpgpu_set_perf_counters(null_gpgpu_t *gpgpu, cl_buffer perf) { }
+static void null_gpgpu_states_setup(null_gpgpu_t *gpgpu, cl_gpgpu_kernel *kernel) { }
+static void null_gpgpu_upload_samplers(null_gpgpu_t *gpgpu, const void *data, uint32_t n) { }
+static void null_gpgpu_set_sampler(null_gpgpu_t *gpgpu, uint32_t index, uint32_t non_normalized) { }
+
+/* Everything is complete as soon as it is flushed */
+static null_event_t *
+null_gpgpu_event_new(null_gpgpu_t *gpgpu)
+{
+  null_event_t *event = CALLOC(null_event_t);
+  if (event)
+    event->status = command_complete;
+  return event;
+}
+
+static int null_gpgpu_event_update_status(null_event_t *event, int wait) { return event->status; }
+static void null_gpgpu_event_nop(null_event_t *event) { }
+static void null_gpgpu_event_delete(null_event_t *event) { cl_free(event); }
+
+static void
+null_gpgpu_event_get_exec_timestamp(null_gpgpu_t *gpgpu, int index, uint64_t *ret_ts)
+{
+  assert(index == 0 || index == 1);
+  *ret_ts = gpgpu->exec_ts[index];
+}
+
+static void
+null_gpgpu_event_get_gpu_cur_timestamp(null_driver_t *driver, uint64_t *ret_ts)
+{
+  *ret_ts = null_get_timestamp();
+}
+
+LOCAL void
+null_setup_callbacks(void)
+{
+  cl_driver_new = (cl_driver_new_cb *) null_driver_new;
+  cl_driver_delete = (cl_driver_delete_cb *) null_driver_delete;
+  cl_driver_get_ver = (cl_driver_get_ver_cb *) null_driver_get_ver;
+  cl_driver_enlarge_stack_size = (cl_driver_enlarge_stack_size_cb *) null_driver_enlarge_stack_size;
+  cl_driver_set_atomic_flag = (cl_driver_set_atomic_flag_cb *) null_driver_set_atomic_flag;
+  cl_driver_get_bufmgr = (cl_driver_get_bufmgr_cb *) null_driver_get_bufmgr;
+  cl_driver_get_device_id = (cl_driver_get_device_id_cb *) null_get_device_id;
+  cl_driver_update_device_info = (cl_driver_update_device_info_cb *) null_update_device_info;
+
+  cl_buffer_alloc = (cl_buffer_alloc_cb *) null_buffer_alloc;
+  cl_buffer_alloc_userptr = (cl_buffer_alloc_userptr_cb *) null_buffer_alloc_userptr;
+  cl_buffer_set_softpin_offset = (cl_buffer_set_softpin_offset_cb *) null_buffer_set_softpin_offset;
+  cl_buffer_set_bo_use_full_range = (cl_buffer_set_bo_use_full_range_cb *) null_buffer_set_full_range;
+  cl_buffer_disable_reuse = (cl_buffer_disable_reuse_cb *) null_buffer_nop;
+  cl_buffer_set_tiling = (cl_buffer_set_tiling_cb *) null_buffer_set_tiling;
+  cl_buffer_get_buffer_from_libva = (cl_buffer_get_buffer_from_libva_cb *) null_buffer_from_libva;
+  cl_buffer_get_image_from_libva = (cl_buffer_get_image_from_libva_cb *) null_image_from_libva;
+  cl_buffer_reference = (cl_buffer_reference_cb *) null_buffer_reference;
+  cl_buffer_unreference = (cl_buffer_unreference_cb *) null_buffer_unreference;
+  cl_buffer_map = (cl_buffer_map_cb *) null_buffer_map;
+  cl_buffer_unmap = (cl_buffer_unmap_cb *) null_buffer_nop;
+  cl_buffer_map_gtt = (cl_buffer_map_gtt_cb *) null_buffer_nop;
+  cl_buffer_unmap_gtt = (cl_buffer_unmap_gtt_cb *) null_buffer_nop;
+  cl_buffer_map_gtt_unsync = (cl_buffer_map_gtt_unsync_cb *) null_buffer_nop;
+  cl_buffer_get_virtual = (cl_buffer_get_virtual_cb *) null_buffer_get_virtual;
+  cl_buffer_get_size = (cl_buffer_get_size_cb *) null_buffer_get_size;
+  cl_buffer_pin = (cl_buffer_pin_cb *) null_buffer_pin;
+  cl_buffer_unpin = (cl_buffer_unpin_cb *) null_buffer_nop;
+  cl_buffer_subdata = (cl_buffer_subdata_cb *) null_buffer_subdata;
+  cl_buffer_get_subdata = (cl_buffer_get_subdata_cb *) null_buffer_get_subdata;
+  cl_buffer_wait_rendering = (cl_buffer_wait_rendering_cb *) null_buffer_nop;
+  cl_buffer_is_busy = (cl_buffer_is_busy_cb *) null_buffer_nop;
+  cl_buffer_get_fd = (cl_buffer_get_fd_cb *) null_buffer_get_fd;
+  cl_buffer_get_tiling_align = (cl_buffer_get_tiling_align_cb *) null_buffer_get_tiling_align;
+  cl_buffer_get_swizzle = (cl_buffer_get_swizzle_cb *) null_buffer_get_swizzle;
+  cl_buffer_get_buffer_from_fd = (cl_buffer_get_buffer_from_fd_cb *) null_buffer_from_fd;
+  cl_buffer_get_image_from_fd = (cl_buffer_get_image_from_fd_cb *) null_image_from_fd;
+
+  cl_gpgpu_new = (cl_gpgpu_new_cb *) null_gpgpu_new;
+  cl_gpgpu_delete = (cl_gpgpu_delete_cb *) null_gpgpu_delete;
+  cl_gpgpu_sync = (cl_gpgpu_sync_cb *) null_gpgpu_nop_ptr;
+  cl_gpgpu_bind_buf = (cl_gpgpu_bind_buf_cb *) null_gpgpu_bind_buf;
+  cl_gpgpu_set_kernel = (cl_gpgpu_set_kernel_cb *) null_gpgpu_set_kernel;
+  cl_gpgpu_get_kernel = (cl_gpgpu_get_kernel_cb *) null_gpgpu_get_kernel;
+  cl_gpgpu_bind_sampler = (cl_gpgpu_bind_sampler_cb *) null_gpgpu_bind_sampler;
+  cl_gpgpu_bind_vme_state = (cl_gpgpu_bind_vme_state_cb *) null_gpgpu_bind_vme_state;
+  cl_gpgpu_get_cache_ctrl = (cl_gpgpu_get_cache_ctrl_cb *) null_gpgpu_get_cache_ctrl;
+  cl_gpgpu_bind_image = (cl_gpgpu_bind_image_cb *) null_gpgpu_bind_image;
+  cl_gpgpu_bind_image_for_vme = (cl_gpgpu_bind_image_for_vme_cb *) null_gpgpu_bind_image;
+  cl_gpgpu_set_stack = (cl_gpgpu_set_stack_cb *) null_gpgpu_set_stack;
+  cl_gpgpu_set_scratch = (cl_gpgpu_set_scratch_cb *) null_gpgpu_set_scratch;
+  cl_gpgpu_state_init = (cl_gpgpu_state_init_cb *) null_gpgpu_state_init;
+  cl_gpgpu_set_perf_counters = (cl_gpgpu_set_perf_counters_cb *) null_gpgpu_set_perf_counters;
+  cl_gpgpu_upload_curbes = (cl_gpgpu_upload_curbes_cb *) null_gpgpu_upload_curbes;
+  cl_gpgpu_alloc_constant_buffer = (cl_gpgpu_alloc_constant_buffer_cb *) null_gpgpu_alloc_constant_buffer;
+  cl_gpgpu_states_setup = (cl_gpgpu_states_setup_cb *) null_gpgpu_states_setup;
+  cl_gpgpu_upload_samplers = (cl_gpgpu_upload_samplers_cb *) null_gpgpu_upload_samplers;
+  cl_gpgpu_set_sampler = (cl_gpgpu_set_sampler_cb *) null_gpgpu_set_sampler;
+  cl_gpgpu_batch_reset = (cl_gpgpu_batch_reset_cb *) null_gpgpu_batch_reset;
+  cl_gpgpu_batch_start = (cl_gpgpu_batch_start_cb *) null_gpgpu_nop;
+  cl_gpgpu_batch_end = (cl_gpgpu_batch_end_cb *) null_gpgpu_batch_end;
+  cl_gpgpu_flush = (cl_gpgpu_flush_cb *) null_gpgpu_ok;
+  cl_gpgpu_walker = (cl_gpgpu_walker_cb *) null_gpgpu_walker;
+  cl_gpgpu_event_new = (cl_gpgpu_event_new_cb *) null_gpgpu_event_new;
+  cl_gpgpu_event_update_status = (cl_gpgpu_event_update_status_cb *) null_gpgpu_event_update_status;
+  cl_gpgpu_event_flush = (cl_gpgpu_event_flush_cb *) null_gpgpu_event_nop;
+  cl_gpgpu_event_cancel = (cl_gpgpu_event_cancel_cb *) null_gpgpu_event_nop;
+  cl_gpgpu_event_delete = (cl_gpgpu_event_delete_cb *) null_gpgpu_event_delete;
+  cl_gpgpu_event_get_exec_timestamp = (cl_gpgpu_event_get_exec_timestamp_cb *) null_gpgpu_event_get_exec_timestamp;
+  cl_gpgpu_event_get_gpu_cur_timestamp = (cl_gpgpu_event_get_gpu_cur_timestamp_cb *) null_gpgpu_event_get_gpu_cur_timestamp;
+  cl_gpgpu_ref_batch_buf = (cl_gpgpu_ref_batch_buf_cb *) null_gpgpu_ref_batch_buf;
+  cl_gpgpu_unref_batch_buf = (cl_gpgpu_unref_batch_buf_cb *) null_gpgpu_nop_ptr;
+  cl_gpgpu_set_profiling_buffer = (cl_gpgpu_set_profiling_buffer_cb *) null_gpgpu_set_profiling_buffer;
+  cl_gpgpu_set_profiling_info = (cl_gpgpu_set_profiling_info_cb *) null_gpgpu_set_profiling_info;
+  cl_gpgpu_get_profiling_info = (cl_gpgpu_get_profiling_info_cb *) null_gpgpu_get_profiling_info;
+  cl_gpgpu_map_profiling_buffer = (cl_gpgpu_map_profiling_buffer_cb *) null_gpgpu_map_profiling_buffer;
+  cl_gpgpu_unmap_profiling_buffer = (cl_gpgpu_unmap_profiling_buffer_cb *) null_gpgpu_nop;
+  cl_gpgpu_set_printf_buffer = (cl_gpgpu_set_printf_buffer_cb *) null_gpgpu_set_printf_buffer;
+  cl_gpgpu_ref_printf_buffer = (cl_gpgpu_ref_printf_buffer_cb *) null_gpgpu_ref_printf_buffer;
+  cl_gpgpu_map_printf_buffer = (cl_gpgpu_map_printf_buffer_cb *) null_gpgpu_map_printf_buffer;
+  cl_gpgpu_unmap_printf_buffer = (cl_gpgpu_unmap_printf_buffer_cb *) null_gpgpu_nop;
+  cl_gpgpu_release_printf_buffer = (cl_gpgpu_release_printf_buffer_cb *) null_gpgpu_release_printf_buffer;
+  cl_gpgpu_set_printf_info = (cl_gpgpu_set_printf_info_cb *) null_gpgpu_set_printf_info;
+  cl_gpgpu_get_printf_info = (cl_gpgpu_get_printf_info_cb *) null_gpgpu_get_printf_info;
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright © 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _NULL_DRIVER_H_
+#define _NULL_DRIVER_H_
+
+/* The null driver implements the cl_driver call backs without any GPU:
+ * buffers are plain host memory and the walker / flushes complete at once.
+ * All the runtime state building still runs, which makes it possible to
+ * benchmark and profile the host side of the API on any machine.
+ *
+ * OCL_NULL_DRIVER=1 selects it, OCL_NULL_DEVICE_ID=<pci id> chooses the
+ * device to report (and to compile for), Skylake GT2 by default. */
+
+/* Return 1 when the runtime must run on the null driver */
+extern int null_driver_enabled(void);
+
+/* Install the null driver call backs */
+extern void null_setup_callbacks(void);
+
+#endif /* _NULL_DRIVER_H_ */
@@ -2,332 +2,258 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
-#include <sys/time.h>
 #include <pthread.h>
 
-#define MAX_KERNEL_NAME_LENGTH 100
-#define MAX_KERNEL_EXECUTION_COUNT 100000
-#define MAX_KERNEL_BUILD_OPT 1000
-typedef struct kernel_storage_node
+#include "CL/cl_intel.h"
+#include "cl_event.h"
+#include "cl_kernel.h"
+#include "cl_program.h"
+#include "cl_driver.h"
+#include "cl_gbe_loader.h"
+#include "cl_utils.h"
+
+/* Distinct kernel / build options pairs, a power of 2 */
+#define CL_KERNEL_PERF_SLOT_N 1024
+/* Last launch times kept per kernel for the percentiles */
+#define CL_KERNEL_PERF_SAMPLE_N 4096
+/* The exec timestamps are 32 bits counters of 80ns */
+#define CL_KERNEL_PERF_TS_WRAP (0x100000000ull * 80)
+
+enum {
+  CL_KERNEL_PERF_SLOT_FREE = 0,
+  CL_KERNEL_PERF_SLOT_BUSY,   /* Being filled by the thread which claimed it */
+  CL_KERNEL_PERF_SLOT_READY
+};
+
+typedef struct cl_kernel_perf_slot {
+  uint32_t state;
+  uint32_t hash;
+  char *name;
+  char *build_opts;
+  uint64_t *samples;          /* Ring of the GPU times, in ns */
+  uint64_t launch_n;
+  uint64_t total_ns;
+  uint64_t min_ns;
+  uint64_t max_ns;
+  cl_kernel_perf_info info;   /* Static data of the last launch */
+} cl_kernel_perf_slot;
+
+static cl_kernel_perf_slot cl_kernel_perf_slots[CL_KERNEL_PERF_SLOT_N];
+static int cl_kernel_perf_level = 0;
+static pthread_once_t cl_kernel_perf_once = PTHREAD_ONCE_INIT;
+
+static void cl_kernel_perf_output(void);
+
+static void
+cl_kernel_perf_init(void)
 {
-  char kernel_name[MAX_KERNEL_NAME_LENGTH];
-  float kernel_times[MAX_KERNEL_EXECUTION_COUNT];
-  char build_option[MAX_KERNEL_BUILD_OPT];
-  int current_count;
-  float kernel_sum_time;
-  struct kernel_storage_node *next;
-} kernel_storage_node;
-
-typedef struct context_storage_node
-{
-  uintptr_t context_id;
-  kernel_storage_node *kernels_storage;
-  char max_time_kernel_name[MAX_KERNEL_NAME_LENGTH];
-  float kernel_max_time;
-  int kernel_count;
-  struct context_storage_node *next;
-} context_storage_node;
-
-typedef struct storage
-{
-  context_storage_node * context_storage;
-} storage;
-
-
-
-static storage record;
-static int atexit_registered = 0;
+  const char *env = getenv("OCL_OUTPUT_KERNEL_PERF");
 
+  if (env == NULL || *env == '\0' || !strncmp(env, "0", 1))
+    cl_kernel_perf_level = 0;
+  else if (!strncmp(env, "1", 1))
+    cl_kernel_perf_level = 1;
+  else
+    cl_kernel_perf_level = 2;
 
-static context_storage_node * prev_context_pointer = NULL;
-static kernel_storage_node * prev_kernel_pointer = NULL;
+  if (cl_kernel_perf_level)
+    atexit(cl_kernel_perf_output);
+}
 
-static context_storage_node * find_context(cl_context context)
+LOCAL int
+cl_kernel_perf_enabled(void)
 {
-  if(NULL != prev_context_pointer )
-  {
-    if(prev_context_pointer->context_id == (uintptr_t)context)
-      return prev_context_pointer;
-  }
-
-  if(NULL == record.context_storage)
-  {
-    record.context_storage = (context_storage_node *) malloc(sizeof(context_storage_node));
-    if (record.context_storage == NULL)
-      return NULL;
-    record.context_storage->context_id = (uintptr_t)context;
-    record.context_storage->kernels_storage = NULL;
-    record.context_storage->kernel_max_time = 0.0f;
-    record.context_storage->next = NULL;
-    record.context_storage->kernel_count = 0;
-    return record.context_storage;
-  }
-
-  context_storage_node *pre = record.context_storage;
-  context_storage_node *cur = record.context_storage;
-  while(NULL !=cur && (uintptr_t)context != cur->context_id )
-  {
-    pre = cur;
-    cur = cur->next;
-  }
-  if(NULL != cur)
-    return cur;
-
-  pre->next = (context_storage_node *)malloc(sizeof(context_storage_node));
-  pre = pre->next;
-  pre->context_id = (uintptr_t)context;
-  pre->kernels_storage = NULL;
-  pre->kernel_max_time = 0.0f;
-  pre->next = NULL;
-  pre->kernel_count = 0;
-  return pre;
+  pthread_once(&cl_kernel_perf_once, cl_kernel_perf_init);
+  return cl_kernel_perf_level;
 }
 
-static kernel_storage_node * find_kernel(context_storage_node *p_context, const char *kernel_name, const char *build_opt)
+static uint32_t
+cl_kernel_perf_hash(const char *str, uint32_t hash)
 {
-  if(NULL != prev_kernel_pointer && NULL != prev_context_pointer &&
-     p_context == prev_context_pointer &&
-     !strncmp(kernel_name, prev_kernel_pointer->kernel_name, MAX_KERNEL_NAME_LENGTH) &&
-     !strncmp(build_opt, prev_kernel_pointer->build_option, MAX_KERNEL_BUILD_OPT))
-    return prev_kernel_pointer;
-
-  if(NULL == p_context)
-    return NULL;
-
-  if(NULL == p_context->kernels_storage)
-  {
-    p_context->kernels_storage = (kernel_storage_node *)malloc(sizeof(kernel_storage_node));
-    if (p_context->kernels_storage == NULL)
-      return NULL;
-    p_context->kernel_count++;
-    strncpy(p_context->kernels_storage->kernel_name,kernel_name, MAX_KERNEL_NAME_LENGTH);
-    p_context->kernels_storage->kernel_name[MAX_KERNEL_NAME_LENGTH - 1] = '\0';
-    strncpy(p_context->kernels_storage->build_option, build_opt, MAX_KERNEL_BUILD_OPT);
-    p_context->kernels_storage->build_option[MAX_KERNEL_BUILD_OPT - 1] = '\0';
-    p_context->kernels_storage->current_count = 0;
-    p_context->kernels_storage->kernel_sum_time = 0.0f;
-    p_context->kernels_storage->next = NULL;
-    return p_context->kernels_storage;
-  }
-
-  kernel_storage_node *pre = p_context->kernels_storage;
-  kernel_storage_node *cur = p_context->kernels_storage;
-  while(NULL != cur &&
-        (strncmp(cur->kernel_name, kernel_name, MAX_KERNEL_NAME_LENGTH) ||
-         strncmp(cur->build_option, build_opt, MAX_KERNEL_BUILD_OPT)))
-  {
-    pre = cur;
-    cur = cur->next;
-  }
-  if(NULL != cur)
-    return cur;
-
-  p_context->kernel_count++;
-  pre->next = (kernel_storage_node *)malloc(sizeof(kernel_storage_node));
-  pre = pre->next;
-  pre->current_count = 0;
-  pre->kernel_sum_time = 0.0f;
-  pre->next = NULL;
-  strncpy(pre->kernel_name, kernel_name, MAX_KERNEL_NAME_LENGTH);
-  pre->kernel_name[MAX_KERNEL_NAME_LENGTH - 1] = '\0';
-  strncpy(pre->build_option, build_opt, MAX_KERNEL_BUILD_OPT);
-  pre->build_option[MAX_KERNEL_NAME_LENGTH - 1] = '\0';
-  return pre;
+  while (*str)
+    hash = (hash ^ (uint8_t)*str++) * 16777619u;
+  return hash;
 }
 
-static void free_storage()
+/* Find or insert the entry of a kernel. Entries are never removed, so a
+ * claimed entry only has to be published once its key is written */
+static cl_kernel_perf_slot *
+cl_kernel_perf_find(const char *name, const char *build_opts)
 {
-  context_storage_node *p_context = record.context_storage;
-  while(NULL != p_context)
-  {
-    context_storage_node *p_tmp_context = p_context->next;
-    kernel_storage_node *p_kernel = p_context->kernels_storage;
-    while(NULL != p_kernel)
-    {
-      kernel_storage_node *p_tmp_kernel = p_kernel->next;
-      free(p_kernel);
-      p_kernel = p_tmp_kernel;
+  const uint32_t hash = cl_kernel_perf_hash(build_opts, cl_kernel_perf_hash(name, 2166136261u));
+  uint32_t i;
+
+  for (i = 0; i < CL_KERNEL_PERF_SLOT_N; i++) {
+    cl_kernel_perf_slot *slot = &cl_kernel_perf_slots[(hash + i) & (CL_KERNEL_PERF_SLOT_N - 1)];
+    uint32_t state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+
+    if (state == CL_KERNEL_PERF_SLOT_FREE &&
+        __atomic_compare_exchange_n(&slot->state, &state, CL_KERNEL_PERF_SLOT_BUSY, 0,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      slot->hash = hash;
+      slot->name = strdup(name);
+      slot->build_opts = strdup(build_opts);
+      slot->samples = calloc(CL_KERNEL_PERF_SAMPLE_N, sizeof(uint64_t));
+      slot->min_ns = UINT64_MAX;
+      __atomic_store_n(&slot->state, CL_KERNEL_PERF_SLOT_READY, __ATOMIC_RELEASE);
+      return slot;
     }
-    free(p_context);
-    p_context = p_tmp_context;
+
+    /* Another thread is writing the key */
+    while (state == CL_KERNEL_PERF_SLOT_BUSY)
+      state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+
+    if (slot->hash == hash && slot->name && slot->build_opts &&
+        !strcmp(slot->name, name) && !strcmp(slot->build_opts, build_opts))
+      return slot;
   }
+  return NULL;
 }
 
-typedef struct time_element
+LOCAL void
+cl_kernel_perf_fill(cl_kernel_perf_info *info, cl_kernel k, uint32_t simd_width,
+                    uint32_t thread_n, uint32_t slm_size, uint32_t max_thread_n)
 {
-  char kernel_name[MAX_KERNEL_NAME_LENGTH];
-  float kernel_sum_time;
-  int kernel_execute_count;
-  double dev;
-  float kernel_times[MAX_KERNEL_EXECUTION_COUNT];
-  uint32_t time_index;
-} time_element;
-
-static int cmp(const void *a, const void *b)
-{
-  if(((time_element *)a)->kernel_sum_time < ((time_element *)b)->kernel_sum_time)
-    return 1;
-  else if(((time_element *)a)->kernel_sum_time > ((time_element *)b)->kernel_sum_time)
-    return -1;
-  else
-    return 0;
+  info->simd_width = simd_width;
+  info->grf_size = interp_kernel_get_grf_size(k->opaque);
+  info->spill_size = interp_kernel_get_scratch_size(k->opaque);
+  info->scratch_size = info->spill_size * max_thread_n;
+  info->thread_n = thread_n;
+  info->slm_size = slm_size;
+  info->slot = NULL;
+
+  if (cl_kernel_perf_enabled())
+    info->slot = cl_kernel_perf_find(cl_kernel_get_name(k),
+                                     k->program->build_opts ? k->program->build_opts : "");
 }
 
-static void print_time_info()
+LOCAL void
+cl_kernel_perf_record(cl_event event)
 {
-  context_storage_node *p_context = record.context_storage;
-  if(NULL == p_context)
-  {
-    printf("Nothing to output !\n");
-    return;
-  }
-
-  int tmp_context_id = 0;
-  while(NULL != p_context)
-  {
-    printf("[------------ CONTEXT %4d ------------]\n", tmp_context_id++);
-    printf("  ->>>> KERNELS TIME SUMMARY <<<<-\n");
-
-    kernel_storage_node *p_kernel = p_context->kernels_storage;
-    kernel_storage_node *p_tmp_kernel = p_kernel;
-    time_element *te = (time_element *)malloc(sizeof(time_element)*p_context->kernel_count);
-    if (te == NULL)
-      return;
-    memset(te, 0, sizeof(time_element)*p_context->kernel_count);
-    int i = -1, j = 0, k = 0;
-    while(NULL != p_tmp_kernel)
-    {
-      for(k=0; k<=i; k++)
-      {
-        if(!strncmp(te[k].kernel_name, p_tmp_kernel->kernel_name, MAX_KERNEL_NAME_LENGTH))
-          break;
-      }
-      if(k == i+1)
-      {
-        i++;
-        k = i;
-      }
-      te[k].kernel_execute_count += p_tmp_kernel->current_count;
-      strncpy(te[k].kernel_name, p_tmp_kernel->kernel_name, MAX_KERNEL_NAME_LENGTH);
-      te[k].kernel_name[MAX_KERNEL_NAME_LENGTH - 1] = '\0';
-      te[k].kernel_sum_time += p_tmp_kernel->kernel_sum_time;
-      for(j=0; j != p_tmp_kernel->current_count; ++j)
-        te[k].kernel_times[te[k].time_index++] = p_tmp_kernel->kernel_times[j];
-      p_tmp_kernel = p_tmp_kernel->next;
-    }
+  cl_kernel_perf_slot *slot = event->perf.slot;
+  uint64_t start = 0, end = 0, ns, n, cur;
 
-    for(k=0; k<=i; k++)
-    {
-      float average = te[k].kernel_sum_time / te[k].kernel_execute_count;
-      double sumsquare = 0.0;
-      for(j=0; j<te[k].time_index; ++j)
-        sumsquare += pow((te[k].kernel_times[j] - average), 2.0);
-      te[k].dev = sqrt(sumsquare / te[k].kernel_execute_count);
-    }
+  if (slot == NULL || event->exec_data.gpgpu == NULL)
+    return;
 
-    float sum_time = 0.0f;
-    qsort((void *)te, p_context->kernel_count, sizeof(time_element), cmp);
-    for(j=0; j<=i; ++j)
-      sum_time += te[j].kernel_sum_time;
-
-    for(j=0; j<=i; ++j)
-    {
-      printf("    [Kernel Name: %-30s Time(ms): (%4.1f%%) %9.2f  Count: %-7d  Ave(ms): %7.2f  Dev: %.1lf%%]\n",
-             te[j].kernel_name,
-             te[j].kernel_sum_time / sum_time * 100,
-             te[j].kernel_sum_time,
-             te[j].kernel_execute_count,
-             te[j].kernel_sum_time / te[j].kernel_execute_count,
-             te[j].dev / te[j].kernel_sum_time * te[j].kernel_execute_count * 100);
-    }
-    free(te);
-    printf("    Total : %.2f\n", sum_time);
-    if(2 != b_output_kernel_perf)
-    {
-      printf("[------------  CONTEXT ENDS------------]\n\n");
-      p_context = p_context->next;
-      continue;
-    }
-    p_tmp_kernel = p_kernel;
-    printf("\n  ->>>> KERNELS TIME DETAIL <<<<-\n");
-    while(NULL != p_kernel)
-    {
-      printf("    [Kernel Name : %30s   Time(ms): %.2f]\n", p_kernel->kernel_name, p_kernel->kernel_sum_time);
-      if(*p_kernel->build_option != '\0')
-      {
-        int count = 0;
-        printf("      ->Build Options : ");
-        while(p_kernel->build_option[count] != '\0' )
-        {
-          printf("%c", p_kernel->build_option[count++]);
-          if(count % 100 == 0)
-            printf("\n                         ");
-        }
-        printf("\n");
-      }
-      for(i=0; i!=p_kernel->current_count; ++i)
-        printf("      Execution Round%5d : %.2f (ms)\n", i+1, p_kernel->kernel_times[i]);
-      p_kernel = p_kernel->next;
-    }
-    printf("[------------  CONTEXT ENDS------------]\n\n");
-    p_context = p_context->next;
-  }
-  free_storage();
+  cl_gpgpu_event_get_exec_timestamp(event->exec_data.gpgpu, 0, &start);
+  cl_gpgpu_event_get_exec_timestamp(event->exec_data.gpgpu, 1, &end);
+  ns = end >= start ? end - start : end + CL_KERNEL_PERF_TS_WRAP - start;
+
+  n = __atomic_fetch_add(&slot->launch_n, 1, __ATOMIC_RELAXED);
+  if (slot->samples)
+    __atomic_store_n(&slot->samples[n % CL_KERNEL_PERF_SAMPLE_N], ns, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&slot->total_ns, ns, __ATOMIC_RELAXED);
+
+  cur = __atomic_load_n(&slot->min_ns, __ATOMIC_RELAXED);
+  while (ns < cur && !__atomic_compare_exchange_n(&slot->min_ns, &cur, ns, 1,
+                                                  __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  cur = __atomic_load_n(&slot->max_ns, __ATOMIC_RELAXED);
+  while (ns > cur && !__atomic_compare_exchange_n(&slot->max_ns, &cur, ns, 1,
+                                                  __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+  /* Only read at exit, the last launch wins */
+  __atomic_store_n(&slot->info.simd_width, event->perf.simd_width, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->info.grf_size, event->perf.grf_size, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->info.spill_size, event->perf.spill_size, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->info.scratch_size, event->perf.scratch_size, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->info.thread_n, event->perf.thread_n, __ATOMIC_RELAXED);
+  __atomic_store_n(&slot->info.slm_size, event->perf.slm_size, __ATOMIC_RELAXED);
 }
 
-
-static void insert(cl_context context, const char *kernel_name, const char *build_opt, float time)
+LOCAL cl_int
+cl_kernel_perf_get_info(const cl_kernel_perf_info *info, cl_profiling_info param_name,
+                        cl_ulong *value)
 {
-  if(!atexit_registered)
-  {
-    atexit_registered = 1;
-    atexit(print_time_info);
-  }
-  context_storage_node *p_context = find_context(context);
-  kernel_storage_node *p_kernel = find_kernel(p_context, kernel_name, build_opt);
-  if(!p_kernel)
-    return;
-
-  prev_context_pointer = p_context;
-  prev_kernel_pointer = p_kernel;
-  p_kernel->kernel_times[p_kernel->current_count++] = time;
-  p_kernel->kernel_sum_time += time;
-  if(p_kernel->kernel_sum_time > p_context->kernel_max_time)
-  {
-    p_context->kernel_max_time = p_kernel->kernel_sum_time;
-    strncpy(p_context->max_time_kernel_name, kernel_name, MAX_KERNEL_NAME_LENGTH);
-    p_context->max_time_kernel_name[MAX_KERNEL_NAME_LENGTH - 1] = '\0';
+  switch (param_name) {
+    case CL_PROFILING_KERNEL_SIMD_WIDTH_INTEL: *value = info->simd_width; break;
+    case CL_PROFILING_KERNEL_GRF_SIZE_INTEL: *value = info->grf_size; break;
+    case CL_PROFILING_KERNEL_SPILL_SIZE_INTEL: *value = info->spill_size; break;
+    case CL_PROFILING_KERNEL_SCRATCH_SIZE_INTEL: *value = info->scratch_size; break;
+    case CL_PROFILING_KERNEL_THREAD_NUM_INTEL: *value = info->thread_n; break;
+    case CL_PROFILING_KERNEL_SLM_SIZE_INTEL: *value = info->slm_size; break;
+    default:
+      return CL_INVALID_VALUE;
   }
+  return CL_SUCCESS;
 }
 
-
-static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
-int b_output_kernel_perf = 0;
-static struct timeval start, end;
-
-void initialize_env_var()
+static int
+cl_kernel_perf_cmp_ns(const void *a, const void *b)
 {
-  char *env = getenv("OCL_OUTPUT_KERNEL_PERF");
-  if(NULL == env || !strncmp(env,"0", 1))
-    b_output_kernel_perf = 0;
-  else if(!strncmp(env,"1", 1))
-    b_output_kernel_perf = 1;
-  else
-    b_output_kernel_perf = 2;
+  const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return x < y ? -1 : x > y;
 }
 
-void time_start(cl_context context, const char * kernel_name, cl_command_queue cq)
+static int
+cl_kernel_perf_cmp_slot(const void *a, const void *b)
 {
-  pthread_mutex_lock(&mutex);
-  gettimeofday(&start, NULL);
+  const uint64_t x = (*(cl_kernel_perf_slot *const *)a)->total_ns;
+  const uint64_t y = (*(cl_kernel_perf_slot *const *)b)->total_ns;
+  return x > y ? -1 : x < y;
 }
 
-void time_end(cl_context context, const char * kernel_name, const char * build_opt, cl_command_queue cq)
+static void
+cl_kernel_perf_output(void)
 {
-  clFinish(cq);
-  gettimeofday(&end, NULL);
-  float t = (end.tv_sec - start.tv_sec)*1000 + (end.tv_usec - start.tv_usec)/1000.0f;
-  insert(context, kernel_name, build_opt, t);
-  pthread_mutex_unlock(&mutex);
+  cl_kernel_perf_slot *slots[CL_KERNEL_PERF_SLOT_N];
+  uint64_t *sorted = NULL, total_ns = 0, launch_n = 0;
+  uint32_t slot_n = 0, i, j;
+
+  for (i = 0; i < CL_KERNEL_PERF_SLOT_N; i++) {
+    cl_kernel_perf_slot *slot = &cl_kernel_perf_slots[i];
+    if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != CL_KERNEL_PERF_SLOT_READY ||
+        __atomic_load_n(&slot->launch_n, __ATOMIC_RELAXED) == 0)
+      continue;
+    slots[slot_n++] = slot;
+    total_ns += slot->total_ns;
+    launch_n += slot->launch_n;
+  }
+  if (slot_n == 0) {
+    printf("Nothing to output !\n");
+    return;
+  }
+  qsort(slots, slot_n, sizeof(slots[0]), cl_kernel_perf_cmp_slot);
+  sorted = malloc(CL_KERNEL_PERF_SAMPLE_N * sizeof(uint64_t));
+
+  printf("[------------ KERNELS GPU TIME: %u kernels, %llu launches, %.2f ms ------------]\n",
+         slot_n, (unsigned long long)launch_n, total_ns / 1e6);
+  printf("  %10s %6s %8s %9s %9s %9s %9s %9s %4s %6s %8s %6s %7s  %s\n",
+         "Time(ms)", "%", "Count", "Ave(us)", "p50(us)", "p90(us)", "p99(us)", "Max(us)",
+         "SIMD", "GRF", "Spill", "SLM", "Threads", "Kernel");
+  for (i = 0; i < slot_n; i++) {
+    const cl_kernel_perf_slot *slot = slots[i];
+    const uint32_t sample_n = slot->launch_n < CL_KERNEL_PERF_SAMPLE_N ? slot->launch_n : CL_KERNEL_PERF_SAMPLE_N;
+    double p50 = 0, p90 = 0, p99 = 0;
+
+    if (sorted && slot->samples) {
+      memcpy(sorted, slot->samples, sample_n * sizeof(uint64_t));
+      qsort(sorted, sample_n, sizeof(uint64_t), cl_kernel_perf_cmp_ns);
+      p50 = sorted[(sample_n - 1) * 50 / 100] / 1e3;
+      p90 = sorted[(sample_n - 1) * 90 / 100] / 1e3;
+      p99 = sorted[(sample_n - 1) * 99 / 100] / 1e3;
+    }
+
+    printf("  %10.2f %5.1f%% %8llu %9.1f %9.1f %9.1f %9.1f %9.1f %4u %6u %8u %6u %7u  %s\n",
+           slot->total_ns / 1e6, total_ns ? slot->total_ns * 100.0 / total_ns : 0.0,
+           (unsigned long long)slot->launch_n, slot->total_ns / 1e3 / slot->launch_n,
+           p50, p90, p99, slot->max_ns / 1e3,
+           slot->info.simd_width, slot->info.grf_size, slot->info.spill_size,
+           slot->info.slm_size, slot->info.thread_n, slot->name ? slot->name : "");
+    if (cl_kernel_perf_level < 2)
+      continue;
+    if (slot->build_opts && *slot->build_opts != '\0')
+      printf("      ->Build Options : %s\n", slot->build_opts);
+    printf("      ->Min(us): %.1f  Scratch: %u\n", slot->min_ns / 1e3, slot->info.scratch_size);
+    if (sorted && slot->samples) {
+      /* Oldest first */
+      for (j = 0; j < sample_n; j++) {
+        const uint64_t n = slot->launch_n - sample_n + j;
+        printf("      Execution Round%7llu : %.1f (us)\n", (unsigned long long)n + 1,
+               slot->samples[n % CL_KERNEL_PERF_SAMPLE_N] / 1e3);
+      }
+    }
+  }
+  printf("[------------ KERNELS GPU TIME ENDS ------------]\n\n");
+  free(sorted);
 }
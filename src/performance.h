@@ -1,12 +1,42 @@
 #ifndef __PERFORMANCE_H__
 #define __PERFORMANCE_H__
+#include <stdint.h>
 #include "CL/cl.h"
 
+/* Per launch kernel performance data.
+ *
+ * Every NDRange event carries the static data of the kernel it runs, which
+ * clGetEventProfilingInfo returns through the CL_PROFILING_KERNEL_*_INTEL
+ * queries. With OCL_OUTPUT_KERNEL_PERF set, the GPU time of each launch is
+ * also accumulated per kernel name and build options, and a summary with the
+ * percentiles is output at exit (2 adds the build options and the launch
+ * times). The accumulation is lock-free.
+ */
 
-extern int b_output_kernel_perf;
-void time_start(cl_context context, const char * kernel_name, cl_command_queue cq);
-void time_end(cl_context context, const char * kernel_name, const char * build_opt, cl_command_queue cq);
-void initialize_env_var();
+struct cl_kernel_perf_slot;
 
+typedef struct cl_kernel_perf_info {
+  struct cl_kernel_perf_slot *slot; /* Summary entry, NULL when not accumulated */
+  uint32_t simd_width;
+  uint32_t grf_size;        /* Peak register file bytes */
+  uint32_t spill_size;      /* Scratch bytes per thread used by spills */
+  uint32_t scratch_size;    /* Scratch bytes of the launch */
+  uint32_t thread_n;        /* HW threads of the launch */
+  uint32_t slm_size;
+} cl_kernel_perf_info;
+
+/* Non zero when the GPU times are accumulated */
+extern int cl_kernel_perf_enabled(void);
+
+/* Fill the static data of a launch */
+extern void cl_kernel_perf_fill(cl_kernel_perf_info *info, cl_kernel k, uint32_t simd_width,
+                                uint32_t thread_n, uint32_t slm_size, uint32_t max_thread_n);
+
+/* Accumulate the GPU time of a completed NDRange event */
+extern void cl_kernel_perf_record(cl_event event);
+
+/* Answer a CL_PROFILING_KERNEL_*_INTEL query, returns CL_INVALID_VALUE for others */
+extern cl_int cl_kernel_perf_get_info(const cl_kernel_perf_info *info, cl_profiling_info param_name,
+                                      cl_ulong *value);
 
 #endif
@@ -0,0 +1,40 @@
+#include "utest_helper.hpp"
+
+/* Contiguous async copies of full sub-groups go through the block messages
+ * when the SLM side is aligned, the tail and the misaligned copies through
+ * the element loop */
+static void compiler_async_copy_block(void)
+{
+  const size_t n = 1031;
+  const size_t group_num = 4;
+  const size_t local_size = 64;
+
+  OCL_CREATE_KERNEL("compiler_async_copy_block");
+  OCL_CREATE_BUFFER(buf[0], 0, 2 * n * group_num * sizeof(uint32_t), NULL);
+  OCL_CREATE_BUFFER(buf[1], 0, n * group_num * sizeof(uint32_t), NULL);
+  OCL_SET_ARG(0, sizeof(cl_mem), &buf[0]);
+  OCL_SET_ARG(1, sizeof(cl_mem), &buf[1]);
+
+  OCL_MAP_BUFFER(1);
+  for (uint32_t i = 0; i < n * group_num; ++i)
+    ((uint32_t*)buf_data[1])[i] = rand();
+  OCL_UNMAP_BUFFER(1);
+
+  globals[0] = group_num * local_size;
+  locals[0] = local_size;
+  OCL_NDRANGE(1);
+
+  OCL_MAP_BUFFER(0);
+  OCL_MAP_BUFFER(1);
+  uint32_t *dst = (uint32_t*)buf_data[0];
+  uint32_t *src = (uint32_t*)buf_data[1];
+  for (uint32_t g = 0; g < group_num; ++g)
+    for (uint32_t i = 0; i < n; ++i) {
+      OCL_ASSERT(dst[2 * g * n + i] == src[g * n + i]);
+      OCL_ASSERT(dst[2 * g * n + n + i] == src[g * n + i]);
+    }
+  OCL_UNMAP_BUFFER(0);
+  OCL_UNMAP_BUFFER(1);
+}
+
+MAKE_UTEST_FROM_FUNCTION(compiler_async_copy_block);
@@ -0,0 +1,65 @@
+#include <cstdint>
+#include <cstring>
+#include "utest_helper.hpp"
+
+static void compiler_bitfield_run(const char *name, uint32_t dstNum)
+{
+  const size_t n = 32;
+  uint32_t src1[n], src2[n];
+
+  // Setup kernel and buffers
+  OCL_CREATE_KERNEL_FROM_FILE("compiler_bitfield", name);
+  OCL_CREATE_BUFFER(buf[0], 0, n * sizeof(uint32_t), NULL);
+  OCL_CREATE_BUFFER(buf[1], 0, n * sizeof(uint32_t), NULL);
+  OCL_CREATE_BUFFER(buf[2], 0, dstNum * n * sizeof(uint32_t), NULL);
+  OCL_SET_ARG(0, sizeof(cl_mem), &buf[0]);
+  OCL_SET_ARG(1, sizeof(cl_mem), &buf[1]);
+  OCL_SET_ARG(2, sizeof(cl_mem), &buf[2]);
+  globals[0] = n;
+  locals[0] = 16;
+
+  // The extract shifts cover the fields crossing the top bit
+  for (size_t i = 0; i < n; ++i) {
+    src1[i] = ((uint32_t)rand() << 16) ^ rand();
+    src2[i] = dstNum == 4 ? i : ((uint32_t)rand() << 16) ^ rand();
+  }
+  src1[0] = 0xffffffff;
+  src1[1] = 0;
+  OCL_MAP_BUFFER(0);
+  OCL_MAP_BUFFER(1);
+  memcpy(buf_data[0], src1, sizeof(src1));
+  memcpy(buf_data[1], src2, sizeof(src2));
+  OCL_UNMAP_BUFFER(0);
+  OCL_UNMAP_BUFFER(1);
+
+  OCL_NDRANGE(1);
+
+  OCL_MAP_BUFFER(2);
+  const uint32_t *dst = (const uint32_t *)buf_data[2];
+  for (size_t i = 0; i < n; ++i) {
+    const uint32_t x = src1[i], y = src2[i];
+    if (dstNum == 4) {
+      OCL_ASSERT(dst[4*i+0] == ((x >> 3) & 0x1f));
+      OCL_ASSERT(dst[4*i+1] == ((x >> 8) & 0xff));
+      OCL_ASSERT(dst[4*i+2] == ((x >> 20) & 0xfff));
+      OCL_ASSERT(dst[4*i+3] == ((x >> y) & 0x7f));
+    } else {
+      OCL_ASSERT(dst[2*i+0] == ((x & ~0xff00u) | ((y << 8) & 0xff00u)));
+      OCL_ASSERT(dst[2*i+1] == ((x & ~0x1f8u) | ((y & 0x3f) << 3)));
+    }
+  }
+  OCL_UNMAP_BUFFER(2);
+}
+
+void compiler_bitfield_extract(void)
+{
+  compiler_bitfield_run("compiler_bitfield_extract", 4);
+}
+
+void compiler_bitfield_insert(void)
+{
+  compiler_bitfield_run("compiler_bitfield_insert", 2);
+}
+
+MAKE_UTEST_FROM_FUNCTION(compiler_bitfield_extract);
+MAKE_UTEST_FROM_FUNCTION(compiler_bitfield_insert);
@@ -0,0 +1,39 @@
+#include <string.h>
+#include "utest_helper.hpp"
+
+void compiler_local_transpose(void)
+{
+  const int w = 64;
+  OCL_CREATE_KERNEL_FROM_FILE("compiler_local_transpose", "compiler_local_transpose");
+
+  // The padding is reported in the build log
+  char log[4096];
+  memset(log, 0, sizeof(log));
+  OCL_CALL(clGetProgramBuildInfo, program, device, CL_PROGRAM_BUILD_LOG, sizeof(log) - 1, log, NULL);
+  OCL_ASSERT(strstr(log, "are padded from 16 to 17 elements") != NULL);
+
+  OCL_CREATE_BUFFER(buf[0], 0, w * w * sizeof(float), NULL);
+  OCL_CREATE_BUFFER(buf[1], 0, w * w * sizeof(float), NULL);
+  OCL_SET_ARG(0, sizeof(cl_mem), &buf[0]);
+  OCL_SET_ARG(1, sizeof(cl_mem), &buf[1]);
+  OCL_SET_ARG(2, sizeof(int), &w);
+  globals[0] = w;
+  globals[1] = w;
+  locals[0] = 16;
+  locals[1] = 16;
+
+  OCL_MAP_BUFFER(0);
+  for (int i = 0; i < w * w; ++i)
+    ((float*)buf_data[0])[i] = (float)i;
+  OCL_UNMAP_BUFFER(0);
+
+  OCL_NDRANGE(2);
+
+  OCL_MAP_BUFFER(1);
+  for (int y = 0; y < w; ++y)
+    for (int x = 0; x < w; ++x)
+      OCL_ASSERT(((float*)buf_data[1])[y * w + x] == (float)(x * w + y));
+  OCL_UNMAP_BUFFER(1);
+}
+
+MAKE_UTEST_FROM_FUNCTION(compiler_local_transpose);
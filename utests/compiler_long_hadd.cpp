@@ -0,0 +1,70 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include "utest_helper.hpp"
+
+/* The sums overflow 64 bits for the first values, the hardware must not. */
+static void compiler_long_hadd_run(const char *name, bool round)
+{
+  const size_t n = 32;
+  uint64_t src1[n], src2[n];
+
+  // Setup kernel and buffers
+  OCL_CREATE_KERNEL_FROM_FILE("compiler_long_hadd", name);
+  OCL_CREATE_BUFFER(buf[0], 0, n * sizeof(uint64_t), NULL);
+  OCL_CREATE_BUFFER(buf[1], 0, n * sizeof(uint64_t), NULL);
+  OCL_CREATE_BUFFER(buf[2], 0, n * sizeof(uint64_t), NULL);
+  OCL_SET_ARG(0, sizeof(cl_mem), &buf[0]);
+  OCL_SET_ARG(1, sizeof(cl_mem), &buf[1]);
+  OCL_SET_ARG(2, sizeof(cl_mem), &buf[2]);
+  globals[0] = n;
+  locals[0] = 16;
+
+  src1[0] = src2[0] = 0xFFFFFFFFFFFFFFFFULL;
+  src1[1] = 0xFFFFFFFFFFFFFFFFULL; src2[1] = 0xFFFFFFFFFFFFFFFEULL;
+  src1[2] = 0x8000000000000000ULL; src2[2] = 0x8000000000000001ULL;
+  src1[3] = 0x7FFFFFFFFFFFFFFFULL; src2[3] = 0x8000000000000000ULL;
+  src1[4] = 0x00000000FFFFFFFFULL; src2[4] = 0x0000000000000001ULL;
+  src1[5] = 0; src2[5] = 1;
+  for (size_t i = 6; i < n; ++i) {
+    src1[i] = ((uint64_t)rand() << 33) ^ ((uint64_t)rand() << 16) ^ rand();
+    src2[i] = ((uint64_t)rand() << 33) ^ ((uint64_t)rand() << 16) ^ rand();
+  }
+  OCL_MAP_BUFFER(0);
+  OCL_MAP_BUFFER(1);
+  memcpy(buf_data[0], src1, sizeof(src1));
+  memcpy(buf_data[1], src2, sizeof(src2));
+  OCL_UNMAP_BUFFER(0);
+  OCL_UNMAP_BUFFER(1);
+
+  OCL_NDRANGE(1);
+
+  // Compare, the unsigned and signed results have the same bits
+  const bool isSigned = strstr(name, "signed") != NULL;
+  OCL_MAP_BUFFER(2);
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t expect;
+    if (isSigned) {
+      int64_t a = (int64_t)src1[i], b = (int64_t)src2[i];
+      expect = (uint64_t)((a >> 1) + (b >> 1) + ((round ? (a | b) : (a & b)) & 1));
+    } else
+      expect = (src1[i] >> 1) + (src2[i] >> 1) + ((round ? (src1[i] | src2[i]) : (src1[i] & src2[i])) & 1);
+    OCL_ASSERT(((uint64_t *)buf_data[2])[i] == expect);
+  }
+  OCL_UNMAP_BUFFER(2);
+}
+
+void compiler_long_hadd(void)
+{
+  compiler_long_hadd_run("compiler_long_hadd", false);
+  compiler_long_hadd_run("compiler_long_hadd_signed", false);
+}
+
+void compiler_long_rhadd(void)
+{
+  compiler_long_hadd_run("compiler_long_rhadd", true);
+  compiler_long_hadd_run("compiler_long_rhadd_signed", true);
+}
+
+MAKE_UTEST_FROM_FUNCTION(compiler_long_hadd);
+MAKE_UTEST_FROM_FUNCTION(compiler_long_rhadd);
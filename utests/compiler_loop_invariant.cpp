@@ -0,0 +1,42 @@
+#include "utest_helper.hpp"
+
+void compiler_loop_invariant(void)
+{
+  const size_t n = 64;
+  const int stride = 32, tripNum = 5;
+  const size_t srcNum = n * stride;
+
+  // Setup kernel and buffers
+  OCL_CREATE_KERNEL("compiler_loop_invariant");
+  OCL_CREATE_BUFFER(buf[0], 0, n * sizeof(int), NULL);
+  OCL_CREATE_BUFFER(buf[1], 0, srcNum * sizeof(int), NULL);
+  OCL_SET_ARG(0, sizeof(cl_mem), &buf[0]);
+  OCL_SET_ARG(1, sizeof(cl_mem), &buf[1]);
+  OCL_SET_ARG(2, sizeof(int), &stride);
+  OCL_SET_ARG(3, sizeof(int), &tripNum);
+  globals[0] = n;
+  locals[0] = 16;
+
+  OCL_MAP_BUFFER(1);
+  for (size_t i = 0; i < srcNum; ++i)
+    ((int *)buf_data[1])[i] = rand() % 1000;
+  OCL_UNMAP_BUFFER(1);
+
+  OCL_NDRANGE(1);
+
+  // Compare
+  OCL_MAP_BUFFER(0);
+  OCL_MAP_BUFFER(1);
+  const int *src = (const int *)buf_data[1];
+  for (int gid = 0; gid < (int)n; ++gid) {
+    int sum = 0;
+    for (int k = 0; k < tripNum + (gid & 3); k++)
+      for (int j = 0; j < 3; j++)
+        sum += src[gid * stride + k * 3 + j] * (j + 1);
+    OCL_ASSERT(((int *)buf_data[0])[gid] == sum);
+  }
+  OCL_UNMAP_BUFFER(1);
+  OCL_UNMAP_BUFFER(0);
+}
+
+MAKE_UTEST_FROM_FUNCTION(compiler_loop_invariant);
@@ -0,0 +1,42 @@
+#include <cmath>
+#include "utest_helper.hpp"
+
+/* With relaxed math, a * b + (1 - a) * c is selected as a single LRP */
+void compiler_lrp(void)
+{
+  const size_t n = 256;
+
+  OCL_CALL(cl_kernel_init, "compiler_lrp.cl", "compiler_lrp", SOURCE, "-cl-fast-relaxed-math");
+  for (int i = 0; i < 4; ++i) {
+    OCL_CREATE_BUFFER(buf[i], 0, n * sizeof(float), NULL);
+    OCL_SET_ARG(i, sizeof(cl_mem), &buf[i]);
+  }
+  globals[0] = n;
+  locals[0] = 16;
+
+  OCL_MAP_BUFFER(1);
+  OCL_MAP_BUFFER(2);
+  OCL_MAP_BUFFER(3);
+  for (uint32_t i = 0; i < n; ++i) {
+    ((float *)buf_data[1])[i] = (float)(i % 17) / 16.0f;
+    ((float *)buf_data[2])[i] = (float)i * 0.5f - 20.0f;
+    ((float *)buf_data[3])[i] = 100.0f - (float)i * 0.25f;
+  }
+  OCL_UNMAP_BUFFER(1);
+  OCL_UNMAP_BUFFER(2);
+  OCL_UNMAP_BUFFER(3);
+
+  OCL_NDRANGE(1);
+
+  OCL_MAP_BUFFER(0);
+  for (uint32_t i = 0; i < n; ++i) {
+    const float a = (float)(i % 17) / 16.0f;
+    const float b = (float)i * 0.5f - 20.0f;
+    const float c = 100.0f - (float)i * 0.25f;
+    const float ref = a * b + (1.0f - a) * c;
+    OCL_ASSERT(fabsf(((float *)buf_data[0])[i] - ref) <= 1e-4f * (1.0f + fabsf(ref)));
+  }
+  OCL_UNMAP_BUFFER(0);
+}
+
+MAKE_UTEST_FROM_FUNCTION(compiler_lrp);
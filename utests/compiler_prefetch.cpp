@@ -0,0 +1,45 @@
+#include "utest_helper.hpp"
+
+/* prefetch() and the raw __gen_ocl_prefetch hint must not disturb the loads
+ * that follow them, on the BTI path (1.2) and the stateless A64 path (2.0) */
+static void run_prefetch(const char *options)
+{
+  const size_t n = 1024;
+
+  OCL_CALL(cl_kernel_init, "compiler_prefetch.cl", "compiler_prefetch", SOURCE, options);
+  /* One spare group so the look-ahead hint of the last group stays in bounds */
+  OCL_CREATE_BUFFER(buf[0], 0, n * sizeof(int), NULL);
+  OCL_CREATE_BUFFER(buf[1], 0, (n + 64) * sizeof(int), NULL);
+  OCL_SET_ARG(0, sizeof(cl_mem), &buf[0]);
+  OCL_SET_ARG(1, sizeof(cl_mem), &buf[1]);
+  globals[0] = n;
+  locals[0] = 64;
+
+  OCL_MAP_BUFFER(1);
+  for (uint32_t i = 0; i < n + 64; ++i)
+    ((int *)buf_data[1])[i] = i * 3 - 7;
+  OCL_UNMAP_BUFFER(1);
+
+  OCL_NDRANGE(1);
+
+  OCL_MAP_BUFFER(0);
+  for (uint32_t i = 0; i < n; ++i)
+    OCL_ASSERT(((int *)buf_data[0])[i] == ((int)i * 3 - 7) * 2 + 1);
+  OCL_UNMAP_BUFFER(0);
+}
+
+void compiler_prefetch(void)
+{
+  run_prefetch(NULL);
+}
+
+MAKE_UTEST_FROM_FUNCTION(compiler_prefetch);
+
+void compiler_prefetch_20(void)
+{
+  if (!cl_check_ocl20(false))
+    return;
+  run_prefetch("-cl-std=CL2.0");
+}
+
+MAKE_UTEST_FROM_FUNCTION(compiler_prefetch_20);
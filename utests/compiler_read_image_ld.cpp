@@ -0,0 +1,72 @@
+#include <string.h>
+#include <math.h>
+#include "utest_helper.hpp"
+
+// The reads with a constant unnormalized, CLK_ADDRESS_NONE and
+// CLK_FILTER_NEAREST sampler and the reads without sampler use a LD message,
+// they must return the same texels as the sampler argument read
+static void compiler_read_image_ld(void)
+{
+  const size_t w = 64;
+  const size_t h = 32;
+  cl_image_format format;
+  cl_image_desc desc;
+  cl_sampler sampler;
+
+  memset(&desc, 0x0, sizeof(cl_image_desc));
+  memset(&format, 0x0, sizeof(cl_image_format));
+
+  // Setup kernel and image
+  OCL_CREATE_KERNEL("compiler_read_image_ld");
+  buf_data[0] = (uint32_t*) malloc(sizeof(uint32_t) * w * h);
+  for (uint32_t j = 0; j < h; ++j)
+    for (uint32_t i = 0; i < w; i++)
+      ((uint32_t*)buf_data[0])[j * w + i] = (j * w + i) * 0x01030507u;
+
+  format.image_channel_order = CL_RGBA;
+  format.image_channel_data_type = CL_UNORM_INT8;
+  desc.image_type = CL_MEM_OBJECT_IMAGE2D;
+  desc.image_width = w;
+  desc.image_height = h;
+  desc.image_row_pitch = w * sizeof(uint32_t);
+  OCL_CREATE_IMAGE(buf[0], CL_MEM_COPY_HOST_PTR, &format, &desc, buf_data[0]);
+  OCL_CREATE_SAMPLER(sampler, CL_ADDRESS_NONE, CL_FILTER_NEAREST);
+  OCL_CREATE_BUFFER(buf[1], 0, w * h * sizeof(float) * 4, NULL);
+  OCL_CREATE_BUFFER(buf[2], 0, w * h * sizeof(float) * 4, NULL);
+  OCL_CREATE_BUFFER(buf[3], 0, w * h * sizeof(float) * 4, NULL);
+
+  // Run the kernel
+  OCL_SET_ARG(0, sizeof(cl_mem), &buf[0]);
+  OCL_SET_ARG(1, sizeof(sampler), &sampler);
+  OCL_SET_ARG(2, sizeof(cl_mem), &buf[1]);
+  OCL_SET_ARG(3, sizeof(cl_mem), &buf[2]);
+  OCL_SET_ARG(4, sizeof(cl_mem), &buf[3]);
+  globals[0] = w;
+  globals[1] = h;
+  locals[0] = 16;
+  locals[1] = 4;
+  OCL_NDRANGE(2);
+
+  // Check result
+  OCL_MAP_BUFFER(1);
+  OCL_MAP_BUFFER(2);
+  OCL_MAP_BUFFER(3);
+  for (uint32_t j = 0; j < h; ++j)
+    for (uint32_t i = 0; i < w; i++) {
+      const uint32_t texel = ((uint32_t*)buf_data[0])[j * w + (w - 1 - i)];
+      for (uint32_t c = 0; c < 4; c++) {
+        const float ref = ((texel >> (8 * c)) & 0xff) / 255.f;
+        for (uint32_t k = 1; k <= 3; k++)
+          OCL_ASSERT(fabs(((float*)buf_data[k])[(j * w + i) * 4 + c] - ref) < 1e-5f);
+      }
+    }
+  OCL_UNMAP_BUFFER(1);
+  OCL_UNMAP_BUFFER(2);
+  OCL_UNMAP_BUFFER(3);
+
+  free(buf_data[0]);
+  buf_data[0] = NULL;
+  OCL_CALL(clReleaseSampler, sampler);
+}
+
+MAKE_UTEST_FROM_FUNCTION(compiler_read_image_ld);
@@ -0,0 +1,50 @@
+#include "utest_helper.hpp"
+
+void compiler_sub_group_shuffle_const(void)
+{
+  if(!cl_check_subgroups())
+    return;
+  const size_t n = 32;
+  const int32_t buf_size = 8 * n + 1;
+
+  // Setup kernel and buffers
+  OCL_CREATE_KERNEL("compiler_sub_group_shuffle_const");
+  OCL_CREATE_BUFFER(buf[0], 0, buf_size * sizeof(int), NULL);
+  OCL_SET_ARG(0, sizeof(cl_mem), &buf[0]);
+
+  int c = 5;
+  OCL_SET_ARG(1, sizeof(int), &c);
+
+  globals[0] = n;
+  locals[0] = 16;
+
+  OCL_MAP_BUFFER(0);
+  for (int32_t i = 0; i < buf_size; ++i)
+    ((int*)buf_data[0])[i] = -1;
+  OCL_UNMAP_BUFFER(0);
+
+  // Run the kernel on GPU
+  OCL_NDRANGE(1);
+
+  // Compare
+  OCL_MAP_BUFFER(0);
+  int* dst = (int *)buf_data[0];
+  int suggroupsize = dst[0];
+  OCL_ASSERT(suggroupsize == 8 || suggroupsize == 16);
+
+  dst++;
+  for (int32_t i = 0; i < (int32_t) n; ++i){
+    int base = i / suggroupsize * suggroupsize;
+    int index = i % suggroupsize;
+    OCL_ASSERT(base + (index ^ 1) == dst[8*i]);
+    OCL_ASSERT(base + (index ^ 2) == dst[8*i+1]);
+    OCL_ASSERT(base + (index ^ 4) == dst[8*i+2]);
+    OCL_ASSERT(base + (index ^ 8) % suggroupsize == dst[8*i+3]);
+    OCL_ASSERT((index + 1 < suggroupsize ? base + index + 1 : -(base + index + 1 - suggroupsize)) == dst[8*i+4]);
+    OCL_ASSERT((index + 5 < suggroupsize ? base + index + 5 : -(base + index + 5 - suggroupsize)) == dst[8*i+5]);
+    OCL_ASSERT((index < 3 ? base + index - 3 + suggroupsize : -(base + index - 3)) == dst[8*i+6]);
+    OCL_ASSERT(base + c == dst[8*i+7]);
+  }
+  OCL_UNMAP_BUFFER(0);
+}
+MAKE_UTEST_FROM_FUNCTION(compiler_sub_group_shuffle_const);
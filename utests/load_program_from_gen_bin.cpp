@@ -1,6 +1,7 @@
 #include "utest_helper.hpp"
 #include "utest_file_map.hpp"
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 
 using namespace std;
@@ -52,6 +53,19 @@ static void test_load_program_from_gen_bin(void)
     /* OCL requires to build the program even if it is created from a binary */
     OCL_ASSERT(clBuildProgram(bin_program, 1, &device, NULL, NULL, NULL) == CL_SUCCESS);
 
+    /* The runtime realigns the binary for the in place (mapped) load, which
+       asserts its alignment in debug builds, whatever the user buffer is */
+    unsigned char *odd_storage = (unsigned char*)malloc(binarySize + 1);
+    OCL_ASSERT(odd_storage != NULL);
+    const unsigned char *odd_binary = odd_storage + 1;
+    memcpy(odd_storage + 1, binary, binarySize);
+    cl_program odd_program = clCreateProgramWithBinary(ctx, 1,
+              &device, &binarySize, &odd_binary, &binary_status, &status);
+    OCL_ASSERT(odd_program && status == CL_SUCCESS);
+    OCL_ASSERT(clBuildProgram(odd_program, 1, &device, NULL, NULL, NULL) == CL_SUCCESS);
+    clReleaseProgram(odd_program);
+    free(odd_storage);
+
     kernel = clCreateKernel(bin_program, "compiler_ceil", &status);
     OCL_ASSERT(status == CL_SUCCESS);
 